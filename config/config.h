@@ -132,12 +132,57 @@
 #define	USE_DSP			(0)	/* Use DSP */
 
 #define	ALWAYS_FPU_ATR		(1)	/* Always set the TA_FPU attribute on all tasks */
+#define	USE_LAZYFPU		(0)	/* Lazy FPU context switching (ARMv7-M, Requires USE_FPU) */
 
 /*---------------------------------------------------------------------- */
 /* Use Physical timer.
  *  1: Valid  0: Invalid
  */
 #define USE_PTMR		(0)	/* Use Physical timer */
+#define USE_PTMR_CAPTURE	(0)	/* Use Physical timer Input-capture/Compare */
+
+/*---------------------------------------------------------------------- */
+/* Interrupt statistics (Latency & Duration histogram)
+ *  1: Valid  0: Invalid
+ */
+#define USE_INTSTAT		(0)		/* Use interrupt statistics */
+#define INTSTAT_INTVEC		(N_INTVEC)	/* Number of measured interrupts */
+
+/*---------------------------------------------------------------------- */
+/* Deferred interrupt work (Bottom half)
+ *  1: Valid  0: Invalid
+ */
+#define USE_DEFWORK		(0)	/* Use deferred work queue */
+#define DEFWORK_NPRI		(2)	/* Number of priority levels (Worker tasks) */
+#define DEFWORK_QSZ		(16)	/* Queue size of each level (Power of 2) */
+#define DEFWORK_TSKPRI		(1)	/* Task priority of the level 0 worker */
+#define DEFWORK_STKSZ		(1024)	/* Stack size of the worker task */
+
+/*---------------------------------------------------------------------- */
+/* Binary log (Deferred formatting on the host)
+ *  1: Valid  0: Invalid
+ */
+#define USE_BINLOG		(0)	/* Use binary log */
+#define BINLOG_BUFSZ		(2048)	/* Log ring buffer size (Power of 2) */
+
+/*---------------------------------------------------------------------- */
+/* Slab allocator (Size-class memory allocation)
+ *  1: Valid  0: Invalid
+ *  It does not reduce the allocation failures of the random mixed sizes
+ *  (tools/slab_bench.c). Size SLAB_MEMSZ with the benchmark before use.
+ */
+#define USE_SLAB		(0)		/* Use slab allocator */
+#define SLAB_MEMSZ		(16*1024)	/* Slab area size */
+#define SLAB_PAGESZ		(512)		/* Page size (Power of 2, 512 or more) */
+#define SLAB_CACHE		(8)		/* Free blocks cached for the lock-free path of each class */
+#define SLAB_KMALLOC		(0)		/* Route Kmalloc() to the slab allocator (Linker option --wrap) */
+#define SLAB_LWIP		(0)		/* Route mem_malloc() of lwIP to the slab allocator */
+
+/*---------------------------------------------------------------------- */
+/* Task stack usage (Stack painting, ARMv7-M)
+ *  1: Valid  0: Invalid
+ */
+#define USE_STKUSE		(0)	/* Measure the maximum stack usage of tasks */
 
 /*---------------------------------------------------------------------- */
 /* Use Sample device driver.
@@ -33,6 +33,21 @@
  */
 #define USE_DEBUG_SYSMEMINFO   (1)		// 1:Valid   0:invalid
 
+/* ------------------------------------------------------------------------ */
+/*
+ *  Stack pointer monitoring function
+ *	The MPU guard region is placed at the bottom of the running task stack.
+ */
+#define USE_SPMON		(1)		// 1:Valid   0:invalid
+
+/* ------------------------------------------------------------------------ */
+/*
+ * Fast interrupt handler of static interrupt vector table (USE_STATIC_IVT)
+ *	List the handlers with FASTINT_VECTOR(intno, handler). (Up to 8 handlers)
+ *	  e.g.  #define STATIC_IVT_FASTINT	FASTINT_VECTOR(28, tim2_fast_hdr)
+ */
+#define STATIC_IVT_FASTINT
+
 /* ------------------------------------------------------------------------ */
 /* Device usage settings
  *	1: Use   0: Do not use
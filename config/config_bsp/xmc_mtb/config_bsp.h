@@ -39,6 +39,32 @@
  */
 #define USE_SPMON		(1)		// 1:Valid   0:invalid
 
+/* ------------------------------------------------------------------------ */
+/*
+ *  CPU interrupt (IRQ0-7) mapping of the system interrupts
+ *	CNF_CPUIRQ_LEVEL : Interrupt level of CPU interrupt IRQ0-7 (0: Not used)
+ *		Interrupt levels 1 and 7 are used by the OS and cannot be set.
+ *		If several CPU interrupts have the same level, EnableInt() maps the
+ *		system interrupt to the CPU interrupt with the fewest system interrupts.
+ *		The default table has two CPU interrupts (IRQ3, IRQ5) of level 5, which
+ *		is the level of the sample device drivers (I2C, A/DC).
+ *	CNF_CPUIRQ_FIXED : System interrupts mapped to a dedicated CPU interrupt
+ *		CPUIRQ_FIXED(intno, irq)  Other system interrupts are not mapped to 'irq'.
+ *		The level of 'irq' must not be 0 and must be the level of EnableInt().
+ *		Otherwise, EnableInt() does not map the system interrupt.
+ *		(Example) #define CNF_CPUIRQ_FIXED	CPUIRQ_FIXED(INTNO_INTSAR1_CH16, 5)
+ */
+#define CNF_CPUIRQ_LEVEL	{ 2, 3, 4, 5, 6, 5, 0, 0 }
+#define CNF_CPUIRQ_FIXED
+
+/* ------------------------------------------------------------------------ */
+/*
+ *  T-Monitor buffered transmission (USE_TM_TXBUF in config_tm.h)
+ *	CNF_TM_TXBUF_INTPRI : Interrupt level of the console UART (SCB3)
+ *		Must be one of the levels of CNF_CPUIRQ_LEVEL.
+ */
+#define CNF_TM_TXBUF_INTPRI	6
+
 /* ------------------------------------------------------------------------ */
 /* Device usage settings
  *	1: Use   0: Do not use
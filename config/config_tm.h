@@ -27,6 +27,8 @@
 #define	TM_COM_SERIAL_DEV	(1)	/* Use serial communication device */
 #define	TM_COM_NO_DEV		(0)	/* Do not use communication port */
 
+#define	TM_COM_BAUD		(115200)	/* Communication speed (bps) */
+
 /*---------------------------------------------------------------------- */
 /* tm_printf() call setting
  *         1: Valid  0: Invalid
@@ -34,4 +36,16 @@
 #define	USE_TM_PRINTF		(1)	/* Use tm_printf() & tm_sprintf() calls */
 #define	TM_OUTBUF_SZ		(0)	/* Output Buffer size in stack */
 
+/*---------------------------------------------------------------------- */
+/* Buffered transmission (STM32Cube, XMC7200)
+ *      tm_snd_dat() copies the data to the ring buffer and returns.
+ *      The UART transmit interrupt or DMA sends the buffered data.
+ *         1: Valid  0: Invalid
+ */
+#define	USE_TM_TXBUF		(0)	/* Use buffered transmission */
+#define	TM_TXBUF_DMA		(0)	/* Transmit by  1: DMA  0: UART interrupt (XMC7200: Interrupt only) */
+#define	TM_TXBUF_SZ		(1024)	/* Transmit buffer size (Power of 2) */
+#define	TM_TXBUF_BLOCK		(0)	/* Buffer full  1: Wait (Task only)  0: Discard */
+#define	TM_TXBUF_INTPRI		(14)	/* UART interrupt priority (XMC7200: CNF_TM_TXBUF_INTPRI) */
+
 #endif /* _MTKBSP_TM_CONFIG_H_ */
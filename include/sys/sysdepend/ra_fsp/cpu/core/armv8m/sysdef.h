@@ -135,6 +135,38 @@
 #define NVIC_IPR_BASE	0xE000E400
 #define NVIC_IPR(x)	(NVIC_IPR_BASE + (x))
 
+/*
+ * Cache maintenance operations (Cortex-M7/M85)
+ *	CCR.DC is always 0 on the cores without D-cache.
+ */
+#define CCR_DC		0x00010000	/* D-cache enable */
+#define SCB_DCIMVAC	0xE000EF5C	/* D-cache invalidate by address */
+#define SCB_DCCMVAC	0xE000EF68	/* D-cache clean by address */
+#define SCB_DCCIMVAC	0xE000EF70	/* D-cache clean and invalidate by address */
+#define DCACHE_LINE_SIZE	32	/* D-cache line size (bytes) */
+
+/*
+ * MPU (Memory protection unit)
+ */
+#define MPU_TYPE	0xE000ED90
+#define MPU_CTRL	0xE000ED94
+#define MPU_RNR		0xE000ED98
+#define MPU_RBAR	0xE000ED9C
+#define MPU_RLAR	0xE000EDA0
+#define MPU_MAIR0	0xE000EDC0
+#define MPU_MAIR1	0xE000EDC4
+
+#define MPU_TYPE_DREGION(x)	(((x) >> 8) & 0xFF)	/* Number of regions */
+#define MPU_CTRL_ENABLE		0x00000001	/* Enable MPU */
+#define MPU_CTRL_PRIVDEFENA	0x00000004	/* Default memory map for privileged access */
+
+#define MPU_RBAR_XN		0x00000001	/* Execute never */
+#define MPU_RBAR_AP_RW		0x00000002	/* Read/Write */
+#define MPU_RBAR_SH_OUTER	0x00000010	/* Outer shareable */
+#define MPU_RLAR_ENABLE		0x00000001	/* Enable region */
+#define MPU_RLAR_ATTR(n)	((n) << 1)	/* Attribute index (MAIR) */
+#define MPU_MAIR_NOCACHE	0x44		/* Normal, Non-cacheable */
+
 /*
  * FPU (Floating point unit) register  - System control block
  */
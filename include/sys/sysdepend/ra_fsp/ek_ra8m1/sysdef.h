@@ -44,4 +44,19 @@
 #define TMCLK_KHz	(CPUCLK_MHz*1000)	// System timer clock input (kHz)
 #define TMCLK		(CPUCLK_MHz)		// System timer clock input (MHz)
 
+/* ------------------------------------------------------------------------ */
+/*
+ * Memory region (MemRgnAlloc)
+ *	The area of the region is reserved by the linker script (lib/libtk/memrgn.c).
+ *	The region is empty if the linker script does not reserve it.
+ */
+#define MEMRGN_NUM		1
+
+/* DTCM   0x20000000 - 0x2001FFFF
+ *	(Example)  .mtk_memrgn0 (NOLOAD) : ALIGN(32) {
+ *			__mtk_memrgn0_start = .; . += 0x4000; __mtk_memrgn0_end = .;
+ *		   } >DTCM
+ */
+#define MEMRGN_0_ATR		(MRA_TCM)
+
 #endif /* _MTKBSP_TK_SYSDEF_DEPEND_H_ */
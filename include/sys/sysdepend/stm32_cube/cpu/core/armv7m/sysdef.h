@@ -74,6 +74,9 @@
 #define ICSR_PENDSVCLR	0x08000000	/* Remove the pending state from the PendSV exception. */
 #define ICSR_PENDSTCLR	0x02000000	/* SysCTick Clean pending */
 
+#define SHCSR_USGFAULTENA	0x00040000	/* Enable UsageFault */
+#define CFSR_NOCP		0x00080000	/* UsageFault: Coprocessor access (Write 1 to clear) */
+
 #define AIRCR_VECTKEY	0x05FA0000	/* AIRCR bit.31~16  VECTKEY */
 #define AIRCR_PRIGROUP7	0x00000700	/* AIRCR bit.10~8   PRIGROUP */
 #define	AIRCR_PRIGROUP6	0x00000600
@@ -131,8 +134,63 @@
 #define NVIC_IPR_BASE	0xE000E400
 #define NVIC_IPR(x)	(NVIC_IPR_BASE + (x))
 
+/*
+ * DWT (Data Watchpoint and Trace unit)
+ */
+#define SCB_DEMCR	0xE000EDFC
+#define DEMCR_TRCENA	0x01000000	/* Enable DWT */
+
+#define DWT_CTRL	0xE0001000
+#define DWT_CYCCNT	0xE0001004
+#define DWT_LAR		0xE0001FB0
+
+#define DWT_CTRL_CYCCNTENA	0x00000001	/* Enable cycle counter */
+#define DWT_LAR_UNLOCK		0xC5ACCE55	/* Unlock key */
+
+
+/*
+ * Cache maintenance operations (Cortex-M7/M85)
+ *	CCR.DC is always 0 on the cores without D-cache.
+ */
+#define CCR_DC		0x00010000	/* D-cache enable */
+#define SCB_DCIMVAC	0xE000EF5C	/* D-cache invalidate by address */
+#define SCB_DCCMVAC	0xE000EF68	/* D-cache clean by address */
+#define SCB_DCCIMVAC	0xE000EF70	/* D-cache clean and invalidate by address */
+#define DCACHE_LINE_SIZE	32	/* D-cache line size (bytes) */
+
+/*
+ * MPU (Memory protection unit)
+ */
+#define MPU_TYPE	0xE000ED90
+#define MPU_CTRL	0xE000ED94
+#define MPU_RNR		0xE000ED98
+#define MPU_RBAR	0xE000ED9C
+#define MPU_RASR	0xE000EDA0
+
+#define MPU_TYPE_DREGION(x)	(((x) >> 8) & 0xFF)	/* Number of regions */
+#define MPU_CTRL_ENABLE		0x00000001	/* Enable MPU */
+#define MPU_CTRL_PRIVDEFENA	0x00000004	/* Default memory map for privileged access */
+
+#define MPU_RASR_ENABLE		0x00000001	/* Enable region */
+#define MPU_RASR_SIZE(n)	(((n) - 1) << 1)	/* Region size (2^n bytes) */
+#define MPU_RASR_NOCACHE	0x000C0000	/* Normal, Non-cacheable, Shareable (TEX=1,S=1) */
+#define MPU_RASR_AP_RW		0x03000000	/* Read/Write */
+#define MPU_RASR_XN		0x10000000	/* Execute never */
+#define MPU_RBAR_VALID		0x00000010	/* Set MPU_RNR by RBAR[3:0] */
+
+/*
+ * Stack guard (USE_SPMON)
+ *	The MPU region MPU_RGN_STKGUARD (32 bytes, No access) is placed
+ *	STKGUARD_OFS bytes or more above the bottom of the task stack. The area
+ *	below the guard is left for the free block information of the memory
+ *	allocator, which is written when the task is deleted.
+ */
+#define MPU_RGN_STKGUARD	7
+#define STKGUARD_OFS		32
+#define STKGUARD_SIZE		32
+#define STKGUARD_RASR		(MPU_RASR_XN | MPU_RASR_SIZE(5) | MPU_RASR_ENABLE)
 
-#ifdef MTKBSP_CPU_CORE_ACM4F	/* ARM Cortex-M4F has FPU */
+#if defined(MTKBSP_CPU_CORE_ACM4F) || defined(MTKBSP_CPU_CORE_ACM7)	/* ARM Cortex-M4F/M7 has FPU */
 /*
  * FPU (Floating point unit) register  - System control block
  */
@@ -145,7 +203,7 @@
 #define FPU_FPCCR_ASPEN		0x80000000	/* FPCCR.ASPEN */
 #define FPU_FPCCR_LSPEN		0x40000000	/* FPCCR.LSPEN */
 
-#endif  /* CPU_CORE_ACM4F */
+#endif  /* CPU_CORE_ACM4F || CPU_CORE_ACM7 */
 
 
 /* ------------------------------------------------------------------------ */
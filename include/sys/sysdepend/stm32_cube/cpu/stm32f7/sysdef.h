@@ -181,6 +181,25 @@
 #define TIMxSR_UIF	(1<<0)
 #define TIMxEGR_UG	(1<<0)
 
+/* Capture/Compare channel (ch: 1-4) */
+#define TIMxDIER_CCIE(ch)	(1<<(ch))		/* Capture/Compare interrupt enable */
+#define TIMxDIER_CCDE(ch)	(1<<((ch)+8))		/* Capture/Compare DMA request enable */
+#define TIMxSR_CCIF(ch)		(1<<(ch))		/* Capture/Compare interrupt flag */
+#define TIMxSR_CCOF(ch)		(1<<((ch)+8))		/* Capture overcapture flag */
+#define TIMxCCER_CCE(ch)	(1<<(((ch)-1)*4))	/* Capture/Compare output enable */
+#define TIMxCCER_CCP(ch)	(1<<(((ch)-1)*4+1))	/* Capture/Compare polarity */
+#define TIMxCCER_CCNP(ch)	(1<<(((ch)-1)*4+3))	/* Capture/Compare complementary polarity */
+#define TIMxCCER_MASK(ch)	(0x0000000F<<(((ch)-1)*4))
+
+#define TIMxCCMR(ch)		(((ch)<=2)?TIMxCCMR1:TIMxCCMR2)
+#define TIMxCCR(ch)		(TIMxCCR1+((ch)-1)*4)
+#define TIMxCCMR_SHIFT(ch)	((((ch)-1)&1)*8)
+#define TIMxCCMR_MASK		(0x000000FF)
+#define TIMxCCMR_CCS_IN		(0x00000001)		/* CCxS: Input, ICx is mapped on TIx */
+#define TIMxCCMR_ICF(f)		(((f)&0x0F)<<4)		/* ICxF: Input capture filter */
+#define TIMxCCMR_OCM(m)		(((m)&0x07)<<4)		/* OCxM: Output compare mode */
+#define TIMxCCMR_OCPE		(0x00000008)		/* OCxPE: Output compare preload enable */
+
 /* Prescaler value */
 #define TIM2PSC_PSC_INIT	0
 #define TIM3PSC_PSC_INIT	0
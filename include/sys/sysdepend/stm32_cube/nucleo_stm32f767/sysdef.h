@@ -24,4 +24,20 @@
 /* CPU-dependent definition */
 #include <sys/sysdepend/stm32_cube/cpu/stm32f7/sysdef.h>
 
+/* ------------------------------------------------------------------------ */
+/*
+ * Memory region (MemRgnAlloc)
+ *	The area of the region is reserved by the linker script (lib/libtk/memrgn.c).
+ *	The region is empty if the linker script does not reserve it.
+ */
+#define MEMRGN_NUM		1
+
+/* DTCM   0x20000000 - 0x2001FFFF  (Accessible by DMA)
+ *	(Example)  Place the section in RAM before .data
+ *	.mtk_memrgn0 (NOLOAD) : ALIGN(32) {
+ *		__mtk_memrgn0_start = .; . += 0x4000; __mtk_memrgn0_end = .;
+ *	} >RAM
+ */
+#define MEMRGN_0_ATR		(MRA_TCM|MRA_DMA)
+
 #endif /* _MTKBSP_TK_SYSDEF_DEPEND_H_ */
@@ -24,4 +24,55 @@
 /* CPU-dependent definition */
 #include <sys/sysdepend/stm32_cube/cpu/stm32h7/sysdef.h>
 
+/* ------------------------------------------------------------------------ */
+/*
+ * Memory region (MemRgnAlloc)
+ *	The area of the region is reserved by the linker script (lib/libtk/memrgn.c).
+ *	The region is empty if the linker script does not reserve it, except
+ *	for the AXI SRAM region, which has the fallback area of the BSP.
+ *	ETHDMA can not access DTCM, so the DMA buffer is allocated from SRAM-D2,
+ *	or from AXI SRAM if SRAM-D2 is not reserved.
+ *	SRAM-D2 region is set to non-cacheable by the MPU. The size must be a
+ *	power of 2, and the start address must be aligned to the size.
+ *	AXI SRAM region is cacheable. The D-cache must be maintained for the DMA.
+ */
+#define MEMRGN_NUM		3
+
+/* DTCM   0x20000000 - 0x2001FFFF
+ *	(Example)  .mtk_memrgn0 (NOLOAD) : ALIGN(32) {
+ *			__mtk_memrgn0_start = .; . += 0x4000; __mtk_memrgn0_end = .;
+ *		   } >DTCMRAM
+ */
+#define MEMRGN_0_ATR		(MRA_TCM)
+
+/* SRAM-D2 (SRAM1, SRAM2)   0x30000000 - 0x30007FFF
+ *	(Example)  .mtk_memrgn1 (NOLOAD) : ALIGN(0x8000) {
+ *			__mtk_memrgn1_start = .; . += 0x8000; __mtk_memrgn1_end = .;
+ *		   } >RAM_D2
+ */
+#define MEMRGN_1_ATR		(MRA_DMA|MRA_NOCACHE)
+
+/* AXI SRAM (SRAM-D1)   0x24004000 - 0x2400BFFF  (Fallback area)
+ *	0x24000000 - 0x24003FFF is used by the net driver.
+ *	(Example)  .mtk_memrgn2 (NOLOAD) : ALIGN(32) {
+ *			__mtk_memrgn2_start = .; . += 0x8000; __mtk_memrgn2_end = .;
+ *		   } >RAM_D1
+ */
+#define MEMRGN_2_START		0x24004000
+#define MEMRGN_2_SIZE		0x00008000
+#define MEMRGN_2_ATR		(MRA_DMA)
+
+/* ------------------------------------------------------------------------ */
+/*
+ * DMA buffer section
+ *	DMA1/DMA2 and ETHDMA can not access DTCM. The static buffers accessed
+ *	by the DMA (e.g. T-Monitor transmit buffer) are placed in DMABUF_SECTION.
+ *	The linker script must place the section in AXI SRAM or SRAM-D2.
+ *	  (Example)  .mtk_dmabuf (NOLOAD) : { *(.mtk_dmabuf) } >RAM_D1
+ *	DMABUF_REACHABLE() checks the address at run time, because the section
+ *	is placed with .bss if the linker script does not have it.
+ */
+#define DMABUF_SECTION		".mtk_dmabuf"
+#define DMABUF_REACHABLE(a)	((UW)(a) < 0x20000000 || (UW)(a) >= 0x20020000)	/* Not DTCM */
+
 #endif /* _MTKBSP_TK_SYSDEF_DEPEND_H_ */
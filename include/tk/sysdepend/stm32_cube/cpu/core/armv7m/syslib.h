@@ -53,6 +53,13 @@ IMPORT UW disint(void);			/* Disable interrupt */
  */
 #define INTPRI_GROUP(pri, subpri)	(((pri) << (8-INTPRI_BITWIDTH)) | (subpri))
 
+/*
+ * Fast interrupt
+ *	The handler is executed without the kernel processing.
+ *	'level' must be higher than INTPRI_MAX_EXTINT_PRI. (level < INTPRI_MAX_EXTINT_PRI)
+ */
+IMPORT ER DefineFastInt( UINT intno, FP inthdr, INT level );
+
 
 /* ------------------------------------------------------------------------ */
 /*
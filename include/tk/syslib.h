@@ -135,6 +135,117 @@ IMPORT void Kfree( void *ptr );
 #endif /* TK_SUPPORT_MEMLIB */
 
 
+/* ------------------------------------------------------------------------ */
+/*
+ * Slab allocator (BSP extension)
+ *	O(1) allocation of the size classes (16 - 512 bytes) without lock.
+ *	The larger sizes are passed to Kmalloc().
+ */
+#if USE_SLAB
+
+#define SLAB_NCLS	14		/* Number of size classes */
+
+typedef struct {
+	UW	size;			/* Block size */
+	UW	pages;			/* Number of pages */
+	UW	inuse;			/* Number of blocks in use */
+	UW	peak;			/* Peak number of blocks in use */
+	UW	nalloc;			/* Number of allocations */
+	UW	nfail;			/* Number of allocations passed to Kmalloc */
+} T_RSLAB;
+
+IMPORT void *SlabAlloc( size_t size );
+IMPORT void *SlabCalloc( size_t nmemb, size_t size );
+IMPORT void *SlabRealloc( void *ptr, size_t size );
+IMPORT void SlabFree( void *ptr );
+IMPORT ER SlabGetStat( INT cls, T_RSLAB *pk_rslab );
+IMPORT void PrintSlabStat( void );
+
+#endif /* USE_SLAB */
+
+
+/* ------------------------------------------------------------------------ */
+/*
+ * Memory region (BSP extension)
+ *	Allocate the memory from the region with the capability, which is
+ *	defined by MEMRGN_n_ATR in sysdef.h of the board and reserved by the
+ *	linker script. Returns NULL if no region is reserved. The memory is
+ *	not released. (e.g. Task stack in TCM)
+ *		ctsk.tskatr |= TA_USERBUF;
+ *		ctsk.bufptr = MemRgnAlloc(ctsk.stksz, 8, MRA_TCM);
+ */
+#define MRA_TCM		0x0001		/* Tightly coupled memory */
+#define MRA_DMA		0x0002		/* Accessible by the DMA of the peripherals */
+#define MRA_NOCACHE	0x0004		/* Non-cacheable */
+
+typedef struct {
+	void	*start;			/* Start address */
+	SZ	size;			/* Size (bytes) */
+	ATR	attr;			/* Capability (MRA_xxx) */
+	SZ	used;			/* Allocated size (bytes) */
+} T_RMEMRGN;
+
+IMPORT void *MemRgnAlloc( SZ size, SZ align, ATR attr );
+IMPORT ER MemRgnRef( INT no, T_RMEMRGN *pk_rmemrgn );
+
+
+/* ------------------------------------------------------------------------ */
+/*
+ * D-cache maintenance (BSP extension)
+ *	The buffer accessed by the DMA must be aligned to the cache line, and
+ *	the size must be a multiple of the cache line. (DCACHE_ALIGNED,
+ *	DCACHE_ROUNDUP, or MemRgnAlloc() with the alignment DCACHE_LINE_SIZE)
+ *		DCacheClean()		Before the DMA reads the buffer (TX)
+ *		DCacheInvalidate()	Before and after the DMA writes the buffer (RX)
+ *	No operation if the D-cache is disabled or not present.
+ */
+#ifndef DCACHE_LINE_SIZE
+#define DCACHE_LINE_SIZE	32
+#endif
+#define DCACHE_ALIGNED		__attribute__((aligned(DCACHE_LINE_SIZE)))
+#define DCACHE_ROUNDUP(sz)	(((sz) + DCACHE_LINE_SIZE - 1) & ~(DCACHE_LINE_SIZE - 1))
+
+IMPORT void DCacheClean( const void *addr, SZ size );
+IMPORT void DCacheInvalidate( void *addr, SZ size );
+IMPORT void DCacheFlush( const void *addr, SZ size );
+
+
+/* ------------------------------------------------------------------------ */
+/*
+ * Task stack usage (BSP extension)
+ *	The task stack is filled with the pattern when the task is created or
+ *	restarted, and the maximum used size is measured. (USE_STKUSE)
+ */
+#if USE_STKUSE
+
+typedef struct {
+	SZ	stksz;			/* Stack size (bytes) */
+	SZ	used;			/* Maximum used size (bytes) */
+} T_RSTKUSE;
+
+IMPORT ER GetStackUsage( ID tskid, T_RSTKUSE *pk_rstkuse );
+
+#endif /* USE_STKUSE */
+
+
+/* ------------------------------------------------------------------------ */
+/*
+ * Task FPU usage (BSP extension)
+ *	The FPU registers are saved and restored only when the FPU is handed
+ *	over to another task. (USE_LAZYFPU)
+ */
+#if USE_LAZYFPU
+
+typedef struct {
+	UW	handoff;		/* Number of times the task took over the FPU */
+	BOOL	owner;			/* The FPU registers hold the task context */
+} T_RFPUUSE;
+
+IMPORT ER GetFpuUsage( ID tskid, T_RFPUUSE *pk_rfpuuse );
+
+#endif /* USE_LAZYFPU */
+
+
 /* ------------------------------------------------------------------------ */
 /*
  * Physical timer
@@ -162,9 +273,118 @@ IMPORT ER GetPhysicalTimerCount( UINT ptmrno, UW *p_count );
 IMPORT ER DefinePhysicalTimerHandler( UINT ptmrno, CONST T_DPTMR *pk_dptmr );
 IMPORT ER GetPhysicalTimerConfig(UINT ptmrno, T_RPTMR *pk_rptmr);
 
+#if USE_PTMR_CAPTURE
+/*
+ * Physical timer Input-capture / Output-compare (BSP extension)
+ *	StartPhysicalTimer() returns E_OBJ while the capture is running.
+ */
+#define TA_PTMR_CAP_RISE	0	/* Capture on rising edge */
+#define TA_PTMR_CAP_FALL	1	/* Capture on falling edge */
+#define TA_PTMR_CAP_BOTH	2	/* Capture on both edges */
+
+#define TA_PTMR_CMP_FROZEN	0	/* Compare: Output is not changed */
+#define TA_PTMR_CMP_ACTIVE	1	/* Compare: Set output active on match */
+#define TA_PTMR_CMP_INACTIVE	2	/* Compare: Set output inactive on match */
+#define TA_PTMR_CMP_TOGGLE	3	/* Compare: Toggle output on match */
+#define TA_PTMR_CMP_PWM1	6	/* Compare: PWM mode 1 */
+#define TA_PTMR_CMP_PWM2	7	/* Compare: PWM mode 2 */
+
+typedef struct {
+	UINT	ch;		/* Capture channel */
+	ATR	capatr;		/* Capture edge attribute */
+	UINT	filter;		/* Input filter value */
+	UW	*capbuf;	/* Capture ring buffer */
+	INT	bufsz;		/* Ring buffer size (Number of capture values) */
+	void	*dmahdl;	/* DMA handle (NULL: Interrupt transfer) */
+} T_CPTMR;
+
+typedef struct {
+	UINT	ch;		/* Compare channel */
+	ATR	cmpatr;		/* Compare output mode */
+	UW	cmpval;		/* Compare value */
+} T_MPTMR;
+
+IMPORT ER StartPhysicalTimerCapture( UINT ptmrno, CONST T_CPTMR *pk_cptmr );
+IMPORT ER StopPhysicalTimerCapture( UINT ptmrno );
+IMPORT ER ReadPhysicalTimerCapture( UINT ptmrno, UW *buf, INT cnt );
+IMPORT ER SetPhysicalTimerCompare( UINT ptmrno, CONST T_MPTMR *pk_mptmr );
+
+#endif /* USE_PTMR_CAPTURE */
 #endif /* TK_SUPPORT_PTIMER */
 
 
+/* ------------------------------------------------------------------------ */
+/*
+ * Interrupt statistics (BSP extension)
+ *	Histogram of interrupt latency and handler duration (CPU cycles).
+ *	Bucket n counts the values of 2^(n-1) <= value < 2^n.
+ */
+#if USE_INTSTAT
+
+#define INTSTAT_NBKT	16		/* Number of histogram buckets */
+
+typedef struct {
+	UW	count;			/* Number of interrupts */
+	UW	maxlat;			/* Maximum latency (cycles) */
+	UW	maxdur;			/* Maximum duration (cycles) */
+	UH	lat[INTSTAT_NBKT];	/* Latency histogram */
+	UH	dur[INTSTAT_NBKT];	/* Duration histogram */
+} T_RINTSTAT;
+
+IMPORT void MarkIntPending( UINT intno );
+IMPORT ER GetIntStat( UINT intno, T_RINTSTAT *pk_rintstat );
+IMPORT ER ClearIntStat( UINT intno );
+IMPORT void PrintIntStat( void );
+
+#endif /* USE_INTSTAT */
+
+
+/* ------------------------------------------------------------------------ */
+/*
+ * Deferred work queue (BSP extension)
+ *	The interrupt handler enqueues a work item, and the worker task of
+ *	the priority level executes it in task context.
+ *	Level 0 is the highest priority. DeferWork() calls tk_wup_tsk(), so
+ *	the interrupt priority must be INTPRI_MAX_EXTINT_PRI or lower.
+ */
+#if USE_DEFWORK
+
+IMPORT ER InitDeferredWork( void );
+IMPORT ER DeferWork( INT pri, FP func, void *arg );
+IMPORT UW GetDeferredWorkLost( INT pri );
+
+#endif /* USE_DEFWORK */
+
+
+/* ------------------------------------------------------------------------ */
+/*
+ * Binary log (BSP extension)
+ *	BinLog(fmt, ...) records the format string ID and the arguments.
+ *	The text is formatted on the host with the ELF file (tools/binlog_dec.py).
+ *	'fmt' must be a string literal. The arguments are 32-bit integers.
+ *	(Cast pointers to UW. %s is decoded for constant strings in the ELF file.)
+ *	The number of the arguments must match the conversions of 'fmt'.
+ */
+#if USE_BINLOG
+
+#define BINLOG_MAXARG	6		/* Maximum number of arguments */
+
+#define BinLog(fmt, ...)						\
+	do {								\
+		static const char _binlog_fmt[]				\
+			__attribute__((section("binlog_fmt"))) = fmt;	\
+		const UW _binlog_arg[] = { 0, ##__VA_ARGS__ };		\
+		BinLogWrite(_binlog_fmt,				\
+			sizeof(_binlog_arg)/sizeof(UW) - 1, &_binlog_arg[1]);	\
+	} while(0)
+
+IMPORT void BinLogWrite( const char *fmt, INT narg, const UW *arg );
+IMPORT INT BinLogFlush( void );
+IMPORT UW GetBinLogLost( void );
+
+#endif /* USE_BINLOG */
+
+
 /* ------------------------------------------------------------------------ */
 /*
  * 4-character object name
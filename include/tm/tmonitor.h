@@ -25,4 +25,12 @@
 
 #include <mtkernel/include/tm/tmonitor.h>
 
+#if USE_TM_TXBUF
+/*
+ * Buffered transmission (BSP extension)
+ */
+IMPORT ER tm_com_start_txbuf( void );	/* Start buffered transmission */
+IMPORT void tm_com_flush( void );	/* Flush synchronously (for panic path) */
+#endif /* USE_TM_TXBUF */
+
 #endif /* _MTKBSP_TM_TMONITOR_H_ */
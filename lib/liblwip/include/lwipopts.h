@@ -183,6 +183,20 @@
 #define TCP_MSS                         1460
 
 #define MEM_SIZE                        16000
+
+/**
+ * MEM_CUSTOM_ALLOCATOR==1: mem_malloc() uses the slab allocator of the BSP
+ * (lib/libtk/slab.c) instead of the heap of MEM_SIZE.
+ */
+#include <config.h>
+#if USE_SLAB && SLAB_LWIP
+#include <tk/tkernel.h>
+#include <tk/syslib.h>
+#define MEM_CUSTOM_ALLOCATOR            1
+#define MEM_CUSTOM_FREE                 SlabFree
+#define MEM_CUSTOM_MALLOC               SlabAlloc
+#define MEM_CUSTOM_CALLOC               SlabCalloc
+#endif
 #define TCP_SND_QUEUELEN                40
 #define MEMP_NUM_TCP_SEG                TCP_SND_QUEUELEN
 #define TCP_SND_BUF                     (12 * TCP_MSS)
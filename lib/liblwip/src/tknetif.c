@@ -89,6 +89,18 @@
 #define DMAC_MPL_SIZE	((ETHER_DRV_MAX_RBUFF + 1) * 2048)
 #endif
 
+/* D-cache maintenance of the buffers accessed by the ETHDMA.
+   STM32H7: The receive pool and the transmit buffer are in the cacheable
+   AXI SRAM or SRAM-D2 unless the pool is allocated from a non-cacheable
+   memory region (MRA_NOCACHE). */
+#if defined(EVAL_STM32H743I) || defined(NUCLEO_STM32H723ZGT6) || defined(NUCLEO_STM32H742ZIT6) || defined(NUCLEO_STM32H743ZIT6)
+#define ETHER_DCACHE_CLEAN(addr, size)		DCacheClean((addr), (size))
+#define ETHER_DCACHE_INVALIDATE(addr, size)	DCacheInvalidate((addr), (size))
+#else
+#define ETHER_DCACHE_CLEAN(addr, size)
+#define ETHER_DCACHE_INVALIDATE(addr, size)
+#endif
+
 struct pbuf_ether {
 	struct pbuf_custom cpbuf;
 	
@@ -146,6 +158,8 @@ static void netif_ether_pbuf_free(struct pbuf* p)
   ER er;
   W asz;
   
+  /* Discard the cached lines before the ETHDMA writes the buffer. */
+  ETHER_DCACHE_INVALIDATE(pe->base, ETHER_DRV_BUFF_SIZE);
   er = tk_swri_dev(pe->devid, DN_NETRXBUF, &(pe->base), sizeof(void*), &asz);
   LWIP_ASSERT("netif_ether_pbuf_free: tk_swri_dev failed.\n", er >= E_OK);
 }
@@ -439,14 +453,25 @@ low_level_init(int ch, struct netif *netif)
   /* WARNING! STM32H7's ETHDMA module CAN NOT access the DTCM & ITCM. 
      So receive Buffer MUST be allocated from other internal memories. */
   cmpl.mplatr |= TA_USERBUF;
-  /* AXI SRAM: 0x24004000 - 0x2400BFFF(0x24000000 - 24003FFF Used by the net driver.)  */
-  cmpl.bufptr = (void *) 0x24004000;
+  /* DMA-capable memory region (SRAM-D2, or AXI SRAM of the fallback area in sysdef.h) */
+  cmpl.bufptr = MemRgnAlloc(DMAC_MPL_SIZE, ETHER_DRV_BUFF_ALIGNMENT, MRA_DMA);
+  if(cmpl.bufptr == NULL) {
+    /* AXI SRAM: 0x24004000 - 0x2400BFFF(0x24000000 - 24003FFF Used by the net driver.)  */
+    cmpl.bufptr = (void *) 0x24004000;
+  }
  #elif defined(NUCLEO_STM32H742ZIT6) || defined(NUCLEO_STM32H743ZIT6)
   /* WARNING! STM32H7's ETHDMA module CAN NOT access the DTCM & ITCM. 
      So receive Buffer MUST be allocated from other internal memories. */
   cmpl.mplatr |= TA_USERBUF;
   /* SRAM1: 0x30000000 - 0x30007FFF */
   cmpl.bufptr = (void *) 0x30000000;
+#else
+  /* Allocate from the DMA-capable memory region reserved by the linker script
+     (MEMRGN_n_ATR in sysdef.h). Otherwise the pool is created in the kernel heap. */
+  cmpl.bufptr = MemRgnAlloc(DMAC_MPL_SIZE, ETHER_DRV_BUFF_ALIGNMENT, MRA_DMA);
+  if(cmpl.bufptr != NULL) {
+    cmpl.mplatr |= TA_USERBUF;
+  }
 #endif
   ethernetif->mplid = tk_cre_mpl(&cmpl);
   LWIP_ASSERT("Error: cannot create memory pool.\n", ethernetif->mplid >= E_OK );
@@ -519,6 +544,7 @@ low_level_init(int ch, struct netif *netif)
     ercd = tk_get_mpl(ethernetif->mplid, ETHER_DRV_BUFF_SIZE + ETHER_BUF_HEADER_SIZE + ETHER_DRV_BUFF_ALIGNMENT, (void **) &ethernetif->drv_buf[i], TMO_POL);
     if(ercd >= E_OK){
       ptr = (void *) ROUNDUP((UW) ethernetif->drv_buf[i]) + ETHER_BUF_HEADER_SIZE;
+      ETHER_DCACHE_INVALIDATE(ptr, ETHER_DRV_BUFF_SIZE);
       ercd = tk_swri_dev(ethernetif->ethdevid, DN_NETRXBUF, &ptr, sizeof( void * ), &asize);
       if(ercd < E_OK){
         LWIP_DEBUGF(LWIP_DBG_LEVEL_WARNING | LWIP_DBG_ON, ((UB *)"Net receive buffer set error.\n"));
@@ -563,6 +589,7 @@ low_level_output(struct netif *netif, struct pbuf *p)
     memcpy(ethernetif->output_buf + dlen, q->payload, q->len);
     dlen += q->len;
   }
+  ETHER_DCACHE_CLEAN(ethernetif->output_buf, dlen);  /* Write back before the ETHDMA reads it */
 
   ercd = tk_swri_dev(ethernetif->ethdevid, 0, ethernetif->output_buf, dlen, &asize);
   if(ercd < E_OK){
@@ -609,6 +636,7 @@ low_level_input(struct netif *netif)
   }
   
   len = event.len;
+  ETHER_DCACHE_INVALIDATE(event.buf, event.len);  /* Read the data written by the ETHDMA */
 
 #if ETH_PAD_SIZE
   len += ETH_PAD_SIZE; /* allow room for Ethernet padding */
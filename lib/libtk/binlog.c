@@ -0,0 +1,173 @@
+/*
+ *----------------------------------------------------------------------
+ *    micro T-Kernel 3.0 BSP 2.0
+ *
+ *    Copyright (C) 2023-2024 by Ken Sakamura.
+ *    This software is distributed under the T-License 2.1.
+ *----------------------------------------------------------------------
+ *
+ *    Released by TRON Forum(http://www.tron.org) at 2024/08.
+ *
+ *----------------------------------------------------------------------
+ */
+
+/*
+ *	binlog.c
+ *	Binary log (Deferred formatting)
+ *
+ *	BinLog() records only the format string ID, the timestamp and the
+ *	raw arguments into the RAM ring buffer. The format strings are placed
+ *	in the "binlog_fmt" section, and the host tool (tools/binlog_dec.py)
+ *	formats the text with the ELF file.
+ *
+ *	Record	: UB narg, varint fmt_id, varint time_delta, varint arg[narg]
+ *		  fmt_id	Offset of the format string in "binlog_fmt" section
+ *		  time_delta	Time (ms) from the previous record
+ *		  arg		Zigzag-encoded argument
+ *	Frame	: "\0BLG", varint length, varint base_time, varint lost, Record...
+ *		  base_time	Time (ms) of the record just before the frame
+ *		  lost		Number of records lost by buffer full
+ */
+#include <tk/tkernel.h>
+#include <tk/syslib.h>
+
+#if USE_BINLOG
+
+#if !USE_TMONITOR
+#error "USE_BINLOG requires USE_TMONITOR."
+#endif
+#include <mtkernel/lib/libtm/libtm.h>
+
+#if (BINLOG_BUFSZ & (BINLOG_BUFSZ - 1)) != 0
+#error "BINLOG_BUFSZ must be a power of 2."
+#endif
+
+#define BINLOG_MASK	(BINLOG_BUFSZ - 1)
+
+IMPORT const char	__start_binlog_fmt[];		// Top of "binlog_fmt" section (Linker)
+
+LOCAL UB	blog_buf[BINLOG_BUFSZ];		// Log ring buffer
+LOCAL UW	blog_wp;			// Write position
+LOCAL UW	blog_rp;			// Read position (BinLogFlush)
+LOCAL UW	blog_wtime;			// Time of the last written record
+LOCAL UW	blog_rtime;			// Time of the last flushed record
+LOCAL UW	blog_lost;			// Number of lost records
+
+/*
+ * Encode the unsigned LEB128 variable length integer
+ */
+LOCAL INT put_varint( UB *p, UW val )
+{
+	INT	n = 0;
+
+	while(val >= 0x80) {
+		p[n++] = (UB)(val | 0x80);
+		val >>= 7;
+	}
+	p[n++] = (UB)val;
+	return n;
+}
+
+/*
+ * Copy to the ring buffer (Interrupt disabled)
+ */
+LOCAL void blog_copy( const UB *p, INT len )
+{
+	for( ; len > 0; len--) {
+		blog_buf[blog_wp & BINLOG_MASK] = *p++;
+		blog_wp++;
+	}
+}
+
+/*
+ * Write the log record
+ *	Called from BinLog(). Can be called from interrupt handlers and tasks.
+ *	If the buffer is full, the record is lost.
+ */
+EXPORT void BinLogWrite( const char *fmt, INT narg, const UW *arg )
+{
+	UB	hdr[1 + 5];			// narg, fmt_id
+	UB	dlt[5];				// time_delta
+	UB	args[5 * BINLOG_MAXARG];	// arg[narg]
+	INT	nh, nd, na, i;
+	SYSTIM	tim;
+	UW	now;
+	UINT	imask;
+
+	if(narg > BINLOG_MAXARG) narg = BINLOG_MAXARG;
+
+	nh = 0;
+	hdr[nh++] = (UB)narg;
+	nh += put_varint(&hdr[nh], (UW)(fmt - __start_binlog_fmt));
+	for(i = 0, na = 0; i < narg; i++) {
+		na += put_varint(&args[na], (arg[i] << 1) ^ (UW)((W)arg[i] >> 31));	// Zigzag encoding
+	}
+
+	DI(imask);
+	tk_get_otm(&tim);
+	now = (UW)tim.lo;
+	nd = put_varint(dlt, now - blog_wtime);
+	if(nh + nd + na > BINLOG_BUFSZ - (INT)(blog_wp - blog_rp)) {
+		blog_lost++;			// Buffer full
+	} else {
+		blog_copy(hdr, nh);
+		blog_copy(dlt, nd);
+		blog_copy(args, na);
+		blog_wtime = now;
+	}
+	EI(imask);
+}
+
+/*
+ * Send the ring buffer to the T-Monitor communication port
+ *	Call from one task only. Returns the number of sent bytes.
+ */
+EXPORT INT BinLogFlush( void )
+{
+	UB	hdr[4 + 5 * 3];
+	UW	rp, wp, wtime, lost;
+	INT	n, len, sz;
+	UINT	imask;
+
+	DI(imask);
+	rp	= blog_rp;
+	wp	= blog_wp;
+	wtime	= blog_wtime;
+	lost	= blog_lost;
+	blog_lost = 0;
+	EI(imask);
+
+	len = (INT)(wp - rp);
+	if(len == 0 && lost == 0) return 0;
+
+	hdr[0] = '\0'; hdr[1] = 'B'; hdr[2] = 'L'; hdr[3] = 'G';
+	n = 4;
+	n += put_varint(&hdr[n], (UW)len);
+	n += put_varint(&hdr[n], blog_rtime);
+	n += put_varint(&hdr[n], lost);
+	tm_snd_dat(hdr, n);
+
+	sz = BINLOG_BUFSZ - (INT)(rp & BINLOG_MASK);	// Up to the end of the buffer
+	if(sz > len) sz = len;
+	tm_snd_dat(&blog_buf[rp & BINLOG_MASK], sz);
+	if(len > sz) {
+		tm_snd_dat(&blog_buf[0], len - sz);
+	}
+
+	DI(imask);
+	blog_rp = wp;
+	blog_rtime = wtime;
+	EI(imask);
+
+	return len;
+}
+
+/*
+ * Get the number of lost records (Not flushed yet)
+ */
+EXPORT UW GetBinLogLost( void )
+{
+	return blog_lost;
+}
+
+#endif	/* USE_BINLOG */
@@ -0,0 +1,99 @@
+/*
+ *----------------------------------------------------------------------
+ *    micro T-Kernel 3.0 BSP 2.0
+ *
+ *    Copyright (C) 2023-2024 by Ken Sakamura.
+ *    This software is distributed under the T-License 2.1.
+ *----------------------------------------------------------------------
+ *
+ *    Released by TRON Forum(http://www.tron.org) at 2024/08.
+ *
+ *----------------------------------------------------------------------
+ */
+
+/*
+ *	dcache.c
+ *	D-cache maintenance for the DMA buffers
+ *
+ *	The cache maintenance registers are defined in sysdef.h of the CPU
+ *	core with D-cache (Cortex-M7/M85). The operations are skipped if the
+ *	D-cache is disabled (CCR.DC = 0) or the core has no D-cache.
+ */
+#include <tk/tkernel.h>
+#include <tk/syslib.h>
+#include <sys/sysdef.h>
+
+#ifdef SCB_DCCMVAC
+
+#define DCACHE_MASK	(DCACHE_LINE_SIZE - 1)
+
+/*
+ * Operate the cache lines from top to end
+ */
+LOCAL void dcache_op( UW reg, UW top, UW end )
+{
+	Asm("dsb" ::: "memory");
+	for( ; top < end; top += DCACHE_LINE_SIZE) {
+		out_w(reg, top);
+	}
+	Asm("dsb" ::: "memory");
+	Asm("isb" ::: "memory");
+}
+
+/*
+ * Clean the D-cache (Write back the data to the memory)
+ *	Call before the DMA reads the buffer.
+ */
+EXPORT void DCacheClean( const void *addr, SZ size )
+{
+	if((in_w(SCB_CCR) & CCR_DC) == 0 || size <= 0) return;
+
+	dcache_op(SCB_DCCMVAC, (UW)addr & ~DCACHE_MASK, (UW)addr + size);
+}
+
+/*
+ * Invalidate the D-cache (Discard the data in the cache)
+ *	Call after the DMA wrote the buffer, and before the buffer is passed to
+ *	the DMA. The partial lines at both ends are cleaned and invalidated,
+ *	not to lose the data out of the buffer.
+ */
+EXPORT void DCacheInvalidate( void *addr, SZ size )
+{
+	UW	top, end;
+
+	if((in_w(SCB_CCR) & CCR_DC) == 0 || size <= 0) return;
+
+	top = (UW)addr;
+	end = (UW)addr + size;
+	if((top & DCACHE_MASK) != 0) {
+		top &= ~DCACHE_MASK;
+		dcache_op(SCB_DCCIMVAC, top, top + DCACHE_LINE_SIZE);
+		top += DCACHE_LINE_SIZE;
+	}
+	if((end & DCACHE_MASK) != 0 && end > top) {
+		end &= ~DCACHE_MASK;
+		dcache_op(SCB_DCCIMVAC, end, end + DCACHE_LINE_SIZE);
+	}
+	if(end > top) {
+		dcache_op(SCB_DCIMVAC, top, end);
+	}
+}
+
+/*
+ * Clean and invalidate the D-cache
+ */
+EXPORT void DCacheFlush( const void *addr, SZ size )
+{
+	if((in_w(SCB_CCR) & CCR_DC) == 0 || size <= 0) return;
+
+	dcache_op(SCB_DCCIMVAC, (UW)addr & ~DCACHE_MASK, (UW)addr + size);
+}
+
+#else	/* SCB_DCCMVAC */
+
+/* The CPU core has no D-cache */
+EXPORT void DCacheClean( const void *addr, SZ size ) {}
+EXPORT void DCacheInvalidate( void *addr, SZ size ) {}
+EXPORT void DCacheFlush( const void *addr, SZ size ) {}
+
+#endif	/* SCB_DCCMVAC */
@@ -0,0 +1,182 @@
+/*
+ *----------------------------------------------------------------------
+ *    micro T-Kernel 3.0 BSP 2.0
+ *
+ *    Copyright (C) 2023-2024 by Ken Sakamura.
+ *    This software is distributed under the T-License 2.1.
+ *----------------------------------------------------------------------
+ *
+ *    Released by TRON Forum(http://www.tron.org) at 2024/08.
+ *
+ *----------------------------------------------------------------------
+ */
+
+/*
+ *	defwork.c
+ *	Deferred work queue (Bottom half of interrupt handler)
+ *
+ *	Each priority level has a bounded lock-free queue and a worker task.
+ *	The queue is written without disabling interrupts, and only the
+ *	worker task reads the queue. DeferWork() wakes up the worker task by
+ *	tk_wup_tsk(), so it can be called only from the interrupt handlers
+ *	with the priority of INTPRI_MAX_EXTINT_PRI or lower (Not from the
+ *	fast interrupt handlers).
+ */
+#ifndef DEFWORK_HOSTTEST
+#include <tk/tkernel.h>
+#include <tk/syslib.h>
+#endif
+
+#if USE_DEFWORK
+
+#if (DEFWORK_QSZ & (DEFWORK_QSZ - 1)) != 0
+#error "DEFWORK_QSZ must be a power of 2."
+#endif
+
+#define DEFWORK_QMASK	(DEFWORK_QSZ - 1)
+
+/* Work item */
+typedef struct {
+	UW	seq;		// Sequence number of the slot
+	FP	func;		// Work function
+	void	*arg;		// Argument
+} T_DWORK;
+
+/* Work queue */
+typedef struct {
+	UW	enqp;		// Enqueue position (Interrupt handlers)
+	UW	deqp;		// Dequeue position (Worker task)
+	UW	lost;		// Number of lost items (Queue full)
+	ID	tskid;		// Worker task ID
+	T_DWORK	item[DEFWORK_QSZ];
+} T_DWORKQ;
+
+LOCAL T_DWORKQ	dworkq[DEFWORK_NPRI];
+
+/*
+ * Dequeue the work item (Worker task only)
+ */
+LOCAL BOOL dwork_deq( T_DWORKQ *q, FP *func, void **arg )
+{
+	T_DWORK	*p;
+	UW	seq;
+
+	p = &q->item[q->deqp & DEFWORK_QMASK];
+	seq = __atomic_load_n(&p->seq, __ATOMIC_ACQUIRE);
+	if((W)(seq - (q->deqp + 1)) < 0) return FALSE;		// Empty
+
+	*func	= p->func;
+	*arg	= p->arg;
+	__atomic_store_n(&p->seq, q->deqp + DEFWORK_QSZ, __ATOMIC_RELEASE);
+	q->deqp++;
+
+	return TRUE;
+}
+
+/*
+ * Worker task
+ */
+LOCAL void dwork_task( INT stacd, void *exinf )
+{
+	T_DWORKQ	*q = &dworkq[stacd];
+	FP		func;
+	void		*arg;
+
+	(void)exinf;
+	while(1) {
+		while(dwork_deq(q, &func, &arg)) {
+			(*func)(arg);
+		}
+		tk_slp_tsk(TMO_FEVR);
+	}
+}
+
+/* ------------------------------------------------------------------------ */
+/*
+ * Deferred work API
+ */
+
+/*
+ * Enqueue the work item
+ *	Can be called from tasks and interrupt handlers of the priority
+ *	INTPRI_MAX_EXTINT_PRI or lower.
+ *	If the queue is full, E_LIMIT is returned and the item is lost.
+ */
+EXPORT ER DeferWork( INT pri, FP func, void *arg )
+{
+	T_DWORKQ	*q;
+	T_DWORK		*p;
+	UW		pos, seq;
+	W		dif;
+
+	if(pri < 0 || pri >= DEFWORK_NPRI || func == NULL) return E_PAR;
+	q = &dworkq[pri];
+
+	pos = __atomic_load_n(&q->enqp, __ATOMIC_RELAXED);
+	while(1) {
+		p = &q->item[pos & DEFWORK_QMASK];
+		seq = __atomic_load_n(&p->seq, __ATOMIC_ACQUIRE);
+		dif = (W)(seq - pos);
+		if(dif == 0) {
+			if(__atomic_compare_exchange_n(&q->enqp, &pos, pos + 1, TRUE,
+					__ATOMIC_RELAXED, __ATOMIC_RELAXED)) break;
+		} else if(dif < 0) {			// Queue full
+			__atomic_fetch_add(&q->lost, 1, __ATOMIC_RELAXED);
+			return E_LIMIT;
+		} else {
+			pos = __atomic_load_n(&q->enqp, __ATOMIC_RELAXED);
+		}
+	}
+	p->func	= func;
+	p->arg	= arg;
+	__atomic_store_n(&p->seq, pos + 1, __ATOMIC_RELEASE);
+
+	tk_wup_tsk(q->tskid);		// Wake up the worker task
+
+	return E_OK;
+}
+
+/*
+ * Get the number of lost work items
+ */
+EXPORT UW GetDeferredWorkLost( INT pri )
+{
+	if(pri < 0 || pri >= DEFWORK_NPRI) return 0;
+	return dworkq[pri].lost;
+}
+
+/*
+ * Initialize the deferred work queue (Create worker tasks)
+ */
+EXPORT ER InitDeferredWork( void )
+{
+	T_CTSK		ctsk;
+	T_DWORKQ	*q;
+	ID		tskid;
+	INT		i, j;
+
+	for(i = 0; i < DEFWORK_NPRI; i++) {
+		q = &dworkq[i];
+		q->enqp	= 0;
+		q->deqp	= 0;
+		q->lost	= 0;
+		for(j = 0; j < DEFWORK_QSZ; j++) {
+			q->item[j].seq = (UW)j;
+		}
+
+		ctsk.exinf	= 0;
+		ctsk.tskatr	= TA_HLNG | TA_RNG0;
+		ctsk.task	= (FP)dwork_task;
+		ctsk.itskpri	= DEFWORK_TSKPRI + i;
+		ctsk.stksz	= DEFWORK_STKSZ;
+		tskid = tk_cre_tsk(&ctsk);
+		if(tskid < E_OK) return (ER)tskid;
+
+		q->tskid = tskid;
+		tk_sta_tsk(tskid, i);
+	}
+
+	return E_OK;
+}
+
+#endif	/* USE_DEFWORK */
@@ -0,0 +1,168 @@
+/*
+ *----------------------------------------------------------------------
+ *    micro T-Kernel 3.0 BSP 2.0
+ *
+ *    Copyright (C) 2023-2024 by Ken Sakamura.
+ *    This software is distributed under the T-License 2.1.
+ *----------------------------------------------------------------------
+ *
+ *    Released by TRON Forum(http://www.tron.org) at 2024/08.
+ *
+ *----------------------------------------------------------------------
+ */
+
+/*
+ *	memrgn.c
+ *	Memory region registry
+ *
+ *	The memory regions are defined in sysdef.h of the board.
+ *		MEMRGN_NUM		Number of regions (max 4)
+ *		MEMRGN_n_ATR		Capability of region n (MRA_xxx)
+ *	The area of region n is reserved by a section of the linker script,
+ *	which defines the symbols __mtk_memrgn<n>_start and __mtk_memrgn<n>_end.
+ *	  (Example)  .mtk_memrgn0 (NOLOAD) : ALIGN(32) {
+ *			__mtk_memrgn0_start = .; . += 0x8000; __mtk_memrgn0_end = .;
+ *		     } >DTCMRAM
+ *	If the linker script does not define the symbols (Weak symbols), the
+ *	fallback area of the BSP is used.
+ *		MEMRGN_n_START		Start address of the fallback area
+ *		MEMRGN_n_SIZE		Size of the fallback area
+ *	The fallback area must not be used by the linker script of the board.
+ *	Without both, the region is empty, and the memory is allocated from
+ *	the other regions.
+ *	MemRgnAlloc() searches the regions in the order of the definition, and
+ *	allocates the memory from the first region with all the requested
+ *	capabilities.
+ */
+#include <tk/tkernel.h>
+#include <tk/syslib.h>
+#include <sys/sysdef.h>
+
+#ifndef MEMRGN_NUM
+#define MEMRGN_NUM	0
+#endif
+
+#if MEMRGN_NUM > 4
+#error "MEMRGN_NUM must be 4 or less."
+#endif
+
+#if MEMRGN_NUM > 0
+
+/* Start and end of the region (Linker script) */
+IMPORT UB	__mtk_memrgn0_start[] __attribute__((weak)), __mtk_memrgn0_end[] __attribute__((weak));
+#if MEMRGN_NUM > 1
+IMPORT UB	__mtk_memrgn1_start[] __attribute__((weak)), __mtk_memrgn1_end[] __attribute__((weak));
+#endif
+#if MEMRGN_NUM > 2
+IMPORT UB	__mtk_memrgn2_start[] __attribute__((weak)), __mtk_memrgn2_end[] __attribute__((weak));
+#endif
+#if MEMRGN_NUM > 3
+IMPORT UB	__mtk_memrgn3_start[] __attribute__((weak)), __mtk_memrgn3_end[] __attribute__((weak));
+#endif
+
+/* Fallback area of the region (sysdef.h) */
+#ifndef MEMRGN_0_START
+#define MEMRGN_0_START	0
+#define MEMRGN_0_SIZE	0
+#endif
+#ifndef MEMRGN_1_START
+#define MEMRGN_1_START	0
+#define MEMRGN_1_SIZE	0
+#endif
+#ifndef MEMRGN_2_START
+#define MEMRGN_2_START	0
+#define MEMRGN_2_SIZE	0
+#endif
+#ifndef MEMRGN_3_START
+#define MEMRGN_3_START	0
+#define MEMRGN_3_SIZE	0
+#endif
+
+typedef struct {
+	UB	*start;		// Start address (Linker script)
+	UB	*end;		// End address (Linker script)
+	UW	fbstart;	// Start address of the fallback area
+	UW	fbsize;		// Size of the fallback area
+	ATR	attr;		// Capability
+} T_MEMRGN;
+
+LOCAL const T_MEMRGN memrgn_tbl[MEMRGN_NUM] = {
+	{ __mtk_memrgn0_start, __mtk_memrgn0_end, MEMRGN_0_START, MEMRGN_0_SIZE, MEMRGN_0_ATR },
+#if MEMRGN_NUM > 1
+	{ __mtk_memrgn1_start, __mtk_memrgn1_end, MEMRGN_1_START, MEMRGN_1_SIZE, MEMRGN_1_ATR },
+#endif
+#if MEMRGN_NUM > 2
+	{ __mtk_memrgn2_start, __mtk_memrgn2_end, MEMRGN_2_START, MEMRGN_2_SIZE, MEMRGN_2_ATR },
+#endif
+#if MEMRGN_NUM > 3
+	{ __mtk_memrgn3_start, __mtk_memrgn3_end, MEMRGN_3_START, MEMRGN_3_SIZE, MEMRGN_3_ATR },
+#endif
+};
+
+#define rgn_start(r)	((r)->start != NULL? (UW)(r)->start: (r)->fbstart)
+#define rgn_size(r)	((r)->start != NULL? (UW)((r)->end - (r)->start): (r)->fbsize)
+
+LOCAL UW	memrgn_used[MEMRGN_NUM];		// Allocated size
+
+/*
+ * Allocate the memory from the region with the capability
+ *	align	Alignment (Power of 2, 0: sizeof(UW))
+ *	Returns NULL if no region has enough space.
+ */
+EXPORT void *MemRgnAlloc( SZ size, SZ align, ATR attr )
+{
+	const T_MEMRGN	*r;
+	UW		top;
+	UINT		imask;
+	INT		i;
+
+	if(size <= 0) return NULL;
+	if(align == 0) align = sizeof(UW);
+	if((align & (align - 1)) != 0) return NULL;
+
+	for(i = 0; i < MEMRGN_NUM; i++) {
+		r = &memrgn_tbl[i];
+		if((r->attr & attr) != attr) continue;
+
+		DI(imask);
+		top = (rgn_start(r) + memrgn_used[i] + (align - 1)) & ~(UW)(align - 1);
+		if(top + size <= rgn_start(r) + rgn_size(r)) {
+			memrgn_used[i] = top + size - rgn_start(r);
+			EI(imask);
+			return (void*)top;
+		}
+		EI(imask);
+	}
+	return NULL;
+}
+
+/*
+ * Refer the memory region
+ *	The size is 0 if neither the linker script nor the fallback area of
+ *	the BSP defines the region.
+ */
+EXPORT ER MemRgnRef( INT no, T_RMEMRGN *pk_rmemrgn )
+{
+	if(no < 0 || no >= MEMRGN_NUM || pk_rmemrgn == NULL) return E_PAR;
+
+	pk_rmemrgn->start	= (void*)rgn_start(&memrgn_tbl[no]);
+	pk_rmemrgn->size	= rgn_size(&memrgn_tbl[no]);
+	pk_rmemrgn->attr	= memrgn_tbl[no].attr;
+	pk_rmemrgn->used	= memrgn_used[no];
+
+	return E_OK;
+}
+
+#else	/* MEMRGN_NUM > 0 */
+
+EXPORT void *MemRgnAlloc( SZ size, SZ align, ATR attr )
+{
+	return NULL;
+}
+
+EXPORT ER MemRgnRef( INT no, T_RMEMRGN *pk_rmemrgn )
+{
+	return E_PAR;
+}
+
+#endif	/* MEMRGN_NUM > 0 */
@@ -0,0 +1,448 @@
+/*
+ *----------------------------------------------------------------------
+ *    micro T-Kernel 3.0 BSP 2.0
+ *
+ *    Copyright (C) 2023-2024 by Ken Sakamura.
+ *    This software is distributed under the T-License 2.1.
+ *----------------------------------------------------------------------
+ *
+ *    Released by TRON Forum(http://www.tron.org) at 2024/08.
+ *
+ *----------------------------------------------------------------------
+ */
+
+/*
+ *	slab.c
+ *	Size-class slab allocator
+ *
+ *	The slab area is divided into pages of SLAB_PAGESZ bytes. A page is
+ *	assigned to a size class and divided into the blocks of the class
+ *	size. Each page has its own free block list, and the page is returned
+ *	to the free pages when all the blocks are released. A block is reused
+ *	only by the same class, so a long-lived block never splits the free
+ *	area of the other classes. On the other hand, the size rounding and
+ *	the partially used pages of each class hold memory. With the random
+ *	mixed sizes at the high load, a first-fit heap of the same size fails
+ *	fewer allocations (tools/slab_bench.c).
+ *
+ *	Fast path: Each class caches up to SLAB_CACHE free blocks in a
+ *	lock-free stack. The stack head holds the block index (Offset /
+ *	SLAB_ALIGN + 1) and a 16-bit tag incremented by each update (ABA
+ *	counter), so the cached block is allocated and released without
+ *	disabling interrupts.
+ *	Slow path: The page lists are updated in a short interrupt disabled
+ *	section. All operations are O(1). SlabAlloc() and SlabFree() can be
+ *	called from interrupt handlers.
+ *
+ *	The size larger than the maximum class, and the request after the slab
+ *	area is exhausted, are passed to Kmalloc(). (Task context only)
+ *	If SLAB_KMALLOC is valid, Kmalloc() etc. are routed to this allocator
+ *	by the linker option:
+ *		-Wl,--wrap=Kmalloc,--wrap=Kcalloc,--wrap=Krealloc,--wrap=Kfree
+ */
+#ifndef SLAB_HOSTBENCH
+#include <tk/tkernel.h>
+#include <tk/syslib.h>
+#include <tm/tmonitor.h>
+#include <mtkernel/kernel/knlinc/tstdlib.h>
+#endif
+
+#if USE_SLAB
+
+#define SLAB_ALIGN	8				// Block alignment
+#define SLAB_NPAGE	(SLAB_MEMSZ / SLAB_PAGESZ)	// Number of pages
+#define SLAB_MAXSZ	512				// Maximum block size
+
+#if (SLAB_PAGESZ & (SLAB_PAGESZ - 1)) != 0 || SLAB_PAGESZ < SLAB_MAXSZ
+#error "SLAB_PAGESZ must be a power of 2 and 512 or more."
+#endif
+#if SLAB_MEMSZ / SLAB_ALIGN > 0xFFFF
+#error "SLAB_MEMSZ is too large."
+#endif
+
+/* Block size of the size class
+ *	Up to 64 bytes in steps of 8. Above 64 bytes, the largest multiple of
+ *	8 that divides a 512-byte page into 7 to 1 blocks, so that little of
+ *	the page tail is wasted. (e.g. 320 and 384 would hold one block per
+ *	page like 512)
+ */
+LOCAL const UH slab_size[SLAB_NCLS] = {
+	16, 24, 32, 40, 48, 56, 64, 72, 80, 96, 128, 168, 256, 512
+};
+
+/* Size class of the size ((size - 1) / 8) */
+LOCAL const UB slab_sel[SLAB_MAXSZ / 8] = {
+	 0,  0,  1,  2,  3,  4,  5,  6,  7,  8,  9,  9, 10, 10, 10, 10,
+	11, 11, 11, 11, 11, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,
+	13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13,
+	13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13
+};
+
+/* Page control */
+typedef struct {
+	UH	next;		// Next page (Page number + 1, 0: None)
+	UH	prev;		// Previous page of the partial page list
+	UH	free;		// Free block list (Block index, 0: Empty)
+	UH	ninit;		// Number of blocks taken out of the page
+	UH	inuse;		// Number of blocks in use (Including the cached blocks)
+	UB	cls;		// Size class
+} T_SLABPAGE;
+
+/* Size class control */
+typedef struct {
+	UW	cache;		// Cached free blocks (Tag << 16 | Block index, 0: Empty)
+	W	ncache;		// Number of cached blocks
+	UH	partial;	// Partial page list (Page number + 1, 0: None)
+	UW	pages;		// Number of pages
+	UW	inuse;		// Number of blocks in use
+	UW	peak;		// Peak number of blocks in use
+	UW	nalloc;		// Number of allocations
+	UW	nfail;		// Number of allocations passed to Kmalloc (Slab area exhausted)
+} T_SLABCLS;
+
+LOCAL UW		slab_area[SLAB_MEMSZ / sizeof(UW)] __attribute__((aligned(SLAB_ALIGN)));
+LOCAL T_SLABPAGE	slab_page[SLAB_NPAGE];
+LOCAL UH		slab_pgfree;		// Free page list (Page number + 1, 0: None)
+LOCAL UH		slab_pgnext;		// Next page never used
+LOCAL UH		slab_nfree = SLAB_NPAGE;	// Number of free pages
+LOCAL T_SLABCLS		slab_cls[SLAB_NCLS];
+
+#define blk_ptr(idx)	((UW*)((UB*)slab_area + ((idx) - 1) * SLAB_ALIGN))
+#define blk_idx(p)	((UW)(((UB*)(p) - (UB*)slab_area) / SLAB_ALIGN) + 1)
+#define in_slab(p)	((UB*)(p) >= (UB*)slab_area && (UB*)(p) < (UB*)slab_area + SLAB_MEMSZ)
+#define page_of(p)	(&slab_page[((UB*)(p) - (UB*)slab_area) / SLAB_PAGESZ])
+#define page_no(pg)	((UH)((pg) - slab_page) + 1)
+
+/* Memory allocation of the kernel (Out of the slab area) */
+#if SLAB_KMALLOC
+IMPORT void *__real_Kmalloc( size_t size );
+IMPORT void *__real_Krealloc( void *ptr, size_t size );
+IMPORT void __real_Kfree( void *ptr );
+#define heap_alloc	__real_Kmalloc
+#define heap_realloc	__real_Krealloc
+#define heap_free	__real_Kfree
+#else
+#define heap_alloc	Kmalloc
+#define heap_realloc	Krealloc
+#define heap_free	Kfree
+#endif
+
+/*
+ * Pop the block from the cache (NULL: Empty)
+ *	The next index may be read from the block allocated by the other
+ *	context. In that case, the tag has been changed and the CAS fails.
+ */
+LOCAL void *cache_pop( T_SLABCLS *c )
+{
+	UW	old, new, idx;
+
+	old = __atomic_load_n(&c->cache, __ATOMIC_ACQUIRE);
+	do {
+		idx = old & 0xFFFF;
+		if(idx == 0) return NULL;
+		new = ((old + 0x10000) & 0xFFFF0000) | (__atomic_load_n(blk_ptr(idx), __ATOMIC_RELAXED) & 0xFFFF);
+	} while(!__atomic_compare_exchange_n(&c->cache, &old, new, TRUE, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+
+	__atomic_fetch_sub(&c->ncache, 1, __ATOMIC_RELAXED);
+	return blk_ptr(idx);
+}
+
+/*
+ * Push the block to the cache (FALSE: Cache full)
+ *	The number of cached blocks may exceed SLAB_CACHE slightly by the
+ *	concurrent push.
+ */
+LOCAL BOOL cache_push( T_SLABCLS *c, UW *blk )
+{
+	UW	old, new;
+
+	if(__atomic_load_n(&c->ncache, __ATOMIC_RELAXED) >= SLAB_CACHE) return FALSE;
+
+	old = __atomic_load_n(&c->cache, __ATOMIC_RELAXED);
+	do {
+		__atomic_store_n(blk, old & 0xFFFF, __ATOMIC_RELAXED);
+		new = ((old + 0x10000) & 0xFFFF0000) | blk_idx(blk);
+	} while(!__atomic_compare_exchange_n(&c->cache, &old, new, TRUE, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+
+	__atomic_fetch_add(&c->ncache, 1, __ATOMIC_RELAXED);
+	return TRUE;
+}
+
+/*
+ * Link/Unlink the partial page list (Interrupt disabled)
+ */
+LOCAL void partial_link( T_SLABCLS *c, T_SLABPAGE *pg )
+{
+	pg->prev = 0;
+	pg->next = c->partial;
+	if(c->partial != 0) slab_page[c->partial - 1].prev = page_no(pg);
+	c->partial = page_no(pg);
+}
+
+LOCAL void partial_unlink( T_SLABCLS *c, T_SLABPAGE *pg )
+{
+	if(pg->prev != 0) slab_page[pg->prev - 1].next = pg->next;
+	else c->partial = pg->next;
+	if(pg->next != 0) slab_page[pg->next - 1].prev = pg->prev;
+}
+
+/*
+ * Allocate the block from the page (Slow path)
+ */
+LOCAL void *page_alloc( INT cls )
+{
+	T_SLABCLS	*c = &slab_cls[cls];
+	T_SLABPAGE	*pg;
+	UW		*blk;
+	UINT		imask;
+
+	DI(imask);
+	if(c->partial != 0) {
+		pg = &slab_page[c->partial - 1];
+	} else {					// Assign a free page
+		if(slab_pgfree != 0) {
+			pg = &slab_page[slab_pgfree - 1];
+			slab_pgfree = pg->next;
+		} else if(slab_pgnext < SLAB_NPAGE) {
+			pg = &slab_page[slab_pgnext++];
+		} else {
+			EI(imask);
+			return NULL;			// Slab area exhausted
+		}
+		slab_nfree--;
+		pg->cls		= (UB)cls;
+		pg->free	= 0;
+		pg->ninit	= 0;
+		pg->inuse	= 0;
+		partial_link(c, pg);
+		c->pages++;
+	}
+
+	if(pg->free != 0) {
+		blk = blk_ptr(pg->free);
+		pg->free = (UH)*blk;
+	} else {					// Take out the unused block
+		blk = (UW*)((UB*)slab_area + (page_no(pg) - 1) * SLAB_PAGESZ + pg->ninit * slab_size[cls]);
+		pg->ninit++;
+	}
+	pg->inuse++;
+	if(pg->free == 0 && pg->ninit >= SLAB_PAGESZ / slab_size[cls]) {
+		partial_unlink(c, pg);			// Page full
+	}
+	EI(imask);
+
+	return blk;
+}
+
+/*
+ * Return the block to the page (Slow path)
+ */
+LOCAL void page_free( T_SLABPAGE *pg, UW *blk )
+{
+	T_SLABCLS	*c = &slab_cls[pg->cls];
+	UINT		imask;
+
+	DI(imask);
+	if(pg->free == 0 && pg->ninit >= SLAB_PAGESZ / slab_size[pg->cls]) {
+		partial_link(c, pg);			// Page was full
+	}
+	*blk = pg->free;
+	pg->free = (UH)blk_idx(blk);
+	if(--pg->inuse == 0) {				// Return the page
+		partial_unlink(c, pg);
+		c->pages--;
+		pg->next = slab_pgfree;
+		slab_pgfree = page_no(pg);
+		slab_nfree++;
+	}
+	EI(imask);
+}
+
+/*
+ * Return all the cached blocks to the pages
+ *	Called when the slab area is exhausted, so that the pages kept by
+ *	the cached blocks are returned. (SLAB_NCLS * SLAB_CACHE blocks at most)
+ */
+LOCAL BOOL cache_drain( void )
+{
+	UW	*blk;
+	INT	cls;
+	BOOL	drained = FALSE;
+
+	for(cls = 0; cls < SLAB_NCLS; cls++) {
+		while((blk = cache_pop(&slab_cls[cls])) != NULL) {
+			page_free(page_of(blk), blk);
+			drained = TRUE;
+		}
+	}
+	return drained;
+}
+
+/*
+ * Allocate memory
+ *	When the slab area is exhausted, the cached blocks are returned to
+ *	the pages, and the free block of the larger class is used before
+ *	Kmalloc().
+ */
+EXPORT void *SlabAlloc( size_t size )
+{
+	T_SLABCLS	*c;
+	void		*p;
+	UW		inuse, peak;
+	INT		cls, k;
+	BOOL		retry;
+
+	if(size == 0 || size > SLAB_MAXSZ) return heap_alloc(size);
+
+	cls = slab_sel[(size - 1) >> 3];
+	c = &slab_cls[cls];
+	p = cache_pop(c);
+	if(p == NULL) p = page_alloc(cls);
+	for(retry = TRUE; p == NULL && retry; retry = cache_drain()) {
+		for(k = cls; k < SLAB_NCLS; k++) {
+			c = &slab_cls[k];
+			p = page_alloc(k);
+			if(p != NULL) break;
+		}
+	}
+	if(p == NULL) {
+		__atomic_fetch_add(&slab_cls[cls].nfail, 1, __ATOMIC_RELAXED);
+		return heap_alloc(size);
+	}
+
+	__atomic_fetch_add(&c->nalloc, 1, __ATOMIC_RELAXED);
+	inuse = __atomic_add_fetch(&c->inuse, 1, __ATOMIC_RELAXED);
+	peak = __atomic_load_n(&c->peak, __ATOMIC_RELAXED);
+	while(inuse > peak) {
+		if(__atomic_compare_exchange_n(&c->peak, &peak, inuse, TRUE, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) break;
+	}
+	return p;
+}
+
+/*
+ * Allocate memory and clear
+ */
+EXPORT void *SlabCalloc( size_t nmemb, size_t size )
+{
+	void	*p;
+
+	if(size != 0 && nmemb > (size_t)-1 / size) return NULL;
+
+	p = SlabAlloc(nmemb * size);
+	if(p != NULL) knl_memset(p, 0, nmemb * size);
+	return p;
+}
+
+/*
+ * Free memory
+ */
+EXPORT void SlabFree( void *ptr )
+{
+	T_SLABCLS	*c;
+	T_SLABPAGE	*pg;
+
+	if(ptr == NULL) return;
+	if(!in_slab(ptr)) {
+		heap_free(ptr);
+		return;
+	}
+
+	pg = page_of(ptr);
+	c = &slab_cls[pg->cls];
+	__atomic_fetch_sub(&c->inuse, 1, __ATOMIC_RELAXED);
+	if(!cache_push(c, (UW*)ptr)) page_free(pg, (UW*)ptr);
+}
+
+/*
+ * Reallocate memory
+ *	The block allocated by Kmalloc stays in the kernel memory.
+ */
+EXPORT void *SlabRealloc( void *ptr, size_t size )
+{
+	void	*p;
+	UW	osz;
+
+	if(ptr == NULL) return SlabAlloc(size);
+	if(!in_slab(ptr)) return heap_realloc(ptr, size);
+	if(size == 0) {
+		SlabFree(ptr);
+		return NULL;
+	}
+
+	osz = slab_size[page_of(ptr)->cls];
+	if(size <= osz) return ptr;
+
+	p = SlabAlloc(size);
+	if(p != NULL) {
+		knl_memcpy(p, ptr, osz);
+		SlabFree(ptr);
+	}
+	return p;
+}
+
+#if SLAB_KMALLOC
+/*
+ * Kmalloc() etc. (Linker option --wrap)
+ */
+EXPORT void *__wrap_Kmalloc( size_t size )
+{
+	return SlabAlloc(size);
+}
+
+EXPORT void *__wrap_Kcalloc( size_t nmemb, size_t size )
+{
+	return SlabCalloc(nmemb, size);
+}
+
+EXPORT void *__wrap_Krealloc( void *ptr, size_t size )
+{
+	return SlabRealloc(ptr, size);
+}
+
+EXPORT void __wrap_Kfree( void *ptr )
+{
+	SlabFree(ptr);
+}
+#endif /* SLAB_KMALLOC */
+
+/*
+ * Get the statistics of the size class
+ *	The counters are updated without lock, so they are not a snapshot.
+ */
+EXPORT ER SlabGetStat( INT cls, T_RSLAB *pk_rslab )
+{
+	T_SLABCLS	*c;
+
+	if(cls < 0 || cls >= SLAB_NCLS || pk_rslab == NULL) return E_PAR;
+
+	c = &slab_cls[cls];
+	pk_rslab->size	= slab_size[cls];
+	pk_rslab->pages	= __atomic_load_n(&c->pages, __ATOMIC_RELAXED);
+	pk_rslab->inuse	= __atomic_load_n(&c->inuse, __ATOMIC_RELAXED);
+	pk_rslab->peak	= __atomic_load_n(&c->peak, __ATOMIC_RELAXED);
+	pk_rslab->nalloc = __atomic_load_n(&c->nalloc, __ATOMIC_RELAXED);
+	pk_rslab->nfail	= __atomic_load_n(&c->nfail, __ATOMIC_RELAXED);
+
+	return E_OK;
+}
+
+/*
+ * Print the statistics to T-Monitor console
+ */
+EXPORT void PrintSlabStat( void )
+{
+#if USE_TMONITOR
+	T_RSLAB	stat;
+	INT	cls;
+
+	tm_printf((UB*)"SIZE PAGES  INUSE   PEAK     NALLOC  NFAIL\n");
+	for(cls = 0; cls < SLAB_NCLS; cls++) {
+		SlabGetStat(cls, &stat);
+		tm_printf((UB*)"%4d %5d %6d %6d %10d %6d\n",
+			stat.size, stat.pages, stat.inuse, stat.peak, stat.nalloc, stat.nfail);
+	}
+	tm_printf((UB*)"Free pages: %d / %d\n", slab_nfree, SLAB_NPAGE);
+#endif	/* USE_TMONITOR */
+}
+
+#endif	/* USE_SLAB */
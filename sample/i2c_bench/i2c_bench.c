@@ -0,0 +1,125 @@
+/*
+ *----------------------------------------------------------------------
+ *    micro T-Kernel 3.0 BSP 2.0
+ *
+ *    Copyright (C) 2023-2024 by Ken Sakamura.
+ *    This software is distributed under the T-License 2.1.
+ *----------------------------------------------------------------------
+ *
+ *    Released by TRON Forum(http://www.tron.org) at 2024/08.
+ *
+ *----------------------------------------------------------------------
+ */
+
+/*
+ *	i2c_bench.c
+ *	Benchmark of the I2C transfer (Sample task for the target)
+ *
+ *	Add this file to the application, and call i2c_bench_start() from
+ *	usermain() after the I2C device driver is registered.
+ *	The registers of the target device (e.g. EEPROM with 16-bit address)
+ *	are read with the payload sizes below and above the DMA threshold
+ *	(DEV_HAL_I2C_DMA_SIZE / DEV_HAL_LPI2C_DMA_SIZE), and the throughput
+ *	and the number of interrupts per transfer are printed by tm_printf().
+ *
+ *	The interrupts of the I2C and its DMA channels are counted by the
+ *	device driver, and read by the attribute data TDN_HAL_I2C_INTCNT.
+ *	Set DEV_HAL_I2C_INTCNT (hal_i2c_cnf.h) or DEV_HAL_LPI2C_INTCNT
+ *	(hal_lpi2c_cnf.h) to 1. If they are not counted, "-" is printed.
+ */
+#include <tk/tkernel.h>
+#include <tk/device.h>
+#include <tm/tmonitor.h>
+
+#if defined(MTKBSP_STM32CUBE) && DEVCNF_USE_HAL_IIC
+#define bench_read_regs		i2c_read_regs16
+#elif defined(MTKBSP_NXP_MCUX) && DEVCNF_USE_HAL_LPI2C
+#define bench_read_regs		hal_lpi2c_read_regs16
+#endif
+
+#ifdef bench_read_regs
+
+/* Benchmark setting */
+#define I2C_BENCH_DEV		"hiica"		// I2C device
+#define I2C_BENCH_SADR		(0x50)		// Target address
+#define I2C_BENCH_RADR		(0x0000)	// Register address (16-bit)
+#define I2C_BENCH_REPEAT	(100)		// Number of transfers for each size
+#define I2C_BENCH_MAXSZ		(256)		// Maximum payload size
+
+LOCAL UB	bench_buf[I2C_BENCH_MAXSZ] DCACHE_ALIGNED;
+LOCAL const SZ	bench_size[] = { 4, 16, 32, 64, 128, 256 };
+
+/* Number of the interrupts counted by the device driver (0: Not counted) */
+LOCAL UW bench_intcnt(ID dd)
+{
+	UW	cnt;
+	SZ	asz;
+
+	if(tk_srea_dev(dd, TDN_HAL_I2C_INTCNT, &cnt, sizeof(cnt), &asz) < E_OK) return 0;
+	return cnt;
+}
+
+LOCAL void i2c_bench_task(INT stacd, void *exinf)
+{
+	SYSTIM	st, et;
+	UW	ms, intcnt, bps;
+	ID	dd;
+	INT	i, n;
+	ER	err;
+
+	dd = tk_opn_dev((UB*)I2C_BENCH_DEV, TD_UPDATE);
+	if(dd < E_OK) {
+		tm_printf((UB*)"i2c_bench: %s open error %d\n", I2C_BENCH_DEV, dd);
+		tk_exd_tsk();
+	}
+
+	tm_printf((UB*)"i2c_bench: %s target 0x%02x, %d transfers\n",
+				I2C_BENCH_DEV, I2C_BENCH_SADR, I2C_BENCH_REPEAT);
+	tm_printf((UB*)"   size    bytes/s  interrupts/transfer\n");
+	for(i = 0; i < (INT)(sizeof(bench_size) / sizeof(SZ)); i++) {
+		err = E_OK;
+		intcnt = bench_intcnt(dd);
+		tk_get_otm(&st);
+		for(n = 0; n < I2C_BENCH_REPEAT && err >= E_OK; n++) {
+			err = bench_read_regs(dd, I2C_BENCH_SADR, I2C_BENCH_RADR, bench_buf, bench_size[i]);
+		}
+		tk_get_otm(&et);
+		intcnt = bench_intcnt(dd) - intcnt;
+
+		if(err < E_OK) {
+			tm_printf((UB*)"  %5d  error %d\n", bench_size[i], err);
+			continue;
+		}
+		ms = et.lo - st.lo;
+		bps = (ms > 0)? (UW)bench_size[i] * I2C_BENCH_REPEAT * 1000 / ms: 0;
+		if(intcnt > 0) {
+			tm_printf((UB*)"  %5d  %9d  %d.%02d\n", bench_size[i], bps,
+				intcnt / I2C_BENCH_REPEAT, (intcnt % I2C_BENCH_REPEAT) * 100 / I2C_BENCH_REPEAT);
+		} else {
+			tm_printf((UB*)"  %5d  %9d  -\n", bench_size[i], bps);
+		}
+	}
+
+	tk_cls_dev(dd, 0);
+	tk_exd_tsk();
+}
+
+/*
+ * Start the benchmark task
+ */
+EXPORT ER i2c_bench_start(void)
+{
+	T_CTSK	ctsk = {
+		.tskatr		= TA_HLNG | TA_RNG3,
+		.task		= i2c_bench_task,
+		.itskpri	= 10,
+		.stksz		= 1024,
+	};
+	ID	tskid;
+
+	tskid = tk_cre_tsk(&ctsk);
+	if(tskid < E_OK) return tskid;
+	return tk_sta_tsk(tskid, 0);
+}
+
+#endif	/* bench_read_regs */
@@ -42,15 +42,23 @@ typedef struct {
 	UINT			omode;		// Open mode
 	ER			err;		// Error code that occurred during interrupt processing
 	ID			evtmbfid;	// MBF ID for event notification
-	UW			val;		// A/DC converted data
+	ID			flgid;		// Interrupt detection flag
+	UW			trg;		// First trigger of the conversion
+	UW			ntrg;		// Number of triggers
+	UW			cnt;		// Number of converted data
+	UW			val[DEV_HAL_ADC_MAXCH];	// A/DC converted data
+	W			winch;		// Trigger of the window event (-1: Not armed)
+	UW			wincmd;		// Command of the window trigger (1 to ADC_CV_COUNT)
+	UW			cmdh;		// Saved CMDH of the command
+	UW			cv;		// Saved CV of the command
 } T_HAL_ADC_DCB;
 
-/* Interrupt detection flag */
-LOCAL ID	id_flgid;
+/* Interrupt detection flag (Created for each unit) */
 LOCAL T_CFLG	id_flg	= {
 			.flgatr		= TA_TFIFO | TA_WMUL,
 			.iflgptn	= 0,
 };
+#define FLGPTN_DONE	(1<<0)		// Interrupt processing completed
 
 #if TK_SUPPORT_MEMLIB
 LOCAL T_HAL_ADC_DCB	*dev_adc_cb[DEV_HAL_ADC_UNITNM];
@@ -68,15 +76,101 @@ LOCAL ER read_atr(T_HAL_ADC_DCB *p_dcb, T_DEVREQ *req)
 	return E_PAR;
 }
 
+/* Window event
+ *	The hardware compare of the trigger's command is set to "store on
+ *	true". The result is stored in the FIFO only when it is out of lo to
+ *	hi, so the existing FIFO interrupt (RDY) occurs only for the results
+ *	out of the window. The compare is true for CVL <= result <= CVH, and
+ *	for result >= CVL or result <= CVH when CVL > CVH.
+ *	(One trigger for each unit. The command must have a CV register.)
+ */
+LOCAL void clr_window(T_HAL_ADC_DCB *p_dcb)
+{
+	if(p_dcb->winch < 0) return;
+
+	p_dcb->base->CMD[p_dcb->wincmd - 1].CMDH = p_dcb->cmdh;
+	p_dcb->base->CV[p_dcb->wincmd - 1] = p_dcb->cv;
+	p_dcb->winch = -1;
+}
+
+LOCAL ER set_window(T_HAL_ADC_DCB *p_dcb, CONST T_HAL_ADC_WINDOW *win)
+{
+	UW	cmd, cvl, cvh;
+	UINT	imask;
+
+	DI(imask);
+	clr_window(p_dcb);
+	EI(imask);
+	if(!win->enable) return E_OK;
+
+	if(win->ch >= DEV_HAL_ADC_MAXCH || win->lo > win->hi || win->hi > DEV_HAL_ADC_MAXVAL) return E_PAR;
+	if(win->lo == 0 && win->hi == DEV_HAL_ADC_MAXVAL) return E_PAR;	// Never out of the window
+
+	cmd = (p_dcb->base->TCTRL[win->ch] & ADC_TCTRL_TCMD_MASK) >> ADC_TCTRL_TCMD_SHIFT;
+	if(cmd == 0 || cmd > ADC_CV_COUNT) return E_NOSPT;
+
+	/* Compare values (16-bit conversion result) */
+	if(win->hi == DEV_HAL_ADC_MAXVAL) {		// result < lo
+		cvl = 0;
+		cvh = (win->lo << 3) - 1;
+	} else if(win->lo == 0) {			// result > hi
+		cvl = (win->hi + 1) << 3;
+		cvh = 0xFFFF;
+	} else {					// result > hi or result < lo
+		cvl = (win->hi + 1) << 3;
+		cvh = (win->lo << 3) - 1;
+	}
+
+	DI(imask);
+	p_dcb->wincmd	= cmd;
+	p_dcb->cmdh	= p_dcb->base->CMD[cmd - 1].CMDH;
+	p_dcb->cv	= p_dcb->base->CV[cmd - 1];
+	p_dcb->base->CV[cmd - 1] = ADC_CV_CVH(cvh) | ADC_CV_CVL(cvl);
+	p_dcb->base->CMD[cmd - 1].CMDH = (p_dcb->cmdh & ~ADC_CMDH_CMPEN_MASK)
+					| ADC_CMDH_CMPEN(kLPADC_HardwareCompareStoreOnTrue);
+	p_dcb->winch	= (W)win->ch;
+	EI(imask);
+
+	return E_OK;
+}
+
 LOCAL ER write_atr(T_HAL_ADC_DCB *p_dcb, T_DEVREQ *req)
 {
-	return E_PAR;
+	ER	err;
+
+	switch(req->start) {
+	case TDN_HAL_ADC_WINDOW:
+		if(req->size != sizeof(T_HAL_ADC_WINDOW)) return E_PAR;
+		err = set_window(p_dcb, (T_HAL_ADC_WINDOW*)req->buf);
+		break;
+	default:
+		return E_PAR;
+	}
+	if(err >= E_OK) req->asize = req->size;
+	return err;
 }
 
 /*---------------------------------------------------------------------*/
 /* Device-specific data control
  */
 
+/* Window event
+ *	The event is notified once. The window is re-armed by TDN_HAL_ADC_WINDOW.
+ */
+LOCAL void window_event(T_HAL_ADC_DCB *p_dcb, UW val)
+{
+	T_HAL_ADC_WINEVT	evt;
+
+	evt.devid	= p_dcb->devid;
+	evt.ch		= (UW)p_dcb->winch;
+	evt.val		= val;
+	tk_get_otm(&evt.time);
+	clr_window(p_dcb);
+	if(p_dcb->evtmbfid > 0) {
+		tk_snd_mbf(p_dcb->evtmbfid, &evt, sizeof(T_HAL_ADC_WINEVT), TMO_POL);
+	}
+}
+
 /* ADC IRQ Callback functions */
 LOCAL void HAL_ADC_Callback(UW unit)
 {
@@ -85,6 +179,7 @@ LOCAL void HAL_ADC_Callback(UW unit)
 	lpadc_conv_result_t	result;
 	uint32_t		trigger_status_flag;
 	uint32_t		status_flag;
+	UW			idx;
 
 	ENTER_TASK_INDEPENDENT
 
@@ -95,15 +190,25 @@ LOCAL void HAL_ADC_Callback(UW unit)
 	LPADC_ClearTriggerStatusFlags(p_dcb->base, trigger_status_flag);
 	LPADC_ClearStatusFlags(p_dcb->base, status_flag);
 
-	LPADC_GetConvResult(p_dcb->base, &result, 0);
-	p_dcb->val = result.convValue >> 3;
-
 	if(status_flag & ADC_STAT_RDY0_MASK) {
+		while(LPADC_GetConvResult(p_dcb->base, &result, 0)) {
+			if(p_dcb->winch >= 0 && result.triggerIdSource == (UW)p_dcb->winch) {
+				window_event(p_dcb, result.convValue >> 3);
+				continue;
+			}
+			idx = result.triggerIdSource - p_dcb->trg;
+			if(idx < p_dcb->ntrg) {
+				p_dcb->val[idx] = result.convValue >> 3;
+				p_dcb->cnt++;
+			}
+		}
 		p_dcb->err = E_OK;
 	} else {
 		p_dcb->err = E_IO;
 	}
-	tk_set_flg(id_flgid, 1<<unit);
+	if(p_dcb->err < E_OK || p_dcb->cnt >= p_dcb->ntrg) {
+		tk_set_flg(p_dcb->flgid, FLGPTN_DONE);
+	}
 
 	LEAVE_TASK_INDEPENDENT
 }
@@ -119,27 +224,39 @@ void ADC1_IRQHandler(void)
 	HAL_ADC_Callback(1);
 }
 
+/* Read the data of the triggers from req->start to (req->start + req->size - 1)
+ *	All triggers are started at once. The results are sorted by the trigger ID.
+ */
 LOCAL ER read_data(T_HAL_ADC_DCB *p_dcb, T_DEVREQ *req)
 {
 	UINT		wflgptn, rflgptn;
+	SZ		i;
 	ER		err;
 
 	if(req->size == 0) {
 		req->asize = 1;
 		return E_OK;
 	}
+	if(req->start + req->size > DEV_HAL_ADC_MAXCH) return E_PAR;
+	if(p_dcb->winch >= req->start && p_dcb->winch < req->start + req->size) {
+		return E_BUSY;		// The window trigger stores only the results out of the window
+	}
+
+	p_dcb->trg	= req->start;
+	p_dcb->ntrg	= req->size;
+	p_dcb->cnt	= 0;
 
-	wflgptn = 1 << p_dcb->unit;
-	tk_clr_flg(id_flgid, ~wflgptn);
+	wflgptn = FLGPTN_DONE;
+	tk_clr_flg(p_dcb->flgid, ~wflgptn);
 
-	LPADC_DoSoftwareTrigger(p_dcb->base, 1<<(req->start));
+	LPADC_DoSoftwareTrigger(p_dcb->base, ((1<<req->size) - 1) << req->start);
 
-	err = tk_wai_flg(id_flgid, wflgptn, TWF_ANDW | TWF_BITCLR, &rflgptn, DEV_HAL_ADC_TMOUT);
+	err = tk_wai_flg(p_dcb->flgid, wflgptn, TWF_ANDW | TWF_BITCLR, &rflgptn, DEV_HAL_ADC_TMOUT);
 	if(err >= E_OK) {
 		err = p_dcb->err;
 		if(err >= E_OK) {
-			*(UW*)(req->buf) = p_dcb->val;
-			req->asize= 1;
+			for(i = 0; i < req->size; i++) ((UW*)req->buf)[i] = p_dcb->val[i];
+			req->asize = req->size;
 		}
 	}
 	return err;
@@ -173,6 +290,13 @@ LOCAL ER dev_adc_openfn( ID devid, UINT omode, T_MSDI *p_msdi)
  */
 LOCAL ER dev_adc_closefn( ID devid, UINT option, T_MSDI *p_msdi)
 {
+	T_HAL_ADC_DCB	*p_dcb;
+	UINT		imask;
+
+	p_dcb = (T_HAL_ADC_DCB*)(p_msdi->dmsdi.exinf);
+	DI(imask);
+	clr_window(p_dcb);			// Disarm the window event
+	EI(imask);
 	return E_OK;
 }
 
@@ -244,9 +368,9 @@ EXPORT ER dev_init_hal_adc( UW unit, ADC_Type *base)
 	p_dcb = &dev_adc_cb[unit];
 #endif
 
-	id_flgid = tk_cre_flg(&id_flg);
-	if(id_flgid <= E_OK) {
-		err = (ER)id_flgid;
+	p_dcb->flgid = tk_cre_flg(&id_flg);
+	if(p_dcb->flgid <= E_OK) {
+		err = (ER)p_dcb->flgid;
 		goto err_1;
 	}
 
@@ -268,15 +392,18 @@ EXPORT ER dev_init_hal_adc( UW unit, ADC_Type *base)
 	dmsdi.devnm[i+1] = 0;
 
 	err = msdi_def_dev( &dmsdi, &idev, &p_msdi);
-	if(err != E_OK) goto err_1;
+	if(err != E_OK) goto err_2;
 
 	p_dcb->base	= base;
 	p_dcb->devid	= p_msdi->devid;
 	p_dcb->unit	= unit;
 	p_dcb->evtmbfid	= idev.evtmbfid;
+	p_dcb->winch	= -1;
 
 	return E_OK;
 
+err_2:
+	tk_del_flg(p_dcb->flgid);
 err_1:
 #if TK_SUPPORT_MEMLIB
 	Kfree(p_dcb);
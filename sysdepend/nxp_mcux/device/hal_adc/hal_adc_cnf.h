@@ -24,5 +24,7 @@
 
 
 #define DEV_HAL_ADC_UNITNM	(2)	// Number of A/DC units (max 26)
+#define DEV_HAL_ADC_MAXCH	(16)	// Number of LPADC triggers
+#define DEV_HAL_ADC_MAXVAL	(0x1FFF)	// Maximum conversion result (16-bit result >> 3)
 
 #endif	/* _DEV_HAL_ADC_CNF_H_ */
\ No newline at end of file
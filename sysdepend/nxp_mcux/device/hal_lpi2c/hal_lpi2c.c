@@ -26,6 +26,10 @@
 #include <mtkernel/device/common/drvif/msdrvif.h>
 #include "hal_lpi2c_cnf.h"
 
+#if DEV_HAL_LPI2C_DMA_UNIT != 0
+#include "fsl_lpi2c_edma.h"
+#endif
+
 /*
  *	hal_lpi2c.c
  *	I2C device driver (NXP MCUXPresso)
@@ -43,16 +47,27 @@ typedef struct {
 	UW				unit;		// Unit no
 	ER				err;		// Error code that occurred during interrupt processing
 	ID				evtmbfid;	// MBF ID for event notification
+	ID				flgid;		// Interrupt detection flag
 	UW				dmode;		// Device mode
 	UW				tadr;		// Target Address
+#if DEV_HAL_LPI2C_DMA_UNIT != 0
+	lpi2c_master_edma_handle_t	hdma;		// LPI2C EDMA handle
+	edma_handle_t			*rxdma;		// EDMA handle for receive (NULL: Not use DMA)
+	edma_handle_t			*txdma;		// EDMA handle for transmit
+	BOOL				edma;		// Current transfer handle (TRUE: EDMA)
+#endif
+#if DEV_HAL_LPI2C_INTCNT
+	INT				intno[3];	// Counted interrupts (LPI2C, EDMA Rx, Tx)
+	UW				intcnt;		// Number of interrupts
+#endif
 } T_HAL_LPI2C_DCB;
 
-/* Interrupt detection flag */
-LOCAL ID	id_flgid;
+/* Interrupt detection flag (Created for each unit) */
 LOCAL T_CFLG	id_flg	= {
 			.flgatr		= TA_TFIFO | TA_WMUL,
 			.iflgptn	= 0,
 };
+#define FLGPTN_DONE	(1<<0)		// Interrupt processing completed
 
 #if TK_SUPPORT_MEMLIB
 LOCAL T_HAL_LPI2C_DCB	*dev_lpi2c_cb[DEV_HAL_LPI2C_UNITNM];
@@ -62,6 +77,67 @@ LOCAL T_HAL_LPI2C_DCB	dev_lpi2c_cb[DEV_HAL_LPI2C_UNITNM];
 #define		get_dcb_ptr(unit)	(&dev_I2C_cb[unit])
 #endif
 
+/* DCB of each open device descriptor (Indexed by dd. Cache of lpi2c_get_dcb) */
+LOCAL T_HAL_LPI2C_DCB	*dev_lpi2c_dd[CNF_MAX_OPNDEV + 1];
+#define DD_CACHED(dd)	((dd) > 0 && (dd) <= CNF_MAX_OPNDEV)
+
+#if DEV_HAL_LPI2C_INTCNT
+/*---------------------------------------------------------------------*/
+/* Interrupt count (Attribute data TDN_HAL_I2C_INTCNT)
+ *	The driver defines the handlers of the LPI2C interrupt and the EDMA
+ *	channel interrupts registered by dev_init_hal_lpi2c_dma(). The handler
+ *	counts the interrupt and calls the handler of the startup vector table
+ *	(The IRQ handler of MCUXpresso SDK).
+ */
+IMPORT UW *knl_exctbl_o;		// Exception handler table (Origin)
+
+LOCAL void lpi2c_intcnt_hdr(UINT intno)
+{
+	T_HAL_LPI2C_DCB	*p_dcb;
+	INT		unit, i;
+
+	for(unit = 0; unit < DEV_HAL_LPI2C_UNITNM; unit++) {
+		p_dcb = get_dcb_ptr(unit);
+		if(p_dcb == NULL) continue;
+		for(i = 0; i < 3; i++) {
+			if(p_dcb->intno[i] == (INT)intno) p_dcb->intcnt++;
+		}
+	}
+	((FP)knl_exctbl_o[N_SYSVEC + intno])();
+}
+
+/* Count the interrupt 'intno' of the unit (intno < 0: None) */
+LOCAL void lpi2c_def_intcnt(T_HAL_LPI2C_DCB *p_dcb, INT i, INT intno)
+{
+	T_DINT	dint;
+
+	p_dcb->intno[i] = intno;
+	if(intno < 0) return;
+
+	dint.intatr	= TA_HLNG;
+	dint.inthdr	= lpi2c_intcnt_hdr;
+	tk_def_int((UINT)intno, &dint);
+}
+
+#if DEV_HAL_LPI2C_DMA_UNIT != 0
+/* Interrupt number of the EDMA channel (-1: Unknown) */
+LOCAL INT edma_intno(edma_handle_t *hdma)
+{
+#if defined(DMA_CHN_IRQS) && defined(DMA_BASE_PTRS)
+	LOCAL const IRQn_Type	irqs[][FSL_FEATURE_EDMA_MODULE_CHANNEL] = DMA_CHN_IRQS;
+	LOCAL void * const	bases[] = DMA_BASE_PTRS;
+	INT			i;
+
+	if(hdma == NULL) return -1;
+	for(i = 0; i < (INT)(sizeof(bases) / sizeof(bases[0])); i++) {
+		if(bases[i] == (void*)hdma->base) return irqs[i][hdma->channel];
+	}
+#endif
+	return -1;
+}
+#endif
+#endif	/* DEV_HAL_LPI2C_INTCNT */
+
 /*---------------------------------------------------------------------*/
 /* Attribute data control
  */
@@ -81,6 +157,11 @@ LOCAL ER read_atr(T_HAL_LPI2C_DCB *p_dcb, T_DEVREQ *req)
 	case TDN_HAL_I2C_TADR:
 		*(UW*)req->buf = p_dcb->tadr;
 		break;
+#if DEV_HAL_LPI2C_INTCNT
+	case TDN_HAL_I2C_INTCNT:
+		*(UW*)req->buf = p_dcb->intcnt;
+		break;
+#endif
 	default:
 		return E_PAR;
 	}
@@ -124,22 +205,68 @@ LOCAL void lpi2c_callback(LPI2C_Type *base, lpi2c_master_handle_t *handle,
 	p_dcb = (T_HAL_LPI2C_DCB*)userData;
 	p_dcb->err = (status == kStatus_Success)? E_OK: E_IO;
 
-	tk_set_flg(id_flgid, 1<<(p_dcb->unit));
+	tk_set_flg(p_dcb->flgid, FLGPTN_DONE);
+
+	LEAVE_TASK_INDEPENDENT
+}
+
+#if DEV_HAL_LPI2C_DMA_UNIT != 0
+LOCAL void lpi2c_edma_callback(LPI2C_Type *base, lpi2c_master_edma_handle_t *handle,
+			status_t status, void *userData)
+{
+	T_HAL_LPI2C_DCB		*p_dcb;
+
+	ENTER_TASK_INDEPENDENT
+
+	p_dcb = (T_HAL_LPI2C_DCB*)userData;
+	p_dcb->err = (status == kStatus_Success)? E_OK: E_IO;
+
+	tk_set_flg(p_dcb->flgid, FLGPTN_DONE);
 
 	LEAVE_TASK_INDEPENDENT
 }
+#endif
+
+/* Start the transfer
+ *	The unit specified by DEV_HAL_LPI2C_DMA_UNIT uses EDMA for the data of
+ *	DEV_HAL_LPI2C_DMA_SIZE bytes or more, if the EDMA handle is registered.
+ *	The interrupt and EDMA transfer handles share the LPI2C interrupt,
+ *	so the handle is created again when the transfer method changes.
+ */
+LOCAL ER start_xfer(T_HAL_LPI2C_DCB *p_dcb, lpi2c_master_transfer_t *xfer)
+{
+	status_t	reVal;
+
+#if DEV_HAL_LPI2C_DMA_UNIT != 0
+	if((DEV_HAL_LPI2C_DMA_UNIT & (1 << p_dcb->unit)) != 0
+			&& p_dcb->rxdma != NULL && xfer->dataSize >= DEV_HAL_LPI2C_DMA_SIZE) {
+		if(!p_dcb->edma) {
+			LPI2C_MasterCreateEDMAHandle(p_dcb->base, &(p_dcb->hdma), p_dcb->rxdma, p_dcb->txdma,
+							lpi2c_edma_callback, p_dcb);
+			p_dcb->edma = TRUE;
+		}
+		reVal = LPI2C_MasterTransferEDMA(p_dcb->base, &(p_dcb->hdma), xfer);
+		return (reVal == kStatus_Success)? E_OK: E_IO;
+	}
+	if(p_dcb->edma) {
+		LPI2C_MasterTransferCreateHandle(p_dcb->base, &(p_dcb->hi2c), lpi2c_callback, p_dcb);
+		p_dcb->edma = FALSE;
+	}
+#endif
+	reVal = LPI2C_MasterTransferNonBlocking(p_dcb->base, &(p_dcb->hi2c), xfer);
+	return (reVal == kStatus_Success)? E_OK: E_IO;
+}
 
 
 LOCAL ER read_data(T_HAL_LPI2C_DCB *p_dcb, T_DEVREQ *req)
 {
 	lpi2c_master_transfer_t masterXfer = {0};
-	status_t reVal;
 
 	UINT		wflgptn, rflgptn;
 	ER		err;
 
-	wflgptn = 1 << p_dcb->unit;
-	tk_clr_flg(id_flgid, ~wflgptn);
+	wflgptn = FLGPTN_DONE;
+	tk_clr_flg(p_dcb->flgid, ~wflgptn);
 
 	switch(p_dcb->dmode) {
 	case HAL_I2C_MODE_CNT:
@@ -150,10 +277,8 @@ LOCAL ER read_data(T_HAL_LPI2C_DCB *p_dcb, T_DEVREQ *req)
 		masterXfer.data           = req->buf;
 		masterXfer.dataSize       = req->size;
 		masterXfer.flags          = kLPI2C_TransferDefaultFlag;
-		reVal = LPI2C_MasterTransferNonBlocking(p_dcb->base, &(p_dcb->hi2c), &masterXfer);
-		if (reVal != kStatus_Success) {
-			return E_IO;
-		}
+		err = start_xfer(p_dcb, &masterXfer);
+		if(err < E_OK) return err;
 
 		break;
 
@@ -163,7 +288,7 @@ LOCAL ER read_data(T_HAL_LPI2C_DCB *p_dcb, T_DEVREQ *req)
 		return E_SYS;
 	}
 
-	err = tk_wai_flg(id_flgid, wflgptn, TWF_ANDW | TWF_BITCLR, &rflgptn, DEV_HAL_LPI2C_TMOUT);
+	err = tk_wai_flg(p_dcb->flgid, wflgptn, TWF_ANDW | TWF_BITCLR, &rflgptn, DEV_HAL_LPI2C_TMOUT);
 	if(err >= E_OK) {
 		err = p_dcb->err;
 		if(err >= E_OK) req->asize = req->size;
@@ -175,13 +300,12 @@ LOCAL ER read_data(T_HAL_LPI2C_DCB *p_dcb, T_DEVREQ *req)
 LOCAL ER write_data(T_HAL_LPI2C_DCB *p_dcb, T_DEVREQ *req)
 {
 	lpi2c_master_transfer_t masterXfer = {0};
-	status_t reVal;
-	
+
 	UINT		wflgptn, rflgptn;
 	ER		err;
 
-	wflgptn = 1 << p_dcb->unit;
-	tk_clr_flg(id_flgid, ~wflgptn);
+	wflgptn = FLGPTN_DONE;
+	tk_clr_flg(p_dcb->flgid, ~wflgptn);
 
 	switch(p_dcb->dmode) {
 	case HAL_I2C_MODE_CNT:
@@ -192,10 +316,8 @@ LOCAL ER write_data(T_HAL_LPI2C_DCB *p_dcb, T_DEVREQ *req)
 		masterXfer.data           = req->buf;
 		masterXfer.dataSize       = req->size;
 		masterXfer.flags          = kLPI2C_TransferDefaultFlag;
-		reVal = LPI2C_MasterTransferNonBlocking(p_dcb->base, &(p_dcb->hi2c), &masterXfer);
-		if (reVal != kStatus_Success) {
-			return E_IO;
-		}
+		err = start_xfer(p_dcb, &masterXfer);
+		if(err < E_OK) return err;
 		break;
 
 	case HAL_I2C_MODE_TAR:
@@ -204,7 +326,53 @@ LOCAL ER write_data(T_HAL_LPI2C_DCB *p_dcb, T_DEVREQ *req)
 		return E_SYS;
 	}
 
-	err = tk_wai_flg(id_flgid, wflgptn, TWF_ANDW | TWF_BITCLR, &rflgptn, DEV_HAL_LPI2C_TMOUT);
+	err = tk_wai_flg(p_dcb->flgid, wflgptn, TWF_ANDW | TWF_BITCLR, &rflgptn, DEV_HAL_LPI2C_TMOUT);
+	if(err >= E_OK) {
+		err = p_dcb->err;
+		if(err >= E_OK) req->asize = req->size;
+	}
+
+	return err;
+}
+
+/* Write-then-read with repeated start (TDN_HAL_I2C_EXEC)
+ *	The send data is transferred as the subaddress of LPI2C, so the
+ *	send data size is up to 4 bytes.
+ */
+LOCAL ER exec_data(T_HAL_LPI2C_DCB *p_dcb, T_DEVREQ *req)
+{
+	lpi2c_master_transfer_t masterXfer = {0};
+
+	T_HAL_I2C_EXEC	*p_ex;
+	UW		subadr;
+	UINT		wflgptn, rflgptn;
+	SZ		i;
+	ER		err;
+
+	if(req->size != sizeof(T_HAL_I2C_EXEC)) return E_PAR;
+	p_ex = (T_HAL_I2C_EXEC*)req->buf;
+	if(p_ex->snd_size <= 0 || p_ex->snd_size > 4 || p_ex->rcv_size <= 0) return E_PAR;
+	if(p_dcb->dmode != HAL_I2C_MODE_CNT) return E_NOSPT;
+
+	for(i = 0, subadr = 0; i < p_ex->snd_size; i++) {
+		subadr = (subadr << 8) | p_ex->snd_data[i];	// Sent from MSB
+	}
+
+	masterXfer.slaveAddress   = p_ex->sadr;
+	masterXfer.direction      = kLPI2C_Read;
+	masterXfer.subaddress     = subadr;
+	masterXfer.subaddressSize = p_ex->snd_size;
+	masterXfer.data           = p_ex->rcv_data;
+	masterXfer.dataSize       = p_ex->rcv_size;
+	masterXfer.flags          = kLPI2C_TransferDefaultFlag;
+
+	wflgptn = FLGPTN_DONE;
+	tk_clr_flg(p_dcb->flgid, ~wflgptn);
+
+	err = start_xfer(p_dcb, &masterXfer);
+	if(err < E_OK) return err;
+
+	err = tk_wai_flg(p_dcb->flgid, wflgptn, TWF_ANDW | TWF_BITCLR, &rflgptn, DEV_HAL_LPI2C_TMOUT);
 	if(err >= E_OK) {
 		err = p_dcb->err;
 		if(err >= E_OK) req->asize = req->size;
@@ -227,8 +395,12 @@ LOCAL ER dev_i2c_openfn( ID devid, UINT omode, T_MSDI *msdi)
 	if(p_dcb->base == NULL) return E_IO;
 
 	p_dcb->omode = omode;
+	knl_memset(dev_lpi2c_dd, 0, sizeof(dev_lpi2c_dd));	// The dd may be reused
 
 	LPI2C_MasterTransferCreateHandle(p_dcb->base, &(p_dcb->hi2c), lpi2c_callback, p_dcb);
+#if DEV_HAL_LPI2C_DMA_UNIT != 0
+	p_dcb->edma = FALSE;
+#endif
 
 	return E_OK;
 }
@@ -238,6 +410,7 @@ LOCAL ER dev_i2c_openfn( ID devid, UINT omode, T_MSDI *msdi)
  */
 LOCAL ER dev_i2c_closefn( ID devid, UINT option, T_MSDI *msdi)
 {
+	knl_memset(dev_lpi2c_dd, 0, sizeof(dev_lpi2c_dd));
 	return E_OK;
 }
 
@@ -271,6 +444,8 @@ LOCAL ER dev_i2c_writefn( T_DEVREQ *req, T_MSDI *p_msdi)
 
 	if(req->start >= 0) {
 		rtn = write_data( p_dcb, req);	// Device specific data
+	} else if(req->start == TDN_HAL_I2C_EXEC) {
+		rtn = exec_data( p_dcb, req);	// Write-then-read
 	} else {
 		rtn = write_atr( p_dcb, req);	// Device attribute data
 	}
@@ -307,9 +482,9 @@ EXPORT ER dev_init_hal_lpi2c( UW unit, LPI2C_Type *base)
 	p_dcb = &dev_lpi2c_cb[unit];
 #endif
 
-	id_flgid = tk_cre_flg(&id_flg);
-	if(id_flgid <= E_OK) {
-		err = (ER)id_flgid;
+	p_dcb->flgid = tk_cre_flg(&id_flg);
+	if(p_dcb->flgid <= E_OK) {
+		err = (ER)p_dcb->flgid;
 		goto err_1;
 	}
 
@@ -331,16 +506,32 @@ EXPORT ER dev_init_hal_lpi2c( UW unit, LPI2C_Type *base)
 	dmsdi.devnm[i+1] = 0;
 
 	err = msdi_def_dev( &dmsdi, &idev, &p_msdi);
-	if(err != E_OK) goto err_1;
+	if(err != E_OK) goto err_2;
 
 	p_dcb->base	= base;
 	p_dcb->devid	= p_msdi->devid;
 	p_dcb->unit	= unit;
 	p_dcb->evtmbfid	= idev.evtmbfid;
 	p_dcb->dmode	= HAL_I2C_MODE_CNT;
+#if DEV_HAL_LPI2C_DMA_UNIT != 0
+	p_dcb->rxdma	= NULL;
+	p_dcb->txdma	= NULL;
+	p_dcb->edma	= FALSE;
+#endif
+#if DEV_HAL_LPI2C_INTCNT
+	{
+		LOCAL const IRQn_Type	lpi2c_irqs[] = LPI2C_IRQS;
+
+		p_dcb->intcnt = 0;
+		lpi2c_def_intcnt(p_dcb, 0, lpi2c_irqs[LPI2C_GetInstance(base)]);
+		p_dcb->intno[1] = p_dcb->intno[2] = -1;
+	}
+#endif
 
 	return E_OK;
 
+err_2:
+	tk_del_flg(p_dcb->flgid);
 err_1:
 #if TK_SUPPORT_MEMLIB
 	Kfree(p_dcb);
@@ -348,84 +539,129 @@ err_1:
 	return err;
 }
 
+/*
+ * Register the EDMA handles for the DMA transfer
+ *	Call after dev_init_hal_lpi2c(). The unit must be specified by
+ *	DEV_HAL_LPI2C_DMA_UNIT. If the LPI2C shares one DMA request for
+ *	receive and transmit, txdma can be NULL.
+ */
+EXPORT ER dev_init_hal_lpi2c_dma( UW unit, struct _edma_handle *rxdma, struct _edma_handle *txdma)
+{
+#if DEV_HAL_LPI2C_DMA_UNIT != 0
+	T_HAL_LPI2C_DCB	*p_dcb;
+
+	if(unit >= DEV_HAL_LPI2C_UNITNM || (DEV_HAL_LPI2C_DMA_UNIT & (1 << unit)) == 0) return E_PAR;
+	if(rxdma == NULL) return E_PAR;
+
+	p_dcb = get_dcb_ptr(unit);
+	if(p_dcb == NULL || p_dcb->base == NULL) return E_OBJ;
+
+	p_dcb->rxdma	= rxdma;
+	p_dcb->txdma	= txdma;
+#if DEV_HAL_LPI2C_INTCNT
+	lpi2c_def_intcnt(p_dcb, 1, edma_intno(rxdma));
+	lpi2c_def_intcnt(p_dcb, 2, edma_intno(txdma));
+#endif
+
+	return E_OK;
+#else
+	return E_NOSPT;
+#endif
+}
+
 /*----------------------------------------------------------------------
  * I2C register access support function
+ *	The register address and the data block are transferred in one
+ *	transaction. (Read: Repeated start after the register address)
  */
-
-EXPORT ER hal_lpi2c_read_reg(ID dd, UW sadr, UW radr, UB *data)
+/*
+ * DCB of the device descriptor
+ *	The device is looked up only at the first access with the dd.
+ *	After that, the DCB is taken from dev_lpi2c_dd[dd].
+ *	The cache is cleared when a device of this driver is opened or closed.
+ */
+LOCAL T_HAL_LPI2C_DCB* lpi2c_get_dcb(ID dd)
 {
 	T_HAL_LPI2C_DCB		*p_dcb;
 	ID			devid;
 	UINT			unit;
-	UINT			wflgptn, rflgptn;
-	ER			err;
 
-	lpi2c_master_transfer_t	masterXfer = {0};
-	status_t		reVal;
+	if(DD_CACHED(dd) && dev_lpi2c_dd[dd] != NULL) return dev_lpi2c_dd[dd];
 
 	devid = tk_oref_dev(dd, NULL);
+	if(devid < E_OK) return NULL;
 	for(unit = 0; unit <DEV_HAL_LPI2C_UNITNM; unit++) {
 		p_dcb = get_dcb_ptr(unit);
-		if(p_dcb->devid == devid) break;
+		if(p_dcb != NULL && p_dcb->devid == devid) {
+			if(DD_CACHED(dd)) dev_lpi2c_dd[dd] = p_dcb;
+			return p_dcb;
+		}
 	}
-	if(unit >= DEV_HAL_LPI2C_UNITNM) return E_ID;
-
-	masterXfer.slaveAddress   = sadr;
-	masterXfer.direction      = kLPI2C_Read;
-	masterXfer.subaddress     = radr;
-	masterXfer.subaddressSize = 1;
-	masterXfer.data           = data;
-	masterXfer.dataSize       = 1;
-	masterXfer.flags          = kLPI2C_TransferDefaultFlag;
-
-
-	wflgptn = 1 << unit;
-	tk_clr_flg(id_flgid, ~wflgptn);
-
-	reVal = LPI2C_MasterTransferNonBlocking(p_dcb->base, &(p_dcb->hi2c), &masterXfer);
-	if (reVal != kStatus_Success) return E_IO;
-
-	err = tk_wai_flg(id_flgid, wflgptn, TWF_ANDW | TWF_BITCLR, &rflgptn, DEV_HAL_LPI2C_TMOUT);
-	
-	return err;
+	return NULL;
 }
 
-EXPORT ER hal_lpi2c_write_reg(ID dd, UW sadr, UW radr, UB data)
+LOCAL ER hal_lpi2c_access_regs(ID dd, UW sadr, UW radr, UW asz, UB *buf, SZ len, BOOL wr)
 {
 	T_HAL_LPI2C_DCB		*p_dcb;
-	ID			devid;
-	UINT			unit;
 	UINT			wflgptn, rflgptn;
 	ER			err;
 
 	lpi2c_master_transfer_t	masterXfer = {0};
-	status_t		reVal;
-	
-	devid = tk_oref_dev(dd, NULL);
-	for(unit = 0; unit <DEV_HAL_LPI2C_UNITNM; unit++) {
-		p_dcb = get_dcb_ptr(unit);
-		if(p_dcb->devid == devid) break;
-	}
-	if(unit >= DEV_HAL_LPI2C_UNITNM) return E_ID;
 
-	wflgptn = 1 << unit;
-	tk_clr_flg(id_flgid, ~wflgptn);
+	if(len <= 0) return E_PAR;
+
+	p_dcb = lpi2c_get_dcb(dd);
+	if(p_dcb == NULL) return E_ID;
 
 	masterXfer.slaveAddress   = sadr;
-	masterXfer.direction      = kLPI2C_Write;
+	masterXfer.direction      = wr? kLPI2C_Write: kLPI2C_Read;
 	masterXfer.subaddress     = radr;
-	masterXfer.subaddressSize = 1;
-	masterXfer.data           = &data;
-	masterXfer.dataSize       = 1;
+	masterXfer.subaddressSize = asz;
+	masterXfer.data           = buf;
+	masterXfer.dataSize       = len;
 	masterXfer.flags          = kLPI2C_TransferDefaultFlag;
 
-	reVal = LPI2C_MasterTransferNonBlocking(p_dcb->base, &(p_dcb->hi2c), &masterXfer);
-	if (reVal != kStatus_Success) return E_IO;
+	wflgptn = FLGPTN_DONE;
+	tk_clr_flg(p_dcb->flgid, ~wflgptn);
+
+	err = start_xfer(p_dcb, &masterXfer);
+	if(err < E_OK) return err;
 
-	err = tk_wai_flg(id_flgid, wflgptn, TWF_ANDW | TWF_BITCLR, &rflgptn, DEV_HAL_LPI2C_TMOUT);
+	err = tk_wai_flg(p_dcb->flgid, wflgptn, TWF_ANDW | TWF_BITCLR, &rflgptn, DEV_HAL_LPI2C_TMOUT);
+	if(err >= E_OK) err = p_dcb->err;
 	
 	return err;
 }
 
+EXPORT ER hal_lpi2c_read_reg(ID dd, UW sadr, UW radr, UB *data)
+{
+	return hal_lpi2c_access_regs(dd, sadr, radr, 1, data, 1, FALSE);
+}
+
+EXPORT ER hal_lpi2c_write_reg(ID dd, UW sadr, UW radr, UB data)
+{
+	return hal_lpi2c_access_regs(dd, sadr, radr, 1, &data, 1, TRUE);
+}
+
+EXPORT ER hal_lpi2c_read_regs(ID dd, UW sadr, UW radr, UB *buf, SZ len)
+{
+	return hal_lpi2c_access_regs(dd, sadr, radr, 1, buf, len, FALSE);
+}
+
+EXPORT ER hal_lpi2c_write_regs(ID dd, UW sadr, UW radr, CONST UB *buf, SZ len)
+{
+	return hal_lpi2c_access_regs(dd, sadr, radr, 1, (UB*)buf, len, TRUE);
+}
+
+EXPORT ER hal_lpi2c_read_regs16(ID dd, UW sadr, UW radr, UB *buf, SZ len)
+{
+	return hal_lpi2c_access_regs(dd, sadr, radr, 2, buf, len, FALSE);
+}
+
+EXPORT ER hal_lpi2c_write_regs16(ID dd, UW sadr, UW radr, CONST UB *buf, SZ len)
+{
+	return hal_lpi2c_access_regs(dd, sadr, radr, 2, (UB*)buf, len, TRUE);
+}
+
 #endif		/* DEVCNF_USE_HAL_LPI2C */
 #endif		/* MTKBSP_MPCXPRESSO */
\ No newline at end of file
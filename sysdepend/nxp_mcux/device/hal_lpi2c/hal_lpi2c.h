@@ -27,7 +27,8 @@
  */
 #define TDN_HAL_I2C_MODE	(-100)	// I2C Mode
 #define TDN_HAL_I2C_TADR	(-101)	// Target Address
-#define TDN_HAL_I2C_MAX		(-101)
+#define TDN_HAL_I2C_INTCNT	(-103)	// Number of interrupts (DEV_HAL_LPI2C_INTCNT, Read only)
+#define TDN_HAL_I2C_MAX		(-104)	// (TDN_HAL_I2C_EXEC(-102) is defined in device.h)
 
 #define HAL_I2C_MODE_CNT	(0)	// I2C Mode: Controller mode	
 #define HAL_I2C_MODE_TAR	(1)	// I2C Mode: Target mode
@@ -37,11 +38,17 @@
  */
 
 IMPORT ER dev_init_hal_lpi2c( UW unit, LPI2C_Type *base);
+struct _edma_handle;			// fsl_edma.h
+IMPORT ER dev_init_hal_lpi2c_dma( UW unit, struct _edma_handle *rxdma, struct _edma_handle *txdma);
 
 /*----------------------------------------------------------------------
  * I2C register access support function
  */
 EXPORT ER hal_lpi2c_read_reg(ID dd, UW sadr, UW radr, UB *data);
 EXPORT ER hal_lpi2c_write_reg(ID dd, UW sadr, UW radr, UB data);
+EXPORT ER hal_lpi2c_read_regs(ID dd, UW sadr, UW radr, UB *buf, SZ len);
+EXPORT ER hal_lpi2c_write_regs(ID dd, UW sadr, UW radr, CONST UB *buf, SZ len);
+EXPORT ER hal_lpi2c_read_regs16(ID dd, UW sadr, UW radr, UB *buf, SZ len);		// 16-bit register address
+EXPORT ER hal_lpi2c_write_regs16(ID dd, UW sadr, UW radr, CONST UB *buf, SZ len);	// 16-bit register address
 
 #endif	/* _DEV_HAL_LPI2C_H_ */
\ No newline at end of file
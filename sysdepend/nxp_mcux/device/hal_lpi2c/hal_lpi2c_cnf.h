@@ -24,4 +24,11 @@
 
 #define DEV_HAL_LPI2C_UNITNM	(2)	// Number of I2C units (max 26)
 
+/* DMA transfer (Register the EDMA handles by dev_init_hal_lpi2c_dma) */
+#define DEV_HAL_LPI2C_DMA_UNIT	(0x00)	// Units using DMA (bit n: unit n)
+#define DEV_HAL_LPI2C_DMA_SIZE	(32)	// Minimum data size for DMA transfer
+
+/* Interrupt count for the benchmark (Attribute data TDN_HAL_I2C_INTCNT) */
+#define DEV_HAL_LPI2C_INTCNT	(0)	// 1: Count the LPI2C and EDMA interrupts  0: Not count
+
 #endif	/* _DEV_HAL_LPI2C_CNF_H_ */
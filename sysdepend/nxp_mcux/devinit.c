@@ -42,6 +42,11 @@ EXPORT ER knl_start_device( void )
 {
 	ER	err	= E_OK;
 
+#if USE_DEFWORK
+	err = InitDeferredWork();
+	if(err < E_OK) return err;
+#endif
+
 #if DEVCNF_USE_HAL_LPI2C
 	err = dev_init_hal_lpi2c( 0, LPI2C2);
 	if(err < E_OK) return err;
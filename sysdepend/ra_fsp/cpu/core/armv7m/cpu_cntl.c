@@ -176,6 +176,42 @@ EXPORT ER knl_get_cpr( TCB *tcb, INT copno, T_COPREGS *copregs)
 #endif /* USE_FPU */
 
 
+#if USE_STKUSE
+/* ------------------------------------------------------------------------ */
+/*
+ * Refer the task stack usage (BSP extension)
+ *	The painted words not changed from the bottom of the stack are unused.
+ */
+EXPORT ER GetStackUsage( ID tskid, T_RSTKUSE *pk_rstkuse )
+{
+	TCB	*tcb;
+	UW	*stk, *top;
+	ER	ercd = E_OK;
+
+	if(tskid == TSK_SELF) {
+		if(in_indp()) return E_ID;
+	} else if(tskid < MIN_TSKID || tskid > MAX_TSKID) {
+		return E_ID;
+	}
+	tcb = get_tcb_self(tskid);
+
+	BEGIN_CRITICAL_SECTION;
+	if(tcb->state == TS_NONEXIST) {
+		ercd = E_NOEXS;
+	} else {
+		stk = (UW*)(tcb->isstack - tcb->sstksz);
+		top = (UW*)tcb->isstack;
+		while(stk < top && *stk == STKUSE_PATTERN) stk++;
+
+		pk_rstkuse->stksz	= tcb->sstksz;
+		pk_rstkuse->used	= (SZ)((UW)top - (UW)stk);
+	}
+	END_CRITICAL_SECTION;
+
+	return ercd;
+}
+#endif /* USE_STKUSE */
+
 /* ----------------------------------------------------------------------- */
 /*
  *	Task dispatcher startup
@@ -62,6 +62,10 @@ typedef struct {
 
 #endif /* USE_FPU */
 
+#if USE_STKUSE
+#define STKUSE_PATTERN		0xCCCCCCCC	/* Stack painting pattern */
+#endif
+
 /*
  * Create stack frame for task startup
  *	Call from 'make_dormant()'
@@ -69,6 +73,9 @@ typedef struct {
 Inline void knl_setup_context( TCB *tcb )
 {
 	SStackFrame	*ssp;
+#if USE_STKUSE
+	UW		*stk;
+#endif
 
 	ssp = tcb->isstack;
 	ssp--;
@@ -86,6 +93,16 @@ Inline void knl_setup_context( TCB *tcb )
 	tcb->tskctxb.spea = tcb->isstack + sizeof(UW) - 1;
 #endif
 
+#if USE_STKUSE
+	/* Paint the stack for the usage measurement (GetStackUsage).
+	   Not painted when the running task exits to DORMANT (tk_ext_tsk). */
+	if(tcb != knl_ctxtsk) {
+		for(stk = (UW*)(tcb->isstack - tcb->sstksz); stk < (UW*)ssp; stk++) {
+			*stk = STKUSE_PATTERN;
+		}
+	}
+#endif
+
 #if USE_FPU && ALWAYS_FPU_ATR
 	tcb->tskatr |= TA_FPU;		/* Always set the TA_FPU attribute on all tasks */
 #endif
@@ -48,6 +48,44 @@ EXPORT void		*knl_sysmem_end	= 0;
 //   Asm ("msr msplim, %0" : : "r" (MainStackPtrLimit));
 // }
 
+/*
+ * Set the non-cacheable MPU regions
+ *	The memory regions with MRA_NOCACHE (sysdef.h) are set to Normal,
+ *	Non-cacheable memory for the DMA descriptors and buffers. The MPU
+ *	regions are used from the highest number, and the regions set by the
+ *	application are not changed. The attribute index 7 (MAIR1) is used.
+ *	The start address and the size must be aligned to 32 bytes.
+ */
+#define MPU_ATTR_NOCACHE	7
+
+LOCAL void knl_setup_nocache(void)
+{
+	T_RMEMRGN	rgn;
+	UW		nrgn;
+	INT		i, n;
+
+	nrgn = MPU_TYPE_DREGION(in_w(MPU_TYPE));
+	for(i = 0, n = 0; MemRgnRef(i, &rgn) == E_OK && n < nrgn; i++) {
+		if((rgn.attr & MRA_NOCACHE) == 0 || rgn.size == 0) continue;
+		if((((UW)rgn.start | (UW)rgn.size) & 0x1F) != 0) continue;
+
+		if(n == 0) {
+			out_w(MPU_MAIR1, (in_w(MPU_MAIR1) & 0x00FFFFFF) | (MPU_MAIR_NOCACHE << 24));
+		}
+		DCacheFlush(rgn.start, rgn.size);		// Write back the cached data
+		out_w(MPU_RNR, nrgn - 1 - n);
+		out_w(MPU_RBAR, (UW)rgn.start | MPU_RBAR_SH_OUTER | MPU_RBAR_AP_RW | MPU_RBAR_XN);
+		out_w(MPU_RLAR, ((UW)rgn.start + rgn.size - 32) | MPU_RLAR_ATTR(MPU_ATTR_NOCACHE)
+						| MPU_RLAR_ENABLE);
+		n++;
+	}
+	if(n > 0) {
+		out_w(MPU_CTRL, in_w(MPU_CTRL) | MPU_CTRL_PRIVDEFENA | MPU_CTRL_ENABLE);
+		Asm("dsb");
+		Asm("isb");
+	}
+}
+
 EXPORT void knl_start_mtkernel(void)
 {
 	UW	*src, *top;
@@ -77,6 +115,8 @@ EXPORT void knl_start_mtkernel(void)
 	out_w(SCB_SHPR2, SCB_SHPR2_VAL);			// SVC pri = 0
 	out_w(SCB_SHPR3, SCB_SHPR3_VAL);			// SysTick = 1 , PendSV = 15
 
+	setup_nocache_mpu();					// Non-cacheable memory regions
+
 #if USE_IMALLOC
 #if USE_STATIC_SYS_MEM
 	knl_lowmem_top = knl_system_mem;
@@ -21,6 +21,22 @@
 #include <hal_data.h>
 #include <config_bsp/ra_fsp/config_bsp.h>
 
+/*----------------------------------------------------------------------
+ * I2C write-then-read (Common to the I2C device drivers)
+ *	Write T_HAL_I2C_EXEC to the attribute data TDN_HAL_I2C_EXEC.
+ *	The send data and the receive data are transferred in one transaction
+ *	with repeated start.
+ */
+#define TDN_HAL_I2C_EXEC	(-102)
+
+typedef struct {
+	UW	sadr;		// Target address
+	SZ	snd_size;	// Send data size
+	UB	*snd_data;	// Send data
+	SZ	rcv_size;	// Receive data size
+	UB	*rcv_data;	// Receive data buffer
+} T_HAL_I2C_EXEC;
+
 #if DEVCNF_USE_HAL_ADC
 #include <sysdepend/ra_fsp/device/hal_adc/hal_adc.h>
 #endif
@@ -43,15 +43,19 @@ typedef struct {
 	UINT			omode;		// Open mode
 	ER			err;		// Error code that occurred during interrupt processing
 	ID			evtmbfid;	// MBF ID for event notification
+	ID			flgid;		// Interrupt detection flag
 	UW			val;		// A/DC converted data
+	W			winch;		// Channel of the window event (-1: Not armed)
+	adc_channel_cfg_t	chcfg;		// ADC channel config (With the window setting)
+	adc_window_cfg_t	wincfg;		// Window compare setting
 } T_HAL_ADC_DCB;
 
-/* Interrupt detection flag */
-LOCAL ID	id_flgid;
+/* Interrupt detection flag (Created for each unit) */
 LOCAL T_CFLG	id_flg	= {
 			.flgatr		= TA_TFIFO | TA_WMUL,
 			.iflgptn	= 0,
 };
+#define FLGPTN_DONE	(1<<0)		// Interrupt processing completed
 
 #if TK_SUPPORT_MEMLIB
 LOCAL T_HAL_ADC_DCB	*dev_adc_cb[DEV_HAL_ADC_UNITNM];
@@ -69,15 +73,79 @@ LOCAL ER read_atr(T_HAL_ADC_DCB *p_dcb, T_DEVREQ *req)
 	return E_PAR;
 }
 
+/* Set the window compare A
+ *	Out of lo to hi is detected on the channel. (One channel for each unit)
+ */
+LOCAL ER set_window(T_HAL_ADC_DCB *p_dcb, CONST T_HAL_ADC_WINDOW *win)
+{
+	adc_window_cfg_t	wincfg = {0};
+
+	if(win->enable && (win->ch >= 32 || win->lo > win->hi || win->hi > 0xFFFF)) return E_PAR;
+
+	p_dcb->chcfg = *p_dcb->cfadc;
+	if(win->enable) {
+		wincfg.compare_mask	= (1U << win->ch);
+		wincfg.compare_mode_mask = 0;			// Detect out of the window
+		wincfg.compare_cfg	= (adc_compare_cfg_t)(ADC_COMPARE_CFG_A_ENABLE | ADC_COMPARE_CFG_WINDOW_ENABLE);
+		wincfg.compare_ref_low	= (uint16_t)win->lo;
+		wincfg.compare_ref_high	= (uint16_t)win->hi;
+		p_dcb->wincfg		= wincfg;
+		p_dcb->chcfg.p_window_cfg = &p_dcb->wincfg;
+	}
+
+	p_dcb->winch = win->enable? (W)win->ch: -1;
+	if(R_ADC_ScanCfg(p_dcb->hadc, &p_dcb->chcfg) != FSP_SUCCESS) {
+		p_dcb->winch = -1;
+		return E_IO;
+	}
+	return E_OK;
+}
+
 LOCAL ER write_atr(T_HAL_ADC_DCB *p_dcb, T_DEVREQ *req)
 {
-	return E_PAR;
+	ER	err;
+
+	switch(req->start) {
+	case TDN_HAL_ADC_WINDOW:
+		if(req->size != sizeof(T_HAL_ADC_WINDOW)) return E_PAR;
+		err = set_window(p_dcb, (T_HAL_ADC_WINDOW*)req->buf);
+		break;
+	default:
+		return E_PAR;
+	}
+	if(err >= E_OK) req->asize = req->size;
+	return err;
 }
 
 /*---------------------------------------------------------------------*/
 /* Device-specific data control
  */
 
+/* Window compare A (Window event)
+ *	The event is notified once. The compare A interrupt stays enabled in
+ *	the A/D converter, so it is masked here. The window is re-armed by
+ *	TDN_HAL_ADC_WINDOW (R_ADC_ScanCfg() sets the interrupt enable again).
+ */
+LOCAL void window_event(T_HAL_ADC_DCB *p_dcb)
+{
+	T_HAL_ADC_WINEVT	evt;
+	uint16_t		val;
+
+	if(p_dcb->winch < 0) return;
+
+	((adc_instance_ctrl_t*)p_dcb->hadc)->p_reg->ADCMPCR_b.CMPAIE = 0;	// Mask the compare A interrupt
+
+	R_ADC_Read(p_dcb->hadc, (adc_channel_t)p_dcb->winch, &val);
+	evt.devid	= p_dcb->devid;
+	evt.ch		= (UW)p_dcb->winch;
+	evt.val		= val;
+	tk_get_otm(&evt.time);
+	p_dcb->winch	= -1;
+	if(p_dcb->evtmbfid > 0) {
+		tk_snd_mbf(p_dcb->evtmbfid, &evt, sizeof(T_HAL_ADC_WINEVT), TMO_POL);
+	}
+}
+
 /* HAL Callback functions */
 LOCAL void HAL_ADC_Callback(adc_callback_args_t *p_args)
 {
@@ -86,24 +154,32 @@ LOCAL void HAL_ADC_Callback(adc_callback_args_t *p_args)
 	ENTER_TASK_INDEPENDENT
 
 	p_dcb = (T_HAL_ADC_DCB*)p_args->p_context;
-	tk_set_flg(id_flgid, 1<< p_dcb->unit);
 
 	switch(p_args->event) {
 		case ADC_EVENT_SCAN_COMPLETE:
 			p_dcb->err = E_OK;
+			tk_set_flg(p_dcb->flgid, FLGPTN_DONE);
+			break;
+		case ADC_EVENT_WINDOW_COMPARE_A:
+			window_event(p_dcb);
 			break;
 		default:
 			p_dcb->err = E_IO;
+			tk_set_flg(p_dcb->flgid, FLGPTN_DONE);
 			break;
 	}
 
 	LEAVE_TASK_INDEPENDENT
 }
 
+/* Read the channels from req->start to (req->start + req->size - 1)
+ *	One scan converts all channels, and each channel result is read.
+ */
 LOCAL ER read_data(T_HAL_ADC_DCB *p_dcb, T_DEVREQ *req)
 {
 	uint16_t	val;
 	UINT		wflgptn, rflgptn;
+	SZ		i;
 	ER		err;
 
 	if(req->size == 0) {
@@ -111,18 +187,21 @@ LOCAL ER read_data(T_HAL_ADC_DCB *p_dcb, T_DEVREQ *req)
 		return E_OK;
 	}
 
-	wflgptn = 1 << p_dcb->unit;
-	tk_clr_flg(id_flgid, ~wflgptn);
+	wflgptn = FLGPTN_DONE;
+	tk_clr_flg(p_dcb->flgid, ~wflgptn);
 	R_ADC_ScanStart(p_dcb->hadc);
 
-	err = tk_wai_flg(id_flgid, wflgptn, TWF_ANDW | TWF_BITCLR, &rflgptn, DEV_HAL_ADC_TMOUT);
+	err = tk_wai_flg(p_dcb->flgid, wflgptn, TWF_ANDW | TWF_BITCLR, &rflgptn, DEV_HAL_ADC_TMOUT);
 	if(err >= E_OK) {
 		err = p_dcb->err;
-		if(err >= E_OK) {
-			R_ADC_Read(p_dcb->hadc, req->start, &val);
-			*(UW*)(req->buf) = val;
-			req->asize= 1;
+		for(i = 0; i < req->size && err >= E_OK; i++) {
+			if(R_ADC_Read(p_dcb->hadc, (adc_channel_t)(req->start + i), &val) != FSP_SUCCESS) {
+				err = E_PAR;
+				break;
+			}
+			((UW*)req->buf)[i] = val;
 		}
+		req->asize = i;		// Number of channels actually read
 	}
 
 	return err;
@@ -160,6 +239,13 @@ LOCAL ER dev_adc_openfn( ID devid, UINT omode, T_MSDI *p_msdi)
  */
 LOCAL ER dev_adc_closefn( ID devid, UINT option, T_MSDI *p_msdi)
 {
+	T_HAL_ADC_DCB	*p_dcb;
+
+	p_dcb = (T_HAL_ADC_DCB*)(p_msdi->dmsdi.exinf);
+	if(p_dcb->winch >= 0) {			// Disarm the window event
+		p_dcb->winch = -1;
+		R_ADC_ScanCfg(p_dcb->hadc, p_dcb->cfadc);
+	}
 	return E_OK;
 }
 
@@ -232,9 +318,9 @@ EXPORT ER dev_init_hal_adc( UW unit, adc_ctrl_t *hadc,
 	p_dcb = &dev_adc_cb[unit];
 #endif
 
-	id_flgid = tk_cre_flg(&id_flg);
-	if(id_flgid <= E_OK) {
-		err = (ER)id_flgid;
+	p_dcb->flgid = tk_cre_flg(&id_flg);
+	if(p_dcb->flgid <= E_OK) {
+		err = (ER)p_dcb->flgid;
 		goto err_1;
 	}
 
@@ -256,7 +342,7 @@ EXPORT ER dev_init_hal_adc( UW unit, adc_ctrl_t *hadc,
 	dmsdi.devnm[i+1] = 0;
 
 	err = msdi_def_dev( &dmsdi, &idev, &p_msdi);
-	if(err != E_OK) goto err_1;
+	if(err != E_OK) goto err_2;
 
 	p_dcb->hadc	= hadc;
 	p_dcb->cadc	= cadc;
@@ -264,9 +350,12 @@ EXPORT ER dev_init_hal_adc( UW unit, adc_ctrl_t *hadc,
 	p_dcb->devid	= p_msdi->devid;
 	p_dcb->unit	= unit;
 	p_dcb->evtmbfid	= idev.evtmbfid;
+	p_dcb->winch	= -1;
 
 	return E_OK;
 
+err_2:
+	tk_del_flg(p_dcb->flgid);
 err_1:
 #if TK_SUPPORT_MEMLIB
 	Kfree(p_dcb);
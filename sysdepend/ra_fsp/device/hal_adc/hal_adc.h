@@ -27,6 +27,25 @@
  * Attribute data
  */
 #define TDN_HAL_ADC_MODE	(-100)	// A/DC Mode
+#define TDN_HAL_ADC_WINDOW	(-101)	// Window event (Write only: T_HAL_ADC_WINDOW)
+
+/* Window event setting (Window compare A, one channel for each unit) */
+typedef struct {
+	UW	ch;		// Channel
+	BOOL	enable;		// TRUE: Arm  FALSE: Disarm
+	UW	lo;		// Low threshold
+	UW	hi;		// High threshold
+} T_HAL_ADC_WINDOW;
+
+/* Window event message (Sent to the event notification message buffer)
+ *	Sent once when the conversion result is out of lo to hi.
+ */
+typedef struct {
+	ID	devid;		// Device ID
+	UW	ch;		// Channel
+	UW	val;		// Conversion result
+	SYSTIM	time;		// Detected time
+} T_HAL_ADC_WINEVT;
 
 /*----------------------------------------------------------------------
  * Device driver initialization and registration
@@ -23,5 +23,6 @@
 #define DEV_HAL_I2C_TMOUT	(500)
 
 #define DEV_HAL_I2C_UNITNM	(4)	// Number of I2C units (max 26)
+#define DEV_HAL_I2C_MAX_SDATSZ	(32)	// Maximum data size of register block write
 
 #endif	/* _DEV_HAL_I2C_CNF_H_ */
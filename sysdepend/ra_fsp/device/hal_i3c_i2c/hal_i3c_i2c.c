@@ -42,16 +42,26 @@ typedef struct {
 	UW				unit;		// Unit no
 	ER				err;		// Error code that occurred during interrupt processing
 	ID				evtmbfid;	// MBF ID for event notification
+	ID				flgid;		// Interrupt detection flag
 	UW				dmode;		// Device mode
 	UW				tadr;		// Target Address
+	UB				*rbuf;		// Receive data of write-then-read
+	SZ				rsize;		// Receive data size (0: None)
+	BOOL				enable;		// I3C enabled
+	UB				devtbl[DEV_HAL_I3C_I2C_DEVTBL];	// Target address of the device table (0: Unused)
+	UINT				devnext;	// Next device table entry to be replaced
+	INT				devsel;		// Selected device table entry (-1: None)
+	INT				ni3c;		// Number of I3C target entries (Top of the device table)
+	T_HAL_I3C_I2C_DAA		*daa;		// Dynamic address assignment in progress
+	UB				ibibuf[HAL_I3C_I2C_IBISZ];	// IBI payload buffer
 } T_HAL_I3C_I2C_DCB;
 
-/* Interrupt detection flag */
-LOCAL ID	id_flgid;
+/* Interrupt detection flag (Created for each unit) */
 LOCAL T_CFLG	id_flg	= {
 		.flgatr		= TA_TFIFO | TA_WMUL,
 		.iflgptn	= 0,
 };
+#define FLGPTN_DONE	(1<<0)		// Interrupt processing completed
 
 #if TK_SUPPORT_MEMLIB
 LOCAL T_HAL_I3C_I2C_DCB	*dev_i3c_cb[DEV_HAL_I3C_I2C_UNITNM];
@@ -61,6 +71,10 @@ LOCAL T_HAL_I3C_I2C_DCB	dev_i3c_cb[DEV_HAL_I3C_I2C_UNITNM];
 #define		get_dcb_ptr(unit)	(&dev_I3C_cb[unit])
 #endif
 
+/* DCB of each open device descriptor (Indexed by dd. Cache of i3c_get_dcb) */
+LOCAL T_HAL_I3C_I2C_DCB	*dev_i3c_dd[CNF_MAX_OPNDEV + 1];
+#define DD_CACHED(dd)	((dd) > 0 && (dd) <= CNF_MAX_OPNDEV)
+
 /*---------------------------------------------------------------------*/
 /* Attribute data control
  */
@@ -112,6 +126,72 @@ LOCAL ER write_atr(T_HAL_I3C_I2C_DCB *p_dcb, T_DEVREQ *req)
 /*Device-specific data control
  */
 
+/* Transfer completion (Called from the callback) */
+LOCAL void xfer_done(T_HAL_I3C_I2C_DCB *p_dcb, ER err)
+{
+	SZ	rsize;
+
+	rsize = p_dcb->rsize;
+	p_dcb->rsize = 0;
+	if(err >= E_OK && rsize > 0) {		// Write-then-read: Receive after repeated start
+		if(R_I3C_Read(p_dcb->hi3c, p_dcb->rbuf, (uint32_t)rsize, false) != FSP_SUCCESS) {
+			err = E_IO;
+		}
+	}
+	if(err < E_OK || rsize == 0) {
+		p_dcb->err = err;
+		tk_set_flg(p_dcb->flgid, FLGPTN_DONE);
+	}
+}
+
+/* Address phase of ENTDAA (Called from the callback) */
+LOCAL void daa_target(T_HAL_I3C_I2C_DCB *p_dcb, i3c_callback_args_t const *p_args)
+{
+	T_HAL_I3C_I2C_DAA	*p_daa;
+	T_HAL_I3C_I2C_TGT	*p_tgt;
+	INT			i;
+
+	p_daa = p_dcb->daa;
+	if(p_daa == NULL || p_args->p_slave_info == NULL) return;
+
+	for(i = 0; i < p_daa->cnt; i++) {
+		p_tgt = &p_daa->tgt[i];
+		if(p_tgt->sadr == 0 && p_tgt->dadr == p_args->dynamic_address) {
+			p_tgt->bcr = p_args->p_slave_info->bcr;
+			p_tgt->dcr = p_args->p_slave_info->dcr;
+			knl_memcpy(p_tgt->pid, p_args->p_slave_info->pid, sizeof(p_tgt->pid));
+			p_daa->acnt++;
+			break;
+		}
+	}
+}
+
+/* In-band interrupt (Called from the callback)
+ *	The IBI is notified by the event message buffer, and the buffer for
+ *	the next IBI is set. The payload exceeding the buffer is discarded.
+ */
+LOCAL void ibi_event(T_HAL_I3C_I2C_DCB *p_dcb, i3c_callback_args_t const *p_args)
+{
+	T_HAL_I3C_I2C_IBIEVT	evt;
+	SZ			size;
+
+	if(p_args->event == I3C_EVENT_IBI_READ_COMPLETE) {
+		size = (SZ)p_args->transfer_size;
+		if(size > HAL_I3C_I2C_IBISZ) size = HAL_I3C_I2C_IBISZ;
+
+		evt.devid	= p_dcb->devid;
+		evt.dadr	= p_args->ibi_address;
+		evt.type	= p_args->ibi_type;
+		evt.size	= size;
+		knl_memcpy(evt.data, p_dcb->ibibuf, size);
+		tk_get_otm(&evt.time);
+		if(p_dcb->evtmbfid > 0) {
+			tk_snd_mbf(p_dcb->evtmbfid, &evt, sizeof(evt), TMO_POL);
+		}
+	}
+	R_I3C_IbiRead(p_dcb->hi3c, p_dcb->ibibuf, HAL_I3C_I2C_IBISZ);
+}
+
 /* HAL Callback functions */
 void g_i3c0_callback(i3c_callback_args_t const *const p_args)
 {
@@ -120,15 +200,22 @@ void g_i3c0_callback(i3c_callback_args_t const *const p_args)
 	ENTER_TASK_INDEPENDENT
 
 	p_dcb = (T_HAL_I3C_I2C_DCB*)p_args->p_context;
-	tk_set_flg(id_flgid, 1<< p_dcb->unit);
 
 	switch(p_args->event) {
 		case I3C_EVENT_WRITE_COMPLETE:
 		case I3C_EVENT_READ_COMPLETE:
-			p_dcb->err = E_OK;
+		case I3C_EVENT_ADDRESS_ASSIGNMENT_COMPLETE:
+			xfer_done(p_dcb, E_OK);
+			break;
+		case I3C_EVENT_ENTDAA_ADDRESS_PHASE:
+			daa_target(p_dcb, p_args);
+			break;
+		case I3C_EVENT_IBI_READ_COMPLETE:
+		case I3C_EVENT_IBI_READ_BUFFER_FULL:
+			ibi_event(p_dcb, p_args);
 			break;
 		default:
-			p_dcb->err = E_IO;
+			xfer_done(p_dcb, E_IO);
 			break;
 	}
 	LEAVE_TASK_INDEPENDENT
@@ -136,10 +223,10 @@ void g_i3c0_callback(i3c_callback_args_t const *const p_args)
 
 LOCAL i3c_device_cfg_t device_cfg = {
 	.static_address		= 0,
-	.dynamic_address	= 0
+	.dynamic_address	= DEV_HAL_I3C_I2C_CNTADR
 };
 
-LOCAL i3c_device_table_cfg_t device_table_cfg = {
+LOCAL const i3c_device_table_cfg_t device_table_cfg = {
 	.static_address        = 0,
 	.dynamic_address       = 0,
 	.device_protocol       = I3C_DEVICE_PROTOCOL_I2C,
@@ -148,29 +235,178 @@ LOCAL i3c_device_table_cfg_t device_table_cfg = {
 	.master_request_accept = false,
 };
 
-LOCAL ER read_data(T_HAL_I3C_I2C_DCB *p_dcb, T_DEVREQ *req)
+/* Select the target device
+ *	The device table entries are cached for each target address, so the
+ *	device table is set only when a new target address is accessed.
+ *	The entries of the I3C targets (TDN_HAL_I3C_I2C_DAA) are not replaced,
+ *	and they are accessed by I3C SDR.
+ */
+LOCAL ER select_device(T_HAL_I3C_I2C_DCB *p_dcb, UW sadr)
 {
-	UINT		wflgptn, rflgptn;
-	fsp_err_t	fsp_err;
-	ER		err;
+	i3c_device_table_cfg_t	tblcfg;
+	fsp_err_t		fsp_err;
+	INT			i;
 
-	wflgptn = 1 << p_dcb->unit;
-	tk_clr_flg(id_flgid, ~wflgptn);
+	if(sadr == 0 || sadr > 0x7F) return E_PAR;
 
-	switch(p_dcb->dmode) {
-	case HAL_I3C_I2C_MODE_CNT:
+	if(!p_dcb->enable) {
 		fsp_err = R_I3C_DeviceCfgSet(p_dcb->hi3c, &device_cfg);
 		if(fsp_err != FSP_SUCCESS) return E_IO;
+	}
 
-		device_table_cfg.static_address = req->start;
-		fsp_err = R_I3C_MasterDeviceTableSet(p_dcb->hi3c, 0, &device_table_cfg);
+	for(i = 0; i < DEV_HAL_I3C_I2C_DEVTBL; i++) {
+		if(p_dcb->devtbl[i] == sadr) break;
+	}
+	if(i >= DEV_HAL_I3C_I2C_DEVTBL) {		// Not cached: Set the device table entry
+		if(p_dcb->ni3c >= DEV_HAL_I3C_I2C_DEVTBL) return E_LIMIT;
+		i = p_dcb->devnext;
+		p_dcb->devnext = (i + 1 < DEV_HAL_I3C_I2C_DEVTBL)? i + 1: p_dcb->ni3c;
+		p_dcb->devtbl[i] = 0;
+		if(p_dcb->devsel == i) p_dcb->devsel = -1;
+
+		tblcfg = device_table_cfg;
+		tblcfg.static_address = sadr;
+		fsp_err = R_I3C_MasterDeviceTableSet(p_dcb->hi3c, i, &tblcfg);
 		if(fsp_err != FSP_SUCCESS) return E_IO;
+		p_dcb->devtbl[i] = (UB)sadr;
+	}
 
+	if(!p_dcb->enable) {
 		fsp_err = R_I3C_Enable(p_dcb->hi3c);
 		if(fsp_err != FSP_SUCCESS) return E_IO;
+		p_dcb->enable = TRUE;
+	}
 
-		fsp_err = R_I3C_DeviceSelect(p_dcb->hi3c, 0, I3C_BITRATE_MODE_I2C_STDBR);
+	if(p_dcb->devsel != i) {
+		fsp_err = R_I3C_DeviceSelect(p_dcb->hi3c, i,
+				(i < p_dcb->ni3c)? I3C_BITRATE_MODE_I3C_SDR0_STDBR: I3C_BITRATE_MODE_I2C_STDBR);
 		if(fsp_err != FSP_SUCCESS) return E_IO;
+		p_dcb->devsel = i;
+	}
+	return E_OK;
+}
+
+/* Clear the device table cache (After R_I3C_Open) */
+LOCAL void clear_device(T_HAL_I3C_I2C_DCB *p_dcb)
+{
+	INT	i;
+
+	for(i = 0; i < DEV_HAL_I3C_I2C_DEVTBL; i++) p_dcb->devtbl[i] = 0;
+	p_dcb->devnext	= 0;
+	p_dcb->devsel	= -1;
+	p_dcb->ni3c	= 0;
+	p_dcb->daa	= NULL;
+	p_dcb->enable	= FALSE;
+}
+
+/* Start the dynamic address assignment and wait for the completion */
+LOCAL ER daa_start(T_HAL_I3C_I2C_DCB *p_dcb, i3c_address_assignment_mode_t mode, UINT idx, UINT cnt)
+{
+	UINT		wflgptn, rflgptn;
+	fsp_err_t	fsp_err;
+	ER		err;
+
+	wflgptn = FLGPTN_DONE;
+	tk_clr_flg(p_dcb->flgid, ~wflgptn);
+
+	fsp_err = R_I3C_DynamicAddressAssignmentStart(p_dcb->hi3c, mode, idx, cnt);
+	if(fsp_err != FSP_SUCCESS) return E_IO;
+
+	err = tk_wai_flg(p_dcb->flgid, wflgptn, TWF_ANDW | TWF_BITCLR, &rflgptn, DEV_HAL_I3C_I2C_TMOUT);
+	if(err >= E_OK) err = p_dcb->err;
+
+	return err;
+}
+
+/* Dynamic address assignment attribute (TDN_HAL_I3C_I2C_DAA)
+ *	The I3C targets are set at the top of the device table. The targets
+ *	with the static address are assigned by SETDASA, and the others are
+ *	assigned by ENTDAA. The I2C device table cache is cleared.
+ */
+LOCAL ER daa_data(T_HAL_I3C_I2C_DCB *p_dcb, T_DEVREQ *req)
+{
+	T_HAL_I3C_I2C_DAA	*p_daa;
+	T_HAL_I3C_I2C_TGT	*p_tgt;
+	i3c_device_table_cfg_t	tblcfg;
+	fsp_err_t		fsp_err;
+	INT			i, n, nsta, pass;
+	ER			err;
+
+	if(req->size != sizeof(T_HAL_I3C_I2C_DAA)) return E_PAR;
+	p_daa = (T_HAL_I3C_I2C_DAA*)req->buf;
+
+	if(p_dcb->dmode != HAL_I3C_I2C_MODE_CNT) return E_NOSPT;
+	if(p_daa->cnt <= 0 || p_daa->cnt > DEV_HAL_I3C_I2C_DEVTBL) return E_PAR;
+	for(i = 0; i < p_daa->cnt; i++) {
+		p_tgt = &p_daa->tgt[i];
+		if(p_tgt->sadr > 0x7F || p_tgt->dadr == 0 || p_tgt->dadr > 0x7F) return E_PAR;
+	}
+
+	clear_device(p_dcb);
+	fsp_err = R_I3C_DeviceCfgSet(p_dcb->hi3c, &device_cfg);
+	if(fsp_err != FSP_SUCCESS) return E_IO;
+
+	/* Targets with the static address (SETDASA) first, and then the others (ENTDAA) */
+	n = nsta = 0;
+	for(pass = 0; pass < 2; pass++) {
+		for(i = 0; i < p_daa->cnt; i++) {
+			p_tgt = &p_daa->tgt[i];
+			if((p_tgt->sadr != 0) != (pass == 0)) continue;
+
+			tblcfg = device_table_cfg;
+			tblcfg.static_address	= p_tgt->sadr;
+			tblcfg.dynamic_address	= p_tgt->dadr;
+			tblcfg.device_protocol	= I3C_DEVICE_PROTOCOL_I3C;
+			tblcfg.ibi_accept	= true;
+			tblcfg.ibi_payload	= true;
+			fsp_err = R_I3C_MasterDeviceTableSet(p_dcb->hi3c, n, &tblcfg);
+			if(fsp_err != FSP_SUCCESS) return E_IO;
+			p_dcb->devtbl[n++] = p_tgt->dadr;
+		}
+		if(pass == 0) nsta = n;
+	}
+	p_dcb->ni3c	= n;
+	p_dcb->devnext	= n % DEV_HAL_I3C_I2C_DEVTBL;
+
+	fsp_err = R_I3C_Enable(p_dcb->hi3c);
+	if(fsp_err != FSP_SUCCESS) return E_IO;
+	p_dcb->enable = TRUE;
+
+	p_daa->acnt	= 0;
+	p_dcb->daa	= p_daa;
+	err = E_OK;
+	for(i = 0; i < nsta && err >= E_OK; i++) {
+		err = daa_start(p_dcb, I3C_ADDRESS_ASSIGNMENT_MODE_SETDASA, i, 1);
+		if(err >= E_OK) p_daa->acnt++;
+	}
+	if(err >= E_OK && n > nsta) {
+		err = daa_start(p_dcb, I3C_ADDRESS_ASSIGNMENT_MODE_ENTDAA, nsta, n - nsta);
+	}
+	p_dcb->daa = NULL;
+
+	if(err >= E_OK && p_daa->acnt < p_daa->cnt) err = E_IO;	// Target not found
+	if(err >= E_OK) {
+		fsp_err = R_I3C_IbiRead(p_dcb->hi3c, p_dcb->ibibuf, HAL_I3C_I2C_IBISZ);
+		if(fsp_err != FSP_SUCCESS) err = E_IO;
+	}
+	if(err >= E_OK) req->asize = req->size;
+
+	return err;
+}
+
+LOCAL ER read_data(T_HAL_I3C_I2C_DCB *p_dcb, T_DEVREQ *req)
+{
+	UINT		wflgptn, rflgptn;
+	fsp_err_t	fsp_err;
+	ER		err;
+
+	wflgptn = FLGPTN_DONE;
+	tk_clr_flg(p_dcb->flgid, ~wflgptn);
+
+	switch(p_dcb->dmode) {
+	case HAL_I3C_I2C_MODE_CNT:
+		err = select_device(p_dcb, req->start);
+		if(err < E_OK) return err;
 
 		fsp_err = R_I3C_Read(p_dcb->hi3c, (UB*)req->buf, req->size, false);
 		if(fsp_err != FSP_SUCCESS) return E_IO;
@@ -183,7 +419,7 @@ LOCAL ER read_data(T_HAL_I3C_I2C_DCB *p_dcb, T_DEVREQ *req)
 		return E_SYS;
 	}
 
-	err = tk_wai_flg(id_flgid, wflgptn, TWF_ANDW | TWF_BITCLR, &rflgptn, DEV_HAL_I3C_I2C_TMOUT);
+	err = tk_wai_flg(p_dcb->flgid, wflgptn, TWF_ANDW | TWF_BITCLR, &rflgptn, DEV_HAL_I3C_I2C_TMOUT);
 	if(err >= E_OK) {
 		err = p_dcb->err;
 		if(err >= E_OK) req->asize = req->size;
@@ -198,23 +434,13 @@ LOCAL ER write_data(T_HAL_I3C_I2C_DCB *p_dcb, T_DEVREQ *req)
 	fsp_err_t	fsp_err;
 	ER		err;
 
-	wflgptn = 1 << p_dcb->unit;
-	tk_clr_flg(id_flgid, ~wflgptn);
+	wflgptn = FLGPTN_DONE;
+	tk_clr_flg(p_dcb->flgid, ~wflgptn);
 
 	switch(p_dcb->dmode) {
 	case HAL_I3C_I2C_MODE_CNT:
-		fsp_err = R_I3C_DeviceCfgSet(p_dcb->hi3c, &device_cfg);
-		if(fsp_err != FSP_SUCCESS) return E_IO;
-
-		device_table_cfg.static_address = req->start;
-		fsp_err = R_I3C_MasterDeviceTableSet(p_dcb->hi3c, 0, &device_table_cfg);
-		if(fsp_err != FSP_SUCCESS) return E_IO;
-
-		fsp_err = R_I3C_Enable(p_dcb->hi3c);
-		if(fsp_err != FSP_SUCCESS) return E_IO;
-
-		fsp_err = R_I3C_DeviceSelect(p_dcb->hi3c, 0, I3C_BITRATE_MODE_I2C_STDBR);
-		if(fsp_err != FSP_SUCCESS) return E_IO;
+		err = select_device(p_dcb, req->start);
+		if(err < E_OK) return err;
 
 		fsp_err = R_I3C_Write(p_dcb->hi3c, (UB*)req->buf, req->size, false);
 		if(fsp_err != FSP_SUCCESS) return E_IO;
@@ -227,7 +453,7 @@ LOCAL ER write_data(T_HAL_I3C_I2C_DCB *p_dcb, T_DEVREQ *req)
 		return E_SYS;
 	}
 
-	err = tk_wai_flg(id_flgid, wflgptn, TWF_ANDW | TWF_BITCLR, &rflgptn, DEV_HAL_I3C_I2C_TMOUT);
+	err = tk_wai_flg(p_dcb->flgid, wflgptn, TWF_ANDW | TWF_BITCLR, &rflgptn, DEV_HAL_I3C_I2C_TMOUT);
 	if(err >= E_OK) {
 		err = p_dcb->err;
 		if(err >= E_OK) req->asize = req->size;
@@ -236,6 +462,53 @@ LOCAL ER write_data(T_HAL_I3C_I2C_DCB *p_dcb, T_DEVREQ *req)
 	return err;
 }
 
+/* Write-then-read with repeated start
+ *	The receive is started in the callback of the send completion.
+ */
+LOCAL ER xfer_exec(T_HAL_I3C_I2C_DCB *p_dcb, UW sadr, UB *sbuf, SZ ssize, UB *rbuf, SZ rsize)
+{
+	UINT		wflgptn, rflgptn;
+	fsp_err_t	fsp_err;
+	ER		err;
+
+	if(p_dcb->dmode != HAL_I3C_I2C_MODE_CNT) return E_NOSPT;
+	if(ssize <= 0 || rsize <= 0) return E_PAR;
+
+	wflgptn = FLGPTN_DONE;
+	tk_clr_flg(p_dcb->flgid, ~wflgptn);
+
+	err = select_device(p_dcb, sadr);
+	if(err < E_OK) return err;
+
+	p_dcb->rbuf	= rbuf;
+	p_dcb->rsize	= rsize;
+	fsp_err = R_I3C_Write(p_dcb->hi3c, sbuf, (uint32_t)ssize, true);
+	if(fsp_err != FSP_SUCCESS) {
+		p_dcb->rsize = 0;
+		return E_IO;
+	}
+
+	err = tk_wai_flg(p_dcb->flgid, wflgptn, TWF_ANDW | TWF_BITCLR, &rflgptn, DEV_HAL_I3C_I2C_TMOUT);
+	p_dcb->rsize = 0;
+	if(err >= E_OK) err = p_dcb->err;
+
+	return err;
+}
+
+/* Write-then-read attribute (TDN_HAL_I2C_EXEC) */
+LOCAL ER exec_data(T_HAL_I3C_I2C_DCB *p_dcb, T_DEVREQ *req)
+{
+	T_HAL_I2C_EXEC	*p_ex;
+	ER		err;
+
+	if(req->size != sizeof(T_HAL_I2C_EXEC)) return E_PAR;
+	p_ex = (T_HAL_I2C_EXEC*)req->buf;
+
+	err = xfer_exec(p_dcb, p_ex->sadr, p_ex->snd_data, p_ex->snd_size, p_ex->rcv_data, p_ex->rcv_size);
+	if(err >= E_OK) req->asize = req->size;
+	return err;
+}
+
 /*----------------------------------------------------------------------
  * mSDI I/F function
  */
@@ -251,9 +524,11 @@ LOCAL ER dev_i2c_openfn( ID devid, UINT omode, T_MSDI *msdi)
 	if(p_dcb->hi3c == NULL) return E_IO;
 
 	p_dcb->omode = omode;
+	knl_memset(dev_i3c_dd, 0, sizeof(dev_i3c_dd));	// The dd may be reused
 
 	p_dcb->ci3c->p_context = p_dcb;
 	fsp_err =  R_I3C_Open(p_dcb->hi3c, p_dcb->ci3c);
+	if(fsp_err == FSP_SUCCESS) clear_device(p_dcb);
 
 	return (fsp_err == FSP_SUCCESS)?E_OK:E_IO;
 }
@@ -263,6 +538,7 @@ LOCAL ER dev_i2c_openfn( ID devid, UINT omode, T_MSDI *msdi)
  */
 LOCAL ER dev_i2c_closefn( ID devid, UINT option, T_MSDI *msdi)
 {
+	knl_memset(dev_i3c_dd, 0, sizeof(dev_i3c_dd));
 	return E_OK;
 }
 
@@ -296,6 +572,10 @@ LOCAL ER dev_i2c_writefn( T_DEVREQ *req, T_MSDI *p_msdi)
 
 	if(req->start >= 0) {
 		rtn = write_data( p_dcb, req);	// Device specific data
+	} else if(req->start == TDN_HAL_I2C_EXEC) {
+		rtn = exec_data( p_dcb, req);	// Write-then-read
+	} else if(req->start == TDN_HAL_I3C_I2C_DAA) {
+		rtn = daa_data( p_dcb, req);	// Dynamic address assignment
 	} else {
 		rtn = write_atr( p_dcb, req);	// Device attribute data
 	}
@@ -334,9 +614,9 @@ EXPORT ER dev_init_hal_i3c_i2c( UW unit, i3c_instance_ctrl_t *hi3c, const i3c_cf
 	p_dcb = &dev_i3c_cb[unit];
 #endif
 
-	id_flgid = tk_cre_flg(&id_flg);
-	if(id_flgid <= E_OK) {
-		err = (ER)id_flgid;
+	p_dcb->flgid = tk_cre_flg(&id_flg);
+	if(p_dcb->flgid <= E_OK) {
+		err = (ER)p_dcb->flgid;
 		goto err_1;
 	}
 
@@ -358,7 +638,7 @@ EXPORT ER dev_init_hal_i3c_i2c( UW unit, i3c_instance_ctrl_t *hi3c, const i3c_cf
 	dmsdi.devnm[i+1] = 0;
 
 	err = msdi_def_dev( &dmsdi, &idev, &p_msdi);
-	if(err != E_OK) goto err_1;
+	if(err != E_OK) goto err_2;
 
 	ci3c_nc = *ci3c;
 
@@ -368,9 +648,13 @@ EXPORT ER dev_init_hal_i3c_i2c( UW unit, i3c_instance_ctrl_t *hi3c, const i3c_cf
 	p_dcb->unit	= unit;
 	p_dcb->evtmbfid	= idev.evtmbfid;
 	p_dcb->dmode	= HAL_I3C_I2C_MODE_CNT;
+	p_dcb->rsize	= 0;
+	clear_device(p_dcb);
 
 	return E_OK;
 
+err_2:
+	tk_del_flg(p_dcb->flgid);
 err_1:
 #if TK_SUPPORT_MEMLIB
 	Kfree(p_dcb);
@@ -380,96 +664,99 @@ err_1:
 
 /*----------------------------------------------------------------------
  * I3C register access support function
+ *	The register address and the data block are transferred in one
+ *	transaction. (Read: Repeated start after the register address)
  */
-
-EXPORT ER hal_i3c_i2c_read_reg(ID dd, UW sadr, UW radr, UB *data)
+/*
+ * DCB of the device descriptor
+ *	The device is looked up only at the first access with the dd.
+ *	After that, the DCB is taken from dev_i3c_dd[dd].
+ *	The cache is cleared when a device of this driver is opened or closed.
+ */
+LOCAL T_HAL_I3C_I2C_DCB* i3c_get_dcb(ID dd)
 {
-	fsp_err_t		fsp_err;
 	T_HAL_I3C_I2C_DCB	*p_dcb;
 	ID			devid;
 	UINT			unit;
-	UINT			wflgptn, rflgptn;
-	UB			adr8b;
-	ER			err;
-	
+
+	if(DD_CACHED(dd) && dev_i3c_dd[dd] != NULL) return dev_i3c_dd[dd];
+
 	devid = tk_oref_dev(dd, NULL);
+	if(devid < E_OK) return NULL;
 	for(unit = 0; unit <DEV_HAL_I3C_I2C_UNITNM; unit++) {
 		p_dcb = get_dcb_ptr(unit);
-		if(p_dcb->devid == devid) break;
+		if(p_dcb != NULL && p_dcb->devid == devid) {
+			if(DD_CACHED(dd)) dev_i3c_dd[dd] = p_dcb;
+			return p_dcb;
+		}
 	}
-	if(unit >= DEV_HAL_I3C_I2C_UNITNM) return E_ID;
+	return NULL;
+}
 
-	wflgptn = 1 << unit;
-	tk_clr_flg(id_flgid, ~wflgptn);
+LOCAL ER hal_i3c_i2c_access_regs(ID dd, UW sadr, UW radr, INT asz, UB *buf, SZ len, BOOL wr)
+{
+	fsp_err_t		fsp_err;
+	T_HAL_I3C_I2C_DCB	*p_dcb;
+	UINT			wflgptn, rflgptn;
+	UB			sdat[2 + DEV_HAL_I3C_I2C_MAX_SDATSZ];
+	INT			n;
+	ER			err;
 
-	fsp_err = R_I3C_DeviceCfgSet(p_dcb->hi3c, &device_cfg);
-	if(fsp_err != FSP_SUCCESS) return E_IO;
+	if(len <= 0 || (wr && len > DEV_HAL_I3C_I2C_MAX_SDATSZ)) return E_PAR;
 
-	device_table_cfg.static_address = sadr;
-	fsp_err = R_I3C_MasterDeviceTableSet(p_dcb->hi3c, 0, &device_table_cfg);
-	if(fsp_err != FSP_SUCCESS) return E_IO;
+	p_dcb = i3c_get_dcb(dd);
+	if(p_dcb == NULL) return E_ID;
 
-	fsp_err = R_I3C_Enable(p_dcb->hi3c);
-	if(fsp_err != FSP_SUCCESS) return E_IO;
+	n = 0;
+	if(asz == 2) sdat[n++] = (UB)(radr >> 8);
+	sdat[n++] = (UB)radr;
 
-	fsp_err = R_I3C_DeviceSelect(p_dcb->hi3c, 0, I3C_BITRATE_MODE_I2C_STDBR);
-	if(fsp_err != FSP_SUCCESS) return E_IO;
+	if(!wr) return xfer_exec(p_dcb, sadr, sdat, n, buf, len);
 
-	adr8b = (UB)radr;
-	fsp_err = R_I3C_Write(p_dcb->hi3c,  &adr8b, 1, true);
-	if(fsp_err != FSP_SUCCESS) return E_IO;
+	wflgptn = FLGPTN_DONE;
+	tk_clr_flg(p_dcb->flgid, ~wflgptn);
 
-	err = tk_wai_flg(id_flgid, wflgptn, TWF_ANDW | TWF_BITCLR, &rflgptn, DEV_HAL_I3C_I2C_TMOUT);
-	if(err < E_OK) return E_IO;
+	err = select_device(p_dcb, sadr);
+	if(err < E_OK) return err;
 
-	fsp_err = R_I3C_Read(p_dcb->hi3c, data, 1, false);
+	knl_memcpy(&sdat[n], buf, len);
+	fsp_err = R_I3C_Write(p_dcb->hi3c, sdat, n + len, false);
 	if(fsp_err != FSP_SUCCESS) return E_IO;
 
-	err = tk_wai_flg(id_flgid, wflgptn, TWF_ANDW | TWF_BITCLR, &rflgptn, DEV_HAL_I3C_I2C_TMOUT);
+	err = tk_wai_flg(p_dcb->flgid, wflgptn, TWF_ANDW | TWF_BITCLR, &rflgptn, DEV_HAL_I3C_I2C_TMOUT);
+	if(err >= E_OK) err = p_dcb->err;
 	
 	return err;
 }
 
-EXPORT ER hal_i3c_i2c_write_reg(ID dd, UW sadr, UW radr, UB data)
+EXPORT ER hal_i3c_i2c_read_reg(ID dd, UW sadr, UW radr, UB *data)
 {
-	fsp_err_t		fsp_err;
-	T_HAL_I3C_I2C_DCB	*p_dcb;
-	ID			devid;
-	UINT			unit;
-	UINT			wflgptn, rflgptn;
-	UB			sdat[2];
-	ER			err;
-	
-	devid = tk_oref_dev(dd, NULL);
-	for(unit = 0; unit <DEV_HAL_I3C_I2C_UNITNM; unit++) {
-		p_dcb = get_dcb_ptr(unit);
-		if(p_dcb->devid == devid) break;
-	}
-	if(unit >= DEV_HAL_I3C_I2C_UNITNM) return E_ID;
-
-	wflgptn = 1 << unit;
-	tk_clr_flg(id_flgid, ~wflgptn);
-
-	fsp_err = R_I3C_DeviceCfgSet(p_dcb->hi3c, &device_cfg);
-	if(fsp_err != FSP_SUCCESS) return E_IO;
+	return hal_i3c_i2c_access_regs(dd, sadr, radr, 1, data, 1, FALSE);
+}
 
-	device_table_cfg.static_address = sadr;
-	fsp_err = R_I3C_MasterDeviceTableSet(p_dcb->hi3c, 0, &device_table_cfg);
-	if(fsp_err != FSP_SUCCESS) return E_IO;
+EXPORT ER hal_i3c_i2c_write_reg(ID dd, UW sadr, UW radr, UB data)
+{
+	return hal_i3c_i2c_access_regs(dd, sadr, radr, 1, &data, 1, TRUE);
+}
 
-	fsp_err = R_I3C_Enable(p_dcb->hi3c);
-	if(fsp_err != FSP_SUCCESS) return E_IO;
+EXPORT ER hal_i3c_i2c_read_regs(ID dd, UW sadr, UW radr, UB *buf, SZ len)
+{
+	return hal_i3c_i2c_access_regs(dd, sadr, radr, 1, buf, len, FALSE);
+}
 
-	fsp_err = R_I3C_DeviceSelect(p_dcb->hi3c, 0, I3C_BITRATE_MODE_I2C_STDBR);
-	if(fsp_err != FSP_SUCCESS) return E_IO;
+EXPORT ER hal_i3c_i2c_write_regs(ID dd, UW sadr, UW radr, CONST UB *buf, SZ len)
+{
+	return hal_i3c_i2c_access_regs(dd, sadr, radr, 1, (UB*)buf, len, TRUE);
+}
 
-	sdat[0] = (UB)radr; sdat[1] = data;
-	fsp_err = R_I3C_Write(p_dcb->hi3c, sdat, sizeof(sdat), false);
-	if(fsp_err != FSP_SUCCESS) return E_IO;
+EXPORT ER hal_i3c_i2c_read_regs16(ID dd, UW sadr, UW radr, UB *buf, SZ len)
+{
+	return hal_i3c_i2c_access_regs(dd, sadr, radr, 2, buf, len, FALSE);
+}
 
-	err = tk_wai_flg(id_flgid, wflgptn, TWF_ANDW | TWF_BITCLR, &rflgptn, DEV_HAL_I3C_I2C_TMOUT);
-	
-	return err;
+EXPORT ER hal_i3c_i2c_write_regs16(ID dd, UW sadr, UW radr, CONST UB *buf, SZ len)
+{
+	return hal_i3c_i2c_access_regs(dd, sadr, radr, 2, (UB*)buf, len, TRUE);
 }
 
 #endif		/* DEVCNF_USE_HAL_I3C_IIC */
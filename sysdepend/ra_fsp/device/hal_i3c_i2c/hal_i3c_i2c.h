@@ -27,11 +27,39 @@
  */
 #define TDN_HAL_I3C_I2C_MODE	(-100)	// I3C Mode
 #define TDN_HAL_I3C_I2C_TADR	(-101)	// Target Address
-#define TDN_HAL_I3C_I2C_MAX		(-101)
+#define TDN_HAL_I3C_I2C_DAA	(-103)	// Dynamic address assignment of I3C targets
+#define TDN_HAL_I3C_I2C_MAX		(-103)	// (TDN_HAL_I2C_EXEC(-102) is defined in device.h)
 
 #define HAL_I3C_I2C_MODE_CNT	(0)	// I3C Mode: Controller mode	
 #define HAL_I3C_I2C_MODE_TAR	(1)	// I3C Mode: Target mode
 
+/* I3C target information (TDN_HAL_I3C_I2C_DAA) */
+typedef struct {
+	UB	sadr;		// Static address (0: Assigned by ENTDAA)
+	UB	dadr;		// Dynamic address to be assigned
+	UB	bcr;		// Bus Characteristics Register (Set by ENTDAA)
+	UB	dcr;		// Device Characteristics Register (Set by ENTDAA)
+	UB	pid[6];		// Provisioned ID (Set by ENTDAA)
+} T_HAL_I3C_I2C_TGT;
+
+typedef struct {
+	INT			cnt;		// Number of I3C targets
+	T_HAL_I3C_I2C_TGT	*tgt;		// Target information
+	INT			acnt;		// Number of assigned targets (Set by the driver)
+} T_HAL_I3C_I2C_DAA;
+
+/* In-band interrupt event (Notified by the event message buffer) */
+#define HAL_I3C_I2C_IBISZ	(8)	// Maximum IBI payload size
+
+typedef struct {
+	ID	devid;				// Device ID
+	UW	dadr;				// Dynamic address of the target
+	UW	type;				// IBI type (i3c_ibi_type_t)
+	SZ	size;				// Payload size
+	UB	data[HAL_I3C_I2C_IBISZ];	// Payload
+	SYSTIM	time;				// Event time
+} T_HAL_I3C_I2C_IBIEVT;
+
 /*----------------------------------------------------------------------
  * Device driver initialization and registration
  */
@@ -42,5 +70,9 @@ IMPORT ER dev_init_hal_i3c_i2c( UW unit, i3c_instance_ctrl_t *hi3c, const i3c_cf
  */
 IMPORT ER hal_i3c_i2c_read_reg(ID dd, UW sadr, UW radr, UB *data);
 IMPORT ER hal_i3c_i2c_write_reg(ID dd, UW sadr, UW radr, UB data);
+IMPORT ER hal_i3c_i2c_read_regs(ID dd, UW sadr, UW radr, UB *buf, SZ len);
+IMPORT ER hal_i3c_i2c_write_regs(ID dd, UW sadr, UW radr, CONST UB *buf, SZ len);
+IMPORT ER hal_i3c_i2c_read_regs16(ID dd, UW sadr, UW radr, UB *buf, SZ len);		// 16-bit register address
+IMPORT ER hal_i3c_i2c_write_regs16(ID dd, UW sadr, UW radr, CONST UB *buf, SZ len);	// 16-bit register address
 
 #endif	/* _DEV_HAL_I3C_I2C_H_ */
\ No newline at end of file
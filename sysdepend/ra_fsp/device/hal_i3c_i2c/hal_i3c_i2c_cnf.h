@@ -23,5 +23,8 @@
 #define DEV_HAL_I3C_I2C_TMOUT	(500)
 
 #define DEV_HAL_I3C_I2C_UNITNM	(3)	// Number of I3C units (max 26)
+#define DEV_HAL_I3C_I2C_MAX_SDATSZ	(32)	// Maximum data size of register block write
+#define DEV_HAL_I3C_I2C_DEVTBL	(8)	// Number of cached device table entries (max 8)
+#define DEV_HAL_I3C_I2C_CNTADR	(0x08)	// Dynamic address of the controller (I3C targets)
 
 #endif	/* _DEV_HAL_I3C_I2C_CNF_H_ */
@@ -30,7 +30,7 @@
 
 #include <tm/tmonitor.h>
 
-LOCAL __attribute__((__aligned__(32)))uint8_t ether_rx_buffers[DEV_HAL_RBUF_NUM][1536]ETHER_BUFFER_PLACE_IN_SECTION;
+LOCAL DCACHE_ALIGNED uint8_t ether_rx_buffers[DEV_HAL_RBUF_NUM][DCACHE_ROUNDUP(1536)]ETHER_BUFFER_PLACE_IN_SECTION;
 
 #define UNUSED(x)		((void *) (x)) 
 
@@ -61,6 +61,7 @@ typedef struct {
 	QUEUE 			freerxbufq;	// Free RX buffer Queue
 	ID			flgid;		// Event flag ID
 	BOOL			linkstatus;	// Link status	
+	volatile BOOL		rxpend;		// RX drain is queued to the worker task
 } T_HAL_NET_DCB;
 
 /* Interrupt detection flag */
@@ -157,28 +158,123 @@ LOCAL ER write_atr(T_HAL_NET_DCB *p_dcb, T_DEVREQ *req)
 /* Device-specific data control
  */
 
-/* HAL Callback functions */
-LOCAL void HAL_Net_Callback(ether_callback_args_t * p_args)
+/*
+ * Receive a frame
+ *	Pass the received frame to the RX message buffer.
+ *	With D-cache, the frame is invalidated after the DMA wrote it, and the
+ *	new buffer is invalidated before it is passed to the DMA (The QUEUE
+ *	link of the free buffer may be left in the cache).
+ *	Returns FSP_ERR_ETHER_ERROR_NO_DATA if no frame is received.
+ */
+LOCAL fsp_err_t net_rx_one(T_HAL_NET_DCB *p_dcb)
 {
-	T_HAL_NET_DCB	*p_dcb;
 	fsp_err_t	err;
 	NetEvent	event;
 	uint32_t 	length;
 	void 		*pbuf;
 	ER		ercd;
 
+	err = g_ether0.p_api->read(g_ether0.p_ctrl, &event.buf, &length);
+	if( err == FSP_SUCCESS ) {
+		pbuf = (void *) QueRemoveNext( &p_dcb->freerxbufq );
+		if( pbuf != NULL ) {
+			DCacheInvalidate(event.buf, (SZ) length);
+			event.len = (UH) length;
+			ercd = tk_snd_mbf( p_dcb->rxmbfid, &event, sizeof( NetEvent ), TMO_POL );
+			
+			if(ercd >= E_OK) {
+				DCacheInvalidate(pbuf, (SZ) g_ether0.p_cfg->ether_buffer_size);
+				g_ether0.p_api->rxBufferUpdate(g_ether0.p_ctrl, pbuf);
+				return err;
+			}
+			else {
+				QueInsert((QUEUE*)pbuf, &p_dcb->freerxbufq);
+			}
+		}
+	}
+	
+	if( err != FSP_ERR_ETHER_ERROR_NO_DATA ) {
+		/* Release current buffer that set to the descriptor. */
+		g_ether0.p_api->bufferRelease(g_ether0.p_ctrl);
+	}
+	return err;
+}
+
+/*
+ * Receive all frames (Interrupt handler)
+ */
+LOCAL void net_rx_drain(T_HAL_NET_DCB *p_dcb)
+{
+	while( net_rx_one(p_dcb) != FSP_ERR_ETHER_ERROR_NO_DATA );
+}
+
+#if USE_DEFWORK
+/*
+ * Deferred work (Executed by the worker task)
+ *	The pending flag is cleared before the drain, so the frame received
+ *	during the drain queues the next work. The interrupt is masked only
+ *	while each frame updates the descriptor ring and the free buffer
+ *	queue, which are shared with DN_NETRXBUF and the interrupt handler.
+ */
+LOCAL void net_rx_work(void *arg)
+{
+	T_HAL_NET_DCB	*p_dcb = (T_HAL_NET_DCB*)arg;
+	fsp_err_t	err;
+
+	p_dcb->rxpend = FALSE;
+	do {
+		DisableInt((UINT) g_ether0.p_cfg->irq);
+		err = net_rx_one(p_dcb);
+		EnableInt((UINT) g_ether0.p_cfg->irq, (INT) g_ether0.p_cfg->interrupt_priority);
+	} while( err != FSP_ERR_ETHER_ERROR_NO_DATA );
+}
+
+/* Link status at the event (arg: TRUE = Link up) */
+LOCAL void net_link_work(void *arg)
+{
+	tm_printf((arg != NULL)?"Ether link up\n":"Ether link down\n");
+}
+
+/*
+ * The RX frames are received by the worker task.
+ *	The interrupts while the work is pending are merged into it. If the
+ *	queue is full, the frames are received in the interrupt handler not
+ *	to leave them until the next interrupt.
+ */
+LOCAL void net_rx_frame(T_HAL_NET_DCB *p_dcb)
+{
+	if( p_dcb->rxpend ) return;
+
+	p_dcb->rxpend = TRUE;
+	if( DeferWork(DEV_HAL_NET_DEFWORK_PRI, (FP)net_rx_work, p_dcb) != E_OK ) {
+		p_dcb->rxpend = FALSE;
+		net_rx_drain(p_dcb);
+	}
+}
+
+#define net_link_msg(stat, msg)	DeferWork(DEV_HAL_NET_DEFWORK_PRI, (FP)net_link_work, (void*)(UW)(stat))
+#else
+#define net_rx_frame(p_dcb)	net_rx_drain(p_dcb)
+#define net_link_msg(stat, msg)	tm_printf(msg)
+#endif	/* USE_DEFWORK */
+
+/* HAL Callback functions */
+LOCAL void HAL_Net_Callback(ether_callback_args_t * p_args)
+{
+	T_HAL_NET_DCB	*p_dcb;
+
 	ENTER_TASK_INDEPENDENT
 
 	p_dcb = (T_HAL_NET_DCB*)p_args->p_context;
 
 	switch(p_args->event) {
 		case ETHER_EVENT_LINK_ON:
-			tm_printf("Ether link up\n");
 			p_dcb->linkstatus = TRUE;
+			net_link_msg(TRUE, "Ether link up\n");
 			break;
 		case ETHER_EVENT_LINK_OFF:
-			tm_printf("Ether link down\n");
 			p_dcb->linkstatus = FALSE;
+			net_link_msg(FALSE, "Ether link down\n");
 			break;
 #if (ETHER_CFG_KEEP_INTERRUPT_EVENT_BACKWORD_COMPATIBILITY)
 		case ETHER_EVENT_INTERRUPT:
@@ -187,29 +283,7 @@ LOCAL void HAL_Net_Callback(ether_callback_args_t * p_args)
 			}
 			
 			if( ETHER_ISR_EE_FR_MASK == (p_args->status_eesr & ETHER_ISR_EE_FR_MASK) ) {
-				do {
-					err = g_ether0.p_api->read(g_ether0.p_ctrl, &event.buf, &length);
-					if( err == FSP_SUCCESS ) {
-						pbuf = (void *) QueRemoveNext( &p_dcb->freerxbufq );
-						if( pbuf != NULL ) {
-							event.len = (UH) length;
-							ercd = tk_snd_mbf( p_dcb->rxmbfid, &event, sizeof( NetEvent ), TMO_POL );
-							
-							if(ercd >= E_OK) {
-								g_ether0.p_api->rxBufferUpdate(g_ether0.p_ctrl, pbuf);
-								continue;
-							}
-							else {
-								QueInsert((QUEUE*)pbuf, &p_dcb->freerxbufq);
-							}
-						}
-					}
-					
-					if( err != FSP_ERR_ETHER_ERROR_NO_DATA ) {
-						/* Release current buffer that set to the descriptor. */
-						g_ether0.p_api->bufferRelease(g_ether0.p_ctrl);
-					}
-				} while(FSP_ERR_ETHER_ERROR_NO_DATA != err);
+				net_rx_frame(p_dcb);
 			}
 			break;
 #else
@@ -220,29 +294,7 @@ LOCAL void HAL_Net_Callback(ether_callback_args_t * p_args)
 			tk_set_flg(p_dcb->flgid, ETHER_FLGPTN_TX_ABORTED);
 			break;
 		case ETHER_EVENT_RX_COMPLETE:
-			do {
-				err = g_ether0.p_api->read(g_ether0.p_ctrl, &event.buf, &length);
-				if( err == FSP_SUCCESS ) {
-					pbuf = (void *) QueRemoveNext( &p_dcb->freerxbufq );
-					if( pbuf != NULL ) {
-						event.len = (UH) length;
-						ercd = tk_snd_mbf( p_dcb->rxmbfid, &event, sizeof( NetEvent ), TMO_POL );
-						
-						if(ercd >= E_OK) {
-							g_ether0.p_api->rxBufferUpdate(g_ether0.p_ctrl, pbuf);
-							continue;
-						}
-						else {
-							QueInsert((QUEUE*)pbuf, &p_dcb->freerxbufq);
-						}
-					}
-				}
-				
-				if( err != FSP_ERR_ETHER_ERROR_NO_DATA ) {
-					/* Release current buffer that set to the descriptor. */
-					g_ether0.p_api->bufferRelease(g_ether0.p_ctrl);
-				}
-			} while(FSP_ERR_ETHER_ERROR_NO_DATA != err);
+			net_rx_frame(p_dcb);
 			break;
 		case ETHER_EVENT_ERR_GLOBAL:
 			break;
@@ -283,6 +335,8 @@ LOCAL ER write_data(T_HAL_NET_DCB *p_dcb, T_DEVREQ *req)
 			}
 		}
 		
+		/* Write back the frame for the DMA (D-cache) */
+		DCacheClean(req->buf, req->size);
 		fsp_err = g_ether0.p_api->write(g_ether0.p_ctrl, req->buf, (uint32_t) req->size);
 		if( fsp_err != FSP_SUCCESS ) {
 			return E_IO;
@@ -434,6 +488,7 @@ EXPORT ER dev_init_hal_net( UW unit )
 	p_dcb->evtmbfid	= idev.evtmbfid;
 	p_dcb->rxmbfid	= -1;
 	p_dcb->linkstatus = FALSE;
+	p_dcb->rxpend = FALSE;
 	p_dcb->initialized = FALSE;
 	
 	/* Initialize the RX buffer. */
@@ -28,6 +28,8 @@
 
 #define DEV_HAL_NET_UNITNM	(1)	// Number of Net units
 
+#define DEV_HAL_NET_DEFWORK_PRI	(0)	// Deferred work level of RX (USE_DEFWORK)
+
 /* 
  * This controller assumes that the maximum size of an Ethernet packet without
  * jumbo frame support can reach up to 1,536 bytes 
@@ -42,16 +42,19 @@ typedef struct {
 	UW			unit;		// Unit no
 	ER			err;		// Error code that occurred during interrupt processing
 	ID			evtmbfid;	// MBF ID for event notification
+	ID			flgid;		// Interrupt detection flag
 	UW			dmode;		// Device mode
 	UW			tadr;		// Target Address
+	UB			*rbuf;		// Receive data of write-then-read
+	SZ			rsize;		// Receive data size (0: None)
 } T_HAL_SCI_I2C_DCB;
 
-/* Interrupt detection flag */
-LOCAL ID	id_flgid;
+/* Interrupt detection flag (Created for each unit) */
 LOCAL T_CFLG	id_flg	= {
 			.flgatr		= TA_TFIFO | TA_WMUL,
 			.iflgptn	= 0,
 };
+#define FLGPTN_DONE	(1<<0)		// Interrupt processing completed
 
 #if TK_SUPPORT_MEMLIB
 LOCAL T_HAL_SCI_I2C_DCB	*dev_i2c_cb[DEV_HAL_I2C_UNITNM];
@@ -61,6 +64,10 @@ LOCAL T_HAL_SCI_I2C_DCB	dev_i2c_cb[DEV_HAL_I2C_UNITNM];
 #define		get_dcb_ptr(unit)	(&dev_I2C_cb[unit])
 #endif
 
+/* DCB of each open device descriptor (Indexed by dd. Cache of i2c_get_dcb) */
+LOCAL T_HAL_SCI_I2C_DCB	*dev_i2c_dd[CNF_MAX_OPNDEV + 1];
+#define DD_CACHED(dd)	((dd) > 0 && (dd) <= CNF_MAX_OPNDEV)
+
 /*---------------------------------------------------------------------*/
 /* Attribute data control
  */
@@ -116,22 +123,35 @@ LOCAL ER write_atr(T_HAL_SCI_I2C_DCB *p_dcb, T_DEVREQ *req)
 LOCAL void HAL_I2C_Callback(i2c_master_callback_args_t *p_args)
 {
 	T_HAL_SCI_I2C_DCB	*p_dcb;
+	ER			err;
+	SZ			rsize;
 
 	ENTER_TASK_INDEPENDENT
 
 	p_dcb = (T_HAL_SCI_I2C_DCB*)p_args->p_context;
-	tk_set_flg(id_flgid, 1<< p_dcb->unit);
 
 	switch(p_args->event) {
 		case I2C_MASTER_EVENT_TX_COMPLETE:
 		case I2C_MASTER_EVENT_RX_COMPLETE:
-			p_dcb->err = E_OK;
+			err = E_OK;
 			break;
 		default:
-			p_dcb->err = E_IO;
+			err = E_IO;
 			break;
 	}
 
+	rsize = p_dcb->rsize;
+	p_dcb->rsize = 0;
+	if(err >= E_OK && rsize > 0) {		// Write-then-read: Receive after repeated start
+		if(R_SCI_I2C_Read(p_dcb->hi2c, p_dcb->rbuf, (uint32_t)rsize, false) != FSP_SUCCESS) {
+			err = E_IO;
+		}
+	}
+	if(err < E_OK || rsize == 0) {
+		p_dcb->err = err;
+		tk_set_flg(p_dcb->flgid, FLGPTN_DONE);
+	}
+
 	LEAVE_TASK_INDEPENDENT
 }
 
@@ -141,8 +161,8 @@ LOCAL ER read_data(T_HAL_SCI_I2C_DCB *p_dcb, T_DEVREQ *req)
 	UINT		wflgptn, rflgptn;
 	ER		err;
 
-	wflgptn = 1 << p_dcb->unit;
-	tk_clr_flg(id_flgid, ~wflgptn);
+	wflgptn = FLGPTN_DONE;
+	tk_clr_flg(p_dcb->flgid, ~wflgptn);
 
 	switch(p_dcb->dmode) {
 	case HAL_I2C_MODE_CNT:
@@ -156,7 +176,7 @@ LOCAL ER read_data(T_HAL_SCI_I2C_DCB *p_dcb, T_DEVREQ *req)
 		return E_SYS;
 	}
 
-	err = tk_wai_flg(id_flgid, wflgptn, TWF_ANDW | TWF_BITCLR, &rflgptn, DEV_HAL_I2C_TMOUT);
+	err = tk_wai_flg(p_dcb->flgid, wflgptn, TWF_ANDW | TWF_BITCLR, &rflgptn, DEV_HAL_I2C_TMOUT);
 	if(err >= E_OK) {
 		err = p_dcb->err;
 		if(err >= E_OK) req->asize = req->size;
@@ -170,8 +190,8 @@ LOCAL ER write_data(T_HAL_SCI_I2C_DCB *p_dcb, T_DEVREQ *req)
 	UINT		wflgptn, rflgptn;
 	ER		err;
 
-	wflgptn = 1 << p_dcb->unit;
-	tk_clr_flg(id_flgid, ~wflgptn);
+	wflgptn = FLGPTN_DONE;
+	tk_clr_flg(p_dcb->flgid, ~wflgptn);
 
 	switch(p_dcb->dmode) {
 	case HAL_I2C_MODE_CNT:
@@ -185,7 +205,7 @@ LOCAL ER write_data(T_HAL_SCI_I2C_DCB *p_dcb, T_DEVREQ *req)
 		return E_SYS;
 	}
 
-	err = tk_wai_flg(id_flgid, wflgptn, TWF_ANDW | TWF_BITCLR, &rflgptn, DEV_HAL_I2C_TMOUT);
+	err = tk_wai_flg(p_dcb->flgid, wflgptn, TWF_ANDW | TWF_BITCLR, &rflgptn, DEV_HAL_I2C_TMOUT);
 	if(err >= E_OK) {
 		err = p_dcb->err;
 		if(err >= E_OK) req->asize = req->size;
@@ -194,6 +214,53 @@ LOCAL ER write_data(T_HAL_SCI_I2C_DCB *p_dcb, T_DEVREQ *req)
 	return err;
 }
 
+/* Write-then-read with repeated start
+ *	The receive is started in the callback of the send completion.
+ */
+LOCAL ER xfer_exec(T_HAL_SCI_I2C_DCB *p_dcb, UW sadr, UB *sbuf, SZ ssize, UB *rbuf, SZ rsize)
+{
+	UINT		wflgptn, rflgptn;
+	ER		err;
+	fsp_err_t	fsp_err;
+
+	if(p_dcb->dmode != HAL_I2C_MODE_CNT) return E_NOSPT;
+	if(ssize <= 0 || rsize <= 0) return E_PAR;
+
+	wflgptn = FLGPTN_DONE;
+	tk_clr_flg(p_dcb->flgid, ~wflgptn);
+
+	fsp_err = R_SCI_I2C_SlaveAddressSet( p_dcb->hi2c, sadr, I2C_MASTER_ADDR_MODE_7BIT);
+	if(fsp_err != FSP_SUCCESS) return E_IO;
+
+	p_dcb->rbuf	= rbuf;
+	p_dcb->rsize	= rsize;
+	fsp_err = R_SCI_I2C_Write(p_dcb->hi2c, sbuf, (uint32_t)ssize, true);
+	if(fsp_err != FSP_SUCCESS) {
+		p_dcb->rsize = 0;
+		return E_IO;
+	}
+
+	err = tk_wai_flg(p_dcb->flgid, wflgptn, TWF_ANDW | TWF_BITCLR, &rflgptn, DEV_HAL_I2C_TMOUT);
+	p_dcb->rsize = 0;
+	if(err >= E_OK) err = p_dcb->err;
+
+	return err;
+}
+
+/* Write-then-read attribute (TDN_HAL_I2C_EXEC) */
+LOCAL ER exec_data(T_HAL_SCI_I2C_DCB *p_dcb, T_DEVREQ *req)
+{
+	T_HAL_I2C_EXEC	*p_ex;
+	ER		err;
+
+	if(req->size != sizeof(T_HAL_I2C_EXEC)) return E_PAR;
+	p_ex = (T_HAL_I2C_EXEC*)req->buf;
+
+	err = xfer_exec(p_dcb, p_ex->sadr, p_ex->snd_data, p_ex->snd_size, p_ex->rcv_data, p_ex->rcv_size);
+	if(err >= E_OK) req->asize = req->size;
+	return err;
+}
+
 /*----------------------------------------------------------------------
  * mSDI I/F function
  */
@@ -208,6 +275,7 @@ LOCAL ER dev_i2c_openfn( ID devid, UINT omode, T_MSDI *msdi)
 	if(p_dcb->hi2c == NULL) return E_IO;
 
 	p_dcb->omode = omode;
+	knl_memset(dev_i2c_dd, 0, sizeof(dev_i2c_dd));	// The dd may be reused
 
 	R_SCI_I2C_Open(p_dcb->hi2c, p_dcb->ci2c);
 	R_SCI_I2C_CallbackSet(p_dcb->hi2c, HAL_I2C_Callback, p_dcb, NULL);
@@ -220,6 +288,7 @@ LOCAL ER dev_i2c_openfn( ID devid, UINT omode, T_MSDI *msdi)
  */
 LOCAL ER dev_i2c_closefn( ID devid, UINT option, T_MSDI *msdi)
 {
+	knl_memset(dev_i2c_dd, 0, sizeof(dev_i2c_dd));
 	return E_OK;
 }
 
@@ -253,6 +322,8 @@ LOCAL ER dev_i2c_writefn( T_DEVREQ *req, T_MSDI *p_msdi)
 
 	if(req->start >= 0) {
 		rtn = write_data( p_dcb, req);	// Device specific data
+	} else if(req->start == TDN_HAL_I2C_EXEC) {
+		rtn = exec_data( p_dcb, req);	// Write-then-read
 	} else {
 		rtn = write_atr( p_dcb, req);	// Device attribute data
 	}
@@ -290,9 +361,9 @@ EXPORT ER dev_init_hal_sci_i2c( UW unit, i2c_master_ctrl_t *hi2c,
 	p_dcb = &dev_i2c_cb[unit];
 #endif
 
-	id_flgid = tk_cre_flg(&id_flg);
-	if(id_flgid <= E_OK) {
-		err = (ER)id_flgid;
+	p_dcb->flgid = tk_cre_flg(&id_flg);
+	if(p_dcb->flgid <= E_OK) {
+		err = (ER)p_dcb->flgid;
 		goto err_1;
 	}
 
@@ -314,7 +385,7 @@ EXPORT ER dev_init_hal_sci_i2c( UW unit, i2c_master_ctrl_t *hi2c,
 	dmsdi.devnm[i+1] = 0;
 
 	err = msdi_def_dev( &dmsdi, &idev, &p_msdi);
-	if(err != E_OK) goto err_1;
+	if(err != E_OK) goto err_2;
 
 	p_dcb->hi2c	= hi2c;
 	p_dcb->ci2c	= ci2c;
@@ -322,9 +393,12 @@ EXPORT ER dev_init_hal_sci_i2c( UW unit, i2c_master_ctrl_t *hi2c,
 	p_dcb->unit	= unit;
 	p_dcb->evtmbfid	= idev.evtmbfid;
 	p_dcb->dmode	= HAL_I2C_MODE_CNT;
+	p_dcb->rsize	= 0;
 
 	return E_OK;
 
+err_2:
+	tk_del_flg(p_dcb->flgid);
 err_1:
 #if TK_SUPPORT_MEMLIB
 	Kfree(p_dcb);
@@ -334,74 +408,99 @@ err_1:
 
 /*----------------------------------------------------------------------
  * I2C register access support function
+ *	The register address and the data block are transferred in one
+ *	transaction. (Read: Repeated start after the register address)
  */
-
-EXPORT ER hal_sci_i2c_read_reg(ID dd, UW sadr, UW radr, UB *data)
+/*
+ * DCB of the device descriptor
+ *	The device is looked up only at the first access with the dd.
+ *	After that, the DCB is taken from dev_i2c_dd[dd].
+ *	The cache is cleared when a device of this driver is opened or closed.
+ */
+LOCAL T_HAL_SCI_I2C_DCB* i2c_get_dcb(ID dd)
 {
-	fsp_err_t		fsp_err;
-	T_HAL_SCI_I2C_DCB		*p_dcb;
+	T_HAL_SCI_I2C_DCB	*p_dcb;
 	ID			devid;
 	UINT			unit;
-	UINT			wflgptn, rflgptn;
-	UB			adr8b;
-	ER			err;
-	
+
+	if(DD_CACHED(dd) && dev_i2c_dd[dd] != NULL) return dev_i2c_dd[dd];
+
 	devid = tk_oref_dev(dd, NULL);
+	if(devid < E_OK) return NULL;
 	for(unit = 0; unit <DEV_HAL_I2C_UNITNM; unit++) {
 		p_dcb = get_dcb_ptr(unit);
-		if(p_dcb->devid == devid) break;
+		if(p_dcb != NULL && p_dcb->devid == devid) {
+			if(DD_CACHED(dd)) dev_i2c_dd[dd] = p_dcb;
+			return p_dcb;
+		}
 	}
-	if(unit >= DEV_HAL_I2C_UNITNM) return E_ID;
+	return NULL;
+}
 
-	wflgptn = 1 << unit;
-	tk_clr_flg(id_flgid, ~wflgptn);
+LOCAL ER hal_sci_i2c_access_regs(ID dd, UW sadr, UW radr, INT asz, UB *buf, SZ len, BOOL wr)
+{
+	fsp_err_t		fsp_err;
+	T_HAL_SCI_I2C_DCB	*p_dcb;
+	UINT			wflgptn, rflgptn;
+	UB			sdat[2 + DEV_HAL_I2C_MAX_SDATSZ];
+	INT			n;
+	ER			err;
 
-	R_SCI_I2C_SlaveAddressSet( p_dcb->hi2c, sadr, I2C_MASTER_ADDR_MODE_7BIT);
-	adr8b = (UB)radr;
-	fsp_err = R_SCI_I2C_Write(p_dcb->hi2c, &adr8b, 1, true);
-	if(fsp_err != FSP_SUCCESS) return E_IO;
+	if(len <= 0 || (wr && len > DEV_HAL_I2C_MAX_SDATSZ)) return E_PAR;
+
+	p_dcb = i2c_get_dcb(dd);
+	if(p_dcb == NULL) return E_ID;
+
+	n = 0;
+	if(asz == 2) sdat[n++] = (UB)(radr >> 8);
+	sdat[n++] = (UB)radr;
+
+	if(!wr) return xfer_exec(p_dcb, sadr, sdat, n, buf, len);
 
-	err = tk_wai_flg(id_flgid, wflgptn, TWF_ANDW | TWF_BITCLR, &rflgptn, DEV_HAL_I2C_TMOUT);
-	if(err < E_OK) return E_IO;
+	wflgptn = FLGPTN_DONE;
+	tk_clr_flg(p_dcb->flgid, ~wflgptn);
 
-	fsp_err = R_SCI_I2C_Read(p_dcb->hi2c, data, 1, false);
+	R_SCI_I2C_SlaveAddressSet( p_dcb->hi2c, sadr, I2C_MASTER_ADDR_MODE_7BIT);
+
+	knl_memcpy(&sdat[n], buf, len);
+	fsp_err = R_SCI_I2C_Write(p_dcb->hi2c, sdat, n + len, false);
 	if(fsp_err != FSP_SUCCESS) return E_IO;
 
-	err = tk_wai_flg(id_flgid, wflgptn, TWF_ANDW | TWF_BITCLR, &rflgptn, DEV_HAL_I2C_TMOUT);
+	err = tk_wai_flg(p_dcb->flgid, wflgptn, TWF_ANDW | TWF_BITCLR, &rflgptn, DEV_HAL_I2C_TMOUT);
+	if(err >= E_OK) err = p_dcb->err;
 	
 	return err;
 }
 
+EXPORT ER hal_sci_i2c_read_reg(ID dd, UW sadr, UW radr, UB *data)
+{
+	return hal_sci_i2c_access_regs(dd, sadr, radr, 1, data, 1, FALSE);
+}
+
 EXPORT ER hal_sci_i2c_write_reg(ID dd, UW sadr, UW radr, UB data)
 {
-	fsp_err_t		fsp_err;
-	T_HAL_SCI_I2C_DCB		*p_dcb;
-	ID			devid;
-	UINT			unit;
-	UINT			wflgptn, rflgptn;
-	UB			sdat[2];
-	ER			err;
-	
-	devid = tk_oref_dev(dd, NULL);
-	for(unit = 0; unit <DEV_HAL_I2C_UNITNM; unit++) {
-		p_dcb = get_dcb_ptr(unit);
-		if(p_dcb->devid == devid) break;
-	}
-	if(unit >= DEV_HAL_I2C_UNITNM) return E_ID;
+	return hal_sci_i2c_access_regs(dd, sadr, radr, 1, &data, 1, TRUE);
+}
 
-	wflgptn = 1 << unit;
-	tk_clr_flg(id_flgid, ~wflgptn);
+EXPORT ER hal_sci_i2c_read_regs(ID dd, UW sadr, UW radr, UB *buf, SZ len)
+{
+	return hal_sci_i2c_access_regs(dd, sadr, radr, 1, buf, len, FALSE);
+}
 
-	R_SCI_I2C_SlaveAddressSet( p_dcb->hi2c, sadr, I2C_MASTER_ADDR_MODE_7BIT);
-	sdat[0] = (UB)radr; sdat[1] = data;
-	fsp_err = R_SCI_I2C_Write(p_dcb->hi2c, sdat, sizeof(sdat), false);
-	if(fsp_err != FSP_SUCCESS) return E_IO;
+EXPORT ER hal_sci_i2c_write_regs(ID dd, UW sadr, UW radr, CONST UB *buf, SZ len)
+{
+	return hal_sci_i2c_access_regs(dd, sadr, radr, 1, (UB*)buf, len, TRUE);
+}
 
-	err = tk_wai_flg(id_flgid, wflgptn, TWF_ANDW | TWF_BITCLR, &rflgptn, DEV_HAL_I2C_TMOUT);
-	
-	return err;
+EXPORT ER hal_sci_i2c_read_regs16(ID dd, UW sadr, UW radr, UB *buf, SZ len)
+{
+	return hal_sci_i2c_access_regs(dd, sadr, radr, 2, buf, len, FALSE);
 }
 
+EXPORT ER hal_sci_i2c_write_regs16(ID dd, UW sadr, UW radr, CONST UB *buf, SZ len)
+{
+	return hal_sci_i2c_access_regs(dd, sadr, radr, 2, (UB*)buf, len, TRUE);
+}
 
 #endif		/* DEVCNF_USE_HAL_SCI_IIC */
 #endif		/* MTKBSP_RAFSP */
\ No newline at end of file
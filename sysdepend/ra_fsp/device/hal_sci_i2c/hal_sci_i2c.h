@@ -27,7 +27,7 @@
  */
 #define TDN_HAL_I2C_MODE	(-100)	// I2C Mode
 #define TDN_HAL_I2C_TADR	(-101)	// Target Address
-#define TDN_HAL_I2C_MAX		(-101)
+#define TDN_HAL_I2C_MAX		(-102)	// (TDN_HAL_I2C_EXEC is defined in device.h)
 
 #define HAL_I2C_MODE_CNT	(0)	// I2C Mode: Controller mode	
 #define HAL_I2C_MODE_TAR	(1)	// I2C Mode: Target mode
@@ -43,5 +43,9 @@ IMPORT ER dev_init_hal_sci_i2c( UW unit, i2c_master_ctrl_t *hi2c, const i2c_mast
  */
 EXPORT ER hal_sci_i2c_read_reg(ID dd, UW sadr, UW radr, UB *data);
 EXPORT ER hal_sci_i2c_write_reg(ID dd, UW sadr, UW radr, UB data);
+EXPORT ER hal_sci_i2c_read_regs(ID dd, UW sadr, UW radr, UB *buf, SZ len);
+EXPORT ER hal_sci_i2c_write_regs(ID dd, UW sadr, UW radr, CONST UB *buf, SZ len);
+EXPORT ER hal_sci_i2c_read_regs16(ID dd, UW sadr, UW radr, UB *buf, SZ len);		// 16-bit register address
+EXPORT ER hal_sci_i2c_write_regs16(ID dd, UW sadr, UW radr, CONST UB *buf, SZ len);	// 16-bit register address
 
 #endif	/* _DEV_HAL_SCI_I2C_H_ */
\ No newline at end of file
@@ -42,6 +42,11 @@ EXPORT ER knl_start_device( void )
 {
 	ER	err	= E_OK;
 
+#if USE_DEFWORK
+	err = InitDeferredWork();
+	if(err < E_OK) return err;
+#endif
+
 #if DEVCNF_USE_HAL_IIC
 	err = dev_init_hal_i2c(0, &g_i2c_master0_ctrl, &g_i2c_master0_cfg);
 	if(err < E_OK) return err;
@@ -0,0 +1,154 @@
+/*
+ *----------------------------------------------------------------------
+ *    micro T-Kernel 3.0 BSP 2.0
+ *
+ *    Copyright (C) 2023-2024 by Ken Sakamura.
+ *    This software is distributed under the T-License 2.1.
+ *----------------------------------------------------------------------
+ *
+ *    Released by TRON Forum(http://www.tron.org) at 2024/08.
+ *
+ *----------------------------------------------------------------------
+ */
+
+#include <sys/machine.h>
+#if defined(MTKBSP_STM32CUBE) && defined(MTKBSP_CPU_CORE_ARMV7M)
+/*
+ *	int_stat.c (ARMv7-M)
+ *	Interrupt statistics (Latency & Duration histogram)
+ */
+
+#include <tk/tkernel.h>
+#include <tm/tmonitor.h>
+#include <kernel.h>
+#include "sysdepend.h"
+#include "int_stat.h"
+
+#if USE_INTSTAT
+
+LOCAL T_RINTSTAT	intstat_tbl[INTSTAT_INTVEC];	// Statistics table
+LOCAL UW		intstat_pend[INTSTAT_INTVEC];	// Pending time (0: Not marked)
+
+/*
+ * Count up the histogram bucket
+ *	Bucket n : 2^(n-1) <= val < 2^n   (Bucket 0 : val = 0)
+ */
+LOCAL void intstat_count( UH *bkt, UW val )
+{
+	INT	n;
+
+	n = (val == 0)? 0: (32 - __builtin_clz(val));
+	if(n >= INTSTAT_NBKT) n = INTSTAT_NBKT - 1;
+	if(bkt[n] < 0xFFFF) bkt[n]++;
+}
+
+/*
+ * Record the interrupt statistics (Called from the interrupt handler)
+ *	stime : Cycle counter at the start of the handler
+ *	etime : Cycle counter at the end of the handler
+ */
+EXPORT void knl_intstat_record( UINT intno, UW stime, UW etime )
+{
+	T_RINTSTAT	*p_stat;
+	UW		lat, dur;
+
+	if(intno >= INTSTAT_INTVEC) return;
+	p_stat = &intstat_tbl[intno];
+
+	p_stat->count++;
+
+	dur = etime - stime;
+	if(dur > p_stat->maxdur) p_stat->maxdur = dur;
+	intstat_count(p_stat->dur, dur);
+
+	if(intstat_pend[intno] != 0) {		// Pending time is marked
+		lat = stime - intstat_pend[intno];
+		intstat_pend[intno] = 0;
+		if(lat > p_stat->maxlat) p_stat->maxlat = lat;
+		intstat_count(p_stat->lat, lat);
+	}
+}
+
+/*
+ * Initialize the interrupt statistics (Enable DWT cycle counter)
+ */
+EXPORT void knl_init_intstat( void )
+{
+	*(_UW*)SCB_DEMCR |= DEMCR_TRCENA;
+	*(_UW*)DWT_LAR = DWT_LAR_UNLOCK;
+	*(_UW*)DWT_CYCCNT = 0;
+	*(_UW*)DWT_CTRL |= DWT_CTRL_CYCCNTENA;
+}
+
+/* ------------------------------------------------------------------------ */
+/*
+ * Interrupt statistics API
+ */
+
+/*
+ * Mark the interrupt pending time
+ *	The NVIC does not record the time when the interrupt becomes pending.
+ *	The latency is measured only for the interrupt whose request time is
+ *	marked by this function (e.g. just before the software trigger).
+ */
+EXPORT void MarkIntPending( UINT intno )
+{
+	if(intno < INTSTAT_INTVEC) {
+		intstat_pend[intno] = knl_intstat_cycle() | 1;	// 0 means "Not marked"
+	}
+}
+
+EXPORT ER GetIntStat( UINT intno, T_RINTSTAT *pk_rintstat )
+{
+	UINT	imask;
+
+	if(intno >= INTSTAT_INTVEC || pk_rintstat == NULL) return E_PAR;
+
+	DI(imask);
+	*pk_rintstat = intstat_tbl[intno];
+	EI(imask);
+
+	return E_OK;
+}
+
+EXPORT ER ClearIntStat( UINT intno )
+{
+	UINT	imask;
+
+	if(intno >= INTSTAT_INTVEC) return E_PAR;
+
+	DI(imask);
+	knl_memset(&intstat_tbl[intno], 0, sizeof(T_RINTSTAT));
+	intstat_pend[intno] = 0;
+	EI(imask);
+
+	return E_OK;
+}
+
+/*
+ * Print the interrupt statistics to T-Monitor console
+ */
+EXPORT void PrintIntStat( void )
+{
+#if USE_TMONITOR
+	T_RINTSTAT	stat;
+	UINT		intno;
+	INT		i;
+
+	tm_printf((UB*)"INTNO      COUNT     MAXLAT     MAXDUR\n");
+	for(intno = 0; intno < INTSTAT_INTVEC; intno++) {
+		GetIntStat(intno, &stat);
+		if(stat.count == 0) continue;
+
+		tm_printf((UB*)"%5d %10d %10d %10d\n", intno, stat.count, stat.maxlat, stat.maxdur);
+		tm_printf((UB*)"  LAT:");
+		for(i = 0; i < INTSTAT_NBKT; i++) tm_printf((UB*)" %d", stat.lat[i]);
+		tm_printf((UB*)"\n  DUR:");
+		for(i = 0; i < INTSTAT_NBKT; i++) tm_printf((UB*)" %d", stat.dur[i]);
+		tm_printf((UB*)"\n");
+	}
+#endif	/* USE_TMONITOR */
+}
+
+#endif	/* USE_INTSTAT */
+#endif	/* defined(MTKBSP_STM32CUBE) && defined(MTKBSP_CPU_CORE_ARMV7M) */
@@ -0,0 +1,36 @@
+/*
+ *----------------------------------------------------------------------
+ *    micro T-Kernel 3.0 BSP 2.0
+ *
+ *    Copyright (C) 2023-2024 by Ken Sakamura.
+ *    This software is distributed under the T-License 2.1.
+ *----------------------------------------------------------------------
+ *
+ *    Released by TRON Forum(http://www.tron.org) at 2024/08.
+ *
+ *----------------------------------------------------------------------
+ */
+
+/*
+ *	int_stat.h (ARMv7-M)
+ *	Interrupt statistics (Latency & Duration histogram)
+ */
+
+#ifndef _MTKBSP_SYSDEPEND_CPU_CORE_INTSTAT_
+#define _MTKBSP_SYSDEPEND_CPU_CORE_INTSTAT_
+
+#if USE_INTSTAT
+
+IMPORT void knl_init_intstat( void );
+IMPORT void knl_intstat_record( UINT intno, UW stime, UW etime );
+
+/*
+ * Get CPU cycle counter (DWT)
+ */
+Inline UW knl_intstat_cycle( void )
+{
+	return *(_UW*)DWT_CYCCNT;
+}
+
+#endif	/* USE_INTSTAT */
+#endif	/* _MTKBSP_SYSDEPEND_CPU_CORE_INTSTAT_ */
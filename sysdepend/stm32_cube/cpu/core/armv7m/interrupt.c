@@ -22,6 +22,7 @@
 #include <kernel.h>
 #include "sysdepend.h"
 #include "cpu_status.h"
+#include "int_stat.h"
 
 /* HLL Interrupt Handler Table */
 LOCAL UW hllint_tbl[N_INTVEC];
@@ -34,13 +35,22 @@ EXPORT void knl_hll_inthdr(void)
 {
 	FP	inthdr;
 	UW	intno;
+#if USE_INTSTAT
+	UW	stime;
+#endif
 
 	ENTER_TASK_INDEPENDENT;
 
 	intno	= knl_get_ipsr() - 16;
 	inthdr	= (FP)hllint_tbl[intno];
 
+#if USE_INTSTAT
+	stime = knl_intstat_cycle();
 	(*inthdr)(intno);
+	knl_intstat_record(intno, stime, knl_intstat_cycle());
+#else
+	(*inthdr)(intno);
+#endif
 
 	LEAVE_TASK_INDEPENDENT;
 }
@@ -58,6 +68,50 @@ EXPORT void knl_systim_inthdr(void)
 	LEAVE_TASK_INDEPENDENT;
 }
 
+#if USE_STATIC_IVT
+/* ----------------------------------------------------------------------- */
+/*
+ * Undefined interrupt handler (Static interrupt vector table)
+ */
+LOCAL void knl_undef_inthdr( UINT intno )
+{
+	DisableInt(intno);
+}
+
+/*
+ * Original interrupt handler (Static interrupt vector table)
+ *	The handler in the vector table of the startup code (e.g. the handlers
+ *	of stm32xxxx_it.c generated by STM32CubeMX) is called by the HLL
+ *	interrupt handler, while the kernel does not define the handler.
+ */
+LOCAL UW knl_org_inthdr( INT intno )
+{
+	UW	inthdr;
+
+	inthdr = knl_exctbl_o[N_SYSVEC + intno];
+	return (inthdr != 0)? inthdr: (UW)knl_undef_inthdr;
+}
+
+/* ----------------------------------------------------------------------- */
+/*
+ * Set interrupt handler (Used in tk_def_int())
+ *	The vector table is fixed. Only the HLL interrupt handler can be set.
+ */
+EXPORT ER knl_define_inthdr( INT intno, ATR intatr, FP inthdr )
+{
+	if(inthdr != NULL) {
+		if ( (intatr & TA_HLNG) == 0 ) {
+			return E_NOSPT;
+		}
+		hllint_tbl[intno] = (UW)inthdr;
+	} else 	{	/* Clear interrupt handler */
+		hllint_tbl[intno] = knl_org_inthdr(intno);
+	}
+
+	return E_OK;
+}
+
+#else
 /* ----------------------------------------------------------------------- */
 /*
  * Set interrupt handler (Used in tk_def_int())
@@ -79,6 +133,48 @@ EXPORT ER knl_define_inthdr( INT intno, ATR intatr, FP inthdr )
 
 	return E_OK;
 }
+#endif	/* USE_STATIC_IVT */
+
+/* ----------------------------------------------------------------------- */
+/*
+ * Define fast interrupt handler
+ *	The handler is set directly in the exception vector table and is
+ *	executed without the kernel processing (ENTER/LEAVE_TASK_INDEPENDENT).
+ *	The interrupt priority must be higher than INTPRI_MAX_EXTINT_PRI,
+ *	so the handler is not masked by the kernel and can not call any
+ *	kernel API.
+ *	With the static vector table, the handler must be registered in
+ *	STATIC_IVT_FASTINT at compile time.
+ */
+EXPORT ER DefineFastInt( UINT intno, FP inthdr, INT level )
+{
+#if !USE_STATIC_IVT
+	UINT	imask;
+#endif
+
+	if( intno >= N_INTVEC ) return E_PAR;
+
+	if( inthdr == NULL ) {		/* Clear fast interrupt handler */
+		DisableInt(intno);
+#if !USE_STATIC_IVT
+		knl_exctbl[N_SYSVEC + intno] = knl_exctbl_o[N_SYSVEC + intno];
+#endif
+		return E_OK;
+	}
+
+	if( level < 0 || level >= INTPRI_MAX_EXTINT_PRI ) return E_PAR;
+
+#if USE_STATIC_IVT
+	if( knl_exctbl[N_SYSVEC + intno] != (UW)inthdr ) return E_NOSPT;
+#else
+	DI(imask);
+	knl_exctbl[N_SYSVEC + intno] = (UW)inthdr;
+	EI(imask);
+#endif
+	EnableInt(intno, level);
+
+	return E_OK;
+}
 
 /* ----------------------------------------------------------------------- */
 /*
@@ -96,9 +192,21 @@ EXPORT void knl_return_inthdr(void)
  */
 EXPORT ER knl_init_interrupt( void )
 {
+#if USE_INTSTAT
+	knl_init_intstat();
+#endif
+#if USE_STATIC_IVT
+	INT	i;
+
+	/* Exception handlers are set in the static vector table */
+	for(i = 0; i < N_INTVEC; i++) {
+		hllint_tbl[i] = knl_org_inthdr(i);
+	}
+#else
 	/* Set Exception handler */
 	knl_exctbl[14]	= (UW)knl_dispatch_entry;
 	knl_exctbl[15]	= (UW)knl_systim_inthdr;
+#endif
 
 	return E_OK;
 }
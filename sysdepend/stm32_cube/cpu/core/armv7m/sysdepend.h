@@ -24,20 +24,47 @@
  */
 IMPORT void knl_dispatch_entry(void);		/* dispatch entry */
 IMPORT void knl_dispatch_to_schedtsk(void);	/* force dispatch */
+#if USE_LAZYFPU
+IMPORT void knl_fpu_nocp_hdr(void);		/* FPU access exception handler */
+#endif
 
 /*
  * Interrupt Control (interrupt.c)
  */
+#if USE_STATIC_IVT
+IMPORT const UW knl_exctbl[];	/* Exception handler table (ROM) */
+#else
 IMPORT UW knl_exctbl[];		/* Exception handler table (RAM) */
+#endif
 IMPORT UW *knl_exctbl_o;		// Exception handler table (Origin)
+IMPORT void knl_hll_inthdr(void);	/* HLL Interrupt Handler */
 IMPORT void knl_systim_inthdr(void);	/* System-timer Interrupt handler */
 
+#if USE_STATIC_IVT
+/*
+ * Exception handler (STM32Cube startup & stm32xxxx_it.c)
+ */
+IMPORT void Reset_Handler(void);		/* Reset Handler */
+IMPORT void NMI_Handler(void);			/* NMI Handler */
+IMPORT void HardFault_Handler(void);		/* Hard Fault Handler */
+IMPORT void MemManage_Handler(void);		/* MPU Fault Handler */
+IMPORT void BusFault_Handler(void);		/* Bus Fault Handler */
+IMPORT void UsageFault_Handler(void);		/* Usage Fault Handler */
+IMPORT void SVC_Handler(void);			/* SVCall Handler */
+IMPORT void DebugMon_Handler(void);		/* Debug Monitor Handler */
+#endif
+
 
 /*
  * Task context block
  */
 typedef struct {
 	void	*ssp;		/* System stack pointer */
+
+#if USE_SPMON
+	void	*spsa;		/* Stack stat address */
+	void	*spea;		/* Stack end address */
+#endif
 } CTXB;
 
 /*
@@ -0,0 +1,123 @@
+/*
+ *----------------------------------------------------------------------
+ *    micro T-Kernel 3.0 BSP 2.0
+ *
+ *    Copyright (C) 2023-2024 by Ken Sakamura.
+ *    This software is distributed under the T-License 2.1.
+ *----------------------------------------------------------------------
+ *
+ *    Released by TRON Forum(http://www.tron.org) at 2024/08.
+ *
+ *----------------------------------------------------------------------
+ */
+
+#include <sys/machine.h>
+#if defined(MTKBSP_STM32CUBE) && defined(MTKBSP_CPU_CORE_ARMV7M)
+
+/*
+ *	vector_tbl.c (STM32Cube & ARMv7-M)
+ *	Exception/Interrupt Vector Table (Static)
+ */
+#include <tk/tkernel.h>
+#include <kernel.h>
+#include "sysdepend.h"
+
+#if USE_STATIC_IVT
+
+IMPORT UW	_estack;		// Top of stack (Linker script)
+
+/* Fast interrupt handler declaration */
+#define FASTINT_VECTOR(intno, hdr)	IMPORT void hdr(void);
+STATIC_IVT_FASTINT
+#undef FASTINT_VECTOR
+
+/*
+ * Interrupt vector
+ *	The vector of interrupt 'i' is selected from STATIC_IVT_FASTINT (Up to
+ *	FASTINT_MAX handlers) by the constant expression, so the table has no
+ *	overlapping initializers. IVT_En(i) lists the vectors of i to i+n-1.
+ */
+#define FASTINT_MAX	8
+#define FASTINT_VECTOR(intno, hdr)	, (intno), (UW)hdr
+#define IVT_PAD		, -1, 0, -1, 0, -1, 0, -1, 0, -1, 0, -1, 0, -1, 0, -1, 0, -1, 0
+
+#define IVT_SEL(...)	IVT_SEL_(__VA_ARGS__)
+#define IVT_SEL_(i, n1, h1, n2, h2, n3, h3, n4, h4, n5, h5, n6, h6, n7, h7, n8, h8, ...) \
+	((i) == (n1))? h1: ((i) == (n2))? h2: ((i) == (n3))? h3: ((i) == (n4))? h4: \
+	((i) == (n5))? h5: ((i) == (n6))? h6: ((i) == (n7))? h7: ((i) == (n8))? h8: \
+	(UW)knl_hll_inthdr,
+
+#define IVT_N9(...)	IVT_N9_(__VA_ARGS__)
+#define IVT_N9_(i, n1, h1, n2, h2, n3, h3, n4, h4, n5, h5, n6, h6, n7, h7, n8, h8, n9, ...)	(n9)
+#if IVT_N9(0 STATIC_IVT_FASTINT IVT_PAD) >= 0
+#error "STATIC_IVT_FASTINT can list up to FASTINT_MAX handlers."
+#endif
+#if N_INTVEC > 255
+#error "N_INTVEC must be 255 or less."
+#endif
+
+#define IVT_E1(i)	IVT_SEL((i) STATIC_IVT_FASTINT IVT_PAD)
+#define IVT_E2(i)	IVT_E1(i) IVT_E1((i) + 1)
+#define IVT_E4(i)	IVT_E2(i) IVT_E2((i) + 2)
+#define IVT_E8(i)	IVT_E4(i) IVT_E4((i) + 4)
+#define IVT_E16(i)	IVT_E8(i) IVT_E8((i) + 8)
+#define IVT_E32(i)	IVT_E16(i) IVT_E16((i) + 16)
+#define IVT_E64(i)	IVT_E32(i) IVT_E32((i) + 32)
+#define IVT_E128(i)	IVT_E64(i) IVT_E64((i) + 64)
+
+/*
+ * Exception handler table (ROM)
+ *	All interrupts are executed by the HLL interrupt handler, except the
+ *	fast interrupts listed in STATIC_IVT_FASTINT. The HLL interrupt
+ *	handler calls the handler of the startup vector table (knl_exctbl_o)
+ *	for the interrupts not defined by tk_def_int().
+ */
+EXPORT const UW knl_exctbl[N_SYSVEC + N_INTVEC] __attribute__ ((aligned(EXCTBL_ALIGN))) = {
+	(UW)&_estack,			// 0: Top of stack
+	(UW)Reset_Handler,		// 1: Reset
+	(UW)NMI_Handler,		// 2: NMI
+	(UW)HardFault_Handler,		// 3: Hard Fault
+	(UW)MemManage_Handler,		// 4: MPU Fault
+	(UW)BusFault_Handler,		// 5: Bus Fault
+#if USE_LAZYFPU
+	(UW)knl_fpu_nocp_hdr,		// 6: Usage Fault (FPU access)
+#else
+	(UW)UsageFault_Handler,		// 6: Usage Fault
+#endif
+	0,				// 7: (Reserved)
+	0,				// 8: (Reserved)
+	0,				// 9: (Reserved)
+	0,				// 10: (Reserved)
+	(UW)SVC_Handler,		// 11: SVCall
+	(UW)DebugMon_Handler,		// 12: Debug Monitor
+	0,				// 13: (Reserved)
+	(UW)knl_dispatch_entry,		// 14: PendSV (Dispatcher)
+	(UW)knl_systim_inthdr,		// 15: SysTick (System timer)
+#if N_INTVEC & 128				// 16-: Interrupts
+	IVT_E128(0)
+#endif
+#if N_INTVEC & 64
+	IVT_E64(N_INTVEC & 128)
+#endif
+#if N_INTVEC & 32
+	IVT_E32(N_INTVEC & 192)
+#endif
+#if N_INTVEC & 16
+	IVT_E16(N_INTVEC & 224)
+#endif
+#if N_INTVEC & 8
+	IVT_E8(N_INTVEC & 240)
+#endif
+#if N_INTVEC & 4
+	IVT_E4(N_INTVEC & 248)
+#endif
+#if N_INTVEC & 2
+	IVT_E2(N_INTVEC & 252)
+#endif
+#if N_INTVEC & 1
+	IVT_E1(N_INTVEC & 254)
+#endif
+};
+
+#endif	/* USE_STATIC_IVT */
+#endif	/* defined(MTKBSP_STM32CUBE) && defined(MTKBSP_CPU_CORE_ARMV7M) */
@@ -35,6 +35,22 @@
 
 #include <config_bsp/stm32_cube/config_bsp.h>
 
+/*----------------------------------------------------------------------
+ * I2C write-then-read (Common to the I2C device drivers)
+ *	Write T_HAL_I2C_EXEC to the attribute data TDN_HAL_I2C_EXEC.
+ *	The send data and the receive data are transferred in one transaction
+ *	with repeated start.
+ */
+#define TDN_HAL_I2C_EXEC	(-102)
+
+typedef struct {
+	UW	sadr;		// Target address
+	SZ	snd_size;	// Send data size
+	UB	*snd_data;	// Send data
+	SZ	rcv_size;	// Receive data size
+	UB	*rcv_data;	// Receive data buffer
+} T_HAL_I2C_EXEC;
+
 #if DEVCNF_USE_HAL_IIC
 #include <sysdepend/stm32_cube/device/hal_i2c/hal_i2c.h>
 #endif
@@ -42,16 +42,36 @@ typedef struct {
 	ID			tskid;		// Wait Task ID
 	ER			err;		// Error code that occurred during interrupt processing
 	ID			evtmbfid;	// MBF ID for event notification
+	ID			flgid;		// Interrupt detection flag
 
 	UW			val;		// A/DC converted data
+	W			curch;		// Channel configured in the A/DC (-1: Not configured)
+	W			winch;		// Channel of the window event (-1: Not armed)
+
+	/* Scan sequence by the DMA (Scan read or streaming) */
+	CONST UB		*seqch;		// Channels in the scan order
+	INT			seqnch;		// Number of channels (0: Not scanning)
+	UH			*seqbuf;	// DMA buffer
+	SZ			seqsz;		// Number of samples of the DMA buffer
+
+	/* Streaming mode */
+	BOOL			stream;		// Streaming in progress
+	T_HAL_ADC_STREAM	strm;		// Streaming mode setting
+	ADC_InitTypeDef		init;		// A/DC initial setting (Restored at the end of streaming)
+	UW			wseq;		// Number of completed blocks
+	UW			rseq;		// Sequence number of the next block to read
+	SYSTIM			btime[2];	// Completion time of each half of the ring buffer
+	UW			lost;		// Number of lost blocks
+	UW			ovrcnt;		// Number of A/DC errors during streaming
 } T_HAL_ADC_DCB;
 
-/* Interrupt detection flag */
-LOCAL ID	id_flgid;
+/* Interrupt detection flag (Created for each unit) */
 LOCAL T_CFLG	id_flg	= {
 			.flgatr		= TA_TFIFO | TA_WMUL,
 			.iflgptn	= 0,
 };
+#define FLGPTN_DONE	(1<<0)		// Interrupt processing completed
+#define FLGPTN_BLK	(1<<1)		// Streaming block completed
 
 #if TK_SUPPORT_MEMLIB
 LOCAL T_HAL_ADC_DCB	*dev_adc_cb[DEV_HAL_ADC_UNITNM];
@@ -61,19 +81,250 @@ LOCAL T_HAL_ADC_DCB	dev_adc_cb[DEV_HAL_ADC_UNITNM];
 #define		get_dcb_ptr(unit)	(&dev_ADC_cb[unit])
 #endif
 
+/* DCB of each A/DC instance (Indexed by the instance number for HAL callbacks) */
+#define ADC_INSNM	(6)		// ADC1 - ADC5 (0: Unknown instance)
+LOCAL T_HAL_ADC_DCB	*dev_adc_ins[ADC_INSNM];
+
+/* A/DC instance number (ADCn: n, 0: Unknown) */
+LOCAL INT adc_insno(ADC_TypeDef *ins)
+{
+	switch((uintptr_t)ins) {
+#ifdef ADC1_BASE
+	case ADC1_BASE:	return 1;
+#endif
+#ifdef ADC2_BASE
+	case ADC2_BASE:	return 2;
+#endif
+#ifdef ADC3_BASE
+	case ADC3_BASE:	return 3;
+#endif
+#ifdef ADC4_BASE
+	case ADC4_BASE:	return 4;
+#endif
+#ifdef ADC5_BASE
+	case ADC5_BASE:	return 5;
+#endif
+	default:	return 0;
+	}
+}
+
+#define get_hdl_dcb(hdl)	(dev_adc_ins[adc_insno((hdl)->Instance)])
+
+IMPORT ER dev_adc_initch(UW unit);
+IMPORT ER dev_adc_setsmp(UW unit, W ch, UW smptime);
+IMPORT ER dev_adc_getsmp(UW unit, W ch, UW *smptime);
+IMPORT ER dev_adc_setovs(UW unit, W ch, UW ratio, UW shift);
+IMPORT ER dev_adc_getovs(UW unit, W ch, UW *ratio, UW *shift);
 IMPORT ER dev_adc_setch(ADC_HandleTypeDef *hadc, UW unit, W start);
+IMPORT ER dev_adc_setwdg(ADC_HandleTypeDef *hadc, W ch, BOOL enable, UW lo, UW hi);
+IMPORT ER dev_adc_setscan(ADC_HandleTypeDef *hadc, UW unit, CONST UB *ch, INT nch);
+
+/*---------------------------------------------------------------------*/
+/* Streaming mode
+ *	The channels are converted by the scan sequence, and the circular DMA
+ *	transfers the data to the ring buffer. Each half of the ring buffer is
+ *	one block, completed by the half and full transfer interrupts.
+ *	The conversion trigger (e.g. Timer) and the DMA (Circular, Half word)
+ *	are configured by STM32CubeMX. The application starts the trigger timer.
+ */
+/* DMA buffer for the scan read (Aligned to the cache line) */
+LOCAL UH	adc_scanbuf[DEV_HAL_ADC_UNITNM][HAL_ADC_STREAM_MAXCH] DCACHE_ALIGNED;
+
+LOCAL void set_seq(T_HAL_ADC_DCB *p_dcb, CONST UB *ch, INT nch, UH *buf, SZ sz)
+{
+	p_dcb->seqch	= ch;
+	p_dcb->seqbuf	= buf;
+	p_dcb->seqsz	= sz;
+	p_dcb->seqnch	= nch;
+}
+
+LOCAL void stream_intr(T_HAL_ADC_DCB *p_dcb, INT half)
+{
+	tk_get_otm(&p_dcb->btime[half]);
+	p_dcb->wseq++;
+	tk_set_flg(p_dcb->flgid, FLGPTN_BLK);
+}
+
+LOCAL ER stop_stream(T_HAL_ADC_DCB *p_dcb)
+{
+	if(!p_dcb->stream) return E_OK;
+
+	HAL_ADC_Stop_DMA(p_dcb->hadc);
+	p_dcb->stream = FALSE;
+	p_dcb->seqnch = 0;
+	tk_set_flg(p_dcb->flgid, FLGPTN_BLK);		// Release the waiting task
+
+	p_dcb->hadc->Init = p_dcb->init;
+	return (HAL_ADC_Init(p_dcb->hadc) == HAL_OK)? E_OK: E_IO;
+}
+
+LOCAL ER start_stream(T_HAL_ADC_DCB *p_dcb, CONST T_HAL_ADC_STREAM *strm)
+{
+	ER	err;
+
+	if(strm->nch <= 0 || strm->nch > HAL_ADC_STREAM_MAXCH || strm->buf == NULL
+			|| strm->blksz <= 0 || (strm->blksz % strm->nch) != 0) return E_PAR;
+#if defined(__DCACHE_PRESENT) && __DCACHE_PRESENT
+	/* The blocks are invalidated while the DMA writes the other block */
+	if(((UW)strm->buf % DCACHE_LINE_SIZE) != 0
+			|| ((strm->blksz * sizeof(UH)) % DCACHE_LINE_SIZE) != 0) return E_PAR;
+#endif
+	if(p_dcb->hadc->DMA_Handle == NULL) return E_NOSPT;	// DMA is not linked by STM32CubeMX
+	if(p_dcb->stream) return E_BUSY;
+
+	p_dcb->init = p_dcb->hadc->Init;
+	HAL_ADC_Stop(p_dcb->hadc);
+	p_dcb->curch = -1;
+	err = dev_adc_setscan(p_dcb->hadc, p_dcb->unit, strm->ch, strm->nch);
+	if(err < E_OK) goto err_1;
+
+	p_dcb->strm	= *strm;
+	p_dcb->wseq	= 0;
+	p_dcb->rseq	= 0;
+	p_dcb->lost	= 0;
+	p_dcb->ovrcnt	= 0;
+	tk_clr_flg(p_dcb->flgid, ~FLGPTN_BLK);
+
+	p_dcb->stream	= TRUE;
+	set_seq(p_dcb, p_dcb->strm.ch, strm->nch, strm->buf, strm->blksz * 2);
+	if(HAL_ADC_Start_DMA(p_dcb->hadc, (uint32_t*)strm->buf, (uint32_t)(strm->blksz * 2)) != HAL_OK) {
+		p_dcb->stream = FALSE;
+		p_dcb->seqnch = 0;
+		err = E_IO;
+		goto err_1;
+	}
+	return E_OK;
+
+err_1:
+	p_dcb->hadc->Init = p_dcb->init;
+	HAL_ADC_Init(p_dcb->hadc);
+	return err;
+}
+
+/* Read the oldest block not yet read
+ *	If the DMA overwrites the block before it is read, the block is lost.
+ */
+LOCAL ER read_stream(T_HAL_ADC_DCB *p_dcb, T_DEVREQ *req)
+{
+	T_HAL_ADC_BLK	*blk;
+	UH		*src;
+	UW		seq;
+	SZ		blksz;
+	UINT		rflgptn, imask;
+	ER		err;
+
+	req->asize = sizeof(T_HAL_ADC_BLK);
+	if(req->size == 0) return E_OK;
+	else if(req->size != sizeof(T_HAL_ADC_BLK)) return E_PAR;
+
+	if(!p_dcb->stream) return E_OBJ;
+	blk = (T_HAL_ADC_BLK*)req->buf;
+	blksz = p_dcb->strm.blksz;
+	if(blk->smp == NULL || blk->nsmp < blksz) return E_PAR;
+
+	while(1) {
+		DI(imask);
+		if(p_dcb->wseq - p_dcb->rseq > 1) {		// Overwritten
+			p_dcb->lost += p_dcb->wseq - p_dcb->rseq - 1;
+			p_dcb->rseq = p_dcb->wseq - 1;
+		}
+		seq = p_dcb->rseq;
+		EI(imask);
+
+		if(p_dcb->wseq != seq) {			// Block completed
+			src = p_dcb->strm.buf + (seq & 1) * blksz;
+			blk->time = p_dcb->btime[seq & 1];
+			DCacheInvalidate(src, blksz * sizeof(UH));
+			knl_memcpy(blk->smp, src, blksz * sizeof(UH));
+
+			DI(imask);
+			p_dcb->rseq = seq + 1;
+			if(p_dcb->wseq - seq > 1) {		// Overwritten while copying
+				p_dcb->lost++;
+				EI(imask);
+				continue;
+			}
+			blk->nsmp	= blksz;
+			blk->seqno	= seq;
+			blk->lost	= p_dcb->lost;
+			blk->ovrcnt	= p_dcb->ovrcnt;
+			EI(imask);
+			return E_OK;
+		}
+
+		err = tk_wai_flg(p_dcb->flgid, FLGPTN_BLK, TWF_ORW | TWF_BITCLR, &rflgptn, DEV_HAL_ADC_TMOUT);
+		if(err < E_OK) return err;
+		if(!p_dcb->stream) return E_OBJ;		// Stopped
+	}
+}
 
 /*---------------------------------------------------------------------*/
 /* Attribute data control
  */
 LOCAL ER read_atr(T_HAL_ADC_DCB *p_dcb, T_DEVREQ *req)
 {
-	return E_PAR;
+	T_HAL_ADC_SMPTIME	*smp;
+	T_HAL_ADC_OVS		*ovs;
+	ER			err;
+
+	switch(req->start) {
+	case TDN_HAL_ADC_STREAM:
+		return read_stream(p_dcb, req);
+	case TDN_HAL_ADC_SMPTIME:
+		if(req->size != sizeof(T_HAL_ADC_SMPTIME)) return E_PAR;
+		smp = (T_HAL_ADC_SMPTIME*)req->buf;
+		err = dev_adc_getsmp(p_dcb->unit, smp->ch, &smp->smptime);
+		break;
+	case TDN_HAL_ADC_OVS:
+		if(req->size != sizeof(T_HAL_ADC_OVS)) return E_PAR;
+		ovs = (T_HAL_ADC_OVS*)req->buf;
+		err = dev_adc_getovs(p_dcb->unit, ovs->ch, &ovs->ratio, &ovs->shift);
+		break;
+	default:
+		return E_PAR;
+	}
+	if(err >= E_OK) req->asize = req->size;
+	return err;
 }
 
 LOCAL ER write_atr(T_HAL_ADC_DCB *p_dcb, T_DEVREQ *req)
 {
-	return E_PAR;
+	T_HAL_ADC_STREAM	*strm;
+	T_HAL_ADC_SMPTIME	*smp;
+	T_HAL_ADC_OVS		*ovs;
+	T_HAL_ADC_WINDOW	*win;
+	ER			err;
+
+	switch(req->start) {
+	case TDN_HAL_ADC_STREAM:
+		if(req->size != sizeof(T_HAL_ADC_STREAM)) return E_PAR;
+		strm = (T_HAL_ADC_STREAM*)req->buf;
+		err = (strm->nch == 0)? stop_stream(p_dcb): start_stream(p_dcb, strm);
+		break;
+	case TDN_HAL_ADC_SMPTIME:
+		if(req->size != sizeof(T_HAL_ADC_SMPTIME)) return E_PAR;
+		smp = (T_HAL_ADC_SMPTIME*)req->buf;
+		err = dev_adc_setsmp(p_dcb->unit, smp->ch, smp->smptime);
+		if(err >= E_OK && p_dcb->curch == (W)smp->ch) p_dcb->curch = -1;	// Reconfigure at the next read
+		break;
+	case TDN_HAL_ADC_OVS:
+		if(req->size != sizeof(T_HAL_ADC_OVS)) return E_PAR;
+		ovs = (T_HAL_ADC_OVS*)req->buf;
+		err = dev_adc_setovs(p_dcb->unit, ovs->ch, ovs->ratio, ovs->shift);
+		if(err >= E_OK && p_dcb->curch == (W)ovs->ch) p_dcb->curch = -1;
+		break;
+	case TDN_HAL_ADC_WINDOW:
+		if(req->size != sizeof(T_HAL_ADC_WINDOW)) return E_PAR;
+		win = (T_HAL_ADC_WINDOW*)req->buf;
+		p_dcb->winch = win->enable? (W)win->ch: -1;
+		err = dev_adc_setwdg(p_dcb->hadc, win->ch, win->enable, win->lo, win->hi);
+		if(err < E_OK) p_dcb->winch = -1;
+		break;
+	default:
+		return E_PAR;
+	}
+	if(err >= E_OK) req->asize = req->size;
+	return err;
 }
 
 /*---------------------------------------------------------------------*/
@@ -84,51 +335,196 @@ LOCAL ER write_atr(T_HAL_ADC_DCB *p_dcb, T_DEVREQ *req)
 void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef *hadc)
 {
 	T_HAL_ADC_DCB	*p_dcb;
-	UINT	i;
 
 	ENTER_TASK_INDEPENDENT
 
-	for(i = 0; i < DEV_HAL_ADC_UNITNM; i++) {
-		p_dcb = get_dcb_ptr(i);
-		if(p_dcb->hadc == hadc) {
+	p_dcb = get_hdl_dcb(hadc);
+	if(p_dcb != NULL) {
+		if(p_dcb->stream) {
+			stream_intr(p_dcb, 1);
+		} else {
 			p_dcb->err = E_OK;
-			tk_set_flg(id_flgid, 1<< p_dcb->unit);
-			break;
+			tk_set_flg(p_dcb->flgid, FLGPTN_DONE);
 		}
 	}
 
 	LEAVE_TASK_INDEPENDENT
 }
 
-LOCAL ER read_data(T_HAL_ADC_DCB *p_dcb, T_DEVREQ *req)
+void HAL_ADC_ConvHalfCpltCallback(ADC_HandleTypeDef *hadc)
+{
+	T_HAL_ADC_DCB	*p_dcb;
+
+	ENTER_TASK_INDEPENDENT
+
+	p_dcb = get_hdl_dcb(hadc);
+	if(p_dcb != NULL && p_dcb->stream) stream_intr(p_dcb, 0);
+
+	LEAVE_TASK_INDEPENDENT
+}
+
+/* Conversion result of the window channel
+ *	In the scan sequence, HAL_ADC_GetValue() returns the last converted rank,
+ *	not the window channel. The latest result of the channel is read from
+ *	the DMA buffer at the position given by the DMA counter.
+ */
+LOCAL UW window_value(T_HAL_ADC_DCB *p_dcb)
+{
+	UH	*p;
+	SZ	pos;
+	INT	rank, nch;
+
+	nch = p_dcb->seqnch;
+	for(rank = 0; rank < nch && p_dcb->seqch[rank] != p_dcb->winch; rank++);
+	if(rank >= nch) return (UW)HAL_ADC_GetValue(p_dcb->hadc);	// Single channel
+
+	pos = p_dcb->seqsz - (SZ)__HAL_DMA_GET_COUNTER(p_dcb->hadc->DMA_Handle) - 1;	// Last written
+	pos -= ((pos - rank) % nch + nch) % nch;
+	if(pos < 0) pos += p_dcb->seqsz;		// Previous round of the ring buffer
+	p = &p_dcb->seqbuf[pos];
+	DCacheInvalidate((void*)((UW)p & ~(DCACHE_LINE_SIZE - 1)), DCACHE_LINE_SIZE);
+	return *p;
+}
+
+/* Analog watchdog 1 (Window event)
+ *	The event is notified once. The window is re-armed by TDN_HAL_ADC_WINDOW.
+ */
+void HAL_ADC_LevelOutOfWindowCallback(ADC_HandleTypeDef *hadc)
+{
+	T_HAL_ADC_DCB		*p_dcb;
+	T_HAL_ADC_WINEVT	evt;
+
+	ENTER_TASK_INDEPENDENT
+
+#if defined(ADC_IT_AWD1)
+	__HAL_ADC_DISABLE_IT(hadc, ADC_IT_AWD1);
+#else
+	__HAL_ADC_DISABLE_IT(hadc, ADC_IT_AWD);
+#endif
+	p_dcb = get_hdl_dcb(hadc);
+	if(p_dcb != NULL && p_dcb->winch >= 0) {
+		evt.devid	= p_dcb->devid;
+		evt.ch		= (UW)p_dcb->winch;
+		evt.val		= window_value(p_dcb);
+		tk_get_otm(&evt.time);
+		p_dcb->winch	= -1;
+		if(p_dcb->evtmbfid > 0) {
+			tk_snd_mbf(p_dcb->evtmbfid, &evt, sizeof(T_HAL_ADC_WINEVT), TMO_POL);
+		}
+	}
+
+	LEAVE_TASK_INDEPENDENT
+}
+
+void HAL_ADC_ErrorCallback(ADC_HandleTypeDef *hadc)
+{
+	T_HAL_ADC_DCB	*p_dcb;
+
+	ENTER_TASK_INDEPENDENT
+
+	p_dcb = get_hdl_dcb(hadc);
+	if(p_dcb != NULL && p_dcb->stream) p_dcb->ovrcnt++;
+
+	LEAVE_TASK_INDEPENDENT
+}
+
+/* Convert one channel */
+LOCAL ER read_ch(T_HAL_ADC_DCB *p_dcb, W ch, UW *val)
 {
-	uint32_t		value;
 	HAL_StatusTypeDef	hal_sts;
 	UINT			wflgptn, rflgptn;
 	ER			err;
 
-	if(req->size == 0) {
-		req->asize = 1;
-		return E_OK;
+	// Configure for A/DC (Skipped if the channel is already configured)
+	if(p_dcb->curch != ch) {
+		err = dev_adc_setch(p_dcb->hadc, p_dcb->unit, ch);
+		if(err != E_OK) return err;
+		p_dcb->curch = ch;
 	}
-	// Configure for A/DC
-	err = dev_adc_setch(p_dcb->hadc, p_dcb->unit, req->start);
-	if(err != E_OK) return err;
 
-	wflgptn = 1 << p_dcb->unit;
-	tk_clr_flg(id_flgid, ~wflgptn);
+	wflgptn = FLGPTN_DONE;
+	tk_clr_flg(p_dcb->flgid, ~wflgptn);
 	hal_sts = HAL_ADC_Start_IT(p_dcb->hadc);
 	if(hal_sts != HAL_OK) return E_BUSY;
 
-	err = tk_wai_flg(id_flgid, wflgptn, TWF_ANDW | TWF_BITCLR, &rflgptn, DEV_HAL_ADC_TMOUT);
+	err = tk_wai_flg(p_dcb->flgid, wflgptn, TWF_ANDW | TWF_BITCLR, &rflgptn, DEV_HAL_ADC_TMOUT);
 	if(err >= E_OK) {
 		err  = p_dcb->err;
-		if(err >= E_OK) {
-			value = HAL_ADC_GetValue(p_dcb->hadc);
-			*(UW*)(req->buf) = (UW)value;
-			req->asize= 1;
+		if(err >= E_OK) *val = (UW)HAL_ADC_GetValue(p_dcb->hadc);
+	}
+	return err;
+}
+
+/* Convert the contiguous channels by one scan sequence
+ *	The DMA (Half word) linked to the HAL handle transfers the data.
+ */
+LOCAL ER read_scan(T_HAL_ADC_DCB *p_dcb, W start, SZ size, UW *buf)
+{
+	ADC_InitTypeDef	init;
+	UH		*scanbuf;
+	UB		ch[HAL_ADC_STREAM_MAXCH];
+	UINT		rflgptn;
+	INT		i;
+	ER		err;
+
+	if(start + size > 0x100) return E_PAR;
+	for(i = 0; i < size; i++) ch[i] = (UB)(start + i);
+	scanbuf = adc_scanbuf[p_dcb->unit];
+
+	init = p_dcb->hadc->Init;
+	HAL_ADC_Stop(p_dcb->hadc);
+	p_dcb->curch = -1;
+	err = dev_adc_setscan(p_dcb->hadc, p_dcb->unit, ch, size);
+	if(err < E_OK) goto err_1;
+
+	tk_clr_flg(p_dcb->flgid, ~FLGPTN_DONE);
+	set_seq(p_dcb, ch, size, scanbuf, size);
+	if(HAL_ADC_Start_DMA(p_dcb->hadc, (uint32_t*)scanbuf, (uint32_t)size) != HAL_OK) {
+		p_dcb->seqnch = 0;
+		err = E_BUSY;
+		goto err_1;
+	}
+	err = tk_wai_flg(p_dcb->flgid, FLGPTN_DONE, TWF_ANDW | TWF_BITCLR, &rflgptn, DEV_HAL_ADC_TMOUT);
+	HAL_ADC_Stop_DMA(p_dcb->hadc);
+	p_dcb->seqnch = 0;
+	if(err >= E_OK) err = p_dcb->err;
+	if(err >= E_OK) {
+		DCacheInvalidate(scanbuf, sizeof(adc_scanbuf[0]));
+		for(i = 0; i < size; i++) buf[i] = scanbuf[i];
+	}
+
+err_1:
+	p_dcb->hadc->Init = init;
+	HAL_ADC_Init(p_dcb->hadc);
+	return err;
+}
+
+/* Read the channels from req->start to (req->start + req->size - 1) */
+LOCAL ER read_data(T_HAL_ADC_DCB *p_dcb, T_DEVREQ *req)
+{
+	UW	*buf;
+	SZ	i;
+	ER	err;
+
+	if(req->size == 0) {
+		req->asize = 1;
+		return E_OK;
+	}
+	if(p_dcb->stream) return E_BUSY;
+
+	buf = (UW*)req->buf;
+	if(req->size == 1) {
+		err = read_ch(p_dcb, req->start, buf);
+	} else if(req->size > HAL_ADC_STREAM_MAXCH) {
+		err = E_PAR;
+	} else if(p_dcb->hadc->DMA_Handle != NULL) {
+		err = read_scan(p_dcb, req->start, req->size, buf);
+	} else {				// Without DMA, convert one by one
+		for(i = 0, err = E_OK; i < req->size && err >= E_OK; i++) {
+			err = read_ch(p_dcb, req->start + i, &buf[i]);
 		}
 	}
+	if(err >= E_OK) req->asize = req->size;
 
 	return err;
 }
@@ -160,7 +556,16 @@ LOCAL ER dev_adc_openfn( ID devid, UINT omode, T_MSDI *msdi)
  */
 LOCAL ER dev_adc_closefn( ID devid, UINT option, T_MSDI *msdi)
 {
-	return E_OK;
+	T_HAL_ADC_DCB	*p_dcb;
+
+	p_dcb = (T_HAL_ADC_DCB*)(msdi->dmsdi.exinf);
+	if(p_dcb->hadc == NULL) return E_OK;
+
+	if(p_dcb->winch >= 0) {			// Disarm the window event
+		p_dcb->winch = -1;
+		dev_adc_setwdg(p_dcb->hadc, 0, FALSE, 0, 0);
+	}
+	return stop_stream(p_dcb);
 }
 
 /*
@@ -222,6 +627,7 @@ EXPORT ER dev_init_hal_adc( UW unit, ADC_HandleTypeDef *hadc )
 	INT		i;
 
 	if( unit >= DEV_HAL_ADC_UNITNM) return E_PAR;
+	if( hadc != NULL && adc_insno(hadc->Instance) == 0) return E_PAR;
 
 #if TK_SUPPORT_MEMLIB
 	p_dcb = (T_HAL_ADC_DCB*)Kmalloc(sizeof(T_HAL_ADC_DCB));
@@ -231,12 +637,17 @@ EXPORT ER dev_init_hal_adc( UW unit, ADC_HandleTypeDef *hadc )
 	p_dcb = &dev_adc_cb[unit];
 #endif
 
-	id_flgid = tk_cre_flg(&id_flg);
-	if(id_flgid <= E_OK) {
-		err = (ER)id_flgid;
+	p_dcb->flgid = tk_cre_flg(&id_flg);
+	if(p_dcb->flgid <= E_OK) {
+		err = (ER)p_dcb->flgid;
 		goto err_1;
 	}
 
+	if(hadc != NULL) {
+		err = dev_adc_initch(unit);	// Prepare the channel setting
+		if(err != E_OK) goto err_2;
+	}
+
 	/* Device registration information */
 	dmsdi.exinf	= p_dcb;
 	dmsdi.drvatr	= 0;			/* Driver attributes */
@@ -255,15 +666,22 @@ EXPORT ER dev_init_hal_adc( UW unit, ADC_HandleTypeDef *hadc )
 	dmsdi.devnm[i+1] = 0;
 
 	err = msdi_def_dev( &dmsdi, &idev, &p_msdi);
-	if(err != E_OK) goto err_1;
+	if(err != E_OK) goto err_2;
 
 	p_dcb->hadc	= hadc;
 	p_dcb->devid	= p_msdi->devid;
 	p_dcb->unit	= unit;
 	p_dcb->evtmbfid	= idev.evtmbfid;
+	p_dcb->stream	= FALSE;
+	p_dcb->curch	= -1;
+	p_dcb->winch	= -1;
+	p_dcb->seqnch	= 0;
+	if(hadc != NULL) dev_adc_ins[adc_insno(hadc->Instance)] = p_dcb;
 
 	return E_OK;
 
+err_2:
+	tk_del_flg(p_dcb->flgid);
 err_1:
 #if TK_SUPPORT_MEMLIB
 	Kfree(p_dcb);
@@ -28,6 +28,67 @@
  * Attribute data
  */
 #define TDN_HAL_ADC_MODE	(-100)	// A/DC Mode
+#define TDN_HAL_ADC_STREAM	(-101)	// Streaming mode (Write: T_HAL_ADC_STREAM, Read: T_HAL_ADC_BLK)
+#define TDN_HAL_ADC_SMPTIME	(-102)	// Sampling time of the channel (T_HAL_ADC_SMPTIME)
+#define TDN_HAL_ADC_OVS		(-103)	// Oversampling of the channel (T_HAL_ADC_OVS)
+#define TDN_HAL_ADC_WINDOW	(-104)	// Window event (Write only: T_HAL_ADC_WINDOW)
+
+/* Streaming mode setting */
+#define HAL_ADC_STREAM_MAXCH	(16)	// Maximum number of channels (Also for the scan read)
+
+typedef struct {
+	INT	nch;				// Number of channels (0: Stop streaming)
+	UB	ch[HAL_ADC_STREAM_MAXCH];	// Channels in the scan order
+	UH	*buf;				// Ring buffer (blksz * 2 samples)
+	SZ	blksz;				// Number of samples in a block (Multiple of nch)
+} T_HAL_ADC_STREAM;
+/* With D-cache (STM32F7/H7), 'buf' must be aligned to the cache line
+ * (DCACHE_ALIGNED), and the block size (blksz * 2 bytes) must be a multiple
+ * of the cache line. Otherwise the invalidation of a partial cache line can
+ * overwrite the samples written by the DMA. (E_PAR)
+ * The DMA must be linked to the A/DC HAL handle by STM32CubeMX. (E_NOSPT)
+ */
+
+/* Streaming data block */
+typedef struct {
+	UH	*smp;		// Sample buffer (Set by the caller)
+	SZ	nsmp;		// Number of samples (Set the buffer size by the caller)
+	UW	seqno;		// Block sequence number
+	SYSTIM	time;		// Block completion time
+	UW	lost;		// Number of lost blocks (Total)
+	UW	ovrcnt;		// Number of A/DC errors (Total)
+} T_HAL_ADC_BLK;
+
+/* Sampling time of the channel */
+typedef struct {
+	UW	ch;		// Channel (Set by the caller)
+	UW	smptime;	// Sampling time (ADC_SAMPLETIME_xxx of HAL)
+} T_HAL_ADC_SMPTIME;
+
+/* Oversampling of the channel (STM32L4, G4, H7) */
+typedef struct {
+	UW	ch;		// Channel (Set by the caller)
+	UW	ratio;		// Oversampling ratio (1: No oversampling)
+	UW	shift;		// Right bit shift of the accumulated data
+} T_HAL_ADC_OVS;
+
+/* Window event setting (One channel for each unit) */
+typedef struct {
+	UW	ch;		// Channel
+	BOOL	enable;		// TRUE: Arm  FALSE: Disarm
+	UW	lo;		// Low threshold
+	UW	hi;		// High threshold
+} T_HAL_ADC_WINDOW;
+
+/* Window event message (Sent to the event notification message buffer)
+ *	Sent once when the conversion result is out of lo to hi.
+ */
+typedef struct {
+	ID	devid;		// Device ID
+	UW	ch;		// Channel
+	UW	val;		// Conversion result
+	SYSTIM	time;		// Detected time
+} T_HAL_ADC_WINEVT;
 
 /*----------------------------------------------------------------------
  * Device driver initialization and registration
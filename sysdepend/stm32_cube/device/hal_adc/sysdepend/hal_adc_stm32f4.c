@@ -36,25 +36,134 @@ LOCAL const UW adc_cfg_ch[] = {
 	ADC_CHANNEL_12, ADC_CHANNEL_13, ADC_CHANNEL_14, ADC_CHANNEL_15, 
 };
 
-EXPORT ER dev_adc_setch(ADC_HandleTypeDef *hadc, UW unit, W start)
-{
-	ADC_ChannelConfTypeDef	sConfig = {0};
-	HAL_StatusTypeDef	hal_sts;
+#define ADC_CFG_CHNUM	(sizeof(adc_cfg_ch)/sizeof(UW))
 
-	if(start >= sizeof(adc_cfg_ch)/sizeof(UW)) return E_PAR;
+/* Channel setting of each unit (Prepared by dev_adc_initch) */
+LOCAL ADC_ChannelConfTypeDef	adc_chconf[DEV_HAL_ADC_UNITNM];			// Common setting of the channels
+LOCAL UW			adc_smptime[DEV_HAL_ADC_UNITNM][ADC_CFG_CHNUM];	// Sampling time of each channel
 
-	sConfig.Channel = adc_cfg_ch[start];
+/* Channel setting of each unit (Except the channel and the rank) */
+LOCAL ER set_chconf(ADC_ChannelConfTypeDef *sConfig, UW unit)
+{
 	if(unit == 0) {		// ADC1
-		sConfig.Rank = 1;
-		sConfig.SamplingTime = ADC_SAMPLETIME_3CYCLES;
+		sConfig->SamplingTime = ADC_SAMPLETIME_3CYCLES;
 	} else {
 		return E_IO;
 	}
+	return E_OK;
+}
+
+/* Prepare the channel setting (Called at the initialization) */
+EXPORT ER dev_adc_initch(UW unit)
+{
+	ER	err;
+	INT	i;
+
+	err = set_chconf(&adc_chconf[unit], unit);
+	if(err < E_OK) return err;
+
+	for(i = 0; i < ADC_CFG_CHNUM; i++) {
+		adc_smptime[unit][i] = adc_chconf[unit].SamplingTime;
+	}
+	return E_OK;
+}
+
+/* Sampling time of each channel (ADC_SAMPLETIME_xxx) */
+EXPORT ER dev_adc_setsmp(UW unit, W ch, UW smptime)
+{
+	if(ch >= ADC_CFG_CHNUM) return E_PAR;
+	if(!IS_ADC_SAMPLE_TIME(smptime)) return E_PAR;
+
+	adc_smptime[unit][ch] = smptime;
+	return E_OK;
+}
+
+EXPORT ER dev_adc_getsmp(UW unit, W ch, UW *smptime)
+{
+	if(ch >= ADC_CFG_CHNUM) return E_PAR;
+
+	*smptime = adc_smptime[unit][ch];
+	return E_OK;
+}
+
+/* Oversampling of each channel (Not supported by the A/DC of STM32F4) */
+EXPORT ER dev_adc_setovs(UW unit, W ch, UW ratio, UW shift)
+{
+	if(ch >= ADC_CFG_CHNUM) return E_PAR;
+
+	return (ratio == 1 && shift == 0)? E_OK: E_NOSPT;
+}
+
+EXPORT ER dev_adc_getovs(UW unit, W ch, UW *ratio, UW *shift)
+{
+	if(ch >= ADC_CFG_CHNUM) return E_PAR;
+
+	*ratio = 1;
+	*shift = 0;
+	return E_OK;
+}
+
+EXPORT ER dev_adc_setch(ADC_HandleTypeDef *hadc, UW unit, W start)
+{
+	ADC_ChannelConfTypeDef	sConfig;
+	HAL_StatusTypeDef	hal_sts;
+
+	if(start >= ADC_CFG_CHNUM) return E_PAR;
+
+	sConfig = adc_chconf[unit];
+	sConfig.Channel = adc_cfg_ch[start];
+	sConfig.Rank = 1;
+	sConfig.SamplingTime = adc_smptime[unit][start];
 
 	hal_sts = HAL_ADC_ConfigChannel(hadc, &sConfig);
 
 	return (hal_sts == HAL_OK)?E_OK:E_PAR;
 }
 
+/* Analog watchdog 1 setting (Window event)
+ *	The interrupt occurs when the conversion result of the channel is out of lo to hi.
+ */
+EXPORT ER dev_adc_setwdg(ADC_HandleTypeDef *hadc, W ch, BOOL enable, UW lo, UW hi)
+{
+	ADC_AnalogWDGConfTypeDef	wdg = {0};
+
+	if(ch >= ADC_CFG_CHNUM || lo > hi) return E_PAR;
+
+	wdg.WatchdogMode	= enable? ADC_ANALOGWATCHDOG_SINGLE_REG: ADC_ANALOGWATCHDOG_NONE;
+	wdg.Channel		= adc_cfg_ch[ch];
+	wdg.ITMode		= enable? ENABLE: DISABLE;
+	wdg.HighThreshold	= hi;
+	wdg.LowThreshold	= lo;
+
+	return (HAL_ADC_AnalogWDGConfig(hadc, &wdg) == HAL_OK)? E_OK: E_BUSY;
+}
+
+/* Scan sequence setting (Streaming mode and scan read)
+ *	Converts the channels in the order of ch[0]...ch[nch-1] with the DMA.
+ */
+EXPORT ER dev_adc_setscan(ADC_HandleTypeDef *hadc, UW unit, CONST UB *ch, INT nch)
+{
+	ADC_ChannelConfTypeDef	sConfig;
+	INT			i;
+
+	if(nch <= 0 || nch > 16) return E_PAR;
+	sConfig = adc_chconf[unit];
+
+	hadc->Init.ScanConvMode		= ENABLE;
+	hadc->Init.NbrOfConversion	= nch;
+	hadc->Init.DMAContinuousRequests	= ENABLE;
+	hadc->Init.EOCSelection		= ADC_EOC_SEQ_CONV;
+	if(HAL_ADC_Init(hadc) != HAL_OK) return E_IO;
+
+	for(i = 0; i < nch; i++) {
+		if(ch[i] >= ADC_CFG_CHNUM) return E_PAR;
+		sConfig.Channel = adc_cfg_ch[ch[i]];
+		sConfig.SamplingTime = adc_smptime[unit][ch[i]];
+		sConfig.Rank = i + 1;
+		if(HAL_ADC_ConfigChannel(hadc, &sConfig) != HAL_OK) return E_PAR;
+	}
+	return E_OK;
+}
+
 #endif		/* DEVCNF_USE_HAL_ADC */
 #endif		/* MTKBSP_CPU_STM32F4 */
\ No newline at end of file
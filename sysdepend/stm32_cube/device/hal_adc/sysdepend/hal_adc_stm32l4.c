@@ -36,28 +36,198 @@ LOCAL const UW adc_cfg_ch[] = {
 	ADC_CHANNEL_12, ADC_CHANNEL_13, ADC_CHANNEL_14, ADC_CHANNEL_15,
 };
 
-EXPORT ER dev_adc_setch(ADC_HandleTypeDef *hadc, UW unit, W start)
-{
-	ADC_ChannelConfTypeDef	sConfig = {0};
-	HAL_StatusTypeDef	hal_sts;
+LOCAL const UW adc_cfg_rank[] = {
+	ADC_REGULAR_RANK_1, ADC_REGULAR_RANK_2, ADC_REGULAR_RANK_3, ADC_REGULAR_RANK_4,
+	ADC_REGULAR_RANK_5, ADC_REGULAR_RANK_6, ADC_REGULAR_RANK_7, ADC_REGULAR_RANK_8,
+	ADC_REGULAR_RANK_9, ADC_REGULAR_RANK_10, ADC_REGULAR_RANK_11, ADC_REGULAR_RANK_12,
+	ADC_REGULAR_RANK_13, ADC_REGULAR_RANK_14, ADC_REGULAR_RANK_15, ADC_REGULAR_RANK_16
+};
 
-	if(start >= sizeof(adc_cfg_ch)/sizeof(UW)) return E_PAR;
+#define ADC_CFG_CHNUM	(sizeof(adc_cfg_ch)/sizeof(UW))
 
-	sConfig.Channel = adc_cfg_ch[start];
+/* Channel setting of each unit (Prepared by dev_adc_initch) */
+LOCAL ADC_ChannelConfTypeDef	adc_chconf[DEV_HAL_ADC_UNITNM];			// Common setting of the channels
+LOCAL UW			adc_smptime[DEV_HAL_ADC_UNITNM][ADC_CFG_CHNUM];	// Sampling time of each channel
+LOCAL struct {
+	UH	ratio;		// Oversampling ratio (1: No oversampling)
+	UH	shift;		// Right bit shift
+} adc_ovs[DEV_HAL_ADC_UNITNM][ADC_CFG_CHNUM];				// Oversampling of each channel
+
+/* Channel setting of each unit (Except the channel and the rank) */
+LOCAL ER set_chconf(ADC_ChannelConfTypeDef *sConfig, UW unit)
+{
 	if(unit == 0) {		// ADC1
-		sConfig.Rank = ADC_REGULAR_RANK_1;
-		sConfig.SamplingTime = ADC_SAMPLETIME_2CYCLE_5;
-		sConfig.SingleDiff = ADC_SINGLE_ENDED;
-		sConfig.OffsetNumber = ADC_OFFSET_NONE;
-		sConfig.Offset = 0;
+		sConfig->SamplingTime = ADC_SAMPLETIME_2CYCLE_5;
+		sConfig->SingleDiff = ADC_SINGLE_ENDED;
+		sConfig->OffsetNumber = ADC_OFFSET_NONE;
+		sConfig->Offset = 0;
 	} else {
 		return E_IO;
 	}
+	return E_OK;
+}
+
+/* Oversampling setting (ratio: 1 to 256, Power of 2  shift: 0 to 8) */
+LOCAL ER set_ovsconf(ADC_OversamplingTypeDef *ovs, UW unit, UW ratio, UW shift)
+{
+	UW	n;
+
+	if(ratio < 1 || ratio > 256 || (ratio & (ratio - 1)) != 0 || shift > 8) return E_PAR;
+	for(n = 0; (2U << n) < ratio; n++);		// log2(ratio) - 1
+
+	ovs->Ratio			= n << ADC_CFGR2_OVSR_Pos;
+	ovs->RightBitShift		= shift << ADC_CFGR2_OVSS_Pos;
+	ovs->TriggeredMode		= ADC_TRIGGEREDMODE_SINGLE_TRIGGER;
+	ovs->OversamplingStopReset	= ADC_REGOVERSAMPLING_CONTINUED_MODE;
+	return E_OK;
+}
+
+/* Oversampling of the channel (Set to the initial setting of the A/DC)
+ *	Returns TRUE if the initial setting is changed.
+ */
+LOCAL BOOL set_ovs(ADC_HandleTypeDef *hadc, UW unit, W ch)
+{
+	ADC_OversamplingTypeDef	ovs;
+	FunctionalState		mode;
+
+	mode = (adc_ovs[unit][ch].ratio > 1)? ENABLE: DISABLE;
+	set_ovsconf(&ovs, unit, adc_ovs[unit][ch].ratio, adc_ovs[unit][ch].shift);
+	if(hadc->Init.OversamplingMode == mode && (mode == DISABLE
+			|| (hadc->Init.Oversampling.Ratio == ovs.Ratio
+				&& hadc->Init.Oversampling.RightBitShift == ovs.RightBitShift))) return FALSE;
+
+	hadc->Init.OversamplingMode = mode;
+	if(mode == ENABLE) hadc->Init.Oversampling = ovs;
+	return TRUE;
+}
+
+/* Prepare the channel setting (Called at the initialization) */
+EXPORT ER dev_adc_initch(UW unit)
+{
+	ER	err;
+	INT	i;
+
+	err = set_chconf(&adc_chconf[unit], unit);
+	if(err < E_OK) return err;
+
+	for(i = 0; i < ADC_CFG_CHNUM; i++) {
+		adc_smptime[unit][i] = adc_chconf[unit].SamplingTime;
+		adc_ovs[unit][i].ratio = 1;
+		adc_ovs[unit][i].shift = 0;
+	}
+	return E_OK;
+}
+
+/* Sampling time of each channel (ADC_SAMPLETIME_xxx) */
+EXPORT ER dev_adc_setsmp(UW unit, W ch, UW smptime)
+{
+	if(ch >= ADC_CFG_CHNUM) return E_PAR;
+	if(!IS_ADC_SAMPLE_TIME(smptime)) return E_PAR;
+
+	adc_smptime[unit][ch] = smptime;
+	return E_OK;
+}
+
+EXPORT ER dev_adc_getsmp(UW unit, W ch, UW *smptime)
+{
+	if(ch >= ADC_CFG_CHNUM) return E_PAR;
+
+	*smptime = adc_smptime[unit][ch];
+	return E_OK;
+}
+
+/* Oversampling of each channel (ratio 1: No oversampling) */
+EXPORT ER dev_adc_setovs(UW unit, W ch, UW ratio, UW shift)
+{
+	ADC_OversamplingTypeDef	ovs;
+	ER			err;
+
+	if(ch >= ADC_CFG_CHNUM) return E_PAR;
+	err = set_ovsconf(&ovs, unit, ratio, shift);
+	if(err < E_OK) return err;
+
+	adc_ovs[unit][ch].ratio = (UH)ratio;
+	adc_ovs[unit][ch].shift = (UH)shift;
+	return E_OK;
+}
+
+EXPORT ER dev_adc_getovs(UW unit, W ch, UW *ratio, UW *shift)
+{
+	if(ch >= ADC_CFG_CHNUM) return E_PAR;
+
+	*ratio = adc_ovs[unit][ch].ratio;
+	*shift = adc_ovs[unit][ch].shift;
+	return E_OK;
+}
+
+EXPORT ER dev_adc_setch(ADC_HandleTypeDef *hadc, UW unit, W start)
+{
+	ADC_ChannelConfTypeDef	sConfig;
+	HAL_StatusTypeDef	hal_sts;
+
+	if(start >= ADC_CFG_CHNUM) return E_PAR;
+
+	if(set_ovs(hadc, unit, start)) {
+		if(HAL_ADC_Init(hadc) != HAL_OK) return E_IO;
+	}
+
+	sConfig = adc_chconf[unit];
+	sConfig.Channel = adc_cfg_ch[start];
+	sConfig.Rank = ADC_REGULAR_RANK_1;
+	sConfig.SamplingTime = adc_smptime[unit][start];
 
 	hal_sts = HAL_ADC_ConfigChannel(hadc, &sConfig);
 
 	return (hal_sts == HAL_OK)?E_OK:E_PAR;
 }
 
+/* Analog watchdog 1 setting (Window event)
+ *	The interrupt occurs when the conversion result of the channel is out of lo to hi.
+ */
+EXPORT ER dev_adc_setwdg(ADC_HandleTypeDef *hadc, W ch, BOOL enable, UW lo, UW hi)
+{
+	ADC_AnalogWDGConfTypeDef	wdg = {0};
+
+	if(ch >= ADC_CFG_CHNUM || lo > hi) return E_PAR;
+
+	wdg.WatchdogNumber	= ADC_ANALOGWATCHDOG_1;
+	wdg.WatchdogMode	= enable? ADC_ANALOGWATCHDOG_SINGLE_REG: ADC_ANALOGWATCHDOG_NONE;
+	wdg.Channel		= adc_cfg_ch[ch];
+	wdg.ITMode		= enable? ENABLE: DISABLE;
+	wdg.HighThreshold	= hi;
+	wdg.LowThreshold	= lo;
+
+	return (HAL_ADC_AnalogWDGConfig(hadc, &wdg) == HAL_OK)? E_OK: E_BUSY;
+}
+
+/* Scan sequence setting (Streaming mode and scan read)
+ *	Converts the channels in the order of ch[0]...ch[nch-1] with the DMA.
+ */
+EXPORT ER dev_adc_setscan(ADC_HandleTypeDef *hadc, UW unit, CONST UB *ch, INT nch)
+{
+	ADC_ChannelConfTypeDef	sConfig;
+	INT			i;
+
+	if(nch <= 0 || nch > sizeof(adc_cfg_rank)/sizeof(UW) || ch[0] >= ADC_CFG_CHNUM) return E_PAR;
+	sConfig = adc_chconf[unit];
+
+	hadc->Init.ScanConvMode		= ADC_SCAN_ENABLE;
+	hadc->Init.NbrOfConversion	= nch;
+	hadc->Init.DMAContinuousRequests	= ENABLE;
+	hadc->Init.EOCSelection		= ADC_EOC_SEQ_CONV;
+	hadc->Init.Overrun		= ADC_OVR_DATA_OVERWRITTEN;
+	set_ovs(hadc, unit, ch[0]);		// Oversampling of the first channel
+	if(HAL_ADC_Init(hadc) != HAL_OK) return E_IO;
+
+	for(i = 0; i < nch; i++) {
+		if(ch[i] >= ADC_CFG_CHNUM) return E_PAR;
+		sConfig.Channel = adc_cfg_ch[ch[i]];
+		sConfig.SamplingTime = adc_smptime[unit][ch[i]];
+		sConfig.Rank = adc_cfg_rank[i];
+		if(HAL_ADC_ConfigChannel(hadc, &sConfig) != HAL_OK) return E_PAR;
+	}
+	return E_OK;
+}
+
 #endif		/* DEVCNF_USE_HAL_ADC */
 #endif		/* MTKBSP_CPU_STM32L4 */
\ No newline at end of file
@@ -10,12 +10,15 @@
  *
  *----------------------------------------------------------------------
  */
+#ifndef I2C_HOSTTEST
 #include <sys/machine.h>
 #include <config_bsp/stm32_cube/config_bsp.h>
+#endif
 
 #ifdef MTKBSP_STM32CUBE
 #if DEVCNF_USE_HAL_IIC
 
+#ifndef I2C_HOSTTEST
 #include <stdlib.h>
 
 #include <tk/tkernel.h>
@@ -25,6 +28,7 @@
 #include <mtkernel/kernel/knlinc/tstdlib.h>
 #include <mtkernel/device/common/drvif/msdrvif.h>
 #include "hal_i2c_cnf.h"
+#endif
 
 /*
  *	hal_i2c.c
@@ -41,16 +45,41 @@ typedef struct {
 	UW			unit;		// Unit no
 	ER			err;		// Error code that occurred during interrupt processing
 	ID			evtmbfid;	// MBF ID for event notification
+	ID			flgid;		// Interrupt detection flag
 	UW			dmode;		// Device mode
 	UW			tadr;		// Target Address
+	T_HAL_I2C_XFER		*xfer_top;	// Transaction queue (Top: Executing)
+	T_HAL_I2C_XFER		*xfer_end;	// Transaction queue (Last)
+	ID			semid;		// Number of free flag bits for synchronous transaction
+	UINT			syncptn;	// Flag bits used by synchronous transactions
+	BOOL			dmarx;		// Receiving by DMA
+	BOOL			abort;		// Waiting for the abort completion
+#if DEV_HAL_I2C_INTCNT
+	INT			intno[4];	// Counted interrupts (I2C event, error, DMA Rx, Tx)
+	UW			intcnt;		// Number of interrupts
+#endif
 } T_HAL_I2C_DCB;
 
-/* Interrupt detection flag */
-LOCAL ID	id_flgid;
+/* Transaction status */
+#define	XFER_WAIT	0		// Waiting in the queue
+#define	XFER_EXEC	1		// Executing
+#define	XFER_SND	2		// Executing: Send before repeated start
+#define	XFER_DONE	3		// Completed
+
+/* Interrupt detection flag (Created for each unit) */
 LOCAL T_CFLG	id_flg	= {
 			.flgatr		= TA_TFIFO | TA_WMUL,
 			.iflgptn	= 0,
 };
+#define FLGPTN_DONE	(1<<0)		// Interrupt processing completed (Target mode)
+#define FLGPTN_SYNC	(~FLGPTN_DONE)	// Synchronous transactions (One bit for each task)
+#define SYNC_MAX	(31)		// Number of bits of FLGPTN_SYNC
+
+LOCAL T_CSEM	id_sem	= {
+			.sematr		= TA_TFIFO | TA_FIRST,
+			.isemcnt	= SYNC_MAX,
+			.maxsem		= SYNC_MAX,
+};
 
 #if TK_SUPPORT_MEMLIB
 LOCAL T_HAL_I2C_DCB	*dev_i2c_cb[DEV_HAL_I2C_UNITNM];
@@ -60,6 +89,157 @@ LOCAL T_HAL_I2C_DCB	dev_i2c_cb[DEV_HAL_I2C_UNITNM];
 #define		get_dcb_ptr(unit)	(&dev_I2C_cb[unit])
 #endif
 
+/* DCB of each open device descriptor (Indexed by dd. Cache of i2c_get_dcb) */
+LOCAL T_HAL_I2C_DCB	*dev_i2c_dd[CNF_MAX_OPNDEV + 1];
+#define DD_CACHED(dd)	((dd) > 0 && (dd) <= CNF_MAX_OPNDEV)
+
+/* DCB of each I2C instance (Indexed by the instance number for HAL callbacks) */
+#define I2C_INSNM	(6)		// I2C1 - I2C5 (0: Unknown instance)
+LOCAL T_HAL_I2C_DCB	*dev_i2c_ins[I2C_INSNM];
+
+/* I2C instance number (I2Cn: n, 0: Unknown) */
+LOCAL INT i2c_insno(I2C_TypeDef *ins)
+{
+	switch((uintptr_t)ins) {
+#ifdef I2C1_BASE
+	case I2C1_BASE:	return 1;
+#endif
+#ifdef I2C2_BASE
+	case I2C2_BASE:	return 2;
+#endif
+#ifdef I2C3_BASE
+	case I2C3_BASE:	return 3;
+#endif
+#ifdef I2C4_BASE
+	case I2C4_BASE:	return 4;
+#endif
+#ifdef I2C5_BASE
+	case I2C5_BASE:	return 5;
+#endif
+	default:	return 0;
+	}
+}
+
+#define get_hdl_dcb(hdl)	(dev_i2c_ins[i2c_insno((hdl)->Instance)])
+
+#if DEV_HAL_I2C_INTCNT
+/*---------------------------------------------------------------------*/
+/* Interrupt count (Attribute data TDN_HAL_I2C_INTCNT)
+ *	The driver defines the handlers of the I2C event and error interrupts
+ *	and the DMA interrupts linked to the HAL handle. The handler counts
+ *	the interrupt and calls the handler of the startup vector table
+ *	(e.g. stm32xxxx_it.c generated by STM32CubeMX).
+ */
+IMPORT UW *knl_exctbl_o;		// Exception handler table (Origin)
+
+LOCAL const struct {
+	UW	ins;			// I2C instance
+	INT	ev, er;			// Event and error interrupt numbers
+} i2c_intno_tbl[] = {
+#ifdef I2C1_BASE
+	{ I2C1_BASE, I2C1_EV_IRQn, I2C1_ER_IRQn },
+#endif
+#ifdef I2C2_BASE
+	{ I2C2_BASE, I2C2_EV_IRQn, I2C2_ER_IRQn },
+#endif
+#ifdef I2C3_BASE
+	{ I2C3_BASE, I2C3_EV_IRQn, I2C3_ER_IRQn },
+#endif
+#ifdef I2C4_BASE
+	{ I2C4_BASE, I2C4_EV_IRQn, I2C4_ER_IRQn },
+#endif
+#ifdef I2C5_BASE
+	{ I2C5_BASE, I2C5_EV_IRQn, I2C5_ER_IRQn },
+#endif
+};
+
+#define DMA_INTNO(ch)	{ (UW)(ch), ch##_IRQn }
+LOCAL const struct {
+	UW	ins;			// DMA stream/channel instance
+	INT	intno;			// Interrupt number
+} dma_intno_tbl[] = {
+#ifdef DMA1_Stream0
+	DMA_INTNO(DMA1_Stream0), DMA_INTNO(DMA1_Stream1), DMA_INTNO(DMA1_Stream2), DMA_INTNO(DMA1_Stream3),
+	DMA_INTNO(DMA1_Stream4), DMA_INTNO(DMA1_Stream5), DMA_INTNO(DMA1_Stream6), DMA_INTNO(DMA1_Stream7),
+#endif
+#ifdef DMA2_Stream0
+	DMA_INTNO(DMA2_Stream0), DMA_INTNO(DMA2_Stream1), DMA_INTNO(DMA2_Stream2), DMA_INTNO(DMA2_Stream3),
+	DMA_INTNO(DMA2_Stream4), DMA_INTNO(DMA2_Stream5), DMA_INTNO(DMA2_Stream6), DMA_INTNO(DMA2_Stream7),
+#endif
+#ifdef DMA1_Channel1
+	DMA_INTNO(DMA1_Channel1), DMA_INTNO(DMA1_Channel2), DMA_INTNO(DMA1_Channel3),
+	DMA_INTNO(DMA1_Channel4), DMA_INTNO(DMA1_Channel5), DMA_INTNO(DMA1_Channel6),
+#endif
+#ifdef DMA1_Channel7
+	DMA_INTNO(DMA1_Channel7),
+#endif
+#ifdef DMA1_Channel8
+	DMA_INTNO(DMA1_Channel8),
+#endif
+#ifdef DMA2_Channel1
+	DMA_INTNO(DMA2_Channel1), DMA_INTNO(DMA2_Channel2), DMA_INTNO(DMA2_Channel3),
+	DMA_INTNO(DMA2_Channel4), DMA_INTNO(DMA2_Channel5), DMA_INTNO(DMA2_Channel6),
+#endif
+#ifdef DMA2_Channel7
+	DMA_INTNO(DMA2_Channel7),
+#endif
+#ifdef DMA2_Channel8
+	DMA_INTNO(DMA2_Channel8),
+#endif
+};
+
+/* Interrupt number of the DMA (-1: Not linked or unknown) */
+LOCAL INT dma_intno(DMA_HandleTypeDef *hdma)
+{
+	INT	i;
+
+	if(hdma == NULL) return -1;
+	for(i = 0; i < (INT)(sizeof(dma_intno_tbl) / sizeof(dma_intno_tbl[0])); i++) {
+		if(dma_intno_tbl[i].ins == (UW)hdma->Instance) return dma_intno_tbl[i].intno;
+	}
+	return -1;
+}
+
+LOCAL void i2c_intcnt_hdr(UINT intno)
+{
+	T_HAL_I2C_DCB	*p_dcb;
+	INT		unit, i;
+
+	for(unit = 0; unit < DEV_HAL_I2C_UNITNM; unit++) {
+		p_dcb = get_dcb_ptr(unit);
+		if(p_dcb == NULL) continue;
+		for(i = 0; i < 4; i++) {
+			if(p_dcb->intno[i] == (INT)intno) p_dcb->intcnt++;
+		}
+	}
+	((FP)knl_exctbl_o[N_SYSVEC + intno])();
+}
+
+/* Define the interrupt handlers to count the interrupts of the unit */
+LOCAL void i2c_def_intcnt(T_HAL_I2C_DCB *p_dcb)
+{
+	T_DINT	dint;
+	INT	i;
+
+	p_dcb->intcnt	= 0;
+	p_dcb->intno[0]	= p_dcb->intno[1] = -1;
+	for(i = 0; i < (INT)(sizeof(i2c_intno_tbl) / sizeof(i2c_intno_tbl[0])); i++) {
+		if(i2c_intno_tbl[i].ins == (UW)p_dcb->hi2c->Instance) {
+			p_dcb->intno[0]	= i2c_intno_tbl[i].ev;
+			p_dcb->intno[1]	= i2c_intno_tbl[i].er;
+		}
+	}
+	p_dcb->intno[2]	= dma_intno(p_dcb->hi2c->hdmarx);
+	p_dcb->intno[3]	= dma_intno(p_dcb->hi2c->hdmatx);
+
+	dint.intatr	= TA_HLNG;
+	dint.inthdr	= i2c_intcnt_hdr;
+	for(i = 0; i < 4; i++) {
+		if(p_dcb->intno[i] >= 0) tk_def_int((UINT)p_dcb->intno[i], &dint);
+	}
+}
+#endif	/* DEV_HAL_I2C_INTCNT */
+
 /*---------------------------------------------------------------------*/
 /* Attribute data control
  */
@@ -79,6 +259,11 @@ LOCAL ER read_atr(T_HAL_I2C_DCB *p_dcb, T_DEVREQ *req)
 	case TDN_HAL_I2C_TADR:
 		*(UW*)req->buf = p_dcb->tadr;
 		break;
+#if DEV_HAL_I2C_INTCNT
+	case TDN_HAL_I2C_INTCNT:
+		*(UW*)req->buf = p_dcb->intcnt;
+		break;
+#endif
 	default:
 		return E_PAR;
 	}
@@ -107,6 +292,253 @@ LOCAL ER write_atr(T_HAL_I2C_DCB *p_dcb, T_DEVREQ *req)
 	return E_OK;
 }
 
+/*---------------------------------------------------------------------*/
+/* Transaction queue
+ *	The transactions of a unit are executed in order of submission.
+ *	The completion interrupt starts the next queued transaction.
+ */
+
+/* DMA transfer
+ *	The unit specified by DEV_HAL_I2C_DMA_UNIT uses DMA for the data of
+ *	DEV_HAL_I2C_DMA_SIZE bytes or more, if the DMA is linked to the HAL handle.
+ *	With D-cache, the receive buffer should be aligned to the cache line.
+ */
+LOCAL BOOL use_dma(T_HAL_I2C_DCB *p_dcb, DMA_HandleTypeDef *hdma, SZ size)
+{
+	return ((DEV_HAL_I2C_DMA_UNIT & (1 << p_dcb->unit)) != 0
+			&& hdma != NULL && size >= DEV_HAL_I2C_DMA_SIZE);
+}
+
+/* Start the transaction on the bus */
+LOCAL HAL_StatusTypeDef xfer_start(T_HAL_I2C_DCB *p_dcb, T_HAL_I2C_XFER *p_xfer)
+{
+	uint16_t	sadr, msz;
+	BOOL		dmatx;
+
+	sadr = (uint16_t)(p_xfer->sadr<<1);
+	dmatx = use_dma(p_dcb, p_dcb->hi2c->hdmatx, p_xfer->ssize);
+	p_dcb->dmarx = use_dma(p_dcb, p_dcb->hi2c->hdmarx, p_xfer->rsize);
+	if(dmatx) DCacheClean(p_xfer->sbuf, p_xfer->ssize);
+	if(p_dcb->dmarx) DCacheFlush(p_xfer->rbuf, p_xfer->rsize);
+
+	if(p_xfer->rasz != 0) {			// Register access
+		msz = (p_xfer->rasz == 2)? I2C_MEMADD_SIZE_16BIT: I2C_MEMADD_SIZE_8BIT;
+		if(p_xfer->rsize > 0) {
+			if(p_dcb->dmarx) {
+				return HAL_I2C_Mem_Read_DMA(p_dcb->hi2c, sadr, (uint16_t)p_xfer->radr, msz,
+							p_xfer->rbuf, (uint16_t)p_xfer->rsize);
+			}
+			return HAL_I2C_Mem_Read_IT(p_dcb->hi2c, sadr, (uint16_t)p_xfer->radr, msz,
+							p_xfer->rbuf, (uint16_t)p_xfer->rsize);
+		}
+		if(dmatx) {
+			return HAL_I2C_Mem_Write_DMA(p_dcb->hi2c, sadr, (uint16_t)p_xfer->radr, msz,
+							p_xfer->sbuf, (uint16_t)p_xfer->ssize);
+		}
+		return HAL_I2C_Mem_Write_IT(p_dcb->hi2c, sadr, (uint16_t)p_xfer->radr, msz,
+							p_xfer->sbuf, (uint16_t)p_xfer->ssize);
+	}
+	if(p_xfer->ssize > 0 && p_xfer->rsize > 0) {	// Write-then-read
+		p_xfer->stat = XFER_SND;
+		if(dmatx) {
+			return HAL_I2C_Master_Seq_Transmit_DMA(p_dcb->hi2c, sadr,
+						p_xfer->sbuf, (uint16_t)p_xfer->ssize, I2C_FIRST_FRAME);
+		}
+		return HAL_I2C_Master_Seq_Transmit_IT(p_dcb->hi2c, sadr,
+						p_xfer->sbuf, (uint16_t)p_xfer->ssize, I2C_FIRST_FRAME);
+	}
+	if(p_xfer->ssize > 0) {
+		if(dmatx) {
+			return HAL_I2C_Master_Transmit_DMA(p_dcb->hi2c, sadr, p_xfer->sbuf, (uint16_t)p_xfer->ssize);
+		}
+		return HAL_I2C_Master_Transmit_IT(p_dcb->hi2c, sadr, p_xfer->sbuf, (uint16_t)p_xfer->ssize);
+	}
+	if(p_dcb->dmarx) {
+		return HAL_I2C_Master_Receive_DMA(p_dcb->hi2c, sadr, p_xfer->rbuf, (uint16_t)p_xfer->rsize);
+	}
+	return HAL_I2C_Master_Receive_IT(p_dcb->hi2c, sadr, p_xfer->rbuf, (uint16_t)p_xfer->rsize);
+}
+
+/* Complete the top transaction and notify (Interrupt disabled) */
+LOCAL void xfer_done(T_HAL_I2C_DCB *p_dcb, ER err)
+{
+	T_HAL_I2C_XFER	*p_xfer;
+
+	p_xfer = p_dcb->xfer_top;
+	p_dcb->xfer_top = p_xfer->next;
+	if(p_dcb->xfer_top == NULL) p_dcb->xfer_end = NULL;
+
+	if(p_dcb->dmarx) {
+		DCacheInvalidate(p_xfer->rbuf, p_xfer->rsize);
+		p_dcb->dmarx = FALSE;
+	}
+
+	p_xfer->err	= err;
+	p_xfer->stat	= XFER_DONE;
+	if(p_xfer->flgid > 0) tk_set_flg(p_xfer->flgid, p_xfer->flgptn);
+	if(p_xfer->cbf != NULL) (*p_xfer->cbf)(p_xfer);
+}
+
+/* Start the next transaction if the bus is idle (Interrupt disabled) */
+LOCAL void xfer_next(T_HAL_I2C_DCB *p_dcb)
+{
+	T_HAL_I2C_XFER	*p_xfer;
+
+	if(p_dcb->abort) return;		// Restarted on the abort completion
+	while((p_xfer = p_dcb->xfer_top) != NULL && p_xfer->stat == XFER_WAIT) {
+		p_xfer->stat = XFER_EXEC;
+		if(xfer_start(p_dcb, p_xfer) == HAL_OK) break;
+		xfer_done(p_dcb, E_IO);
+	}
+}
+
+/* Transaction completion interrupt */
+LOCAL void xfer_intr(T_HAL_I2C_DCB *p_dcb, ER err)
+{
+	HAL_StatusTypeDef	hal_sts;
+	T_HAL_I2C_XFER	*p_xfer;
+	UINT		imask;
+
+	DI(imask);
+	if(p_dcb->abort) {			// Abort completed. Bus released.
+		p_dcb->abort = FALSE;
+		xfer_next(p_dcb);
+		EI(imask);
+		return;
+	}
+	p_xfer = p_dcb->xfer_top;
+	if(p_xfer->stat == XFER_SND && err >= E_OK) {	// Repeated start and receive
+		p_xfer->stat = XFER_EXEC;
+		if(p_dcb->dmarx) {
+			hal_sts = HAL_I2C_Master_Seq_Receive_DMA(p_dcb->hi2c, (uint16_t)(p_xfer->sadr<<1),
+					p_xfer->rbuf, (uint16_t)p_xfer->rsize, I2C_LAST_FRAME);
+		} else {
+			hal_sts = HAL_I2C_Master_Seq_Receive_IT(p_dcb->hi2c, (uint16_t)(p_xfer->sadr<<1),
+					p_xfer->rbuf, (uint16_t)p_xfer->rsize, I2C_LAST_FRAME);
+		}
+		if(hal_sts == HAL_OK) {
+			EI(imask);
+			return;
+		}
+		err = E_IO;
+	}
+	xfer_done(p_dcb, err);
+	xfer_next(p_dcb);
+	EI(imask);
+}
+
+/* Queue the transaction */
+LOCAL ER xfer_submit(T_HAL_I2C_DCB *p_dcb, T_HAL_I2C_XFER *p_xfer)
+{
+	UINT	imask;
+
+	if(p_dcb->dmode != HAL_I2C_MODE_CNT) return E_OBJ;
+	if(p_xfer->ssize < 0 || p_xfer->ssize > 0xFFFF) return E_PAR;
+	if(p_xfer->rsize < 0 || p_xfer->rsize > 0xFFFF) return E_PAR;
+	if(p_xfer->ssize == 0 && p_xfer->rsize == 0) return E_PAR;
+	if(p_xfer->rasz > 2) return E_PAR;
+	if(p_xfer->rasz != 0 && p_xfer->ssize > 0 && p_xfer->rsize > 0) return E_PAR;
+
+	p_xfer->next	= NULL;
+	p_xfer->stat	= XFER_WAIT;
+	p_xfer->err	= E_OK;
+
+	DI(imask);
+	if(p_dcb->xfer_end != NULL) {
+		p_dcb->xfer_end->next = p_xfer;
+	} else {
+		p_dcb->xfer_top = p_xfer;
+	}
+	p_dcb->xfer_end = p_xfer;
+	xfer_next(p_dcb);
+	EI(imask);
+
+	return E_OK;
+}
+
+/* Remove the transaction from the queue
+ *	If 'force' is TRUE, the executing transaction is also removed. (Timeout)
+ */
+LOCAL ER xfer_cancel(T_HAL_I2C_DCB *p_dcb, T_HAL_I2C_XFER *p_xfer, BOOL force)
+{
+	T_HAL_I2C_XFER	*p, *prev;
+	UINT		imask;
+	ER		err	= E_OBJ;
+
+	DI(imask);
+	for(p = p_dcb->xfer_top, prev = NULL; p != NULL; prev = p, p = p->next) {
+		if(p != p_xfer) continue;
+
+		if(p->stat != XFER_WAIT) {		// Executing
+			if(force) {
+				xfer_done(p_dcb, E_TMOUT);
+				if(HAL_I2C_Master_Abort_IT(p_dcb->hi2c, (uint16_t)(p->sadr<<1)) == HAL_OK) {
+					p_dcb->abort = TRUE;	// Restart on abort completion
+				} else {
+					xfer_next(p_dcb);
+				}
+				err = E_OK;
+			}
+			break;
+		}
+		if(prev != NULL) {
+			prev->next = p->next;
+		} else {
+			p_dcb->xfer_top = p->next;
+		}
+		if(p_dcb->xfer_end == p) p_dcb->xfer_end = prev;
+		p->stat = XFER_DONE;
+		p->err	= E_ABORT;
+		err = E_OK;
+		break;
+	}
+	EI(imask);
+
+	return err;
+}
+
+/* Execute the transaction synchronously
+ *	Each task waits for its own bit of the event flag, so the transactions
+ *	of several tasks are queued together and executed back-to-back.
+ */
+LOCAL ER xfer_sync(T_HAL_I2C_DCB *p_dcb, T_HAL_I2C_XFER *p_xfer)
+{
+	UINT	rflgptn, ptn, imask;
+	ER	err;
+
+	err = tk_wai_sem(p_dcb->semid, 1, TMO_FEVR);
+	if(err < E_OK) return err;
+
+	DI(imask);
+	ptn = FLGPTN_SYNC & ~p_dcb->syncptn;
+	ptn &= ~ptn + 1;			// Lowest free bit
+	p_dcb->syncptn |= ptn;
+	EI(imask);
+
+	p_xfer->cbf	= NULL;
+	p_xfer->flgid	= p_dcb->flgid;
+	p_xfer->flgptn	= ptn;
+	tk_clr_flg(p_dcb->flgid, ~ptn);
+
+	err = xfer_submit(p_dcb, p_xfer);
+	if(err >= E_OK) {
+		err = tk_wai_flg(p_dcb->flgid, ptn, TWF_ANDW | TWF_BITCLR, &rflgptn, DEV_HAL_I2C_TMOUT);
+		if(err >= E_OK) {
+			err = p_xfer->err;
+		} else if(xfer_cancel(p_dcb, p_xfer, TRUE) < E_OK) {
+			err = p_xfer->err;	// Completed just after timeout
+			tk_clr_flg(p_dcb->flgid, ~ptn);
+		}
+	}
+
+	DI(imask);
+	p_dcb->syncptn &= ~ptn;
+	EI(imask);
+	tk_sig_sem(p_dcb->semid, 1);
+
+	return err;
+}
+
 /*---------------------------------------------------------------------*/
 /*Device-specific data control
  */
@@ -115,16 +547,16 @@ LOCAL ER write_atr(T_HAL_I2C_DCB *p_dcb, T_DEVREQ *req)
 LOCAL void HAL_I2C_Callback(I2C_HandleTypeDef *hi2c, ER err)
 {
 	T_HAL_I2C_DCB	*p_dcb;
-	UINT	i;
 
 	ENTER_TASK_INDEPENDENT
 
-	for(i = 0; i < DEV_HAL_I2C_UNITNM; i++) {
-		p_dcb = get_dcb_ptr(i);
-		if(p_dcb->hi2c == hi2c) {
+	p_dcb = get_hdl_dcb(hi2c);
+	if(p_dcb != NULL) {
+		if(p_dcb->xfer_top != NULL || p_dcb->abort) {
+			xfer_intr(p_dcb, err);		// Controller mode transaction
+		} else {
 			p_dcb->err = err;
-			tk_set_flg(id_flgid, 1<< p_dcb->unit);
-			break;
+			tk_set_flg(p_dcb->flgid, FLGPTN_DONE);
 		}
 	}
 
@@ -174,22 +606,23 @@ void HAL_I2C_AbortCpltCallback(I2C_HandleTypeDef *hi2c)
 LOCAL ER read_data(T_HAL_I2C_DCB *p_dcb, T_DEVREQ *req)
 {
 	HAL_StatusTypeDef	hal_sts;
+	T_HAL_I2C_XFER		xfer;
 	UINT			wflgptn, rflgptn;
 	ER			err;
 
-	wflgptn = 1 << p_dcb->unit;
-	tk_clr_flg(id_flgid, ~wflgptn);
-
 	switch(p_dcb->dmode) {
 	case HAL_I2C_MODE_CNT:
-		hal_sts = HAL_I2C_Master_Receive_IT(
-			p_dcb->hi2c,		// I2C_Handle
-			(req->start)<<1,	// Target device address
-			req->buf,		// Pointer to data buffer
-			req->size		// Amount of data to be sent
-		);
-		break;
+		xfer.sadr	= req->start;	// Target device address
+		xfer.rasz	= 0;
+		xfer.ssize	= 0;
+		xfer.rbuf	= req->buf;	// Pointer to data buffer
+		xfer.rsize	= req->size;	// Amount of data to be received
+		err = xfer_sync(p_dcb, &xfer);
+		if(err >= E_OK) req->asize = req->size;
+		return err;
 	case HAL_I2C_MODE_TAR:
+		wflgptn = FLGPTN_DONE;
+		tk_clr_flg(p_dcb->flgid, ~wflgptn);
 		hal_sts = HAL_I2C_Slave_Receive_IT(
 			p_dcb->hi2c,		// I2C_Handle
 			req->buf,		// Pointer to data buffer
@@ -201,7 +634,7 @@ LOCAL ER read_data(T_HAL_I2C_DCB *p_dcb, T_DEVREQ *req)
 	}
 	if(hal_sts != HAL_OK) return E_BUSY;
 
-	err = tk_wai_flg(id_flgid, wflgptn, TWF_ANDW | TWF_BITCLR, &rflgptn, DEV_HAL_I2C_TMOUT);
+	err = tk_wai_flg(p_dcb->flgid, wflgptn, TWF_ANDW | TWF_BITCLR, &rflgptn, DEV_HAL_I2C_TMOUT);
 	if(err >= E_OK) {
 		err  = p_dcb->err;
 		if(err >= E_OK) req->asize = req->size;
@@ -213,22 +646,23 @@ LOCAL ER read_data(T_HAL_I2C_DCB *p_dcb, T_DEVREQ *req)
 LOCAL ER write_data(T_HAL_I2C_DCB *p_dcb, T_DEVREQ *req)
 {
 	HAL_StatusTypeDef	hal_sts;
+	T_HAL_I2C_XFER		xfer;
 	UINT			wflgptn, rflgptn;
 	ER			err;
 
-	wflgptn = 1 << p_dcb->unit;
-	tk_clr_flg(id_flgid, ~wflgptn);
-
 	switch(p_dcb->dmode) {
 	case HAL_I2C_MODE_CNT:
-		hal_sts = HAL_I2C_Master_Transmit_IT(
-			p_dcb->hi2c,		// I2C_Handle
-			(req->start)<<1,	// Target device address
-			req->buf,		// Pointer to data buffer
-			req->size		// Amount of data to be sent
-		);
-		break;
+		xfer.sadr	= req->start;	// Target device address
+		xfer.rasz	= 0;
+		xfer.sbuf	= req->buf;	// Pointer to data buffer
+		xfer.ssize	= req->size;	// Amount of data to be sent
+		xfer.rsize	= 0;
+		err = xfer_sync(p_dcb, &xfer);
+		if(err >= E_OK) req->asize = req->size;
+		return err;
 	case HAL_I2C_MODE_TAR:
+		wflgptn = FLGPTN_DONE;
+		tk_clr_flg(p_dcb->flgid, ~wflgptn);
 		hal_sts = HAL_I2C_Slave_Transmit_IT(
 			p_dcb->hi2c,		// I2C_Handle
 			req->buf,		// Pointer to data buffer
@@ -240,7 +674,7 @@ LOCAL ER write_data(T_HAL_I2C_DCB *p_dcb, T_DEVREQ *req)
 	}
 	if(hal_sts != HAL_OK) return E_BUSY;
 
-	err = tk_wai_flg(id_flgid, wflgptn, TWF_ANDW | TWF_BITCLR, &rflgptn, DEV_HAL_I2C_TMOUT);
+	err = tk_wai_flg(p_dcb->flgid, wflgptn, TWF_ANDW | TWF_BITCLR, &rflgptn, DEV_HAL_I2C_TMOUT);
 	if(err >= E_OK) {
 		err  = p_dcb->err;
 		if(err >= E_OK) req->asize = req->size;
@@ -249,6 +683,30 @@ LOCAL ER write_data(T_HAL_I2C_DCB *p_dcb, T_DEVREQ *req)
 	return err;
 }
 
+/* Write-then-read with repeated start (TDN_HAL_I2C_EXEC)
+ *	The receive is started in the send completion interrupt.
+ */
+LOCAL ER exec_data(T_HAL_I2C_DCB *p_dcb, T_DEVREQ *req)
+{
+	T_HAL_I2C_EXEC		*p_ex;
+	T_HAL_I2C_XFER		xfer;
+	ER			err;
+
+	if(req->size != sizeof(T_HAL_I2C_EXEC)) return E_PAR;
+	p_ex = (T_HAL_I2C_EXEC*)req->buf;
+	if(p_ex->snd_size <= 0 || p_ex->rcv_size <= 0) return E_PAR;
+
+	xfer.sadr	= p_ex->sadr;
+	xfer.rasz	= 0;
+	xfer.sbuf	= p_ex->snd_data;
+	xfer.ssize	= p_ex->snd_size;
+	xfer.rbuf	= p_ex->rcv_data;
+	xfer.rsize	= p_ex->rcv_size;
+	err = xfer_sync(p_dcb, &xfer);
+	if(err >= E_OK) req->asize = req->size;
+	return err;
+}
+
 /*----------------------------------------------------------------------
  * mSDI I/F function
  */
@@ -261,6 +719,7 @@ LOCAL ER dev_i2c_openfn( ID devid, UINT omode, T_MSDI *msdi)
 
 	p_dcb = (T_HAL_I2C_DCB*)(msdi->dmsdi.exinf);
 	p_dcb->omode = omode;
+	knl_memset(dev_i2c_dd, 0, sizeof(dev_i2c_dd));	// The dd may be reused
 	return E_OK;
 }
 
@@ -269,6 +728,7 @@ LOCAL ER dev_i2c_openfn( ID devid, UINT omode, T_MSDI *msdi)
  */
 LOCAL ER dev_i2c_closefn( ID devid, UINT option, T_MSDI *msdi)
 {
+	knl_memset(dev_i2c_dd, 0, sizeof(dev_i2c_dd));
 	return E_OK;
 }
 
@@ -302,6 +762,8 @@ LOCAL ER dev_i2c_writefn( T_DEVREQ *req, T_MSDI *p_msdi)
 
 	if(req->start >= 0) {
 		rtn = write_data( p_dcb, req);	// Device specific data
+	} else if(req->start == TDN_HAL_I2C_EXEC) {
+		rtn = exec_data( p_dcb, req);	// Write-then-read
 	} else {
 		rtn = write_atr( p_dcb, req);	// Device attribute data
 	}
@@ -329,6 +791,7 @@ EXPORT ER dev_init_hal_i2c( UW unit, I2C_HandleTypeDef *hi2c )
 	INT		i;
 
 	if( unit >= DEV_HAL_I2C_UNITNM) return E_PAR;
+	if( i2c_insno(hi2c->Instance) == 0) return E_PAR;
 
 #if TK_SUPPORT_MEMLIB
 	p_dcb = (T_HAL_I2C_DCB*)Kmalloc(sizeof(T_HAL_I2C_DCB));
@@ -338,12 +801,19 @@ EXPORT ER dev_init_hal_i2c( UW unit, I2C_HandleTypeDef *hi2c )
 	p_dcb = &dev_i2c_cb[unit];
 #endif
 
-	id_flgid = tk_cre_flg(&id_flg);
-	if(id_flgid <= E_OK) {
-		err = (ER)id_flgid;
+	p_dcb->flgid = tk_cre_flg(&id_flg);
+	if(p_dcb->flgid <= E_OK) {
+		err = (ER)p_dcb->flgid;
 		goto err_1;
 	}
 
+	p_dcb->semid = tk_cre_sem(&id_sem);
+	if(p_dcb->semid <= E_OK) {
+		err = (ER)p_dcb->semid;
+		goto err_2;
+	}
+	p_dcb->syncptn	= 0;
+
 	/* Device registration information */
 	dmsdi.exinf	= p_dcb;
 	dmsdi.drvatr	= 0;			/* Driver attributes */
@@ -362,16 +832,28 @@ EXPORT ER dev_init_hal_i2c( UW unit, I2C_HandleTypeDef *hi2c )
 	dmsdi.devnm[i+1] = 0;
 
 	err = msdi_def_dev( &dmsdi, &idev, &p_msdi);
-	if(err != E_OK) goto err_1;
+	if(err != E_OK) goto err_3;
 
 	p_dcb->hi2c	= hi2c;
 	p_dcb->devid	= p_msdi->devid;
 	p_dcb->unit	= unit;
 	p_dcb->evtmbfid	= idev.evtmbfid;
 	p_dcb->dmode	= HAL_I2C_MODE_CNT;
+	p_dcb->xfer_top	= NULL;
+	p_dcb->xfer_end	= NULL;
+	p_dcb->dmarx	= FALSE;
+	p_dcb->abort	= FALSE;
+	dev_i2c_ins[i2c_insno(hi2c->Instance)]	= p_dcb;
+#if DEV_HAL_I2C_INTCNT
+	i2c_def_intcnt(p_dcb);
+#endif
 
 	return E_OK;
 
+err_3:
+	tk_del_sem(p_dcb->semid);
+err_2:
+	tk_del_flg(p_dcb->flgid);
 err_1:
 #if TK_SUPPORT_MEMLIB
 	Kfree(p_dcb);
@@ -381,64 +863,111 @@ err_1:
 
 /*----------------------------------------------------------------------
  * I2C register access support function
+ *	The register address and the data block are transferred in one
+ *	transaction. (Read: Repeated start after the register address)
  */
-
-EXPORT ER i2c_read_reg(ID dd, UW sadr, UW radr, UB *data)
+/*
+ * DCB of the device descriptor
+ *	The device is looked up only at the first access with the dd.
+ *	After that, the DCB is taken from dev_i2c_dd[dd].
+ *	The cache is cleared when an I2C device is opened or closed.
+ */
+LOCAL T_HAL_I2C_DCB* i2c_get_dcb(ID dd)
 {
-	HAL_StatusTypeDef	hal_sts;
 	T_HAL_I2C_DCB		*p_dcb;
 	ID			devid;
 	UINT			unit;
-	UINT			wflgptn, rflgptn;
-	ER			err;
+
+	if(DD_CACHED(dd) && dev_i2c_dd[dd] != NULL) return dev_i2c_dd[dd];
 
 	devid = tk_oref_dev(dd, NULL);
+	if(devid < E_OK) return NULL;
 	for(unit = 0; unit <DEV_HAL_I2C_UNITNM; unit++) {
 		p_dcb = get_dcb_ptr(unit);
-		if(p_dcb->devid == devid) break;
+		if(p_dcb != NULL && p_dcb->devid == devid) {
+			if(DD_CACHED(dd)) dev_i2c_dd[dd] = p_dcb;
+			return p_dcb;
+		}
 	}
-	if(unit >= DEV_HAL_I2C_UNITNM) return E_ID;
+	return NULL;
+}
 
-	wflgptn = 1 << unit;
-	tk_clr_flg(id_flgid, ~wflgptn);
-	
-	hal_sts = HAL_I2C_Mem_Read_IT(p_dcb->hi2c, (uint16_t)(sadr<<1),
-					(uint16_t)radr, I2C_MEMADD_SIZE_8BIT, data, 1);
-	if(hal_sts != HAL_OK) return E_IO;
+LOCAL ER i2c_access_regs(ID dd, UW sadr, UW radr, UW rasz, UB *buf, SZ len, BOOL wr)
+{
+	T_HAL_I2C_DCB		*p_dcb;
+	T_HAL_I2C_XFER		xfer;
 
-	err = tk_wai_flg(id_flgid, wflgptn, TWF_ANDW | TWF_BITCLR, &rflgptn, DEV_HAL_I2C_TMOUT);
-	if(err >= E_OK) err  = p_dcb->err;
-	
-	return err;
+	if(len <= 0) return E_PAR;
+
+	p_dcb = i2c_get_dcb(dd);
+	if(p_dcb == NULL) return E_ID;
+
+	xfer.sadr	= sadr;
+	xfer.radr	= radr;
+	xfer.rasz	= rasz;
+	xfer.sbuf	= buf;
+	xfer.ssize	= wr? len: 0;
+	xfer.rbuf	= buf;
+	xfer.rsize	= wr? 0: len;
+
+	return xfer_sync(p_dcb, &xfer);
+}
+
+EXPORT ER i2c_read_reg(ID dd, UW sadr, UW radr, UB *data)
+{
+	return i2c_access_regs(dd, sadr, radr, 1, data, 1, FALSE);
 }
 
 EXPORT ER i2c_write_reg(ID dd, UW sadr, UW radr, UB data)
 {
-	HAL_StatusTypeDef	hal_sts;
+	return i2c_access_regs(dd, sadr, radr, 1, &data, 1, TRUE);
+}
+
+EXPORT ER i2c_read_regs(ID dd, UW sadr, UW radr, UB *buf, SZ len)
+{
+	return i2c_access_regs(dd, sadr, radr, 1, buf, len, FALSE);
+}
+
+EXPORT ER i2c_write_regs(ID dd, UW sadr, UW radr, CONST UB *buf, SZ len)
+{
+	return i2c_access_regs(dd, sadr, radr, 1, (UB*)buf, len, TRUE);
+}
+
+EXPORT ER i2c_read_regs16(ID dd, UW sadr, UW radr, UB *buf, SZ len)
+{
+	return i2c_access_regs(dd, sadr, radr, 2, buf, len, FALSE);
+}
+
+EXPORT ER i2c_write_regs16(ID dd, UW sadr, UW radr, CONST UB *buf, SZ len)
+{
+	return i2c_access_regs(dd, sadr, radr, 2, (UB*)buf, len, TRUE);
+}
+
+/*----------------------------------------------------------------------
+ * Asynchronous I2C transaction
+ *	The transaction is queued and executed in order of submission.
+ *	On completion, 'flgptn' is set to the event flag 'flgid' and
+ *	'cbf' is called in the task-independent part.
+ *	The descriptor must not be changed until the completion.
+ */
+EXPORT ER i2c_submit_xfer(ID dd, T_HAL_I2C_XFER *p_xfer)
+{
 	T_HAL_I2C_DCB		*p_dcb;
-	ID			devid;
-	UINT			unit;
-	UINT			wflgptn, rflgptn;
-	ER			err;
-	
-	devid = tk_oref_dev(dd, NULL);
-	for(unit = 0; unit <DEV_HAL_I2C_UNITNM; unit++) {
-		p_dcb = get_dcb_ptr(unit);
-		if(p_dcb->devid == devid) break;
-	}
-	if(unit >= DEV_HAL_I2C_UNITNM) return E_ID;
 
-	wflgptn = 1 << unit;
-	tk_clr_flg(id_flgid, ~wflgptn);
+	p_dcb = i2c_get_dcb(dd);
+	if(p_dcb == NULL) return E_ID;
 
-	hal_sts = HAL_I2C_Mem_Write_IT(p_dcb->hi2c, (uint16_t)(sadr<<1),
-					(uint16_t)radr, I2C_MEMADD_SIZE_8BIT, &data, 1);
-	if(hal_sts != HAL_OK) return E_IO;
+	return xfer_submit(p_dcb, p_xfer);
+}
 
-	err = tk_wai_flg(id_flgid, wflgptn, TWF_ANDW | TWF_BITCLR, &rflgptn, DEV_HAL_I2C_TMOUT);
-	if(err >= E_OK) err  = p_dcb->err;
-	
-	return err;
+EXPORT ER i2c_cancel_xfer(ID dd, T_HAL_I2C_XFER *p_xfer)
+{
+	T_HAL_I2C_DCB		*p_dcb;
+
+	p_dcb = i2c_get_dcb(dd);
+	if(p_dcb == NULL) return E_ID;
+
+	return xfer_cancel(p_dcb, p_xfer, FALSE);	// Only the waiting transaction
 }
 
 #endif		/* DEVCNF_USE_HAL_IIC */
@@ -31,7 +31,8 @@
  */
 #define TDN_HAL_I2C_MODE	(-100)	// I2C Mode
 #define TDN_HAL_I2C_TADR	(-101)	// Target Address
-#define TDN_HAL_I2C_MAX		(-101)
+#define TDN_HAL_I2C_INTCNT	(-103)	// Number of interrupts (DEV_HAL_I2C_INTCNT, Read only)
+#define TDN_HAL_I2C_MAX		(-104)	// (TDN_HAL_I2C_EXEC(-102) is defined in device.h)
 
 #define HAL_I2C_MODE_CNT	(0)	// I2C Mode: Controller mode	
 #define HAL_I2C_MODE_TAR	(1)	// I2C Mode: Target mode
@@ -47,5 +48,34 @@ IMPORT ER dev_init_hal_i2c( UW unit, I2C_HandleTypeDef *hi2c );
  */
 EXPORT ER i2c_read_reg(ID dd, UW sadr, UW radr, UB *data);
 EXPORT ER i2c_write_reg(ID dd, UW sadr, UW radr, UB data);
+EXPORT ER i2c_read_regs(ID dd, UW sadr, UW radr, UB *buf, SZ len);
+EXPORT ER i2c_write_regs(ID dd, UW sadr, UW radr, CONST UB *buf, SZ len);
+EXPORT ER i2c_read_regs16(ID dd, UW sadr, UW radr, UB *buf, SZ len);		// 16-bit register address
+EXPORT ER i2c_write_regs16(ID dd, UW sadr, UW radr, CONST UB *buf, SZ len);	// 16-bit register address
+
+/*----------------------------------------------------------------------
+ * Asynchronous I2C transaction (Controller mode)
+ *	Write: ssize > 0, Read: rsize > 0, Write-then-read: ssize > 0 and rsize > 0
+ *	Register access: rasz = 1 or 2 with either write or read
+ */
+typedef struct t_hal_i2c_xfer {
+	struct t_hal_i2c_xfer	*next;		// Queue link (Used by driver)
+	UW			sadr;		// Target address
+	UW			radr;		// Register address
+	UW			rasz;		// Register address size (0: None, 1: 8bit, 2: 16bit)
+	UB			*sbuf;		// Send data
+	SZ			ssize;		// Send data size
+	UB			*rbuf;		// Receive data buffer
+	SZ			rsize;		// Receive data size
+	void			(*cbf)(struct t_hal_i2c_xfer *p_xfer);	// Completion callback (NULL: None)
+	ID			flgid;		// Event flag set on completion (0: None)
+	UINT			flgptn;		// Event flag pattern
+	void			*exinf;		// Extended information for the callback
+	ER			err;		// Result
+	UINT			stat;		// Transaction status (Used by driver)
+} T_HAL_I2C_XFER;
+
+EXPORT ER i2c_submit_xfer(ID dd, T_HAL_I2C_XFER *p_xfer);
+EXPORT ER i2c_cancel_xfer(ID dd, T_HAL_I2C_XFER *p_xfer);
 
 #endif	/* _DEV_HAL_I2C_H_ */
\ No newline at end of file
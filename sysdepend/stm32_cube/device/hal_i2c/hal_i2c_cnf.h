@@ -24,4 +24,11 @@
 
 #define DEV_HAL_I2C_UNITNM	(5)
 
+/* DMA transfer (The DMA must be linked to the HAL handle by STM32CubeMX) */
+#define DEV_HAL_I2C_DMA_UNIT	(0x00)	// Units using DMA (bit n: unit n)
+#define DEV_HAL_I2C_DMA_SIZE	(32)	// Minimum data size for DMA transfer
+
+/* Interrupt count for the benchmark (Attribute data TDN_HAL_I2C_INTCNT) */
+#define DEV_HAL_I2C_INTCNT	(0)	// 1: Count the I2C and DMA interrupts  0: Not count
+
 #endif	/* _DEV_HAL_I2C_CNF_H_ */
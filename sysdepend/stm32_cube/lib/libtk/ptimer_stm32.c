@@ -25,6 +25,10 @@
 
 #if USE_PTMR
 
+#if USE_PTMR_CAPTURE
+#include <sysdepend/stm32_cube/device/device.h>
+#endif
+
 typedef struct {
 	UW	baddr;		// Register Base Address
 	UINT	mode;		// Timer mode
@@ -49,11 +53,63 @@ T_PTMRCB ptmrcb[TK_MAX_PTIMER] = {
 #define TIM_PSC(n)	(ptmrcb[n].baddr + TIMxPSC)
 #define TIM_ARR(n)	(ptmrcb[n].baddr + TIMxARR)
 
+#if USE_PTMR_CAPTURE
+/*
+ * Input-capture control block
+ */
+typedef struct {
+	UINT	ch;		// Capture channel (0: Not used)
+	UW	*capbuf;	// Capture ring buffer
+	INT	bufsz;		// Ring buffer size
+	INT	rdp;		// Read position
+	INT	wrp;		// Write position (Interrupt transfer)
+	DMA_HandleTypeDef *hdma;	// DMA handle (NULL: Interrupt transfer)
+} T_PTMRCAP;
+
+LOCAL T_PTMRCAP	ptmrcap[TK_MAX_PTIMER];
+
+#define TIM_CCMR(n,ch)	(ptmrcb[n].baddr + TIMxCCMR(ch))
+#define TIM_CCER(n)	(ptmrcb[n].baddr + TIMxCCER)
+#define TIM_CCR(n,ch)	(ptmrcb[n].baddr + TIMxCCR(ch))
+
+/*
+ * Store the capture value to the ring buffer (Interrupt transfer)
+ *	When the buffer is full, the new value is discarded.
+ */
+LOCAL void ptmr_cap_store( T_PTMRCB *p_cb, T_PTMRCAP *p_cap)
+{
+	UW	val;
+	INT	wrp;
+
+	val = in_w(p_cb->baddr + TIMxCCR(p_cap->ch));	// Read capture value. (Clear CCxIF)
+	wrp = p_cap->wrp + 1;
+	if(wrp >= p_cap->bufsz) wrp = 0;
+	if(wrp != p_cap->rdp) {
+		p_cap->capbuf[p_cap->wrp] = val;
+		p_cap->wrp = wrp;
+	}
+}
+#endif	/* USE_PTMR_CAPTURE */
+
 /*
  * Physical timer interrupt handler
  */
 LOCAL void ptmr_int_main( UINT intno, T_PTMRCB *p_cb)
 {
+#if USE_PTMR_CAPTURE
+	T_PTMRCAP	*p_cap = &ptmrcap[p_cb - ptmrcb];
+	UH		sr;
+
+	if(p_cap->ch != 0) {
+		sr = in_h(p_cb->baddr + TIMxSR);
+		if(sr & TIMxSR_CCIF(p_cap->ch)) {
+			ptmr_cap_store( p_cb, p_cap);
+		}
+		out_h(p_cb->baddr + TIMxSR, (UH)~sr);	// Clear interrupt flag
+		ClearInt( intno);
+		return;
+	}
+#endif	/* USE_PTMR_CAPTURE */
 	out_h(p_cb->baddr + TIMxSR, 0);			// Clear interrupt flag
 	ClearInt( intno);
 
@@ -93,6 +149,9 @@ EXPORT ER StartPhysicalTimer( UINT ptmrno, UW limit, UINT mode)
 
 	ptmrno--;
 	if(ptmrcb[ptmrno].baddr == (UW)NULL) return E_PAR;
+#if USE_PTMR_CAPTURE
+	if(ptmrcap[ptmrno].ch != 0) return E_OBJ;	// Used by the capture
+#endif
 
 	if(ptmrcb[ptmrno].tim32) {
 		limit_max = PTMR_MAX_CNT32;
@@ -137,6 +196,9 @@ EXPORT ER StopPhysicalTimer( UINT ptmrno )
 	ptmrno--;
 	if(ptmrcb[ptmrno].baddr == (UW)NULL) return E_PAR;
 
+#if USE_PTMR_CAPTURE
+	if(ptmrcap[ptmrno].ch != 0) return StopPhysicalTimerCapture( ptmrno + 1);
+#endif
 	/* Stop Physical Timer */
 	DisableInt( intno_tbl[ptmrno]);
 	out_h( TIM_CR1(ptmrno), 0);		// Stop timer.
@@ -202,5 +264,202 @@ EXPORT ER GetPhysicalTimerConfig(UINT ptmrno, T_RPTMR *pk_rptmr)
 	return E_OK;
 }
 
+#if USE_PTMR_CAPTURE
+/*
+ * Physical timer Input-capture API
+ *	The counter runs freely up to the maximum count, and the counter value
+ *	at each edge of the channel input is stored in the ring buffer.
+ *	With a DMA handle, the capture value is transferred by DMA without
+ *	interrupt. The DMA handle must be configured as circular mode,
+ *	peripheral to memory and word data width.
+ */
+EXPORT ER StartPhysicalTimerCapture( UINT ptmrno, CONST T_CPTMR *pk_cptmr )
+{
+	T_PTMRCAP	*p_cap;
+	T_DINT		dint;
+	UINT		ch, intno;
+	UW		ccmr, ccer;
+	ER		err;
+
+	/* parameter check */
+	if( ptmrno == 0 || ptmrno > TK_MAX_PTIMER || pk_cptmr == NULL ) return E_PAR;
+	ch = pk_cptmr->ch;
+	if(( ch == 0 || ch > 4 ) || ( pk_cptmr->capatr > TA_PTMR_CAP_BOTH )
+		|| ( pk_cptmr->capbuf == NULL ) || ( pk_cptmr->bufsz < 2 ))	return E_PAR;
+
+	ptmrno--;
+	if(ptmrcb[ptmrno].baddr == (UW)NULL) return E_PAR;
+
+	p_cap = &ptmrcap[ptmrno];
+	if(p_cap->ch != 0) return E_OBJ;
+
+	/* Timer initialization */
+	out_h( TIM_CR1(ptmrno), 0);			// Stop timer.
+	out_h( TIM_DIER(ptmrno), 0);
+	out_h( TIM_PSC(ptmrno), ptmrcb[ptmrno].psc);	// Set prescaler.
+	out_w( TIM_ARR(ptmrno), (ptmrcb[ptmrno].tim32)?PTMR_MAX_CNT32:PTMR_MAX_CNT16);
+	out_h( TIM_EGR(ptmrno), TIMxEGR_UG);		// Reload prescaler.
+
+	/* Capture channel setting */
+	ccer = in_w( TIM_CCER(ptmrno)) & ~TIMxCCER_MASK(ch);
+	out_w( TIM_CCER(ptmrno), ccer);			// Disable channel.
+	ccmr = in_w( TIM_CCMR(ptmrno, ch)) & ~(TIMxCCMR_MASK << TIMxCCMR_SHIFT(ch));
+	ccmr |= (TIMxCCMR_CCS_IN | TIMxCCMR_ICF(pk_cptmr->filter)) << TIMxCCMR_SHIFT(ch);
+	out_w( TIM_CCMR(ptmrno, ch), ccmr);
+	switch(pk_cptmr->capatr) {
+	case TA_PTMR_CAP_FALL:
+		ccer |= TIMxCCER_CCP(ch);
+		break;
+	case TA_PTMR_CAP_BOTH:
+		ccer |= TIMxCCER_CCP(ch) | TIMxCCER_CCNP(ch);
+		break;
+	default:
+		break;
+	}
+
+	p_cap->capbuf	= pk_cptmr->capbuf;
+	p_cap->bufsz	= pk_cptmr->bufsz;
+	p_cap->rdp	= 0;
+	p_cap->wrp	= 0;
+	p_cap->hdma	= (DMA_HandleTypeDef*)pk_cptmr->dmahdl;
+	p_cap->ch	= ch;
+	ptmrcb[ptmrno].mode = TA_CYC_PTMR;
+
+	intno = intno_tbl[ptmrno];
+	if(p_cap->hdma != NULL) {
+		/* DMA transfer */
+		DisableInt( intno);
+		if(HAL_DMA_Start( p_cap->hdma, TIM_CCR(ptmrno, ch),
+				(uint32_t)p_cap->capbuf, (uint32_t)p_cap->bufsz) != HAL_OK) {
+			p_cap->ch = 0;
+			return E_IO;
+		}
+		out_h( TIM_DIER(ptmrno), TIMxDIER_CCDE(ch));	// Enable Capture DMA request.
+	} else {
+		/* Interrupt transfer */
+		dint.intatr	= TA_HLNG;
+		dint.inthdr	= inthdr_tbl[ptmrno];
+		err = tk_def_int( intno, &dint);
+		if(err != E_OK) {
+			p_cap->ch = 0;
+			return err;
+		}
+		out_h( TIM_SR(ptmrno), 0);			// Clear Interrupt flag.
+		out_h( TIM_DIER(ptmrno), TIMxDIER_CCIE(ch));	// Enable Capture Interrupt.
+		EnableInt( intno, ptmrcb[ptmrno].intpri);
+	}
+
+	/* Start capture */
+	out_w( TIM_CCER(ptmrno), ccer | TIMxCCER_CCE(ch));	// Enable capture.
+	out_h( TIM_CR1(ptmrno), TIMxCR1_CEN);			// Start Timer.
+
+	return E_OK;
+}
+
+EXPORT ER StopPhysicalTimerCapture( UINT ptmrno )
+{
+	T_PTMRCAP	*p_cap;
+	UINT		ch;
+
+	/* parameter check */
+	if( ptmrno == 0 || ptmrno > TK_MAX_PTIMER ) return E_PAR;
+
+	ptmrno--;
+	if(ptmrcb[ptmrno].baddr == (UW)NULL) return E_PAR;
+
+	p_cap = &ptmrcap[ptmrno];
+	ch = p_cap->ch;
+	if(ch == 0) return E_OBJ;
+
+	/* Stop capture */
+	DisableInt( intno_tbl[ptmrno]);
+	out_h( TIM_CR1(ptmrno), 0);		// Stop timer.
+	out_h( TIM_DIER(ptmrno), 0);
+	out_w( TIM_CCER(ptmrno), in_w( TIM_CCER(ptmrno)) & ~TIMxCCER_MASK(ch));
+	if(p_cap->hdma != NULL) {
+		HAL_DMA_Abort( p_cap->hdma);
+	}
+	p_cap->ch = 0;
+
+	return E_OK;
+}
+
+/*
+ * Read the capture values
+ *	Returns the number of values read.
+ *	In DMA transfer, the ring buffer must be read before it is overwritten.
+ */
+EXPORT ER ReadPhysicalTimerCapture( UINT ptmrno, UW *buf, INT cnt )
+{
+	T_PTMRCAP	*p_cap;
+	UW		mask;
+	INT		rdp, wrp, n;
+	UINT		imask;
+
+	/* parameter check */
+	if( ptmrno == 0 || ptmrno > TK_MAX_PTIMER || buf == NULL || cnt < 0 ) return E_PAR;
+
+	ptmrno--;
+	if(ptmrcb[ptmrno].baddr == (UW)NULL) return E_PAR;
+
+	p_cap = &ptmrcap[ptmrno];
+	if(p_cap->ch == 0) return E_OBJ;
+
+	mask = (ptmrcb[ptmrno].tim32)?PTMR_MAX_CNT32:PTMR_MAX_CNT16;
+
+	DI(imask);
+	if(p_cap->hdma != NULL) {
+		wrp = p_cap->bufsz - (INT)__HAL_DMA_GET_COUNTER(p_cap->hdma);
+		if(wrp >= p_cap->bufsz) wrp = 0;
+	} else {
+		wrp = p_cap->wrp;
+	}
+	EI(imask);
+
+	rdp = p_cap->rdp;
+	for(n = 0; n < cnt && rdp != wrp; n++) {
+		buf[n] = p_cap->capbuf[rdp] & mask;
+		if(++rdp >= p_cap->bufsz) rdp = 0;
+	}
+	p_cap->rdp = rdp;
+
+	return (ER)n;
+}
+
+/*
+ * Physical timer Output-compare API
+ *	Sets the compare channel of the timer started by StartPhysicalTimer.
+ */
+EXPORT ER SetPhysicalTimerCompare( UINT ptmrno, CONST T_MPTMR *pk_mptmr )
+{
+	UINT		ch;
+	UW		ccmr, ccer;
+
+	/* parameter check */
+	if( ptmrno == 0 || ptmrno > TK_MAX_PTIMER || pk_mptmr == NULL ) return E_PAR;
+	ch = pk_mptmr->ch;
+	if(( ch == 0 || ch > 4 ) || ( pk_mptmr->cmpatr > TA_PTMR_CMP_PWM2 )) return E_PAR;
+
+	ptmrno--;
+	if(ptmrcb[ptmrno].baddr == (UW)NULL) return E_PAR;
+	if(ptmrcap[ptmrno].ch == ch) return E_OBJ;	// Used as capture channel
+	if(!ptmrcb[ptmrno].tim32 && pk_mptmr->cmpval > PTMR_MAX_CNT16) return E_PAR;
+
+	ccer = in_w( TIM_CCER(ptmrno)) & ~TIMxCCER_MASK(ch);
+	out_w( TIM_CCER(ptmrno), ccer);			// Disable channel.
+
+	ccmr = in_w( TIM_CCMR(ptmrno, ch)) & ~(TIMxCCMR_MASK << TIMxCCMR_SHIFT(ch));
+	ccmr |= (TIMxCCMR_OCM(pk_mptmr->cmpatr) | TIMxCCMR_OCPE) << TIMxCCMR_SHIFT(ch);
+	out_w( TIM_CCMR(ptmrno, ch), ccmr);
+	out_w( TIM_CCR(ptmrno, ch), pk_mptmr->cmpval);	// Set compare value.
+
+	if(pk_mptmr->cmpatr != TA_PTMR_CMP_FROZEN) {
+		out_w( TIM_CCER(ptmrno), ccer | TIMxCCER_CCE(ch));	// Enable output.
+	}
+
+	return E_OK;
+}
+#endif	/* USE_PTMR_CAPTURE */
+
 #endif	/* USE_PTMR */
 #endif	/* MTKBSP_STM32CUBE */
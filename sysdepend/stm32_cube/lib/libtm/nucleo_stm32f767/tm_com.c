@@ -43,18 +43,120 @@
 #define CR1_UE		(0x00000001)			/* Enable UART */
 #define CR1_RE		(0x00000004)			/* Enable reception */
 #define CR1_TE		(0x00000008)			/* Enable sending */
+#define CR1_TXEIE	(0x00000080)			/* TXE interrupt enable */
+#define CR1_OVER8	(0x00008000)			/* Oversampling by 8 */
+#define CR3_DMAT	(0x00000080)			/* DMA enable transmitter */
 
 #define ISR_TXE		(0x00000080)			/* Transmit data register empty */
 #define ISR_TC		(0x00000040)			/* Transmission complete */
 #define ISR_RXNE	(0x00000020)			/* Read data register not empty */
 
 /* Communication speed */
-#define UART_BAUD	(115200)			/* 115200 bps */
+#define UART_BAUD	(TM_COM_BAUD)			/* config_tm.h */
+
+#if USE_TM_TXBUF
+/*
+ * Buffered transmission (tm_txbuf.c)
+ */
+#include <sysdepend/stm32_cube/lib/libtm/tm_txbuf.h>
+
+EXPORT	const UINT	tm_com_intno = 39;		/* USART3 global interrupt */
+
+EXPORT	BOOL	tm_com_txready( void )
+{
+	return ((UART_ISR & ISR_TXE) != 0);
+}
+
+EXPORT	BOOL	tm_com_txdone( void )
+{
+	return ((UART_ISR & ISR_TC) != 0);
+}
+
+EXPORT	void	tm_com_txput( UB c )
+{
+	UART_TDR = c;
+}
+
+EXPORT	void	tm_com_txint( BOOL enable )
+{
+	if(enable) {
+		UART_CR1 |= CR1_TXEIE;
+	} else {
+		UART_CR1 &= ~CR1_TXEIE;
+	}
+}
+
+#if TM_TXBUF_DMA
+/*
+ * DMA transmission (USART3_TX: DMA1 Stream3 Channel4)
+ */
+#include <sysdepend/stm32_cube/device/device.h>
+
+#define INTNO_TMCOM_DMA	14				/* DMA1 Stream3 global interrupt */
+
+LOCAL	DMA_HandleTypeDef	tm_hdma;
+
+LOCAL	void	tm_com_dmacplt( DMA_HandleTypeDef *hdma )
+{
+	tm_txbuf_dmadone();
+}
+
+LOCAL	void	tm_com_dmaint( UINT intno )
+{
+	HAL_DMA_IRQHandler(&tm_hdma);
+}
+
+EXPORT	ER	tm_com_dmainit( void )
+{
+	T_DINT	dint;
+	ER	err;
+
+	__HAL_RCC_DMA1_CLK_ENABLE();
+
+	tm_hdma.Instance		= DMA1_Stream3;
+	tm_hdma.Init.Channel		= DMA_CHANNEL_4;
+	tm_hdma.Init.Direction		= DMA_MEMORY_TO_PERIPH;
+	tm_hdma.Init.PeriphInc		= DMA_PINC_DISABLE;
+	tm_hdma.Init.MemInc		= DMA_MINC_ENABLE;
+	tm_hdma.Init.PeriphDataAlignment	= DMA_PDATAALIGN_BYTE;
+	tm_hdma.Init.MemDataAlignment	= DMA_MDATAALIGN_BYTE;
+	tm_hdma.Init.Mode		= DMA_NORMAL;
+	tm_hdma.Init.Priority		= DMA_PRIORITY_LOW;
+	tm_hdma.Init.FIFOMode		= DMA_FIFOMODE_DISABLE;
+	if(HAL_DMA_Init(&tm_hdma) != HAL_OK) return E_IO;
+	tm_hdma.XferCpltCallback	= tm_com_dmacplt;
+
+	dint.intatr = TA_HLNG;
+	dint.inthdr = tm_com_dmaint;
+	err = tk_def_int(INTNO_TMCOM_DMA, &dint);
+	if(err < E_OK) return err;
+	EnableInt(INTNO_TMCOM_DMA, TM_TXBUF_INTPRI);
+
+	UART_CR3 |= CR3_DMAT;
+	return E_OK;
+}
+
+EXPORT	ER	tm_com_dmastart( const UB *buf, INT len )
+{
+	SCB_CleanDCache_by_Addr((uint32_t*)((UW)buf & ~0x1FUL), len + ((UW)buf & 0x1FUL));
+	if(HAL_DMA_Start_IT(&tm_hdma, (UW)buf, (UW)&UART_TDR, len) != HAL_OK) return E_IO;
+	return E_OK;
+}
+
+EXPORT	void	tm_com_dmawait( void )
+{
+	HAL_DMA_PollForTransfer(&tm_hdma, HAL_DMA_FULL_TRANSFER, HAL_MAX_DELAY);
+}
+#endif /* TM_TXBUF_DMA */
+#endif /* USE_TM_TXBUF */
 
 EXPORT	void	tm_snd_dat( const UB* buf, INT size )
 {
 	UB	*b;
 
+#if USE_TM_TXBUF
+	if(tm_txbuf_put(buf, size)) return;	/* Buffered */
+#endif
 	for( b = (UB *)buf; size > 0; size--, b++ ){
 		while ((UART_ISR & ISR_TXE) == 0 );
 		UART_TDR = *b;
@@ -75,7 +177,7 @@ UW get_pclk1(void);
 
 EXPORT	void	tm_com_init(void)
 {
-	UW	pclk1;
+	UW	pclk1, div, over8;
 
 	/* Initialize serial communication. Disable all interrupt. */
 	UART_CR1 = 0;		/* 8bit, Non parity (Reset value) */
@@ -84,9 +186,16 @@ EXPORT	void	tm_com_init(void)
 
 	/* Set baud rate */
 	pclk1 = halif_get_pclk1();
-	UART_BRR = (pclk1 + UART_BAUD/2)/UART_BAUD;
+	if(UART_BAUD > pclk1/16) {		/* High baud rate: Oversampling by 8 */
+		div = (pclk1*2 + UART_BAUD/2)/UART_BAUD;
+		UART_BRR = (div & 0xFFF0) | ((div & 0x000F) >> 1);
+		over8 = CR1_OVER8;
+	} else {
+		UART_BRR = (pclk1 + UART_BAUD/2)/UART_BAUD;
+		over8 = 0;
+	}
 
-	UART_CR1 = CR1_UE | CR1_RE |CR1_TE;	/* Start UART */
+	UART_CR1 = CR1_UE | CR1_RE |CR1_TE | over8;	/* Start UART */
 }
 
 #endif /* TM_COM_SERIAL_DEV */
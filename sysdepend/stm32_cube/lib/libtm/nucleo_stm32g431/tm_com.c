@@ -40,18 +40,118 @@
 #define CR1_UE		(1<<0)				/* UART enable */
 #define CR1_RE		(1<<2)				/* Receiver enable */
 #define CR1_TE		(1<<3)				/* Transmitter enable */
+#define CR1_TXEIE	(1<<7)				/* TXE interrupt enable */
+#define CR3_DMAT	(1<<7)				/* DMA enable transmitter */
 
 #define ISR_TXE		(1<<7)				/* Transmit data register empty */
 #define ISR_TC		(1<<6)				/* Transmission complete */
 #define ISR_RXNE	(1<<5)				/* Read data register not empty */
 
 /* Communication speed */
-#define UART_BAUD	(115200)			/* 115200 bps */
+#define UART_BAUD	(TM_COM_BAUD)			/* config_tm.h */
+
+#if USE_TM_TXBUF
+/*
+ * Buffered transmission (tm_txbuf.c)
+ */
+#include <sysdepend/stm32_cube/lib/libtm/tm_txbuf.h>
+
+EXPORT	const UINT	tm_com_intno = 91;		/* LPUART1 global interrupt */
+
+EXPORT	BOOL	tm_com_txready( void )
+{
+	return ((UART_ISR & ISR_TXE) != 0);
+}
+
+EXPORT	BOOL	tm_com_txdone( void )
+{
+	return ((UART_ISR & ISR_TC) != 0);
+}
+
+EXPORT	void	tm_com_txput( UB c )
+{
+	UART_TDR = c;
+}
+
+EXPORT	void	tm_com_txint( BOOL enable )
+{
+	if(enable) {
+		UART_CR1 |= CR1_TXEIE;
+	} else {
+		UART_CR1 &= ~CR1_TXEIE;
+	}
+}
+
+#if TM_TXBUF_DMA
+/*
+ * DMA transmission (LPUART1_TX: DMA1 Channel1 via DMAMUX1)
+ */
+#include <sysdepend/stm32_cube/device/device.h>
+
+#define INTNO_TMCOM_DMA	11				/* DMA1 Channel1 global interrupt */
+
+LOCAL	DMA_HandleTypeDef	tm_hdma;
+
+LOCAL	void	tm_com_dmacplt( DMA_HandleTypeDef *hdma )
+{
+	tm_txbuf_dmadone();
+}
+
+LOCAL	void	tm_com_dmaint( UINT intno )
+{
+	HAL_DMA_IRQHandler(&tm_hdma);
+}
+
+EXPORT	ER	tm_com_dmainit( void )
+{
+	T_DINT	dint;
+	ER	err;
+
+	__HAL_RCC_DMA1_CLK_ENABLE();
+	__HAL_RCC_DMAMUX1_CLK_ENABLE();
+
+	tm_hdma.Instance		= DMA1_Channel1;
+	tm_hdma.Init.Request		= DMA_REQUEST_LPUART1_TX;
+	tm_hdma.Init.Direction		= DMA_MEMORY_TO_PERIPH;
+	tm_hdma.Init.PeriphInc		= DMA_PINC_DISABLE;
+	tm_hdma.Init.MemInc		= DMA_MINC_ENABLE;
+	tm_hdma.Init.PeriphDataAlignment	= DMA_PDATAALIGN_BYTE;
+	tm_hdma.Init.MemDataAlignment	= DMA_MDATAALIGN_BYTE;
+	tm_hdma.Init.Mode		= DMA_NORMAL;
+	tm_hdma.Init.Priority		= DMA_PRIORITY_LOW;
+	if(HAL_DMA_Init(&tm_hdma) != HAL_OK) return E_IO;
+	tm_hdma.XferCpltCallback	= tm_com_dmacplt;
+
+	dint.intatr = TA_HLNG;
+	dint.inthdr = tm_com_dmaint;
+	err = tk_def_int(INTNO_TMCOM_DMA, &dint);
+	if(err < E_OK) return err;
+	EnableInt(INTNO_TMCOM_DMA, TM_TXBUF_INTPRI);
+
+	UART_CR3 |= CR3_DMAT;
+	return E_OK;
+}
+
+EXPORT	ER	tm_com_dmastart( const UB *buf, INT len )
+{
+	if(HAL_DMA_Start_IT(&tm_hdma, (UW)buf, (UW)&UART_TDR, len) != HAL_OK) return E_IO;
+	return E_OK;
+}
+
+EXPORT	void	tm_com_dmawait( void )
+{
+	HAL_DMA_PollForTransfer(&tm_hdma, HAL_DMA_FULL_TRANSFER, HAL_MAX_DELAY);
+}
+#endif /* TM_TXBUF_DMA */
+#endif /* USE_TM_TXBUF */
 
 EXPORT	void	tm_snd_dat( const UB* buf, INT size )
 {
 	UB	*b;
 
+#if USE_TM_TXBUF
+	if(tm_txbuf_put(buf, size)) return;	/* Buffered */
+#endif
 	for( b = (UB *)buf; size > 0; size--, b++ ){
 		while ((UART_ISR & ISR_TXE) == 0 );
 		UART_TDR = *b;
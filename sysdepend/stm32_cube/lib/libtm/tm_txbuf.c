@@ -0,0 +1,265 @@
+/*
+ *----------------------------------------------------------------------
+ *    micro T-Kernel 3.0 BSP 2.0
+ *
+ *    Copyright (C) 2023-2024 by Ken Sakamura.
+ *    This software is distributed under the T-License 2.1.
+ *----------------------------------------------------------------------
+ *
+ *    Released by TRON Forum(http://www.tron.org) at 2024/08.
+ *
+ *----------------------------------------------------------------------
+ */
+
+/*
+ *    tm_txbuf.c
+ *    T-Monitor buffered transmission (STM32Cube)
+ *
+ *    tm_snd_dat() copies the data to the ring buffer and returns.
+ *    The UART transmit interrupt or DMA sends the buffered data.
+ *    In DMA mode, a contiguous block of the buffer is transmitted while
+ *    the free area of the buffer is filled with the next data.
+ */
+
+#include <tk/tkernel.h>
+
+#if USE_TMONITOR
+#include <mtkernel/lib/libtm/libtm.h>
+
+#ifdef MTKBSP_STM32CUBE
+#if TM_COM_SERIAL_DEV && USE_TM_TXBUF
+
+#include <tm/tmonitor.h>
+#include <sys/sysdef.h>
+#include <sysdepend/stm32_cube/lib/libtm/tm_txbuf.h>
+
+#if (TM_TXBUF_SZ & (TM_TXBUF_SZ - 1)) != 0
+#error "TM_TXBUF_SZ must be a power of 2."
+#endif
+
+#define TM_TXBUF_MASK	(TM_TXBUF_SZ - 1)
+
+/* Transmission state */
+#define TXBUF_POLL	0		/* Not started. Send by polling */
+#define TXBUF_ACTIVE	1		/* Send by transmit interrupt or DMA */
+#define TXBUF_SYNC	2		/* Flushed. Send by polling */
+
+#if TM_TXBUF_DMA && defined(DMABUF_SECTION)
+LOCAL UB	txbuf[TM_TXBUF_SZ]	/* Transmit ring buffer (DMA accessible memory) */
+			__attribute__((section(DMABUF_SECTION)));
+#else
+LOCAL UB	txbuf[TM_TXBUF_SZ];	/* Transmit ring buffer */
+#endif
+LOCAL UW	txbuf_wp;		/* Write position (tm_snd_dat) */
+LOCAL UW	txbuf_rp;		/* Read position (Transmit interrupt) */
+LOCAL INT	txbuf_stat = TXBUF_POLL;
+#if TM_TXBUF_DMA
+LOCAL INT	txbuf_dmalen;		/* Transfer size of DMA (0: DMA stopped) */
+#endif
+
+/*
+ * Check fault exception (NMI, HardFault, MemManage, BusFault, UsageFault)
+ *	The transmit interrupt can not be executed from the fault handler.
+ */
+LOCAL BOOL in_fault_exc( void )
+{
+	UW	ipsr;
+
+	Asm("mrs %0, ipsr": "=r"(ipsr));
+	return (ipsr >= 2 && ipsr <= 6);
+}
+
+#if TM_TXBUF_BLOCK
+/*
+ * Check whether the caller can wait (Task context only)
+ */
+LOCAL BOOL can_wait( void )
+{
+	T_RSYS	rsys;
+
+	if(tk_ref_sys(&rsys) != E_OK) return FALSE;
+	return (rsys.sysstat == TSS_TSK);
+}
+#endif
+
+#if TM_TXBUF_DMA
+/*
+ * Start the DMA transfer of the buffered data
+ *	Called with interrupt disabled.
+ *	If the DMA can not be started, the buffered data is sent by polling
+ *	and T-Monitor sends by polling after that (TXBUF_SYNC).
+ */
+LOCAL void txbuf_dmastart( void )
+{
+	INT	len;
+
+	if(txbuf_dmalen != 0 || txbuf_rp == txbuf_wp) return;
+
+	len = (INT)(txbuf_wp - txbuf_rp);
+	if(len > TM_TXBUF_SZ - (INT)(txbuf_rp & TM_TXBUF_MASK)) {
+		len = TM_TXBUF_SZ - (INT)(txbuf_rp & TM_TXBUF_MASK);	/* Up to the end of the buffer */
+	}
+	txbuf_dmalen = len;
+	if(tm_com_dmastart(&txbuf[txbuf_rp & TM_TXBUF_MASK], len) < E_OK) {
+		txbuf_dmalen = 0;
+		tm_com_flush();
+	}
+}
+
+/*
+ * DMA transfer complete (Called from DMA interrupt handler)
+ */
+EXPORT void tm_txbuf_dmadone( void )
+{
+	UINT	imask;
+
+	DI(imask);
+	txbuf_rp += txbuf_dmalen;
+	txbuf_dmalen = 0;
+	if(txbuf_stat == TXBUF_ACTIVE) txbuf_dmastart();
+	EI(imask);
+}
+
+#else
+/*
+ * UART transmit interrupt handler
+ */
+LOCAL void txbuf_inthdr( UINT intno )
+{
+	UINT	imask;
+
+	while(tm_com_txready()) {
+		DI(imask);
+		if(txbuf_rp == txbuf_wp) {	/* Buffer empty */
+			tm_com_txint(FALSE);
+			EI(imask);
+			break;
+		}
+		tm_com_txput(txbuf[txbuf_rp & TM_TXBUF_MASK]);
+		txbuf_rp++;
+		EI(imask);
+	}
+}
+#endif /* TM_TXBUF_DMA */
+
+/*
+ * Write to the transmit buffer (Called from tm_snd_dat)
+ *	When the buffer is full, the remaining data is discarded.
+ *	If TM_TXBUF_BLOCK is valid, the task waits for free space.
+ */
+EXPORT BOOL tm_txbuf_put( const UB *buf, INT size )
+{
+	UINT	imask;
+	INT	n;
+
+	if(txbuf_stat != TXBUF_ACTIVE) return FALSE;
+	if(in_fault_exc()) {
+		tm_com_flush();
+		return FALSE;
+	}
+
+	while(size > 0) {
+		DI(imask);
+		if(txbuf_stat != TXBUF_ACTIVE) {	/* Flushed. Send the rest by polling */
+			EI(imask);
+			for( ; size > 0; size--) {
+				while(!tm_com_txready());
+				tm_com_txput(*buf++);
+			}
+			break;
+		}
+		n = TM_TXBUF_SZ - (INT)(txbuf_wp - txbuf_rp);
+		if(n > size) n = size;
+		size -= n;
+		if(n > 0) {
+			for( ; n > 0; n--) {
+				txbuf[txbuf_wp & TM_TXBUF_MASK] = *buf++;
+				txbuf_wp++;
+			}
+#if TM_TXBUF_DMA
+			txbuf_dmastart();
+#else
+			tm_com_txint(TRUE);
+#endif
+		}
+		EI(imask);
+
+		if(size > 0) {			/* Buffer full */
+#if TM_TXBUF_BLOCK
+			if(can_wait() && tk_dly_tsk(1) == E_OK) continue;
+#endif
+			break;			/* Discard */
+		}
+	}
+	return TRUE;
+}
+
+/*
+ * Flush the transmit buffer synchronously
+ *	For the panic path (e.g. Fault handler).
+ *	After that, T-Monitor sends the data by polling.
+ */
+EXPORT void tm_com_flush( void )
+{
+	UINT	imask;
+
+	DI(imask);
+	if(txbuf_stat == TXBUF_ACTIVE) {
+#if TM_TXBUF_DMA
+		if(txbuf_dmalen != 0) {		/* Wait for the current DMA transfer */
+			tm_com_dmawait();
+			txbuf_rp += txbuf_dmalen;
+			txbuf_dmalen = 0;
+		}
+#else
+		tm_com_txint(FALSE);
+#endif
+		txbuf_stat = TXBUF_SYNC;
+		while(txbuf_rp != txbuf_wp) {
+			while(!tm_com_txready());
+			tm_com_txput(txbuf[txbuf_rp & TM_TXBUF_MASK]);
+			txbuf_rp++;
+		}
+	}
+	while(!tm_com_txdone());
+	EI(imask);
+}
+
+/*
+ * Start buffered transmission
+ *	Called after micro T-Kernel starts. Until then, data is sent by polling.
+ */
+EXPORT ER tm_com_start_txbuf( void )
+{
+#if !TM_TXBUF_DMA
+	T_DINT	dint;
+#endif
+	ER	err;
+
+	if(txbuf_stat != TXBUF_POLL) return E_OBJ;
+
+#if TM_TXBUF_DMA
+#ifdef DMABUF_REACHABLE
+	/* The DMA can not access the buffer. Keep sending by polling. */
+	if(!DMABUF_REACHABLE(txbuf)) return E_OK;
+#endif
+	err = tm_com_dmainit();
+	if(err < E_OK) return err;
+
+	txbuf_stat = TXBUF_ACTIVE;
+#else
+	dint.intatr = TA_HLNG;
+	dint.inthdr = txbuf_inthdr;
+	err = tk_def_int(tm_com_intno, &dint);
+	if(err < E_OK) return err;
+
+	txbuf_stat = TXBUF_ACTIVE;
+	EnableInt(tm_com_intno, TM_TXBUF_INTPRI);
+#endif
+
+	return E_OK;
+}
+
+#endif /* TM_COM_SERIAL_DEV && USE_TM_TXBUF */
+#endif /* MTKBSP_STM32CUBE */
+#endif /* USE_TMONITOR */
@@ -0,0 +1,38 @@
+/*
+ *----------------------------------------------------------------------
+ *    micro T-Kernel 3.0 BSP 2.0
+ *
+ *    Copyright (C) 2023-2024 by Ken Sakamura.
+ *    This software is distributed under the T-License 2.1.
+ *----------------------------------------------------------------------
+ *
+ *    Released by TRON Forum(http://www.tron.org) at 2024/08.
+ *
+ *----------------------------------------------------------------------
+ */
+
+/*
+ *	tm_txbuf.h
+ *	T-Monitor buffered transmission (STM32Cube)
+ */
+
+#ifndef _MTKBSP_TM_TXBUF_H_
+#define _MTKBSP_TM_TXBUF_H_
+
+/* Transmit buffer (tm_txbuf.c) */
+IMPORT BOOL tm_txbuf_put( const UB *buf, INT size );	/* FALSE: Not buffered, send by polling */
+IMPORT void tm_txbuf_dmadone( void );			/* DMA transfer complete */
+
+/* UART dependent functions (tm_com.c) */
+IMPORT const UINT tm_com_intno;			/* UART interrupt number */
+IMPORT BOOL tm_com_txready( void );		/* Transmit data register empty */
+IMPORT BOOL tm_com_txdone( void );		/* Transmission complete */
+IMPORT void tm_com_txput( UB c );		/* Write transmit data register */
+IMPORT void tm_com_txint( BOOL enable );	/* Enable/Disable transmit interrupt */
+#if TM_TXBUF_DMA
+IMPORT ER tm_com_dmainit( void );		/* Initialize transmit DMA */
+IMPORT ER tm_com_dmastart( const UB *buf, INT len );	/* Start DMA transfer */
+IMPORT void tm_com_dmawait( void );		/* Wait for DMA transfer complete (Polling) */
+#endif
+
+#endif /* _MTKBSP_TM_TXBUF_H_ */
@@ -38,7 +38,7 @@ EXPORT void knl_set_reg( TCB *tcb, CONST T_REGS *regs, CONST T_EIT *eit, CONST T
 	SStackFrame	*ssp;
 	INT	i;
 
-#if USE_FPU
+#if USE_FPU && !USE_LAZYFPU
 	UW		*tmpp;
 
 	tmpp = (UW*)(( cregs != NULL )? cregs->ssp: tcb->tskctxb.ssp);
@@ -83,7 +83,7 @@ EXPORT void knl_get_reg( TCB *tcb, T_REGS *regs, T_EIT *eit, T_CREGS *cregs )
 	SStackFrame	*ssp;
 	INT		i;
 
-#if USE_FPU
+#if USE_FPU && !USE_LAZYFPU
 	UW		*tmpp;
 
 	tmpp = (UW*)tcb->tskctxb.ssp;
@@ -121,6 +121,110 @@ EXPORT void knl_get_reg( TCB *tcb, T_REGS *regs, T_EIT *eit, T_CREGS *cregs )
 	}
 }
 
+#if USE_LAZYFPU
+#if !USE_FPU
+#error "USE_LAZYFPU requires USE_FPU."
+#endif
+/* ------------------------------------------------------------------------ */
+/*
+ * Lazy FPU context switching
+ *	The FPU is enabled by the dispatcher only while the FPU owner task runs.
+ *	The FPU registers are saved to the area of the owner, and loaded from
+ *	the area of the new owner, when another task executes the FPU
+ *	instruction (UsageFault NOCP). The FPU context is not stacked on the
+ *	exception entry (FPCCR.ASPEN = 0), so the interrupt handlers must not
+ *	use the FPU.
+ */
+EXPORT TCB	*knl_fpu_owner;				/* Task that owns the FPU registers */
+EXPORT FPUCTX	knl_fpu_ctx[MAX_TSKID - MIN_TSKID + 1];	/* FPU context of each task ID */
+
+LOCAL void fpu_enable( BOOL enable )
+{
+	if(enable) {
+		out_w(FPU_CPACR, in_w(FPU_CPACR) | FPU_CPACR_FPUENABLE);
+	} else {
+		out_w(FPU_CPACR, in_w(FPU_CPACR) & ~FPU_CPACR_FPUENABLE);
+	}
+	Asm("dsb");
+	Asm("isb");
+}
+
+LOCAL void fpu_save( FPUCTX *ctx )
+{
+	UW	fpscr;
+
+	Asm("vstmia %0, {s0-s31}" :: "r"(ctx->s) : "memory");
+	Asm("vmrs %0, fpscr" : "=r"(fpscr));
+	ctx->fpscr = fpscr;
+}
+
+LOCAL void fpu_load( FPUCTX *ctx )
+{
+	Asm("vldmia %0, {s0-s31}" :: "r"(ctx->s) : "memory");
+	Asm("vmsr fpscr, %0" :: "r"(ctx->fpscr));
+}
+
+/*
+ * Hand over the FPU to 'ctxtsk' (Called from knl_fpu_nocp_hdr)
+ */
+EXPORT void knl_fpu_switch( void )
+{
+	fpu_enable(TRUE);
+	if(knl_fpu_owner == knl_ctxtsk) return;
+
+	if(knl_fpu_owner != NULL) {
+		fpu_save(knl_fpu_ctxp(knl_fpu_owner));
+	}
+	if(knl_ctxtsk != NULL) {
+		fpu_load(knl_fpu_ctxp(knl_ctxtsk));
+		knl_fpu_ctxp(knl_ctxtsk)->handoff++;
+	}
+	knl_fpu_owner = knl_ctxtsk;
+}
+
+/*
+ * Save the FPU registers of the owner task to its area
+ *	Called in the critical section. The FPU is disabled, and the owner
+ *	loads the registers again when it uses the FPU next time.
+ */
+LOCAL void fpu_flush( void )
+{
+	if(knl_fpu_owner == NULL) return;
+
+	fpu_enable(TRUE);
+	fpu_save(knl_fpu_ctxp(knl_fpu_owner));
+	knl_fpu_owner = NULL;
+	fpu_enable(FALSE);
+}
+
+/*
+ * Refer the task FPU usage (BSP extension)
+ */
+EXPORT ER GetFpuUsage( ID tskid, T_RFPUUSE *pk_rfpuuse )
+{
+	TCB	*tcb;
+	ER	ercd = E_OK;
+
+	if(tskid == TSK_SELF) {
+		if(in_indp()) return E_ID;
+	} else if(tskid < MIN_TSKID || tskid > MAX_TSKID) {
+		return E_ID;
+	}
+	tcb = get_tcb_self(tskid);
+
+	BEGIN_CRITICAL_SECTION;
+	if(tcb->state == TS_NONEXIST) {
+		ercd = E_NOEXS;
+	} else {
+		pk_rfpuuse->handoff	= knl_fpu_ctxp(tcb)->handoff;
+		pk_rfpuuse->owner	= (knl_fpu_owner == tcb);
+	}
+	END_CRITICAL_SECTION;
+
+	return ercd;
+}
+#endif /* USE_LAZYFPU */
+
 #if USE_FPU
 #ifdef USE_FUNC_TK_SET_CPR
 /* ------------------------------------------------------------------------ */
@@ -129,6 +233,23 @@ EXPORT void knl_get_reg( TCB *tcb, T_REGS *regs, T_EIT *eit, T_CREGS *cregs )
  */
 EXPORT ER knl_set_cpr( TCB *tcb, INT copno, CONST T_COPREGS *copregs)
 {
+#if USE_LAZYFPU
+	FPUCTX	*ctx;
+	INT	i;
+
+	ctx = knl_fpu_ctxp(tcb);
+	if(ctx->handoff == 0) {		/* FPU is not used */
+		return E_PAR;
+	}
+	if(knl_fpu_owner == tcb) fpu_flush();
+
+	for ( i = 0; i < 32; ++i ) {
+		ctx->s[i] = copregs->s[i];
+	}
+	ctx->fpscr = copregs->fpscr;
+
+	return E_OK;
+#else
 	SStackFrame_wFPU	*ssp;
 	INT	i;
 
@@ -145,6 +266,7 @@ EXPORT ER knl_set_cpr( TCB *tcb, INT copno, CONST T_COPREGS *copregs)
 	ssp->fpscr = copregs->fpscr;
 
 	return E_OK;
+#endif
 }
 
 #endif /* USE_FUNC_TK_SET_CPR */
@@ -156,6 +278,23 @@ EXPORT ER knl_set_cpr( TCB *tcb, INT copno, CONST T_COPREGS *copregs)
  */
 EXPORT ER knl_get_cpr( TCB *tcb, INT copno, T_COPREGS *copregs)
 {
+#if USE_LAZYFPU
+	FPUCTX	*ctx;
+	INT	i;
+
+	ctx = knl_fpu_ctxp(tcb);
+	if(ctx->handoff == 0) {		/* FPU is not used */
+		return E_PAR;
+	}
+	if(knl_fpu_owner == tcb) fpu_flush();
+
+	for ( i = 0; i < 32; ++i ) {
+		copregs->s[i] = ctx->s[i];
+	}
+	copregs->fpscr = ctx->fpscr;
+
+	return E_OK;
+#else
 	SStackFrame_wFPU	*ssp;
 	INT	i;
 
@@ -172,11 +311,52 @@ EXPORT ER knl_get_cpr( TCB *tcb, INT copno, T_COPREGS *copregs)
 	copregs->fpscr = ssp->fpscr;
 
 	return E_OK;
+#endif
 }
 #endif /* USE_FUNC_TK_GET_CPR */
 #endif /* USE_FPU */
 
 
+#if USE_STKUSE
+/* ------------------------------------------------------------------------ */
+/*
+ * Refer the task stack usage (BSP extension)
+ *	The painted words not changed from the bottom of the stack are unused.
+ *	The stack guard region (USE_SPMON) is not read.
+ */
+EXPORT ER GetStackUsage( ID tskid, T_RSTKUSE *pk_rstkuse )
+{
+	TCB	*tcb;
+	UW	*stk, *top;
+	ER	ercd = E_OK;
+
+	if(tskid == TSK_SELF) {
+		if(in_indp()) return E_ID;
+	} else if(tskid < MIN_TSKID || tskid > MAX_TSKID) {
+		return E_ID;
+	}
+	tcb = get_tcb_self(tskid);
+
+	BEGIN_CRITICAL_SECTION;
+	if(tcb->state == TS_NONEXIST) {
+		ercd = E_NOEXS;
+	} else {
+		stk = (UW*)(tcb->isstack - tcb->sstksz);
+#if USE_SPMON
+		stk = (UW*)((((UW)stk + STKGUARD_OFS + STKGUARD_SIZE - 1) & ~(STKGUARD_SIZE - 1)) + STKGUARD_SIZE);
+#endif
+		top = (UW*)tcb->isstack;
+		while(stk < top && *stk == STKUSE_PATTERN) stk++;
+
+		pk_rstkuse->stksz	= tcb->sstksz;
+		pk_rstkuse->used	= (SZ)((UW)top - (UW)stk);
+	}
+	END_CRITICAL_SECTION;
+
+	return ercd;
+}
+#endif /* USE_STKUSE */
+
 /* ----------------------------------------------------------------------- */
 /*
  *	Task dispatcher startup
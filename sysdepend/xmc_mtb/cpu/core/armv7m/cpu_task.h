@@ -62,6 +62,27 @@ typedef struct {
 
 #endif /* USE_FPU */
 
+#if USE_LAZYFPU
+/*
+ * FPU context of the task (Lazy FPU context switching)
+ *	The FPU registers are saved here when another task takes over the FPU.
+ */
+typedef struct {
+	UW	s[32];		/* S0-S31 */
+	UW	fpscr;		/* fpscr */
+	UW	handoff;	/* Number of times the task took over the FPU */
+} FPUCTX;
+
+IMPORT TCB	*knl_fpu_owner;	/* Task that owns the FPU registers */
+IMPORT FPUCTX	knl_fpu_ctx[];	/* FPU context of each task ID */
+
+#define knl_fpu_ctxp(tcb)	(&knl_fpu_ctx[(tcb)->tskid - MIN_TSKID])
+#endif /* USE_LAZYFPU */
+
+#if USE_STKUSE
+#define STKUSE_PATTERN		0xCCCCCCCC	/* Stack painting pattern */
+#endif
+
 /*
  * Create stack frame for task startup
  *	Call from 'make_dormant()'
@@ -69,6 +90,9 @@ typedef struct {
 Inline void knl_setup_context( TCB *tcb )
 {
 	SStackFrame	*ssp;
+#if USE_STKUSE
+	UW		*stk;
+#endif
 
 	ssp = tcb->isstack;
 	ssp--;
@@ -81,9 +105,31 @@ Inline void knl_setup_context( TCB *tcb )
 
 	tcb->tskctxb.ssp = ssp;		/* System stack pointer */
 
+#if USE_SPMON
+	tcb->tskctxb.spsa = tcb->isstack - tcb->sstksz;
+	tcb->tskctxb.spea = tcb->isstack + sizeof(UW) - 1;
+#endif
+
+#if USE_STKUSE
+	/* Paint the stack for the usage measurement (GetStackUsage).
+	   Not painted when the running task exits to DORMANT (tk_ext_tsk). */
+	if(tcb != knl_ctxtsk) {
+		for(stk = (UW*)(tcb->isstack - tcb->sstksz); stk < (UW*)ssp; stk++) {
+			*stk = STKUSE_PATTERN;
+		}
+	}
+#endif
+
 #if USE_FPU && ALWAYS_FPU_ATR
 	tcb->tskatr |= TA_FPU;		/* Always set the TA_FPU attribute on all tasks */
 #endif
+
+#if USE_LAZYFPU
+	/* The FPU registers of the previous task are discarded */
+	if(knl_fpu_owner == tcb) knl_fpu_owner = NULL;
+	knl_fpu_ctxp(tcb)->fpscr	= in_w(FPU_FPDSCR);	/* Initial fpscr */
+	knl_fpu_ctxp(tcb)->handoff	= 0;
+#endif
 }
 
 /*
@@ -115,6 +161,9 @@ Inline void knl_cleanup_context( TCB *tcb )
 		Asm("msr control, %0"::"r"(control));
 	}
 #endif
+#if USE_LAZYFPU
+	if(knl_fpu_owner == tcb) knl_fpu_owner = NULL;	/* Release the FPU */
+#endif
 }
 
 #endif /* _SYSDEPEND_CPU_CORE_CPUTASK_ */
@@ -48,6 +48,76 @@ EXPORT void		*knl_sysmem_top	= 0;
 EXPORT void		*knl_sysmem_end	= 0;
 #endif
 
+/*
+ * Set the MPU regions
+ *	The memory regions with MRA_NOCACHE (sysdef.h) are set to Normal,
+ *	Non-cacheable memory for the DMA descriptors and buffers. The MPU
+ *	regions are used from the highest number, and the regions set by the
+ *	application are not changed. The region size must be a power of 2,
+ *	and the start address must be aligned to the size.
+ *	The stack guard region (USE_SPMON) is set by the dispatcher.
+ */
+LOCAL void setup_mpu(void)
+{
+	T_RMEMRGN	rgn;
+	UW		sz;
+	INT		i, rno;
+	BOOL		ena = FALSE;
+
+	rno = MPU_TYPE_DREGION(in_w(MPU_TYPE));
+	for(i = 0; MemRgnRef(i, &rgn) == E_OK; i++) {
+		if((rgn.attr & MRA_NOCACHE) == 0) continue;
+		for(sz = 5; ((UW)1 << sz) < (UW)rgn.size; sz++);
+		if(((UW)1 << sz) != (UW)rgn.size || ((UW)rgn.start & (rgn.size - 1)) != 0) continue;
+
+		rno--;
+#if USE_SPMON
+		if(rno == MPU_RGN_STKGUARD) rno--;
+#endif
+		if(rno < 0) break;
+
+		DCacheFlush(rgn.start, rgn.size);		// Write back the cached data
+		out_w(MPU_RNR, rno);
+		out_w(MPU_RBAR, (UW)rgn.start);
+		out_w(MPU_RASR, MPU_RASR_XN | MPU_RASR_AP_RW | MPU_RASR_NOCACHE
+						| MPU_RASR_SIZE(sz) | MPU_RASR_ENABLE);
+		ena = TRUE;
+	}
+#if USE_SPMON
+	out_w(MPU_RNR, MPU_RGN_STKGUARD);
+	out_w(MPU_RASR, 0);
+	ena = TRUE;
+#endif
+	if(ena) {
+		out_w(MPU_CTRL, in_w(MPU_CTRL) | MPU_CTRL_PRIVDEFENA | MPU_CTRL_ENABLE);
+		Asm("dsb");
+		Asm("isb");
+	}
+}
+
+#if USE_LAZYFPU
+/*
+ * Set the lazy FPU context switching
+ *	The FPU is disabled, and enabled for the task by the UsageFault (NOCP)
+ *	handler. The FPU context is not stacked on the exception entry.
+ */
+LOCAL void setup_lazyfpu(void)
+{
+	UW	control;
+
+	knl_exctbl[EXP_USF] = (UW)knl_fpu_nocp_hdr;	// FPU access exception handler
+	out_w(SCB_SHCSR, in_w(SCB_SHCSR) | SHCSR_USGFAULTENA);
+	out_w(FPU_FPCCR, in_w(FPU_FPCCR) & ~(FPU_FPCCR_ASPEN | FPU_FPCCR_LSPEN));
+
+	Asm("mrs %0, control":"=r"(control));		// Clear CONTROL.FPCA
+	Asm("msr control, %0"::"r"(control & ~(1<<2)));
+
+	out_w(FPU_CPACR, in_w(FPU_CPACR) & ~FPU_CPACR_FPUENABLE);
+	Asm("dsb");
+	Asm("isb");
+}
+#endif
+
 EXPORT void knl_start_mtkernel(void)
 {
 	UW	*src, *top;
@@ -74,6 +144,11 @@ EXPORT void knl_start_mtkernel(void)
 	out_w(SCB_SHPR2, SCB_SHPR2_VAL);			// SVC pri = 0
 	out_w(SCB_SHPR3, SCB_SHPR3_VAL);			// SysTick = 1 , PendSV = 7
 
+	setup_mpu();						// Non-cacheable regions & Stack guard
+#if USE_LAZYFPU
+	setup_lazyfpu();					// Lazy FPU context switching
+#endif
+
 	knl_sysclk	= halif_get_sysclk();			// Get System clock frequency
 
 #if USE_IMALLOC
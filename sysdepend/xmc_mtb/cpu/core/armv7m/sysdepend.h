@@ -42,6 +42,9 @@ IMPORT void Default_Handler(void);		/* Default Handler (Undefine Interrupt) */
  */
 IMPORT void knl_dispatch_entry(void);		/* dispatch entry */
 IMPORT void knl_dispatch_to_schedtsk(void);	/* force dispatch */
+#if USE_LAZYFPU
+IMPORT void knl_fpu_nocp_hdr(void);		/* FPU access exception handler */
+#endif
 
 /*
  * Interrupt Control (interrupt.c)
@@ -57,6 +60,11 @@ IMPORT void knl_systim_inthdr(void);		/* System-timer Interrupt handler */
  */
 typedef struct {
 	void	*ssp;		/* System stack pointer */
+
+#if USE_SPMON
+	void	*spsa;		/* Stack stat address */
+	void	*spea;		/* Stack end address */
+#endif
 } CTXB;
 
 /*
@@ -23,6 +23,7 @@
 #include "cpu_status.h"
 
 #include <sysdepend/xmc_mtb/lib/libtk/cpu/core/armv7m/int_armv7m.h>
+#include <sysdepend/xmc_mtb/cpu/core/armv7m/int_stat.h>
 
 #include <cy_syslib.h>
 
@@ -59,6 +60,9 @@ LOCAL void CM7_SoftIntr_Handler(UINT intno)
 {
 	UW	system_int_idx;
 	FP	inthdr;
+#if USE_INTSTAT
+	UW	stime;
+#endif
 
 	ENTER_TASK_INDEPENDENT;
 
@@ -66,7 +70,13 @@ LOCAL void CM7_SoftIntr_Handler(UINT intno)
 	system_int_idx = (N_INTVEC - (CORE_EXT_INTVEC + CORE_SOFT_INTVEC) + intno);
 
 	inthdr = knl_inthdr_tbl[system_int_idx];
+#if USE_INTSTAT
+	stime = knl_intstat_cycle();
+	inthdr(system_int_idx); // jump to system interrupt handler
+	knl_intstat_record(system_int_idx, stime, knl_intstat_cycle());
+#else
 	inthdr(system_int_idx); // jump to system interrupt handler
+#endif
 
 	ClearInt_nvic(intno);
 
@@ -137,24 +147,44 @@ LOCAL void CM7_CpuIntr15_Handler(void)
 	CM7_SoftIntr_Handler(15);
 }
 
+/*
+ * The Handler is called when the CPU interrupt0-7 occurs.
+ *	Several system interrupts share one CPU interrupt.
+ *	All the pending system interrupts mapped to the CPU interrupt are
+ *	executed before returning, without re-entering the exception.
+ */
 EXPORT void knl_hll_inthdr(void)
 {
 	FP	inthdr;
 	UW	intno;
+	UW	int_status;
 	UW	system_int_idx;
+#if USE_INTSTAT
+	UW	stime;
+#endif
 
 	ENTER_TASK_INDEPENDENT;
 
 	intno	= knl_get_ipsr() - 16;
 	
 	/* Check module interrupts with CPUSS_CM7_X_INT_STATUS of XMC7200. */
-	if((CPUSS_CM7_0_INT_STATUS[intno] & SYSTEM_INT_VALID) == SYSTEM_INT_VALID)
+	/* INT_STATUS indicates the lowest numbered pending system interrupt. */
+	while(((int_status = CPUSS_CM7_0_INT_STATUS[intno]) & SYSTEM_INT_VALID) == SYSTEM_INT_VALID)
 	{
-		system_int_idx = (CPUSS_CM7_0_INT_STATUS[intno] & SYSTEM_INT_IDX_MASK);
+		system_int_idx = (int_status & SYSTEM_INT_IDX_MASK);
 		inthdr = knl_inthdr_tbl[system_int_idx];
+#if USE_INTSTAT
+		stime = knl_intstat_cycle();
 		inthdr(system_int_idx); // jump to system interrupt handler
+		knl_intstat_record(system_int_idx, stime, knl_intstat_cycle());
+#else
+		inthdr(system_int_idx); // jump to system interrupt handler
+#endif
 	}
 
+	/* The CPU interrupt is level sensitive, and is pended again if a source is still active. */
+	ClearInt_nvic(intno);
+
 	LEAVE_TASK_INDEPENDENT;
 }
 
@@ -207,6 +237,9 @@ EXPORT void knl_return_inthdr(void)
  */
 EXPORT ER knl_init_interrupt( void )
 {
+#if USE_INTSTAT
+	knl_init_intstat();
+#endif
 	/* Set Exception handler */
 	knl_exctbl[14]	= (UW)knl_dispatch_entry;
 	knl_exctbl[15]	= (UW)knl_systim_inthdr;
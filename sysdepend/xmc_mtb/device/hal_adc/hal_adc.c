@@ -64,6 +64,14 @@ LOCAL ER read_atr(T_ADC_DCB *p_dcb, T_DEVREQ *req)
 		}
 		req->asize = sizeof(ID);
 		break;
+	case TDN_HAL_ADC_PPROC:		/* Post-processing of the channel */
+		if(req->size != sizeof(T_HAL_ADC_PPROC)) {
+			err = E_PAR;
+			break;
+		}
+		err = (ER)dev_adc_llctl( p_dcb->unit, LLD_ADC_GETPP, 0, 0, req->buf);
+		if(err >= E_OK) req->asize = req->size;
+		break;
 	default:
 		err = E_PAR;
 		break;
@@ -87,6 +95,22 @@ LOCAL ER write_atr(T_ADC_DCB *p_dcb, T_DEVREQ *req)
 		}
 		req->asize = sizeof(ID);
 		break;
+	case TDN_HAL_ADC_PPROC:		/* Post-processing of the channel */
+		if(req->size != sizeof(T_HAL_ADC_PPROC)) {
+			err = E_PAR;
+			break;
+		}
+		err = (ER)dev_adc_llctl( p_dcb->unit, LLD_ADC_SETPP, 0, 0, req->buf);
+		if(err >= E_OK) req->asize = req->size;
+		break;
+	case TDN_HAL_ADC_WINDOW:	/* Window event */
+		if(req->size != sizeof(T_HAL_ADC_WINDOW)) {
+			err = E_PAR;
+			break;
+		}
+		err = (ER)dev_adc_llctl( p_dcb->unit, LLD_ADC_WINDOW, 0, 0, req->buf);
+		if(err >= E_OK) req->asize = req->size;
+		break;
 	default:
 		err = E_PAR;
 		break;
@@ -248,6 +272,7 @@ EXPORT ER dev_init_hal_adc( UW unit )
 	if(err != E_OK) goto err_2;
 
 	p_dcb->unit	= unit;
+	p_dcb->devid	= p_msdi->devid;
 	p_dcb->evtmbfid = idev.evtmbfid;
 
 	/* Low-level device initialization */
@@ -22,11 +22,47 @@
 #define DEV_HAL_ADC1	1
 #define DEV_HAL_ADC2	2
 
+/*----------------------------------------------------------------------*/
+/* Attribute data
+ */
+#define TDN_HAL_ADC_PPROC	(-100)	/* Post-processing of the channel (T_HAL_ADC_PPROC) */
+#define TDN_HAL_ADC_WINDOW	(-101)	/* Window event (Write only: T_HAL_ADC_WINDOW) */
+
+/* Post-processing of the channel (Averaging and range detection) */
+typedef struct {
+	UW	ch;		/* Channel (Set by the caller) */
+	UW	avgcnt;		/* Number of averaged conversions (1: No averaging, Max. 256) */
+	UW	shift;		/* Right shift of the result (0 to 15) */
+	BOOL	range;		/* Range detection enable */
+	UW	rngmode;	/* Range detection mode (CY_SAR2_RANGE_DETECTION_MODE_xxx) */
+	UH	rnglo;		/* Range detection low threshold */
+	UH	rnghi;		/* Range detection high threshold */
+} T_HAL_ADC_PPROC;
+
+/* Window event setting (Uses the range detection of the channel) */
+typedef struct {
+	UW	ch;		/* Channel */
+	BOOL	enable;		/* TRUE: Arm  FALSE: Disarm */
+	UW	lo;		/* Low threshold */
+	UW	hi;		/* High threshold */
+} T_HAL_ADC_WINDOW;
+
+/* Window event message (Sent to the event notification message buffer)
+ *	Sent once when the conversion result is out of lo to hi.
+ */
+typedef struct {
+	ID	devid;		/* Device ID */
+	UW	ch;		/* Channel */
+	UW	val;		/* Conversion result */
+	SYSTIM	time;		/* Detected time */
+} T_HAL_ADC_WINEVT;
+
 /*----------------------------------------------------------------------*/
 /* Device driver Control block
  */
 typedef struct {
 	UW	unit;		/* Unit No. */
+	ID	devid;		/* Device ID */
 	UINT	omode;		/* Open mode */
 
 	/* Attribute data */
@@ -47,6 +83,9 @@ typedef enum {
 	LLD_ADC_CLOSE,
 	LLD_ADC_READ,
 	LLD_ADC_RSIZE,
+	LLD_ADC_SETPP,
+	LLD_ADC_GETPP,
+	LLD_ADC_WINDOW,
 } T_LLD_ADC_CMD;
 
 /*----------------------------------------------------------------------
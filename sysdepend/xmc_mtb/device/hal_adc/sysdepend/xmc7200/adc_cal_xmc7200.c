@@ -0,0 +1,202 @@
+﻿/*
+ *----------------------------------------------------------------------
+ *    Device Driver for μT-Kernel 3.0
+ *
+ *    Copyright (C) 2020-2024 by Ken Sakamura.
+ *    This software is distributed under the T-License 2.2.
+ *----------------------------------------------------------------------
+ *
+ *    Released by TRON Forum(http://www.tron.org) at 2024/04.
+ *
+ *----------------------------------------------------------------------
+ */
+
+
+/*
+ *	adc_cal_xmc7200.c
+ *	A/D converter device driver
+ *	SAR calibration search for XMC7200
+ *
+ *	The conversion result of VREF_L and VREF_H is nondecreasing in the
+ *	offset and the gain compensation value. Therefore the boundary value
+ *	is found by binary search (8 conversions for the offset range).
+ */
+#ifndef ADC_CAL_HOST
+#include <sys/machine.h>
+#include <config_bsp/xmc_mtb/config_bsp.h>
+#endif
+
+#if defined(ADC_CAL_HOST) || (defined(MTKBSP_MODUSTOOLBOX) && DEVCNF_USE_HAL_ADC)
+
+#include "adc_cal_xmc7200.h"
+
+#define	CAL_OFFSET_MIN		(-128)
+#define	CAL_OFFSET_MAX		(127)
+#define	CAL_OFFSET_LIMIT	(125)
+#define	CAL_GAIN_MIN		(-14)
+#define	CAL_GAIN_MAX		(15)
+#define	CAL_RESULT_MAX		(0xFFFU)
+
+static uint16_t convert(const adc_cal_conv_t *conv, int input, const adc_cal_t *cal)
+{
+	return conv->convert(conv->ctx, input, cal);
+}
+
+/*******************************************************************************
+* Function Name: search
+********************************************************************************
+*
+* Finds the smallest value in [lo, hi] whose conversion result is thr or more.
+* The value is set to *var (a member of cal) for each conversion.
+*
+* \return
+* Found value. (hi + 1 if there is no such value)
+*
+*******************************************************************************/
+static int search(const adc_cal_conv_t *conv, int input, adc_cal_t *cal,
+			int16_t *var, int lo, int hi, uint16_t thr)
+{
+	int mid;
+
+	while (lo <= hi) {
+		mid = lo + (hi - lo) / 2;
+		*var = (int16_t)mid;
+		if (convert(conv, input, cal) >= thr) {
+			hi = mid - 1;
+		} else {
+			lo = mid + 1;
+		}
+	}
+	return lo;
+}
+
+/*******************************************************************************
+* Function Name: adc_cal_offset
+********************************************************************************
+*
+* Performs SAR block offset calibration
+* VREF_L: The largest offset with the result 0.
+* VREF_H: The smallest offset with the result 0xFFF.
+* The offset is set to ((offset_VREFH+offset_VREFL)/2 + 2).
+*
+* \return
+* Boolean value if calibration was successful.
+*
+*******************************************************************************/
+bool adc_cal_offset( const adc_cal_conv_t *conv, adc_cal_t *cal )
+{
+	int offset_VREFL;
+	int offset_VREFH;
+	int value;
+
+	cal->gain = CAL_GAIN_MAX;
+
+	/* VREF_L must be converted to more than 0 with the maximum offset. */
+	cal->offset = CAL_OFFSET_MAX;
+	if (convert(conv, ADC_CAL_IN_VREFL, cal) == 0) {
+		return false;
+	}
+	offset_VREFL = search(conv, ADC_CAL_IN_VREFL, cal, &cal->offset,
+				CAL_OFFSET_MIN, CAL_OFFSET_MAX, 1) - 1;
+	if (offset_VREFL < CAL_OFFSET_MIN) {
+		return false;
+	}
+
+	/* VREF_H must be converted to less than 0xFFF with the minimum offset. */
+	cal->offset = CAL_OFFSET_MIN;
+	if (convert(conv, ADC_CAL_IN_VREFH, cal) >= CAL_RESULT_MAX) {
+		return false;
+	}
+	offset_VREFH = search(conv, ADC_CAL_IN_VREFH, cal, &cal->offset,
+				CAL_OFFSET_MIN, CAL_OFFSET_MAX, CAL_RESULT_MAX);
+	if (offset_VREFH > CAL_OFFSET_MAX) {
+		return false;
+	}
+
+	value = (offset_VREFH + offset_VREFL) / 2 + 2;
+	if (value > CAL_OFFSET_LIMIT) {
+		return false;
+	}
+	cal->offset = (int16_t)value;
+
+	return true;
+}
+
+/*******************************************************************************
+* Function Name: adc_cal_gain
+********************************************************************************
+*
+* Performs SAR block gain calibration (After the offset calibration)
+* The gain is set to the largest gain with the VREF_L result 0, minus 1.
+*
+* \return
+* Boolean value if calibration was successful.
+*
+*******************************************************************************/
+bool adc_cal_gain( const adc_cal_conv_t *conv, adc_cal_t *cal )
+{
+	int gain;
+
+	cal->gain = CAL_GAIN_MAX;
+	if (convert(conv, ADC_CAL_IN_VREFL, cal) == 0) {
+		return true;		/* No gain compensation needed */
+	}
+	gain = search(conv, ADC_CAL_IN_VREFL, cal, &cal->gain,
+				CAL_GAIN_MIN, CAL_GAIN_MAX, 1) - 1;
+	if (gain < CAL_GAIN_MIN) {
+		cal->gain = CAL_GAIN_MAX;
+		return false;
+	}
+	cal->gain = (int16_t)(gain - 1);
+
+	return true;
+}
+
+/*----------------------------------------------------------------------
+ * Calibration record
+ */
+static uint16_t rec_sum(const adc_cal_rec_t *rec)
+{
+	uint32_t sum;
+
+	sum = (rec->magic & 0xFFFFU) + (rec->magic >> 16)
+		+ (uint16_t)rec->offset + (uint16_t)rec->gain + rec->vbg;
+	return (uint16_t)~(sum + (sum >> 16));
+}
+
+void adc_cal_make_rec( const adc_cal_conv_t *conv, const adc_cal_t *cal, adc_cal_rec_t *rec )
+{
+	rec->magic	= ADC_CAL_MAGIC;
+	rec->offset	= cal->offset;
+	rec->gain	= cal->gain;
+	rec->vbg	= convert(conv, ADC_CAL_IN_VBG, cal);
+	rec->sum	= rec_sum(rec);
+}
+
+/*----------------------------------------------------------------------
+ * Check the stored calibration record
+ *	The bandgap voltage is converted with the stored calibration value.
+ *	If the result differs from the result at the calibration by more
+ *	than 'drift' (Temperature or supply voltage changed), the record
+ *	is not used and the calibration must be performed again.
+ */
+bool adc_cal_check_rec( const adc_cal_conv_t *conv, const adc_cal_rec_t *rec, uint16_t drift, adc_cal_t *cal )
+{
+	uint16_t vbg;
+
+	if (rec->magic != ADC_CAL_MAGIC || rec->sum != rec_sum(rec)) {
+		return false;
+	}
+	if (rec->offset < CAL_OFFSET_MIN || rec->offset > CAL_OFFSET_LIMIT
+			|| rec->gain < CAL_GAIN_MIN - 1 || rec->gain > CAL_GAIN_MAX) {
+		return false;
+	}
+
+	cal->offset	= rec->offset;
+	cal->gain	= rec->gain;
+	vbg = convert(conv, ADC_CAL_IN_VBG, cal);
+
+	return ((vbg > rec->vbg)? (vbg - rec->vbg): (rec->vbg - vbg)) <= drift;
+}
+
+#endif		/* ADC_CAL_HOST || DEVCNF_USE_HAL_ADC */
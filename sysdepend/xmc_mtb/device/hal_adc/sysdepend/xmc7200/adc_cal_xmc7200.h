@@ -0,0 +1,69 @@
+﻿/*
+ *----------------------------------------------------------------------
+ *    Device Driver for μT-Kernel 3.0
+ *
+ *    Copyright (C) 2021-2024 by Ken Sakamura.
+ *    This software is distributed under the T-License 2.2.
+ *----------------------------------------------------------------------
+ *
+ *    Released by TRON Forum(http://www.tron.org) at 2024/04.
+ *
+ *----------------------------------------------------------------------
+ */
+
+/*
+ *	adc_cal_xmc7200.h
+ *	A/D converter device driver
+ *	SAR calibration search for XMC7200
+ *
+ *	The search does not access the hardware directly. The conversion is
+ *	done through adc_cal_conv_t, so it can also be built on the host with
+ *	a simulated converter (Define ADC_CAL_HOST).
+ */
+
+#ifndef	__DEV_ADC_CAL_XMC7200_H__
+#define	__DEV_ADC_CAL_XMC7200_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Input of the calibration conversion */
+#define	ADC_CAL_IN_VREFL	(0)	/* VREF_L */
+#define	ADC_CAL_IN_VREFH	(1)	/* VREF_H */
+#define	ADC_CAL_IN_VBG		(2)	/* Bandgap voltage (Drift detection) */
+
+/* Analog calibration value */
+typedef struct {
+	int16_t	offset;		/* Offset compensation (-128 to 127) */
+	int16_t	gain;		/* Gain compensation (-14 to 15) */
+} adc_cal_t;
+
+/* Converter interface
+ *	Converts the input with the calibration value and returns the 12-bit result.
+ */
+typedef struct {
+	uint16_t (*convert)(void *ctx, int input, const adc_cal_t *cal);
+	void	*ctx;
+} adc_cal_conv_t;
+
+/* Calibration record stored in non-volatile memory */
+#define	ADC_CAL_MAGIC		(0x314C4143UL)	/* "CAL1" */
+
+typedef struct {
+	uint32_t	magic;
+	int16_t		offset;
+	int16_t		gain;
+	uint16_t	vbg;	/* Bandgap conversion result at the calibration */
+	uint16_t	sum;	/* Check sum */
+} adc_cal_rec_t;
+
+bool adc_cal_offset( const adc_cal_conv_t *conv, adc_cal_t *cal );
+bool adc_cal_gain( const adc_cal_conv_t *conv, adc_cal_t *cal );
+void adc_cal_make_rec( const adc_cal_conv_t *conv, const adc_cal_t *cal, adc_cal_rec_t *rec );
+bool adc_cal_check_rec( const adc_cal_conv_t *conv, const adc_cal_rec_t *rec, uint16_t drift, adc_cal_t *cal );
+
+/* Non-volatile memory access (Provided by the application if DEVCONF_ADC_CAL_NVM is TRUE) */
+bool adc_cal_nvm_load( adc_cal_rec_t *rec );		/* false: No record */
+bool adc_cal_nvm_save( const adc_cal_rec_t *rec );
+
+#endif		/* __DEV_ADC_CAL_XMC7200_H__ */
@@ -34,4 +34,12 @@
 /* Interrupt t priority */
 #define	DEVCNF_SAR1_INTPRI	5
 
+/* Calibration result in non-volatile memory
+ * TRUE: The result is stored by adc_cal_nvm_save() and reused at the next open
+ *       while the drift of the bandgap conversion is within DEVCONF_ADC_CAL_DRIFT.
+ *       adc_cal_nvm_load() and adc_cal_nvm_save() are provided by the application.
+ */
+#define	DEVCONF_ADC_CAL_NVM	FALSE
+#define	DEVCONF_ADC_CAL_DRIFT	(8U)	// Re-calibration threshold (A/DC count)
+
 #endif		/* __DEV_ADC_CNF_XMC7200_H__ */
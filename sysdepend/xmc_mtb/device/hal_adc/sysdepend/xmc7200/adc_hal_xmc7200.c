@@ -27,6 +27,8 @@
 #include <cybsp.h>
 #include <cy_sysclk.h>
 #include "adc_cnf_sysdep.h"
+#include "adc_cal_xmc7200.h"
+#include "adc_hal_xmc7200.h"
 
 #define CH_VBG		(16U)
 #define CH_CAL		(17U)
@@ -51,6 +53,35 @@ const cy_en_sar2_pin_address_t pin_address[] = {
 	CY_SAR2_PIN_ADDRESS_VBG,	/* VBG */
 };
 
+#define ADC_HAL_CH_NUM	(sizeof(pin_address) / sizeof(cy_en_sar2_pin_address_t))
+
+/* A/DC channel initial setting. */
+static const cy_stc_sar2_channel_config_t channel_config = {
+	.channelHwEnable = true,
+	.triggerSelection = CY_SAR2_TRIGGER_OFF,
+	.channelPriority = 0U,
+	.preenptionType = CY_SAR2_PREEMPTION_FINISH_RESUME,
+	.isGroupEnd = false,
+	.pinAddress = CY_SAR2_PIN_ADDRESS_AN20,
+	.portAddress = CY_SAR2_PORT_ADDRESS_SARMUX1,
+	.extMuxEnable = true,
+	.extMuxSelect = 0U,
+	.preconditionMode = CY_SAR2_PRECONDITION_MODE_OFF,
+	.overlapDiagMode = CY_SAR2_OVERLAP_DIAG_MODE_OFF,
+	.sampleTime = DEVCONF_SAR1_SMPTIME,
+	.postProcessingMode = CY_SAR2_POST_PROCESSING_MODE_NONE,
+	.resultAlignment = CY_SAR2_RESULT_ALIGNMENT_RIGHT,
+	.signExtention = CY_SAR2_SIGN_EXTENTION_UNSIGNED,
+	.averageCount = 1U,
+	.rightShift = 0U,
+	.rangeDetectionMode = CY_SAR2_RANGE_DETECTION_MODE_INSIDE_RANGE,
+	.rangeDetectionLoThreshold = 0U,
+	.rangeDetectionHiThreshold = 65535U,
+};
+
+/* Post-processing of each channel. */
+static adc_hal_pproc_t channel_pproc[ADC_HAL_CH_NUM];
+
 /* Scenario: SAR2 block 1 with it's clock source is configured, channel 17 is
  * not used. */
 /* Calibration initial setting. */
@@ -107,155 +138,140 @@ static uint16_t getAdcValue(void)
 	/* Get the result(s) */
 	return (Cy_SAR2_Channel_GetResult(PASS0_SAR1, CH_CAL, NULL));
 }
+
+/* Input of the calibration channel (ADC_CAL_IN_xxx) */
+static const cy_en_sar2_pin_address_t cal_pin_address[] = {
+	CY_SAR2_PIN_ADDRESS_VREF_L,	/* ADC_CAL_IN_VREFL */
+	CY_SAR2_PIN_ADDRESS_VREF_H,	/* ADC_CAL_IN_VREFH */
+	CY_SAR2_PIN_ADDRESS_VBG,	/* ADC_CAL_IN_VBG */
+};
+static int cal_input;		/* Current input of the channel (-1: Not initialized) */
+
 /*******************************************************************************
-* Function Name: offset_Calibration
+* Function Name: calConvert
 ********************************************************************************
 *
-* Performs SAR block offset calibration
+* Converter of the calibration search (adc_cal_xmc7200.c)
+* The channel is initialized only when the input is changed.
 *
 * \return
-* Boolean value if calibration was successful.
+* Measurement value
 *
 *******************************************************************************/
-static bool offset_Calibration(void)
+static uint16_t calConvert(void *ctx, int input, const adc_cal_t *cal)
 {
-	/* Start ADC conversion and get the ADC value */
-	int16_t result;
-	int16_t offset_VREFH = 0U;
-	int16_t offset_VREFL = 0U;
-	int32_t value = 0U;
-	calibration_channel_config.pinAddress = CY_SAR2_PIN_ADDRESS_VREF_L;
+	if (input != cal_input) {
+		calibration_channel_config.pinAddress = cal_pin_address[input];
+		Cy_SAR2_Channel_Init(PASS0_SAR1, CH_CAL, &calibration_channel_config);
+		cal_input = input;
+	}
+	calibrationConfig.offset = cal->offset;
+	calibrationConfig.gain = cal->gain;
 	Cy_SAR2_SetAnalogCalibrationValue(PASS0_SAR1, &calibrationConfig);
-	/* Initialize channel. */
-	Cy_SAR2_Channel_Init(PASS0_SAR1, CH_CAL, &calibration_channel_config);
-	
-	result = getAdcValue();
-	if(result > 0)
-	{
-		/* Decrement the Value of Offset Compensation by "1" */
-		for(offset_VREFL = 127; offset_VREFL >= -128; offset_VREFL -= 1)
-		{
-			/* Set "offset_VREFL" to offset register value */
-			calibrationConfig.offset = offset_VREFL;
-			Cy_SAR2_SetAnalogCalibrationValue(PASS0_SAR1, &calibrationConfig);
-			/* Get ADC conversion value. */
-			result = getAdcValue();
-			/* Does the ADC conversion value equal to 0? */
-			if(result == 0)
-			{
-				break;
-			}
-			/* If offset has reached lower bound. */
-			if(offset_VREFL == -128)
-			{
-				/* Report error. */
-				return false;
-			}
-		}
+
+	return getAdcValue();
+}
+
+static const adc_cal_conv_t cal_conv = {
+	.convert = calConvert,
+	.ctx = NULL,
+};
+
+/*----------------------------------------------------------------------
+ * A/DC channel initialization
+ */
+static void init_channel( unsigned int ch )
+{
+	cy_stc_sar2_channel_config_t config = channel_config;
+	const adc_hal_pproc_t *pp = &channel_pproc[ch];
+
+	config.pinAddress = pin_address[ch];
+	if (ch + 1 >= ADC_HAL_CH_NUM) {
+		config.isGroupEnd = true;
+		config.interruptMask = CY_SAR2_INT_GRP_DONE;
 	}
-	else
-	{
-		/* End of Offset Adjustment with Abnormality. */
-		return false;
+
+	/* Post-processing (Averaging and range detection) */
+	if (pp->avgcnt > 1U) {
+		config.postProcessingMode = pp->range ? CY_SAR2_POST_PROCESSING_MODE_AVG_RANGE : CY_SAR2_POST_PROCESSING_MODE_AVG;
+	} else {
+		config.postProcessingMode = pp->range ? CY_SAR2_POST_PROCESSING_MODE_RANGE : CY_SAR2_POST_PROCESSING_MODE_NONE;
 	}
-	/* Set VREFH Voltage to Input */
-	calibration_channel_config.pinAddress = CY_SAR2_PIN_ADDRESS_VREF_H;
-	/* Set Offset Compensation to "-128" and init channel. */
-	calibrationConfig.offset = -128;
-	Cy_SAR2_SetAnalogCalibrationValue(PASS0_SAR1, &calibrationConfig);
-	Cy_SAR2_Channel_Init(PASS0_SAR1, CH_CAL, &calibration_channel_config);
-	/* Start ADC Conversion and get the A/D value. */
-	result = getAdcValue();
-	/* Is the ADC Conversion value lower than 0xFFF */
-	if(result < 0xFFF)
-	{
-		/* Increment the Value of Offset Compensation by "1". */
-		for(offset_VREFH = -128; offset_VREFH <= 127; offset_VREFH += 1)
-		{
-			/* Set "offset_VREFH" to offset register value. */
-			calibrationConfig.offset = offset_VREFH;
-			Cy_SAR2_SetAnalogCalibrationValue(PASS0_SAR1, &calibrationConfig);
-			/* Get ADC Conversion value. */
-			result = getAdcValue();
-			/* Does the ADC Conversion value Equal to "4095"? */
-			if(result == 0xFFF)
-			{
-				break;
-			}
-			/* Does the value of offset compensation equal to "127"? */
-			if(offset_VREFH == 127)
-			{
-				/* Offset adjustment failed - report error. */
-				return false;
-			}
-		}
+	config.averageCount = pp->avgcnt;
+	config.rightShift = pp->shift;
+	config.rangeDetectionMode = (cy_en_sar2_range_detection_mode_t)pp->rngmode;
+	config.rangeDetectionLoThreshold = pp->rnglo;
+	config.rangeDetectionHiThreshold = pp->rnghi;
+
+	Cy_SAR2_Channel_Init(PASS0_SAR1, ch, &config);
+}
+
+/*----------------------------------------------------------------------
+ * Post-processing setting of the channel
+ */
+int adc_hal_set_pproc( unsigned int ch, const adc_hal_pproc_t *pp )
+{
+	if ((ch >= ADC_HAL_CH_NUM) || (pp->avgcnt < 1U) || (pp->avgcnt > 256U) || (pp->shift > 15U)
+			|| (pp->rngmode > CY_SAR2_RANGE_DETECTION_MODE_OUTSIDE_RANGE) || (pp->rnglo > pp->rnghi)) {
+		return -1;
 	}
-	else
-	{
-		/* Offset adjustment failed - report error. */
-		return false;
+	channel_pproc[ch] = *pp;
+	init_channel(ch);
+
+	return 0;
+}
+
+int adc_hal_get_pproc( unsigned int ch, adc_hal_pproc_t *pp )
+{
+	if (ch >= ADC_HAL_CH_NUM) {
+		return -1;
 	}
-	/* Does "((offset_VREFH+offset_VREFL)/2 + 2)" greater than "125" ?*/
-	value = ((offset_VREFH+offset_VREFL)/2 + 2);
-	if(value > 125)
-	{
-		/* Offset adjustment failed - report error. */
-		return false;
+	*pp = channel_pproc[ch];
+
+	return 0;
+}
+
+/*----------------------------------------------------------------------
+ * Window setting of the channel (Range detection outside lo to hi)
+ */
+int adc_hal_set_window( unsigned int ch, bool enable, uint16_t lo, uint16_t hi )
+{
+	adc_hal_pproc_t pp;
+
+	if (adc_hal_get_pproc(ch, &pp) != 0) {
+		return -1;
 	}
-	/* Set the value of offset compensation to ((offset_VREFH+offset_VREFL)/2 + 2) */
-	calibrationConfig.offset = ((offset_VREFH+offset_VREFL)/2 + 2);
+	pp.range = enable;
+	pp.rngmode = CY_SAR2_RANGE_DETECTION_MODE_OUTSIDE_RANGE;
+	pp.rnglo = lo;
+	pp.rnghi = hi;
+	if (adc_hal_set_pproc(ch, &pp) != 0) {
+		return -1;
+	}
+
+	/* Clear the previous detection. */
+	Cy_SAR2_Channel_ClearInterrupt(PASS0_SAR1, ch, CY_SAR2_INT_CH_RANGE);
 
-	return true;
+	return 0;
 }
 
-/* Scenario: SAR2 block 1 is left after offset calibration intact, global
- * structure is still available with offset calibration results. */
-/*******************************************************************************
-* Function Name: gain_Calibration
-********************************************************************************
-*
-* Performs SAR block gain calibration
-*
-* \return
-* Boolean value if calibration was successful.
-*
-*******************************************************************************/
-static bool gain_Calibration(void)
+/*----------------------------------------------------------------------
+ * Range detection result
+ *	Returns the channel bit mask of the detected channels, and clears them.
+ */
+unsigned int adc_hal_get_range( void )
 {
-	int16_t gain;
-	int16_t result = 0U;
-	/* Set Gain Correction setting to "15". */
-	calibrationConfig.gain = 15;
-	/* Set VREFL Voltage to Input and init the channel. */
-	calibration_channel_config.pinAddress = CY_SAR2_PIN_ADDRESS_VREF_L;
-	Cy_SAR2_Channel_Init(PASS0_SAR1, CH_CAL, &calibration_channel_config);
-	/* Apply the initial calibration settings. */
-	Cy_SAR2_SetAnalogCalibrationValue(PASS0_SAR1, &calibrationConfig);
-	/* Start ADC value Conversion */
-	result = getAdcValue();
-	if(result > 0)
-	{
-		for(gain = 15; gain >=-14; gain -= 1)
-		{
-			/* Set gain to register */
-			calibrationConfig.gain = gain;
-			Cy_SAR2_SetAnalogCalibrationValue(PASS0_SAR1, &calibrationConfig);
-			result = getAdcValue();
-			if(result == 0)
-			{
-				/* Set gain compensation to "gain - 1" */
-				calibrationConfig.gain = gain - 1;
-				Cy_SAR2_SetAnalogCalibrationValue(PASS0_SAR1, &calibrationConfig);
-				break;
-			}
-			if(gain == -14)
-			{
-				/* Gain adjustment failed - report error. */
-				return false;
-			}
+	unsigned int ch;
+	unsigned int mask = 0U;
+
+	for (ch = 0; ch < ADC_HAL_CH_NUM; ch++) {
+		if (channel_pproc[ch].range
+				&& (Cy_SAR2_Channel_GetInterruptStatus(PASS0_SAR1, ch) & CY_SAR2_INT_CH_RANGE)) {
+			Cy_SAR2_Channel_ClearInterrupt(PASS0_SAR1, ch, CY_SAR2_INT_CH_RANGE);
+			mask |= (1U << ch);
 		}
 	}
-	return true;
+	return mask;
 }
 
 /*----------------------------------------------------------------------
@@ -285,19 +301,44 @@ unsigned int adc_hal_get_result( unsigned int ch)
 
 /*----------------------------------------------------------------------
  * A/DC open
+ *	If DEVCONF_ADC_CAL_NVM is TRUE, the stored calibration result is
+ *	reused while its drift is within DEVCONF_ADC_CAL_DRIFT.
  */
 int adc_hal_open( void )
 {
-	/* Do offset calibration. */
-	if (offset_Calibration() != true) {
-		return -1;
-	}
-	
-	/* Do gain calibration. */
-	if (gain_Calibration() != true) {
-		return -1;
+	adc_cal_t cal;
+#if DEVCONF_ADC_CAL_NVM
+	adc_cal_rec_t rec;
+#endif
+
+	cal_input = -1;
+
+#if DEVCONF_ADC_CAL_NVM
+	if (!adc_cal_nvm_load(&rec) || !adc_cal_check_rec(&cal_conv, &rec, DEVCONF_ADC_CAL_DRIFT, &cal))
+#endif
+	{
+		/* Do offset calibration. */
+		if (adc_cal_offset(&cal_conv, &cal) != true) {
+			return -1;
+		}
+
+		/* Do gain calibration. */
+		if (adc_cal_gain(&cal_conv, &cal) != true) {
+			return -1;
+		}
+
+#if DEVCONF_ADC_CAL_NVM
+		/* Store the calibration result. */
+		adc_cal_make_rec(&cal_conv, &cal, &rec);
+		adc_cal_nvm_save(&rec);
+#endif
 	}
-	
+
+	/* Apply the calibration result. */
+	calibrationConfig.offset = cal.offset;
+	calibrationConfig.gain = cal.gain;
+	Cy_SAR2_SetAnalogCalibrationValue(PASS0_SAR1, &calibrationConfig);
+
 	/* Finalize the calibration channel. */
 	Cy_SAR2_Channel_DeInit(PASS0_SAR1, CH_CAL);
 
@@ -361,28 +402,6 @@ void adc_hal_init( void )
 	Cy_GPIO_Pin_Init(CYBSP_A14_PORT, CYBSP_A14_PIN, &CYBSP_A14_config);
 	Cy_GPIO_Pin_Init(CYBSP_A15_PORT, CYBSP_A15_PIN, &CYBSP_A15_config);
 	
-	cy_stc_sar2_channel_config_t channel_config = {
-		.channelHwEnable = true,
-		.triggerSelection = CY_SAR2_TRIGGER_OFF,
-		.channelPriority = 0U,
-		.preenptionType = CY_SAR2_PREEMPTION_FINISH_RESUME,
-		.isGroupEnd = false,
-		.pinAddress = CY_SAR2_PIN_ADDRESS_AN20,
-		.portAddress = CY_SAR2_PORT_ADDRESS_SARMUX1,
-		.extMuxEnable = true,
-		.extMuxSelect = 0U,
-		.preconditionMode = CY_SAR2_PRECONDITION_MODE_OFF,
-		.overlapDiagMode = CY_SAR2_OVERLAP_DIAG_MODE_OFF,
-		.sampleTime = DEVCONF_SAR1_SMPTIME,
-		.postProcessingMode = CY_SAR2_POST_PROCESSING_MODE_NONE,
-		.resultAlignment = CY_SAR2_RESULT_ALIGNMENT_RIGHT,
-		.signExtention = CY_SAR2_SIGN_EXTENTION_UNSIGNED,
-		.averageCount = 1U,
-		.rightShift = 0U,
-		.rangeDetectionMode = CY_SAR2_RANGE_DETECTION_MODE_INSIDE_RANGE,
-		.rangeDetectionLoThreshold = 0U,
-		.rangeDetectionHiThreshold = 65535U,
-	};
 	cy_stc_sar2_config_t sar2_config = {
 		.preconditionTime = 0U,
 		.powerupTime = 0U,
@@ -402,13 +421,14 @@ void adc_hal_init( void )
 	Cy_SAR2_SetReferenceBufferMode(PASS0_EPASS_MMIO, CY_SAR2_REF_BUF_MODE_ON);
 	
 	/* Initialize A/DC channels. */
-	for (i = 0; i < (sizeof(pin_address) / sizeof(cy_en_sar2_pin_address_t)); i++) {
-		channel_config.pinAddress = pin_address[i];
-		if (i + 1 >= (sizeof(pin_address) / sizeof(cy_en_sar2_pin_address_t))) {
-			channel_config.isGroupEnd = true;
-			channel_config.interruptMask = CY_SAR2_INT_GRP_DONE;
-		}
-		Cy_SAR2_Channel_Init(PASS0_SAR1, i, &channel_config);
+	for (i = 0; i < ADC_HAL_CH_NUM; i++) {
+		channel_pproc[i].avgcnt = 1U;
+		channel_pproc[i].shift = 0U;
+		channel_pproc[i].range = false;
+		channel_pproc[i].rngmode = CY_SAR2_RANGE_DETECTION_MODE_INSIDE_RANGE;
+		channel_pproc[i].rnglo = 0U;
+		channel_pproc[i].rnghi = 65535U;
+		init_channel(i);
 	}
 
 	return;
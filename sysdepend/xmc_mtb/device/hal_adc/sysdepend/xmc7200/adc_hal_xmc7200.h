@@ -20,6 +20,19 @@
 #ifndef	__DEV_ADC_HAL_XMC7200_H__
 #define	__DEV_ADC_HAL_XMC7200_H__
 
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Post-processing setting of the channel */
+typedef struct {
+	uint16_t	avgcnt;		/* Number of averaged conversions (1: No averaging) */
+	uint8_t		shift;		/* Right shift of the result */
+	bool		range;		/* Range detection enable */
+	uint8_t		rngmode;	/* Range detection mode (cy_en_sar2_range_detection_mode_t) */
+	uint16_t	rnglo;		/* Range detection low threshold */
+	uint16_t	rnghi;		/* Range detection high threshold */
+} adc_hal_pproc_t;
+
 void adc_hal_init( void );
 void adc_hal_init_clock( void );
 int adc_hal_open( void );
@@ -27,5 +40,9 @@ void adc_hal_close();
 void adc_hal_start_convert( void );
 unsigned int adc_hal_get_result( unsigned int ch);
 void adc_hal_clear_interrupt( void );
+int adc_hal_set_pproc( unsigned int ch, const adc_hal_pproc_t *pp );
+int adc_hal_get_pproc( unsigned int ch, adc_hal_pproc_t *pp );
+int adc_hal_set_window( unsigned int ch, bool enable, uint16_t lo, uint16_t hi );
+unsigned int adc_hal_get_range( void );
 
 #endif		/* __DEV_ADC_HAL_XMC7200_H__ */
@@ -33,12 +33,40 @@
 */
 LOCAL struct {
 	volatile ID	wait_tskid;
+	T_ADC_DCB	*p_dcb;		/* Device driver control block */
+	UW		winmask;	/* Channels of the armed window event */
 } ll_devcb[DEV_HAL_ADC_UNITNM] = {
 	{0},
 	{0},
 	{0},
 };
 
+/*----------------------------------------------------------------------
+ * Window event notification
+ *	The event is notified once. The window is re-armed by TDN_HAL_ADC_WINDOW.
+ */
+LOCAL void adc_window_event( UINT unit )
+{
+	T_HAL_ADC_WINEVT	evt;
+	UW			rng;
+	INT			ch;
+
+	rng = adc_hal_get_range() & ll_devcb[unit].winmask;
+	if(rng == 0) return;
+
+	ll_devcb[unit].winmask &= ~rng;
+	tk_get_otm(&evt.time);
+	for(ch = 0; ch < ADC_CH_NUM; ch++) {
+		if((rng & (1U << ch)) == 0) continue;
+		evt.devid	= ll_devcb[unit].p_dcb->devid;
+		evt.ch		= ch;
+		evt.val		= adc_hal_get_result(ch);
+		if(ll_devcb[unit].p_dcb->evtmbfid > 0) {
+			tk_snd_mbf(ll_devcb[unit].p_dcb->evtmbfid, &evt, sizeof(T_HAL_ADC_WINEVT), TMO_POL);
+		}
+	}
+}
+
 /*----------------------------------------------------------------------
  * Interrupt handler
  */
@@ -47,6 +75,9 @@ void adc_inthdr( UINT intno)
 	if(ll_devcb[1].wait_tskid) {
 		tk_wup_tsk(ll_devcb[1].wait_tskid);
 	}
+	if(ll_devcb[1].winmask) {
+		adc_window_event(1);
+	}
 
 	adc_hal_clear_interrupt();	// Clear interrupt flag.
 }
@@ -113,6 +144,62 @@ LOCAL void adc_close(UW unit)
 	adc_hal_close();
 }
 
+/*----------------------------------------------------------------------
+ * Post-processing of the channel
+ */
+LOCAL ER adc_set_pproc(UW unit, T_HAL_ADC_PPROC *pk_pp)
+{
+	adc_hal_pproc_t	pp;
+
+	if((pk_pp->ch >= ADC_CH_NUM) || (pk_pp->avgcnt > 256) || (pk_pp->shift > 15)) return E_PAR;
+
+	pp.avgcnt	= (uint16_t)pk_pp->avgcnt;
+	pp.shift	= (uint8_t)pk_pp->shift;
+	pp.range	= pk_pp->range ? true : false;
+	pp.rngmode	= (uint8_t)pk_pp->rngmode;
+	pp.rnglo	= pk_pp->rnglo;
+	pp.rnghi	= pk_pp->rnghi;
+
+	return (adc_hal_set_pproc(pk_pp->ch, &pp) == 0) ? E_OK : E_PAR;
+}
+
+LOCAL ER adc_set_window(UW unit, T_HAL_ADC_WINDOW *pk_win)
+{
+	UINT	imask;
+
+	if((pk_win->ch >= ADC_CH_NUM) || (pk_win->lo > pk_win->hi) || (pk_win->hi > 0xFFFF)) return E_PAR;
+
+	DI(imask);
+	ll_devcb[unit].winmask &= ~(1U << pk_win->ch);
+	EI(imask);
+
+	if(adc_hal_set_window(pk_win->ch, pk_win->enable ? true : false,
+				(uint16_t)pk_win->lo, (uint16_t)pk_win->hi) != 0) return E_PAR;
+
+	if(pk_win->enable) {
+		DI(imask);
+		ll_devcb[unit].winmask |= (1U << pk_win->ch);
+		EI(imask);
+	}
+	return E_OK;
+}
+
+LOCAL ER adc_get_pproc(UW unit, T_HAL_ADC_PPROC *pk_pp)
+{
+	adc_hal_pproc_t	pp;
+
+	if(adc_hal_get_pproc(pk_pp->ch, &pp) != 0) return E_PAR;
+
+	pk_pp->avgcnt	= pp.avgcnt;
+	pk_pp->shift	= pp.shift;
+	pk_pp->range	= pp.range ? TRUE : FALSE;
+	pk_pp->rngmode	= pp.rngmode;
+	pk_pp->rnglo	= pp.rnglo;
+	pk_pp->rnghi	= pp.rnghi;
+
+	return E_OK;
+}
+
 /*----------------------------------------------------------------------
  * Low level device control
  */
@@ -137,6 +224,18 @@ EXPORT W dev_adc_llctl( UW unit, INT cmd, UW p1, UW p2, UW *pp)
 		rtn = ADC_CH_NUM - p1;
 		if(rtn < 0 ) rtn = 0;
 		break;
+
+	case LLD_ADC_SETPP:	/* Set post-processing */
+		rtn = (W)adc_set_pproc(unit, (T_HAL_ADC_PPROC*)pp);
+		break;
+
+	case LLD_ADC_GETPP:	/* Get post-processing */
+		rtn = (W)adc_get_pproc(unit, (T_HAL_ADC_PPROC*)pp);
+		break;
+
+	case LLD_ADC_WINDOW:	/* Window event */
+		rtn = (W)adc_set_window(unit, (T_HAL_ADC_WINDOW*)pp);
+		break;
 	}
 	
 	return rtn;
@@ -156,6 +255,7 @@ EXPORT ER dev_adc_llinit( T_ADC_DCB *p_dcb)
 	if (p_dcb->unit != 1) {
 		return E_NOSPT;
 	}
+	ll_devcb[p_dcb->unit].p_dcb = p_dcb;
 
 #if DEVCONF_ADC_INIT_MCLK
 	/* Initialize clock source. */
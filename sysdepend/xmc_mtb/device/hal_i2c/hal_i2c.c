@@ -315,37 +315,73 @@ err_2:
 
 /*----------------------------------------------------------------------
  * I2C register access support function
+ *	The register address and the data block are transferred in one
+ *	transaction. (Read: Repeated start after the register address)
  */
-
-EXPORT ER i2c_read_reg(ID dd, UW sadr, UW radr, UB *data)
+LOCAL ER i2c_read_regs_sub(ID dd, UW sadr, UW radr, INT asz, UB *buf, SZ len)
 {
 	T_I2C_EXEC	exec;
-	SZ		asz;
-	ER		err;
+	UB		snd_data[2];
+	SZ		rsz;
+	INT		n;
+
+	n = 0;
+	if(asz == 2) snd_data[n++] = (UB)(radr >> 8);
+	snd_data[n++] = (UB)radr;
 
 	exec.sadr	= sadr;
-	exec.snd_size	= 1;
-	exec.snd_data	= (UB*)&radr;
-	exec.rcv_size	= 1;
-	exec.rcv_data	= data;
+	exec.snd_size	= n;
+	exec.snd_data	= snd_data;
+	exec.rcv_size	= len;
+	exec.rcv_data	= buf;
 
-	err = tk_swri_dev(dd, TDN_I2C_EXEC, &exec, sizeof(T_I2C_EXEC), &asz);
+	return tk_swri_dev(dd, TDN_I2C_EXEC, &exec, sizeof(T_I2C_EXEC), &rsz);
+}
 
-	return err;
+LOCAL ER i2c_write_regs_sub(ID dd, UW sadr, UW radr, INT asz, CONST UB *buf, SZ len)
+{
+	UB	snd_data[DEVCNF_I2C_MAX_SDATSZ];
+	SZ	wsz;
+	INT	n;
+
+	if(len <= 0 || len + asz > DEVCNF_I2C_MAX_SDATSZ) return E_PAR;
+
+	n = 0;
+	if(asz == 2) snd_data[n++] = (UB)(radr >> 8);
+	snd_data[n++] = (UB)radr;
+	knl_memcpy(&snd_data[n], buf, len);
+
+	return tk_swri_dev(dd, sadr, snd_data, n + len, &wsz);
+}
+
+EXPORT ER i2c_read_reg(ID dd, UW sadr, UW radr, UB *data)
+{
+	return i2c_read_regs_sub(dd, sadr, radr, 1, data, 1);
 }
 
 EXPORT ER i2c_write_reg(ID dd, UW sadr, UW radr, UB data)
 {
-	UB	snd_data[2];
-	SZ	asz;
-	ER	err;
+	return i2c_write_regs_sub(dd, sadr, radr, 1, &data, 1);
+}
 
-	snd_data[0] = radr;
-	snd_data[1] = data;
-	
-	err = tk_swri_dev(dd, sadr, snd_data, sizeof(snd_data), &asz);
+EXPORT ER i2c_read_regs(ID dd, UW sadr, UW radr, UB *buf, SZ len)
+{
+	return i2c_read_regs_sub(dd, sadr, radr, 1, buf, len);
+}
 
-	return err;
+EXPORT ER i2c_write_regs(ID dd, UW sadr, UW radr, CONST UB *buf, SZ len)
+{
+	return i2c_write_regs_sub(dd, sadr, radr, 1, buf, len);
+}
+
+EXPORT ER i2c_read_regs16(ID dd, UW sadr, UW radr, UB *buf, SZ len)
+{
+	return i2c_read_regs_sub(dd, sadr, radr, 2, buf, len);
+}
+
+EXPORT ER i2c_write_regs16(ID dd, UW sadr, UW radr, CONST UB *buf, SZ len)
+{
+	return i2c_write_regs_sub(dd, sadr, radr, 2, buf, len);
 }
 
 #endif		/* DEVCNF_USE_HAL_IIC */
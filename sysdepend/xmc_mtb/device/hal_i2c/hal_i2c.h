@@ -28,6 +28,12 @@
  */
 #define DEV_HAL_I2C9		9
 
+/*----------------------------------------------------------------------
+ * I2C write-then-read (Common to the I2C device drivers)
+ *	Same as TDN_I2C_EXEC and T_I2C_EXEC.
+ */
+#define TDN_HAL_I2C_EXEC	TDN_I2C_EXEC
+typedef T_I2C_EXEC		T_HAL_I2C_EXEC;
 
 /*---------------------------------------------------------------------*/
 /* Device driver Control block
@@ -65,6 +71,10 @@ IMPORT ER dev_init_hal_i2c( UW unit );
  */
 EXPORT ER i2c_read_reg(ID dd, UW sadr, UW radr, UB *data);
 EXPORT ER i2c_write_reg(ID dd, UW sadr, UW radr, UB data);
+EXPORT ER i2c_read_regs(ID dd, UW sadr, UW radr, UB *buf, SZ len);
+EXPORT ER i2c_write_regs(ID dd, UW sadr, UW radr, CONST UB *buf, SZ len);
+EXPORT ER i2c_read_regs16(ID dd, UW sadr, UW radr, UB *buf, SZ len);		// 16-bit register address
+EXPORT ER i2c_write_regs16(ID dd, UW sadr, UW radr, CONST UB *buf, SZ len);	// 16-bit register address
 
 
 #endif		/* _DEV_HAL_I2C_H_ */
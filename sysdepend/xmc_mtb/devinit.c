@@ -21,6 +21,7 @@
 #include <tk/tkernel.h>
 #include <tk/device.h>
 #include <kernel.h>
+#include <tm/tmonitor.h>
 
 /* ------------------------------------------------------------------------ */
 
@@ -42,6 +43,16 @@ EXPORT ER knl_start_device( void )
 {
 	ER	err	= E_OK;
 
+#if USE_DEFWORK
+	err = InitDeferredWork();
+	if(err < E_OK) return err;
+#endif
+
+#if USE_TMONITOR && TM_COM_SERIAL_DEV && USE_TM_TXBUF
+	err = tm_com_start_txbuf();
+	if(err < E_OK) return err;
+#endif
+
 #if DEVCNF_USE_HAL_IIC
 
 	err = dev_init_hal_i2c(DEV_HAL_I2C9);
@@ -26,26 +26,7 @@
 
 #include <cybsp.h>
 
-#define UNUSED_INT	(0xFFU)
-
-typedef struct irq_table
-{
-	UINT intno;
-	INT level;
-} IRQ_TABLE;
-
-LOCAL const IRQ_TABLE nvic_table[CORE_EXT_INTVEC] =
-{
-	/* Interrupt priorities 1 and 7 are used by the OS and cannot be set. */
-	{0U, 2U},	/* IRQ 0 */
-	{1U, 3U},	/* IRQ 1 */
-	{2U, 4U},	/* IRQ 2 */
-	{3U, 5U},	/* IRQ 3 */
-	{4U, 6U},	/* IRQ 4 */
-	{UNUSED_INT, 7U},	/* IRQ 5 */
-	{UNUSED_INT, 8U},	/* IRQ 6 */
-	{UNUSED_INT, 9U},	/* IRQ 7 */
-};
+LOCAL const UB cpuirq_level[CORE_EXT_INTVEC] = CNF_CPUIRQ_LEVEL;
 
 IMPORT void EnableInt_nvic( UINT intno, INT level );
 
@@ -53,11 +34,12 @@ LOCAL void enable_irq(void)
 {
 	UB loop_cnt;
 
+	/* Interrupt priorities 1 and 7 are used by the OS and cannot be set. */
 	for(loop_cnt = 0U; loop_cnt < CORE_EXT_INTVEC; loop_cnt++)
 	{
-		if (nvic_table[loop_cnt].intno != UNUSED_INT)
+		if (cpuirq_level[loop_cnt] != 0U)
 		{
-			EnableInt_nvic(nvic_table[loop_cnt].intno, nvic_table[loop_cnt].level);
+			EnableInt_nvic(loop_cnt, cpuirq_level[loop_cnt]);
 		}
 	}
 }
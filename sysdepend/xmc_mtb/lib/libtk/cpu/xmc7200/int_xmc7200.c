@@ -21,32 +21,84 @@
  */
 #include <tk/tkernel.h>
 #include <tk/syslib.h>
+#include <tm/tmonitor.h>
 
 #include <sysdepend/xmc_mtb/lib/libtk/cpu/core/armv7m/int_armv7m.h>
 
 #include <cy_sysint.h>
 
 #define UNUSED_IRQNO	(0xFFU)
+#define N_SYSINT	(N_INTVEC - CORE_SOFT_INTVEC)	/* Number of system interrupts */
 
-typedef struct ext_int_table
+/*
+ * CPU interrupt (IRQ0-7) mapping of the system interrupts
+ */
+/* Interrupt level of CPU interrupts. Interrupt priorities 1 and 7 are used by the OS and cannot be set. */
+LOCAL const UB cpuirq_level[CORE_EXT_INTVEC] = CNF_CPUIRQ_LEVEL;
+
+typedef struct cpuirq_fixed
 {
-	INT level;	/* Interrupt level */
-	UINT irqno;	/* IRQ No */
-} EXT_INT_TABLE;
+	UH intno;	/* System interrupt number */
+	UB irqno;	/* Dedicated CPU interrupt */
+} CPUIRQ_FIXED_TBL;
 
-LOCAL const EXT_INT_TABLE ext_int_table[CORE_EXT_INTVEC] =
+#define CPUIRQ_FIXED(intno, irq)	{(intno), (irq)},
+LOCAL const CPUIRQ_FIXED_TBL cpuirq_fixed[] =
 {
-	/* Interrupt priorities 1 and 7 are used by the OS and cannot be set. */
-	/* If level 2 to 6 is selected, IRQ0 to 4 interrupts are enabled. */
-	{0U, UNUSED_IRQNO},	/* level 0 */
-	{1U, UNUSED_IRQNO},	/* level 1 */
-	{2U, 0U},	/* level 2 */
-	{3U, 1U},	/* level 3 */
-	{4U, 2U},	/* level 4 */
-	{5U, 3U},	/* level 5 */
-	{6U, 4U},	/* level 6 */
-	{7U, UNUSED_IRQNO},	/* level 7 */
+	CNF_CPUIRQ_FIXED
+	{N_SYSINT, UNUSED_IRQNO}	/* Terminator */
 };
+#undef CPUIRQ_FIXED
+
+LOCAL UB sysint_map[N_SYSINT];		/* Mapped CPU interrupt + 1 (0: Not mapped) */
+LOCAL UH cpuirq_cnt[CORE_EXT_INTVEC];	/* Number of mapped system interrupts */
+
+/*
+ * Check the dedicated CPU interrupt
+ */
+LOCAL BOOL is_fixed_irq( UINT irqno )
+{
+	const CPUIRQ_FIXED_TBL	*p;
+
+	for(p = cpuirq_fixed; p->irqno != UNUSED_IRQNO; p++) {
+		if(p->irqno == irqno) return TRUE;
+	}
+	return FALSE;
+}
+
+/*
+ * Select the CPU interrupt to map the system interrupt
+ *	The dedicated CPU interrupt is used if the system interrupt is fixed.
+ *	The dedicated CPU interrupt must be used (CNF_CPUIRQ_LEVEL is not 0)
+ *	and have the requested interrupt level. Otherwise, the system
+ *	interrupt is not mapped.
+ *	The other system interrupts are mapped to the CPU interrupt with the
+ *	fewest system interrupts of the interrupt level.
+ */
+LOCAL UINT select_cpuirq( UINT intno, INT level )
+{
+	const CPUIRQ_FIXED_TBL	*p;
+	UINT	irqno, sel;
+
+	for(p = cpuirq_fixed; p->irqno != UNUSED_IRQNO; p++) {
+		if(p->intno != intno) continue;
+		if(p->irqno >= CORE_EXT_INTVEC || cpuirq_level[p->irqno] == 0
+					|| cpuirq_level[p->irqno] != level) {
+			return UNUSED_IRQNO;
+		}
+		return p->irqno;
+	}
+
+	sel = UNUSED_IRQNO;
+	for(irqno = 0; irqno < CORE_EXT_INTVEC; irqno++) {
+		if(cpuirq_level[irqno] == 0 || cpuirq_level[irqno] != level) continue;
+		if(is_fixed_irq(irqno)) continue;
+		if(sel == UNUSED_IRQNO || cpuirq_cnt[irqno] < cpuirq_cnt[sel]) {
+			sel = irqno;
+		}
+	}
+	return sel;
+}
 
 /*----------------------------------------------------------------------*/
 /*
@@ -59,17 +111,32 @@ LOCAL const EXT_INT_TABLE ext_int_table[CORE_EXT_INTVEC] =
 EXPORT void EnableInt( UINT intno, INT level )
 {
 	UINT ext_intno;
+	UINT imask;
 
 	/* External interrupt */
 	/* External Interrupts number is 0-566 */
-	if (intno < (N_INTVEC - CORE_SOFT_INTVEC))
+	if (intno < N_SYSINT)
 	{
+		DI(imask);
 		/* Decide which interrupt number to assign with level */
-		ext_intno = ext_int_table[level].irqno;
+		if (sysint_map[intno] != 0U)
+		{
+			cpuirq_cnt[sysint_map[intno] - 1]--;
+			sysint_map[intno] = 0U;
+		}
+		ext_intno = select_cpuirq(intno, level);
 		if (ext_intno == UNUSED_IRQNO)
 		{
+			EI(imask);
+#if USE_SYSTEM_MESSAGE && USE_TMONITOR
+			tm_printf((UB*)"EnableInt: No CPU interrupt for intno %d level %d\n", intno, level);
+#endif
 			return;
 		}
+		sysint_map[intno] = (UB)(ext_intno + 1);
+		cpuirq_cnt[ext_intno]++;
+		EI(imask);
+
 		/* This field specifies to which CPU interrupt the system interrupt is mapped.
 		   E.g., if CPU_INT_IDX is '6', the system interrupt is mapped to CPU interrupt '6'. */
 		Cy_SysInt_SetInterruptSource(ext_intno, intno);
@@ -88,11 +155,21 @@ EXPORT void EnableInt( UINT intno, INT level )
  */
 EXPORT void DisableInt( UINT intno )
 {
+	UINT imask;
+
 	/* External interrupt */
 	/* External Interrupts number is 0-566 */
-	if (intno < (N_INTVEC - CORE_SOFT_INTVEC))
+	if (intno < N_SYSINT)
 	{
 		Cy_SysInt_DisableSystemInt(intno);
+
+		DI(imask);
+		if (sysint_map[intno] != 0U)
+		{
+			cpuirq_cnt[sysint_map[intno] - 1]--;
+			sysint_map[intno] = 0U;
+		}
+		EI(imask);
 	}
 	else
 	{
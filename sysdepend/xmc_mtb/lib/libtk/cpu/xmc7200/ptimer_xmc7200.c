@@ -81,5 +81,31 @@ EXPORT ER GetPhysicalTimerConfig(UINT ptmrno, T_RPTMR *pk_rptmr)
 	return E_OK;
 }
 
+#if USE_PTMR_CAPTURE
+/*
+ * Physical timer Input-capture / Output-compare
+ *	Not supported. (The physical timer of XMC7200 is not implemented)
+ */
+EXPORT ER StartPhysicalTimerCapture( UINT ptmrno, CONST T_CPTMR *pk_cptmr )
+{
+	return E_NOSPT;
+}
+
+EXPORT ER StopPhysicalTimerCapture( UINT ptmrno )
+{
+	return E_NOSPT;
+}
+
+EXPORT ER ReadPhysicalTimerCapture( UINT ptmrno, UW *buf, INT cnt )
+{
+	return E_NOSPT;
+}
+
+EXPORT ER SetPhysicalTimerCompare( UINT ptmrno, CONST T_MPTMR *pk_mptmr )
+{
+	return E_NOSPT;
+}
+#endif	/* USE_PTMR_CAPTURE */
+
 #endif	/* USE_PTMR */
 #endif	/* MTKBSP_CPU_XMC7200 */
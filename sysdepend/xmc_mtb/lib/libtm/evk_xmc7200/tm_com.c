@@ -62,6 +62,7 @@
 #define SCBxRX_FIFO_CTRL(p)	(_UW*)(uart_reg_base[p]+0x00304ul)	/* Receiver FIFO control register */
 #define SCBxRX_FIFO_STATUS(p)	(_UW*)(uart_reg_base[p]+0x00308ul)	/* Receiver FIFO status register */
 #define SCBxRX_FIFO_RD(p)	(_UW*)(uart_reg_base[p]+0x00340ul)	/* Receiver FIFO read register */
+#define SCBxINTR_TX(p)		(_UW*)(uart_reg_base[p]+0x00F80ul)	/* Transmitter interrupt request register */
 #define SCBxINTR_TX_MASK(p)	(_UW*)(uart_reg_base[p]+0x00F88ul)	/* Transmitter interrupt mask register */
 #define SCBxINTR_RX(p)		(_UW*)(uart_reg_base[p]+0x00FC0ul)	/* Receiver interrupt request register */
 #define SCBxINTR_RX_MASK(p)	(_UW*)(uart_reg_base[p]+0x00FC8ul)	/* Receiver interrupt mask register */
@@ -143,7 +144,7 @@
 #define UART_PARITY	UART_PARITY_NONE
 #define UART_STOP_BIT	UART_STOP_BIT_1
 #define UART_HW_FLOW	UART_HW_FLOW_DISABLE
-#define UART_BAUD	(115200)	// = 115200, 57600, 38400, 19200, 9600, 4800, 2400, 1200
+#define UART_BAUD	(TM_COM_BAUD)	// config_tm.h
 
 #define PCLK_SCB3_CLOCK	(33)
 
@@ -198,10 +199,49 @@ EXPORT	void	clock_set( UW clock_no, UW div_no, UW div_val )
 	while((*PERI_PCLK_GR1_DIV_16_CTL(div_no) & DIV_16_CTRL_EN) != DIV_16_CTRL_EN);
 }
 
+#if USE_TM_TXBUF
+/*
+ * Buffered transmission (tm_txbuf.c)
+ *	The transmit interrupt (TX FIFO empty) is routed to a CPU interrupt
+ *	by EnableInt() like the other system interrupts.
+ */
+#include <sysdepend/xmc_mtb/lib/libtm/tm_txbuf.h>
+
+EXPORT	const UINT	tm_com_intno = 115;		/* SCB3 interrupt */
+
+EXPORT	BOOL	tm_com_txready( void )
+{
+	return ((*SCBxTX_FIFO_STATUS(TERM_PORT) & SCB_TX_FIFO_STATUS_USED) < fifoNo);
+}
+
+EXPORT	BOOL	tm_com_txdone( void )
+{
+	return ((*SCBxTX_FIFO_STATUS(TERM_PORT) & SCB_TX_FIFO_STATUS_USED) == 0);
+}
+
+EXPORT	void	tm_com_txput( UB c )
+{
+	*SCBxTX_FIFO_WR(TERM_PORT) = c;
+}
+
+EXPORT	void	tm_com_txint( BOOL enable )
+{
+	*SCBxINTR_TX_MASK(TERM_PORT) = (enable)? SCB_INTR_TX_EMPTY: 0;
+}
+
+EXPORT	void	tm_com_txclr( void )
+{
+	*SCBxINTR_TX(TERM_PORT) = SCB_INTR_TX_EMPTY;		/* Write 1 to clear */
+}
+#endif /* USE_TM_TXBUF */
+
 EXPORT	void	tm_snd_dat( const UB* buf, INT size )
 {
 	UB	*b;
 
+#if USE_TM_TXBUF
+	if(tm_txbuf_put(buf, size)) return;	/* Buffered */
+#endif
 	for( b = (UB *)buf; size > 0; size--, b++ ){
 		while( (*SCBxTX_FIFO_STATUS(TERM_PORT) & SCB_TX_FIFO_STATUS_USED) >= fifoNo );	// Wait for free space in FIFO.
 		*SCBxTX_FIFO_WR(TERM_PORT) = *b;
@@ -243,7 +283,11 @@ EXPORT void initUartParam( W port, UW wl, UW par, UW sb, UW baud, UW flow )
 	/*------------------------------*/
 	/*	Check Baudrate		*/
 	/*------------------------------*/
-	div_val = Cy_SysClk_ClkHfGetFrequency(2) / baud / 8;
+	/* Baud rate = CLK_HF2 / (INT16_DIV + 1) / 8  (Oversampling 8: CTRL_OVS(7))
+	   INT16_DIV + 1 is rounded to the nearest integer, to keep the error
+	   small at high baud rates. */
+	div_val = (Cy_SysClk_ClkHfGetFrequency(2) / 8 + baud / 2) / baud;
+	if(div_val > 0) div_val--;
 
 	/*------------------------------*/
 	/*	BAUDRATE		*/
@@ -268,7 +312,7 @@ EXPORT void initUartParam( W port, UW wl, UW par, UW sb, UW baud, UW flow )
 
 	/* interrupt configurations */
 	*SCBxINTR_RX_MASK(port) = (SCB_INTR_RX_NOT_EMPTY);
-	*SCBxINTR_TX_MASK(port) = (SCB_INTR_TX_EMPTY | SCB_INTR_TX_NOT_FULL);
+	*SCBxINTR_TX_MASK(port) = 0;	/* Polling. Enabled by tm_com_txint() */
 
 	/* flow control configurations */
 	*SCBxUART_FLOW_CTRL(port) = flow;
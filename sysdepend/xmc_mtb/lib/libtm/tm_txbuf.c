@@ -0,0 +1,190 @@
+/*
+ *----------------------------------------------------------------------
+ *    micro T-Kernel 3.0 BSP 2.0
+ *
+ *    Copyright (C) 2023-2024 by Ken Sakamura.
+ *    This software is distributed under the T-License 2.1.
+ *----------------------------------------------------------------------
+ *
+ *    Released by TRON Forum(http://www.tron.org) at 2024/08.
+ *
+ *----------------------------------------------------------------------
+ */
+
+/*
+ *    tm_txbuf.c
+ *    T-Monitor buffered transmission (XMC ModusToolbox)
+ *
+ *    tm_snd_dat() copies the data to the ring buffer and returns.
+ *    The SCB transmit interrupt refills the hardware FIFO from the buffer
+ *    each time the FIFO becomes empty.
+ */
+
+#include <tk/tkernel.h>
+
+#if USE_TMONITOR
+#include <mtkernel/lib/libtm/libtm.h>
+
+#ifdef MTKBSP_MODUSTOOLBOX
+#if TM_COM_SERIAL_DEV && USE_TM_TXBUF
+
+#include <tm/tmonitor.h>
+#include <sys/sysdef.h>
+#include <sysdepend/xmc_mtb/lib/libtm/tm_txbuf.h>
+
+#if TM_TXBUF_DMA
+#error "TM_TXBUF_DMA is not supported. Set TM_TXBUF_DMA to 0."
+#endif
+
+#if (TM_TXBUF_SZ & (TM_TXBUF_SZ - 1)) != 0
+#error "TM_TXBUF_SZ must be a power of 2."
+#endif
+
+#define TM_TXBUF_MASK	(TM_TXBUF_SZ - 1)
+
+/* Transmission state */
+#define TXBUF_POLL	0		/* Not started. Send by polling */
+#define TXBUF_ACTIVE	1		/* Send by transmit interrupt */
+#define TXBUF_SYNC	2		/* Flushed. Send by polling */
+
+LOCAL UB	txbuf[TM_TXBUF_SZ];	/* Transmit ring buffer */
+LOCAL UW	txbuf_wp;		/* Write position (tm_snd_dat) */
+LOCAL UW	txbuf_rp;		/* Read position (Transmit interrupt) */
+LOCAL INT	txbuf_stat = TXBUF_POLL;
+
+/*
+ * Check fault exception (NMI, HardFault, MemManage, BusFault, UsageFault)
+ *	The transmit interrupt can not be executed from the fault handler.
+ */
+LOCAL BOOL in_fault_exc( void )
+{
+	UW	ipsr;
+
+	Asm("mrs %0, ipsr": "=r"(ipsr));
+	return (ipsr >= 2 && ipsr <= 6);
+}
+
+#if TM_TXBUF_BLOCK
+/*
+ * Check whether the caller can wait (Task context only)
+ */
+LOCAL BOOL can_wait( void )
+{
+	T_RSYS	rsys;
+
+	if(tk_ref_sys(&rsys) != E_OK) return FALSE;
+	return (rsys.sysstat == TSS_TSK);
+}
+#endif
+
+/*
+ * UART transmit interrupt handler
+ *	The interrupt request is cleared after the FIFO is refilled,
+ *	so that it is set again only when the FIFO becomes empty.
+ */
+LOCAL void txbuf_inthdr( UINT intno )
+{
+	UINT	imask;
+
+	while(tm_com_txready()) {
+		DI(imask);
+		if(txbuf_rp == txbuf_wp) {	/* Buffer empty */
+			tm_com_txint(FALSE);
+			EI(imask);
+			break;
+		}
+		tm_com_txput(txbuf[txbuf_rp & TM_TXBUF_MASK]);
+		txbuf_rp++;
+		EI(imask);
+	}
+	tm_com_txclr();
+}
+
+/*
+ * Write to the transmit buffer (Called from tm_snd_dat)
+ *	When the buffer is full, the remaining data is discarded.
+ *	If TM_TXBUF_BLOCK is valid, the task waits for free space.
+ */
+EXPORT BOOL tm_txbuf_put( const UB *buf, INT size )
+{
+	UINT	imask;
+	INT	n;
+
+	if(txbuf_stat != TXBUF_ACTIVE) return FALSE;
+	if(in_fault_exc()) {
+		tm_com_flush();
+		return FALSE;
+	}
+
+	while(size > 0) {
+		DI(imask);
+		n = TM_TXBUF_SZ - (INT)(txbuf_wp - txbuf_rp);
+		if(n > size) n = size;
+		size -= n;
+		if(n > 0) {
+			for( ; n > 0; n--) {
+				txbuf[txbuf_wp & TM_TXBUF_MASK] = *buf++;
+				txbuf_wp++;
+			}
+			tm_com_txint(TRUE);
+		}
+		EI(imask);
+
+		if(size > 0) {			/* Buffer full */
+#if TM_TXBUF_BLOCK
+			if(can_wait() && tk_dly_tsk(1) == E_OK) continue;
+#endif
+			break;			/* Discard */
+		}
+	}
+	return TRUE;
+}
+
+/*
+ * Flush the transmit buffer synchronously
+ *	For the panic path (e.g. Fault handler).
+ *	After that, T-Monitor sends the data by polling.
+ */
+EXPORT void tm_com_flush( void )
+{
+	UINT	imask;
+
+	DI(imask);
+	if(txbuf_stat == TXBUF_ACTIVE) {
+		tm_com_txint(FALSE);
+		txbuf_stat = TXBUF_SYNC;
+		while(txbuf_rp != txbuf_wp) {
+			while(!tm_com_txready());
+			tm_com_txput(txbuf[txbuf_rp & TM_TXBUF_MASK]);
+			txbuf_rp++;
+		}
+	}
+	while(!tm_com_txdone());
+	EI(imask);
+}
+
+/*
+ * Start buffered transmission
+ *	Called after micro T-Kernel starts. Until then, data is sent by polling.
+ */
+EXPORT ER tm_com_start_txbuf( void )
+{
+	T_DINT	dint;
+	ER	err;
+
+	if(txbuf_stat != TXBUF_POLL) return E_OBJ;
+
+	dint.intatr = TA_HLNG;
+	dint.inthdr = txbuf_inthdr;
+	err = tk_def_int(tm_com_intno, &dint);
+	if(err < E_OK) return err;
+
+	txbuf_stat = TXBUF_ACTIVE;
+	EnableInt(tm_com_intno, CNF_TM_TXBUF_INTPRI);
+
+	return E_OK;
+}
+
+#endif /* TM_COM_SERIAL_DEV && USE_TM_TXBUF */
+#endif /* MTKBSP_MODUSTOOLBOX */
+#endif /* USE_TMONITOR */
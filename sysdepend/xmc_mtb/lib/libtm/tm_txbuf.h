@@ -0,0 +1,33 @@
+/*
+ *----------------------------------------------------------------------
+ *    micro T-Kernel 3.0 BSP 2.0
+ *
+ *    Copyright (C) 2023-2024 by Ken Sakamura.
+ *    This software is distributed under the T-License 2.1.
+ *----------------------------------------------------------------------
+ *
+ *    Released by TRON Forum(http://www.tron.org) at 2024/08.
+ *
+ *----------------------------------------------------------------------
+ */
+
+/*
+ *	tm_txbuf.h
+ *	T-Monitor buffered transmission (XMC ModusToolbox)
+ */
+
+#ifndef _MTKBSP_TM_TXBUF_H_
+#define _MTKBSP_TM_TXBUF_H_
+
+/* Transmit buffer (tm_txbuf.c) */
+IMPORT BOOL tm_txbuf_put( const UB *buf, INT size );	/* FALSE: Not buffered, send by polling */
+
+/* UART dependent functions (tm_com.c) */
+IMPORT const UINT tm_com_intno;			/* UART interrupt number */
+IMPORT BOOL tm_com_txready( void );		/* Transmit FIFO not full */
+IMPORT BOOL tm_com_txdone( void );		/* Transmit FIFO empty */
+IMPORT void tm_com_txput( UB c );		/* Write transmit FIFO */
+IMPORT void tm_com_txint( BOOL enable );	/* Enable/Disable transmit interrupt */
+IMPORT void tm_com_txclr( void );		/* Clear transmit interrupt request */
+
+#endif /* _MTKBSP_TM_TXBUF_H_ */
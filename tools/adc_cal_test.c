@@ -0,0 +1,303 @@
+/*
+ *----------------------------------------------------------------------
+ *    micro T-Kernel 3.0 BSP 2.0
+ *
+ *    Copyright (C) 2023-2024 by Ken Sakamura.
+ *    This software is distributed under the T-License 2.1.
+ *----------------------------------------------------------------------
+ *
+ *    Released by TRON Forum(http://www.tron.org) at 2024/08.
+ *
+ *----------------------------------------------------------------------
+ */
+
+/*
+ *	adc_cal_test.c
+ *	Test of the XMC7200 SAR calibration search (Host tool)
+ *
+ *	usage: cc -O2 -o adc_cal_test tools/adc_cal_test.c
+ *	       ./adc_cal_test [<Number of random converters> [<Random seed>]]
+ *
+ *	adc_cal_offset() and adc_cal_gain() (Binary search) of
+ *	sysdepend/xmc_mtb/device/hal_adc/sysdepend/xmc7200/adc_cal_xmc7200.c
+ *	are compared with the linear sweeps of the former driver on simulated
+ *	converters. The converter result is linear in the offset and the gain
+ *	compensation value and saturated at 0 and 0xFFF (Monotonic).
+ *	The results (Success or failure, offset and gain) must be the same,
+ *	including the error cases at each bound of the sweeps.
+ *	The exit status is 0 if all tests pass.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#define ADC_CAL_HOST
+#include "../sysdepend/xmc_mtb/device/hal_adc/sysdepend/xmc7200/adc_cal_xmc7200.c"
+
+/*----------------------------------------------------------------------
+ * Simulated converter
+ *	result = base[input] + so * offset + sg * gain  (0 - 0xFFF)
+ */
+typedef struct {
+	int		base[3];
+	int		so;		/* Result step of the offset (>= 0) */
+	int		sg;		/* Result step of the gain (>= 0) */
+	unsigned long	nconv;		/* Number of conversions */
+} sim_t;
+
+static uint16_t sim_convert(void *ctx, int input, const adc_cal_t *cal)
+{
+	sim_t	*sim = ctx;
+	long	r;
+
+	sim->nconv++;
+	r = sim->base[input] + (long)sim->so * cal->offset + (long)sim->sg * cal->gain;
+	if (r < 0) r = 0;
+	if (r > 0xFFF) r = 0xFFF;
+	return (uint16_t)r;
+}
+
+/*----------------------------------------------------------------------
+ * Linear sweeps of the former driver (offset_Calibration, gain_Calibration)
+ */
+static bool lin_offset(const adc_cal_conv_t *conv, adc_cal_t *cal)
+{
+	int16_t result;
+	int16_t offset_VREFH = 0;
+	int16_t offset_VREFL = 0;
+	int32_t value;
+
+	cal->offset = 127;
+	cal->gain = 15;
+	result = (int16_t)convert(conv, ADC_CAL_IN_VREFL, cal);
+	if (result > 0) {
+		for (offset_VREFL = 127; offset_VREFL >= -128; offset_VREFL -= 1) {
+			cal->offset = offset_VREFL;
+			result = (int16_t)convert(conv, ADC_CAL_IN_VREFL, cal);
+			if (result == 0) break;
+			if (offset_VREFL == -128) return false;
+		}
+	} else {
+		return false;
+	}
+
+	cal->offset = -128;
+	result = (int16_t)convert(conv, ADC_CAL_IN_VREFH, cal);
+	if (result < 0xFFF) {
+		for (offset_VREFH = -128; offset_VREFH <= 127; offset_VREFH += 1) {
+			cal->offset = offset_VREFH;
+			result = (int16_t)convert(conv, ADC_CAL_IN_VREFH, cal);
+			if (result == 0xFFF) break;
+			if (offset_VREFH == 127) return false;
+		}
+	} else {
+		return false;
+	}
+
+	value = ((offset_VREFH + offset_VREFL) / 2 + 2);
+	if (value > 125) return false;
+	cal->offset = (int16_t)value;
+	return true;
+}
+
+static bool lin_gain(const adc_cal_conv_t *conv, adc_cal_t *cal)
+{
+	int16_t gain;
+	int16_t result;
+
+	cal->gain = 15;
+	result = (int16_t)convert(conv, ADC_CAL_IN_VREFL, cal);
+	if (result > 0) {
+		for (gain = 15; gain >= -14; gain -= 1) {
+			cal->gain = gain;
+			result = (int16_t)convert(conv, ADC_CAL_IN_VREFL, cal);
+			if (result == 0) {
+				cal->gain = gain - 1;
+				break;
+			}
+			if (gain == -14) return false;
+		}
+	}
+	return true;
+}
+
+/*----------------------------------------------------------------------
+ * Comparison
+ */
+static int		nerr;
+static unsigned long	nconv_bin, nconv_lin, nok, nfail;
+static unsigned long	ngain_none, ngain_min, ngain_fail;	/* Gain bound cases */
+
+static void compare(const char *name, sim_t *sim)
+{
+	adc_cal_conv_t	conv = { sim_convert, sim };
+	adc_cal_t	bin, lin;
+	bool		bin_ok, lin_ok;
+	unsigned long	n;
+
+	/* Offset calibration */
+	sim->nconv = 0;
+	bin_ok = adc_cal_offset(&conv, &bin);
+	n = sim->nconv;
+	nconv_bin += n;
+	sim->nconv = 0;
+	lin_ok = lin_offset(&conv, &lin);
+	nconv_lin += sim->nconv;
+
+	if (bin_ok != lin_ok || (bin_ok && bin.offset != lin.offset)) {
+		printf("  NG: %s offset: binary %d (%d), linear %d (%d)\n",
+			name, bin_ok, bin.offset, lin_ok, lin.offset);
+		nerr++;
+		return;
+	}
+	if (n > 2 * (1 + 9)) {		/* Check and search of 256 values */
+		printf("  NG: %s offset: %lu conversions\n", name, n);
+		nerr++;
+	}
+	if (!bin_ok) {
+		nfail++;
+		return;
+	}
+
+	/* Gain calibration (With the calibrated offset) */
+	sim->nconv = 0;
+	bin_ok = adc_cal_gain(&conv, &bin);
+	n = sim->nconv;
+	nconv_bin += n;
+	sim->nconv = 0;
+	lin_ok = lin_gain(&conv, &lin);
+	nconv_lin += sim->nconv;
+
+	if (bin_ok != lin_ok || (bin_ok && bin.gain != lin.gain)) {
+		printf("  NG: %s gain: binary %d (%d), linear %d (%d)\n",
+			name, bin_ok, bin.gain, lin_ok, lin.gain);
+		nerr++;
+		return;
+	}
+	if (n > 1 + 5) {			/* Check and search of 30 values */
+		printf("  NG: %s gain: %lu conversions\n", name, n);
+		nerr++;
+	}
+	if (bin_ok) {
+		nok++;
+		if (bin.gain == CAL_GAIN_MAX) ngain_none++;
+		if (bin.gain == CAL_GAIN_MIN - 1) ngain_min++;
+	} else {
+		nfail++;
+		ngain_fail++;
+	}
+}
+
+/*
+ * Converter with the boundaries at the given offsets (With the gain 15)
+ *	VREF_L: 0 at the offset 'lo' and below
+ *	VREF_H: 0xFFF at the offset 'hi' and above
+ */
+static void set_bound(sim_t *sim, int lo, int hi)
+{
+	sim->so = 16;
+	sim->sg = 1;
+	sim->base[ADC_CAL_IN_VREFL] = -sim->so * lo - 15;
+	sim->base[ADC_CAL_IN_VREFH] = 0xFFF - sim->so * hi - 15;
+	sim->base[ADC_CAL_IN_VBG] = 0x800;
+}
+
+static void test_bound(void)
+{
+	static const struct {
+		const char	*name;
+		int		lo, hi;
+	} tc[] = {
+		{ "VREF_L zero at offset max",		127, 200 },	/* Error */
+		{ "VREF_L zero at offset 126",		126, 127 },
+		{ "VREF_L not zero at offset min",	-129, 0 },	/* Error */
+		{ "VREF_L zero only at offset min",	-128, 0 },
+		{ "VREF_H full at offset min",		-200, -128 },	/* Error */
+		{ "VREF_H full at offset -127",		-200, -127 },
+		{ "VREF_H not full at offset max",	-10, 128 },	/* Error */
+		{ "VREF_H full only at offset max",	-10, 127 },
+		{ "Offset just at limit",		120, 126 },	/* (120+126)/2+2 = 125 */
+		{ "Offset over limit",			122, 126 },	/* Error */
+	};
+	sim_t	sim;
+	int	i;
+
+	printf("offset bounds\n");
+	for (i = 0; i < (int)(sizeof(tc) / sizeof(tc[0])); i++) {
+		set_bound(&sim, tc[i].lo, tc[i].hi);
+		compare(tc[i].name, &sim);
+	}
+}
+
+/*
+ * Gain bounds
+ *	VREF_L is swept so that the gain calibration ends with no compensation,
+ *	with each gain value, at the lower bound and with the error.
+ */
+static void test_gain(void)
+{
+	sim_t	sim;
+	int	b;
+
+	printf("gain bounds\n");
+	sim.so = 32;
+	sim.sg = 4;
+	sim.base[ADC_CAL_IN_VREFH] = 0xFFF;
+	sim.base[ADC_CAL_IN_VBG] = 0x800;
+	for (b = -200; b <= 200; b++) {
+		sim.base[ADC_CAL_IN_VREFL] = b;
+		compare("gain", &sim);
+	}
+	if (ngain_none == 0 || ngain_min == 0 || ngain_fail == 0) {
+		printf("  NG: gain bound cases (none %lu, min %lu, error %lu)\n",
+			ngain_none, ngain_min, ngain_fail);
+		nerr++;
+	}
+}
+
+/*
+ * Random converters
+ */
+static unsigned long	rnd_state = 1;
+
+static int rnd(int lo, int hi)
+{
+	rnd_state = rnd_state * 1103515245UL + 12345UL;
+	return lo + (int)((rnd_state >> 16) % (unsigned long)(hi - lo + 1));
+}
+
+static void test_random(long n)
+{
+	sim_t	sim;
+	long	i;
+
+	printf("random (%ld converters)\n", n);
+	for (i = 0; i < n; i++) {
+		sim.so = rnd(0, 40);
+		sim.sg = rnd(0, 64);
+		sim.base[ADC_CAL_IN_VREFL] = rnd(-sim.so * 160 - sim.sg * 20, sim.so * 160 + 40);
+		sim.base[ADC_CAL_IN_VREFH] = 0xFFF + rnd(-sim.so * 160 - sim.sg * 20, sim.so * 160 + 40);
+		sim.base[ADC_CAL_IN_VBG] = 0x800;
+		compare("random", &sim);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	long	n = 100000;
+
+	if (argc > 1) n = atol(argv[1]);
+	if (argc > 2) rnd_state = strtoul(argv[2], NULL, 0);
+
+	test_bound();
+	test_gain();
+	test_random(n);
+
+	printf("  success %lu  failure %lu\n", nok, nfail);
+	printf("  conversions: binary %lu  linear %lu\n", nconv_bin, nconv_lin);
+	if (nok == 0 || nfail == 0) {
+		printf("  NG: both success and failure cases must be tested\n");
+		nerr++;
+	}
+	printf("%s\n", (nerr == 0)? "OK": "FAILED");
+	return (nerr == 0)? 0: 1;
+}
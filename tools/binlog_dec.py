@@ -0,0 +1,224 @@
+#!/usr/bin/env python3
+#
+# ----------------------------------------------------------------------
+#     micro T-Kernel 3.0 BSP 2.0
+#
+#     Copyright (C) 2023-2024 by Ken Sakamura.
+#     This software is distributed under the T-License 2.1.
+# ----------------------------------------------------------------------
+#
+#     Released by TRON Forum(http://www.tron.org) at 2024/08.
+#
+# ----------------------------------------------------------------------
+#
+#	binlog_dec.py
+#	Binary log decoder (Host tool for BinLog(), lib/libtk/binlog.c)
+#
+#	usage: binlog_dec.py <ELF file> <Captured serial data>
+#
+#	The format strings are read from "binlog_fmt" section of the ELF file.
+#	The other text output of T-Monitor in the captured data is passed through.
+#	A frame broken by tm_snd_dat() (Data discarded with the full transmit
+#	buffer) is reported, and the decoding resumes at the next frame.
+#	(A record whose number of arguments does not match the format string
+#	 is treated as broken.)
+#
+
+import re
+import struct
+import sys
+
+MAGIC = b'\0BLG'
+FMT_SECTION = 'binlog_fmt'
+MAXARG = 6			# BINLOG_MAXARG (syslib.h)
+SPEC = re.compile(r'%([-+ #0]*)(\d+|\*)?(?:\.(\d+))?(hh|h|ll|l|z|j|t)?([diouxXcsp%])')
+
+
+class Elf:
+	"""Minimal ELF32/ELF64 little-endian section reader"""
+
+	def __init__(self, path):
+		with open(path, 'rb') as f:
+			self.data = f.read()
+		if self.data[:4] != b'\x7fELF':
+			raise ValueError('not an ELF file: ' + path)
+		is64 = self.data[4] == 2
+		if is64:
+			shoff, = struct.unpack_from('<Q', self.data, 0x28)
+			shentsize, shnum, shstrndx = struct.unpack_from('<HHH', self.data, 0x3A)
+			shfmt = '<IIQQQQIIQQ'
+		else:
+			shoff, = struct.unpack_from('<I', self.data, 0x20)
+			shentsize, shnum, shstrndx = struct.unpack_from('<HHH', self.data, 0x2E)
+			shfmt = '<IIIIIIIIII'
+		self.sections = []
+		for i in range(shnum):
+			sh = struct.unpack_from(shfmt, self.data, shoff + i * shentsize)
+			self.sections.append({'name': sh[0], 'type': sh[1], 'addr': sh[3],
+					'offset': sh[4], 'size': sh[5]})
+		strtab = self.sections[shstrndx]
+		for sec in self.sections:
+			end = self.data.index(b'\0', strtab['offset'] + sec['name'])
+			sec['name'] = self.data[strtab['offset'] + sec['name']:end].decode()
+
+	def section(self, name):
+		for sec in self.sections:
+			if sec['name'] == name:
+				return self.data[sec['offset']:sec['offset'] + sec['size']]
+		raise KeyError('section not found: ' + name)
+
+	def cstring(self, addr):
+		"""Read the constant string at the target address (None: Not found)"""
+		for sec in self.sections:
+			if sec['type'] == 1 and sec['addr'] <= addr < sec['addr'] + sec['size']:
+				pos = sec['offset'] + addr - sec['addr']
+				end = self.data.find(b'\0', pos)
+				return self.data[pos:end].decode(errors='replace')
+		return None
+
+
+class FrameError(Exception):
+	"""Broken frame (e.g. truncated by tm_snd_dat() with the full buffer)"""
+
+	def __init__(self, pos):
+		Exception.__init__(self, pos)
+		self.pos = pos
+
+
+def get_varint(buf, pos, limit):
+	val = shift = 0
+	while True:
+		if pos >= limit or shift > 28:
+			raise FrameError(pos)
+		b = buf[pos]
+		pos += 1
+		val |= (b & 0x7F) << shift
+		shift += 7
+		if b < 0x80:
+			return val, pos
+
+
+def count_args(fmt):
+	"""Number of the arguments used by the format string"""
+	n = 0
+	for m in SPEC.finditer(fmt):
+		if m.group(5) != '%':
+			n += 2 if m.group(2) == '*' else 1
+	return n
+
+
+def format_text(fmt, args, elf):
+	"""Format the text as printf with the 32-bit arguments"""
+	args = list(args)
+
+	def conv(m):
+		flags, width, prec, _, spec = m.groups()
+		if spec == '%':
+			return '%'
+		if width == '*':
+			width = str(args.pop(0) if args else 0)
+		val = args.pop(0) if args else 0
+		pyfmt = '%' + flags + (width or '') + ('.' + prec if prec is not None else '')
+		if spec in 'di':
+			return (pyfmt + 'd') % (val - (1 << 32) if val & 0x80000000 else val)
+		if spec in 'ouxX':
+			return (pyfmt + spec) % val
+		if spec == 'c':
+			return (pyfmt + 'c') % chr(val & 0xFF)
+		if spec == 'p':
+			return (pyfmt + 's') % ('0x%08x' % val)
+		s = elf.cstring(val)
+		return (pyfmt + 's') % (s if s is not None else '<0x%08x>' % val)
+
+	return SPEC.sub(conv, fmt)
+
+
+def decode_frame(data, pos, limit, fmtsec, elf, out):
+	"""Decode one frame from data[pos] (after MAGIC) up to 'limit'.
+	Returns the end position of the frame. Raises FrameError at the broken record."""
+	top = pos
+	length, pos = get_varint(data, pos, limit)
+	tim, pos = get_varint(data, pos, limit)
+	lost, pos = get_varint(data, pos, limit)
+	end = pos + length
+	if end > limit:
+		# Truncated frame: The remaining data is followed by the text output
+		limit = skip_broken(data, top, limit)
+		if pos > limit:
+			raise FrameError(top)
+	if lost:
+		out.write('[%10d] *** %d records lost ***\n' % (tim, lost))
+	while pos < end:
+		rec = pos
+		try:
+			if pos >= min(end, limit):
+				raise FrameError(pos)
+			narg = data[pos]
+			pos += 1
+			fid, pos = get_varint(data, pos, limit)
+			dlt, pos = get_varint(data, pos, limit)
+			args = []
+			for _ in range(narg):
+				z, pos = get_varint(data, pos, limit)
+				args.append(((z >> 1) ^ -(z & 1)) & 0xFFFFFFFF)
+			if narg > MAXARG or fid >= len(fmtsec) or (fid > 0 and fmtsec[fid - 1] != 0) or pos > end:
+				raise FrameError(rec)
+			fend = fmtsec.find(b'\0', fid)
+			fmt = fmtsec[fid:fend].decode(errors='replace')
+			if min(count_args(fmt), MAXARG) != narg:
+				raise FrameError(rec)
+		except FrameError:
+			raise FrameError(rec)
+		tim = (tim + dlt) & 0xFFFFFFFF
+		text = format_text(fmt, args, elf)
+		out.write('[%10d] %s%s' % (tim, text, '' if text.endswith('\n') else '\n'))
+	return end
+
+
+def is_text(b):
+	return b in (0x09, 0x0A, 0x0D) or 0x20 <= b < 0x7F
+
+
+def skip_broken(data, pos, limit):
+	"""Start position of the text output following the broken frame
+	(After the last binary byte)"""
+	for i in range(limit - 1, pos - 1, -1):
+		if not is_text(data[i]):
+			return i + 1
+	return pos
+
+
+def decode(elf, data, out):
+	fmtsec = elf.section(FMT_SECTION)
+	pos = 0
+	while True:
+		top = data.find(MAGIC, pos)
+		if top < 0:
+			out.write(data[pos:].decode(errors='replace'))
+			return
+		out.write(data[pos:top].decode(errors='replace'))
+		limit = data.find(MAGIC, top + len(MAGIC))
+		if limit < 0:
+			limit = len(data)
+		try:
+			pos = decode_frame(data, top + len(MAGIC), limit, fmtsec, elf, out)
+		except FrameError as e:
+			# Resynchronize at the next frame
+			out.write('*** broken frame ***\n')
+			sys.stderr.write('binlog_dec: broken frame at offset %d\n' % top)
+			pos = skip_broken(data, e.pos, limit)
+
+
+def main(argv):
+	if len(argv) != 3:
+		sys.stderr.write('usage: binlog_dec.py <ELF file> <Captured serial data>\n')
+		return 2
+	elf = Elf(argv[1])
+	with open(argv[2], 'rb') as f:
+		data = f.read()
+	decode(elf, data, sys.stdout)
+	return 0
+
+
+if __name__ == '__main__':
+	sys.exit(main(sys.argv))
@@ -0,0 +1,204 @@
+#!/usr/bin/env python3
+#
+# ----------------------------------------------------------------------
+#     micro T-Kernel 3.0 BSP 2.0
+#
+#     Copyright (C) 2023-2024 by Ken Sakamura.
+#     This software is distributed under the T-License 2.1.
+# ----------------------------------------------------------------------
+#
+#     Released by TRON Forum(http://www.tron.org) at 2024/08.
+#
+# ----------------------------------------------------------------------
+#
+#	binlog_test.py
+#	Test of the binary log decoder (Host tool)
+#
+#	usage: python3 tools/binlog_test.py
+#
+#	The frames are encoded as lib/libtk/binlog.c and decoded by
+#	binlog_dec.py with a minimal ELF file (binlog_fmt and .rodata).
+#	The frame truncated by tm_snd_dat() is tested to be reported and
+#	followed by the next frame.
+#
+
+import io
+import os
+import struct
+import sys
+import tempfile
+import unittest
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import binlog_dec
+
+RODATA_ADDR = 0x08010000
+
+
+def make_elf(sections):
+	"""ELF32 with the sections [(name, type, addr, data)]"""
+	shstr = b'\0'
+	names = []
+	for name, _, _, _ in sections:
+		names.append(len(shstr))
+		shstr += name.encode() + b'\0'
+	sections = list(sections) + [('.shstrtab', 3, 0, shstr)]
+	names.append(len(shstr) - len(b'.shstrtab\0'))
+
+	body = b''
+	offs = []
+	for _, _, _, data in sections:
+		offs.append(0x34 + len(body))
+		body += data
+	shoff = 0x34 + len(body)
+	hdr = b'\x7fELF' + bytes([1, 1, 1]) + bytes(9)
+	hdr += struct.pack('<HHIIIIIHHHHHH', 2, 40, 1, 0, 0, shoff, 0,
+			0x34, 0, 0, 40, len(sections) + 1, len(sections))
+	shdr = bytes(40)
+	for (_, typ, addr, data), name, off in zip(sections, names, offs):
+		shdr += struct.pack('<IIIIIIIIII', name, typ, 0, addr, off, len(data), 0, 0, 1, 0)
+	return hdr + body + shdr
+
+
+def varint(val):
+	out = b''
+	while val >= 0x80:
+		out += bytes([(val & 0x7F) | 0x80])
+		val >>= 7
+	return out + bytes([val])
+
+
+def zigzag(val):
+	val &= 0xFFFFFFFF
+	return ((val << 1) & 0xFFFFFFFF) ^ (0xFFFFFFFF if val & 0x80000000 else 0)
+
+
+class BinLog:
+	"""Encoder of BinLogWrite() / BinLogFlush()"""
+
+	def __init__(self, fmts):
+		self.fmtsec = b''
+		self.fid = {}
+		for fmt in fmts:
+			self.fid[fmt] = len(self.fmtsec)
+			self.fmtsec += fmt.encode() + b'\0'
+
+	def record(self, fmt, dlt, *args):
+		rec = bytes([len(args)]) + varint(self.fid[fmt]) + varint(dlt)
+		for a in args:
+			rec += varint(zigzag(a))
+		return rec
+
+	@staticmethod
+	def header(payload, base, lost=0):
+		return binlog_dec.MAGIC + varint(len(payload)) + varint(base) + varint(lost)
+
+	def frame(self, base, records, lost=0):
+		payload = b''.join(records)
+		return self.header(payload, base, lost) + payload
+
+
+class DecodeTest(unittest.TestCase):
+
+	FMTS = ['tick %d\n', 'val %d %u %x\n', 'name %s (%c) %5.5s|%%\n', 'star [%*d]\n']
+	STRS = b'task_a\0'
+
+	@classmethod
+	def setUpClass(cls):
+		cls.log = BinLog(cls.FMTS)
+		elf = make_elf([('binlog_fmt', 1, 0, cls.log.fmtsec),
+				('.rodata', 1, RODATA_ADDR, cls.STRS)])
+		with tempfile.NamedTemporaryFile(suffix='.elf', delete=False) as f:
+			f.write(elf)
+			cls.path = f.name
+		cls.elf = binlog_dec.Elf(cls.path)
+
+	@classmethod
+	def tearDownClass(cls):
+		os.unlink(cls.path)
+
+	def decode(self, data):
+		out = io.StringIO()
+		err = sys.stderr
+		sys.stderr = io.StringIO()
+		try:
+			binlog_dec.decode(self.elf, data, out)
+			nerr = sys.stderr.getvalue().count('broken frame')
+		finally:
+			sys.stderr = err
+		return out.getvalue(), nerr
+
+	def test_frame(self):
+		L = self.log
+		data = b'boot\n' + L.frame(1000, [
+			L.record('tick %d\n', 0, 1),
+			L.record('val %d %u %x\n', 5, -1, 0xFFFFFFFF, 0xBEEF),
+			L.record('name %s (%c) %5.5s|%%\n', 200, RODATA_ADDR, ord('A'), RODATA_ADDR + 5),
+			L.record('star [%*d]\n', 0x10000000, 4, 7),
+		]) + b'> '
+		out, nerr = self.decode(data)
+		self.assertEqual(nerr, 0)
+		self.assertEqual(out,
+			'boot\n'
+			'[      1000] tick 1\n'
+			'[      1005] val -1 4294967295 beef\n'
+			'[      1205] name task_a (A)     a|%\n'
+			'[ 268436661] star [   7]\n'
+			'> ')
+
+	def test_lost(self):
+		L = self.log
+		out, nerr = self.decode(L.frame(0xFFFFFFFF, [L.record('tick %d\n', 2, -100)], lost=3))
+		self.assertEqual(nerr, 0)
+		self.assertEqual(out,
+			'[4294967295] *** 3 records lost ***\n'
+			'[         1] tick -100\n')
+
+	def test_truncated_tail(self):
+		""" Tail of the frame is discarded, and the text output follows """
+		L = self.log
+		recs = [L.record('tick %d\n', 1, n) for n in range(5)]
+		bad = L.frame(10, recs)[:-6]
+		data = bad + b'msg\n' + L.frame(50, [L.record('tick %d\n', 0, 99)])
+		out, nerr = self.decode(data)
+		self.assertEqual(nerr, 1)
+		self.assertEqual(out,
+			'[        11] tick 0\n'
+			'[        12] tick 1\n'
+			'[        13] tick 2\n'
+			'*** broken frame ***\n'
+			'msg\n'
+			'[        50] tick 99\n')
+
+	def test_truncated_chunk(self):
+		""" First payload chunk (ring buffer end) is cut, the second one is sent """
+		L = self.log
+		recs = [L.record('val %d %u %x\n', 1, n, 1000 + n, 0x12345678) for n in range(4)]
+		payload = b''.join(recs)
+		chunk1, chunk2 = payload[:len(payload) // 2 + 3], payload[len(payload) // 2 + 3:]
+		data = L.header(payload, 0) + chunk1[:-5] + chunk2 + L.frame(7, [L.record('tick %d\n', 0, 7)])
+		out, nerr = self.decode(data)
+		self.assertEqual(nerr, 1)
+		self.assertTrue(out.startswith('[         1] val 0 1000 12345678\n'))
+		self.assertTrue(out.endswith('*** broken frame ***\n[         7] tick 7\n'))
+
+	def test_truncated_header(self):
+		""" Only a part of the frame header is sent """
+		L = self.log
+		frame = L.frame(0x12345, [L.record('tick %d\n', 0, 1)])
+		data = b'a\n' + frame[:6] + b'b\n' + frame
+		out, nerr = self.decode(data)
+		self.assertEqual(nerr, 1)
+		self.assertEqual(out, 'a\n*** broken frame ***\nb\n[     74565] tick 1\n')
+
+	def test_truncated_end(self):
+		""" Capture ends in the frame """
+		L = self.log
+		frame = L.frame(0, [L.record('tick %d\n', 0, 1), L.record('tick %d\n', 0, 2)])
+		out, nerr = self.decode(frame[:-1])
+		self.assertEqual(nerr, 1)
+		self.assertEqual(out, '[         0] tick 1\n*** broken frame ***\n')
+
+
+if __name__ == '__main__':
+	unittest.main()
@@ -0,0 +1,316 @@
+/*
+ *----------------------------------------------------------------------
+ *    micro T-Kernel 3.0 BSP 2.0
+ *
+ *    Copyright (C) 2023-2024 by Ken Sakamura.
+ *    This software is distributed under the T-License 2.1.
+ *----------------------------------------------------------------------
+ *
+ *    Released by TRON Forum(http://www.tron.org) at 2024/08.
+ *
+ *----------------------------------------------------------------------
+ */
+
+/*
+ *	defwork_test.c
+ *	Test of the deferred work queue (Host tool)
+ *
+ *	usage: cc -O2 -pthread -o defwork_test tools/defwork_test.c
+ *	       ./defwork_test [<Number of items per producer>]
+ *
+ *	The queue of lib/libtk/defwork.c is tested on the host. The threads
+ *	are used as the interrupt handlers (Producers) and the worker task
+ *	(Consumer).
+ *		wrap	: Enqueue and dequeue across the wraparound of the slot
+ *			  index and the 32-bit sequence number.
+ *		full	: E_LIMIT and the lost count when the queue is full.
+ *		mpsc	: Concurrent producers. Each item is executed once and
+ *			  in the order of each producer, and the lost items are
+ *			  counted.
+ *	The exit status is 0 if all tests pass.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <sched.h>
+
+/* Definitions of micro T-Kernel used by defwork.c */
+typedef int32_t		W;
+typedef uint32_t	UW;
+typedef int		INT;
+typedef INT		BOOL;
+typedef W		ER;
+typedef W		ID;
+typedef UW		ATR;
+typedef INT		PRI;
+typedef INT		SZ;
+typedef W		TMO;
+typedef void		(*FP)();		/* Same as <tk/typedef.h> */
+
+#define LOCAL		static
+#define EXPORT
+#define TRUE		1
+#define FALSE		0
+#define E_OK		(0)
+#define E_PAR		(-17)
+#define E_LIMIT		(-34)
+#define TMO_FEVR	(-1)
+#define TA_HLNG		0x00000001
+#define TA_RNG0		0x00000000
+
+#define USE_DEFWORK	(1)
+#define DEFWORK_NPRI	(2)
+#define DEFWORK_QSZ	(16)
+#define DEFWORK_TSKPRI	(1)
+#define DEFWORK_STKSZ	(1024)
+
+typedef struct {
+	void	*exinf;
+	ATR	tskatr;
+	FP	task;
+	PRI	itskpri;
+	SZ	stksz;
+} T_CTSK;
+
+LOCAL UW	wup_cnt;		/* Number of tk_wup_tsk() calls */
+
+LOCAL ID tk_cre_tsk( T_CTSK *pk_ctsk ) { (void)pk_ctsk; return 1; }
+LOCAL ER tk_sta_tsk( ID tskid, INT stacd ) { (void)tskid; (void)stacd; return E_OK; }
+LOCAL ER tk_slp_tsk( TMO tmout ) { (void)tmout; return E_OK; }
+LOCAL ER tk_wup_tsk( ID tskid )
+{
+	(void)tskid;
+	__atomic_fetch_add(&wup_cnt, 1, __ATOMIC_RELAXED);
+	return E_OK;
+}
+
+#define DEFWORK_HOSTTEST
+#include "../lib/libtk/defwork.c"
+
+LOCAL INT	nerr;
+
+#define CHECK(cond, ...)						\
+	do {								\
+		if(!(cond)) {						\
+			printf("  NG: " __VA_ARGS__);			\
+			printf("\n");					\
+			nerr++;						\
+		}							\
+	} while(0)
+
+/*
+ * Set the queue position (The sequence numbers are set as the empty queue)
+ */
+LOCAL void set_qpos( INT pri, UW pos )
+{
+	T_DWORKQ	*q = &dworkq[pri];
+	UW		i;
+
+	q->enqp = q->deqp = pos;
+	for(i = 0; i < DEFWORK_QSZ; i++) {
+		q->item[(pos + i) & DEFWORK_QMASK].seq = pos + i;
+	}
+}
+
+/*----------------------------------------------------------------------
+ * Work function (Records the argument)
+ */
+LOCAL uintptr_t	done_last;
+LOCAL UW	done_cnt;
+
+LOCAL void work_rec( void *arg )
+{
+	done_last = (uintptr_t)arg;
+	done_cnt++;
+}
+
+/*
+ * Run the queued items (Worker task)
+ */
+LOCAL UW run_worker( INT pri )
+{
+	FP	func;
+	void	*arg;
+	UW	n = 0;
+
+	while(dwork_deq(&dworkq[pri], &func, &arg)) {
+		(*func)(arg);
+		n++;
+	}
+	return n;
+}
+
+/*----------------------------------------------------------------------
+ * Wraparound
+ *	The queue is filled and drained with various depths, starting just
+ *	below the wraparound of the 32-bit sequence number.
+ */
+#define WRAP_START	(0xFFFFFFFFU - 3 * DEFWORK_QSZ)
+
+LOCAL void test_wrap( void )
+{
+	uintptr_t	next = 1, expect = 1;
+	INT		round, depth, i;
+	ER		er;
+
+	printf("wrap\n");
+	set_qpos(0, WRAP_START);
+	for(round = 0; round < 100; round++) {
+		depth = 1 + round % DEFWORK_QSZ;
+		for(i = 0; i < depth; i++) {
+			er = DeferWork(0, work_rec, (void*)next++);
+			CHECK(er == E_OK, "round %d: DeferWork() = %d", round, er);
+		}
+		for(i = 0; i < depth; i++) {
+			FP	func;
+			void	*arg;
+
+			if(!dwork_deq(&dworkq[0], &func, &arg)) {
+				CHECK(0, "round %d: queue is empty at %d", round, i);
+				break;
+			}
+			CHECK((uintptr_t)arg == expect, "round %d: item %lu, expected %lu",
+					round, (unsigned long)(uintptr_t)arg, (unsigned long)expect);
+			expect++;
+		}
+	}
+	CHECK(dworkq[0].enqp < WRAP_START, "sequence number did not wrap (enqp %u)", dworkq[0].enqp);
+	CHECK(run_worker(0) == 0, "queue is not empty");
+}
+
+/*----------------------------------------------------------------------
+ * Full queue
+ */
+LOCAL void test_full( void )
+{
+	UW	lost;
+	INT	i;
+	ER	er;
+
+	printf("full\n");
+	set_qpos(1, 0xFFFFFFFFU - 5);
+	lost = GetDeferredWorkLost(1);
+	for(i = 0; i < DEFWORK_QSZ; i++) {
+		er = DeferWork(1, work_rec, (void*)(uintptr_t)i);
+		CHECK(er == E_OK, "item %d: DeferWork() = %d", i, er);
+	}
+	er = DeferWork(1, work_rec, (void*)(uintptr_t)DEFWORK_QSZ);
+	CHECK(er == E_LIMIT, "full queue: DeferWork() = %d", er);
+	CHECK(GetDeferredWorkLost(1) == lost + 1, "lost count %u", GetDeferredWorkLost(1));
+
+	/* One slot is released by the worker */
+	{
+		FP	func;
+		void	*arg;
+
+		CHECK(dwork_deq(&dworkq[1], &func, &arg) && (uintptr_t)arg == 0, "first item");
+	}
+	er = DeferWork(1, work_rec, (void*)(uintptr_t)DEFWORK_QSZ);
+	CHECK(er == E_OK, "after dequeue: DeferWork() = %d", er);
+
+	done_cnt = 0;
+	CHECK(run_worker(1) == DEFWORK_QSZ, "number of items %u", done_cnt);
+	CHECK(done_last == DEFWORK_QSZ, "last item %lu", (unsigned long)done_last);
+
+	CHECK(DeferWork(DEFWORK_NPRI, work_rec, NULL) == E_PAR, "invalid level");
+	CHECK(DeferWork(0, NULL, NULL) == E_PAR, "invalid function");
+}
+
+/*----------------------------------------------------------------------
+ * Concurrent producers (Interrupt handlers) and the worker task
+ *	The argument is (producer << 24) | sequence number.
+ */
+#define NPROD		4
+
+LOCAL long		nitem = 200000;
+LOCAL volatile INT	prod_run;
+LOCAL UW		prod_ok[NPROD];
+LOCAL UW		prod_lost[NPROD];
+LOCAL UW		cons_next[NPROD];
+LOCAL UW		cons_cnt;
+
+LOCAL void work_chk( void *arg )
+{
+	UW	v = (UW)(uintptr_t)arg;
+	INT	prod = v >> 24;
+	UW	seq = v & 0x00FFFFFF;
+
+	if(prod >= NPROD || seq < cons_next[prod]) {
+		CHECK(0, "producer %d: item %u is out of order (next %u)", prod, seq, cons_next[prod]);
+	} else {
+		cons_next[prod] = seq + 1;
+	}
+	cons_cnt++;
+}
+
+LOCAL void *producer( void *arg )
+{
+	INT	prod = (INT)(uintptr_t)arg;
+	long	i;
+
+	for(i = 0; i < nitem; i++) {
+		if(DeferWork(0, work_chk, (void*)(uintptr_t)((prod << 24) | i)) == E_OK) {
+			prod_ok[prod]++;
+		} else {
+			prod_lost[prod]++;
+			sched_yield();			// Let the worker run
+		}
+	}
+	return NULL;
+}
+
+LOCAL void *consumer( void *arg )
+{
+	(void)arg;
+	while(__atomic_load_n(&prod_run, __ATOMIC_ACQUIRE)) {
+		if(run_worker(0) == 0) sched_yield();
+	}
+	run_worker(0);
+	return NULL;
+}
+
+LOCAL void test_mpsc( void )
+{
+	pthread_t	pth[NPROD], cth;
+	UW		ok = 0, lost = 0, lost0;
+	INT		i;
+
+	printf("mpsc (%d producers, %ld items each)\n", NPROD, nitem);
+	set_qpos(0, 0xFFFFFFFFU - 1000);
+	lost0 = GetDeferredWorkLost(0);
+	cons_cnt = 0;
+
+	prod_run = 1;
+	pthread_create(&cth, NULL, consumer, NULL);
+	for(i = 0; i < NPROD; i++) {
+		pthread_create(&pth[i], NULL, producer, (void*)(uintptr_t)i);
+	}
+	for(i = 0; i < NPROD; i++) {
+		pthread_join(pth[i], NULL);
+		ok += prod_ok[i];
+		lost += prod_lost[i];
+	}
+	__atomic_store_n(&prod_run, 0, __ATOMIC_RELEASE);
+	pthread_join(cth, NULL);
+
+	printf("  executed %u  lost %u\n", cons_cnt, lost);
+	CHECK(cons_cnt == ok, "executed %u, enqueued %u", cons_cnt, ok);
+	CHECK(GetDeferredWorkLost(0) - lost0 == lost, "lost count %u, E_LIMIT %u",
+			GetDeferredWorkLost(0) - lost0, lost);
+	CHECK(wup_cnt >= ok, "worker wakeup %u", wup_cnt);
+}
+
+int main( int argc, char *argv[] )
+{
+	if(argc > 1) nitem = atol(argv[1]);
+	if(nitem <= 0 || nitem > 0x00FFFFFF) nitem = 200000;
+
+	InitDeferredWork();
+	test_wrap();
+	test_full();
+	test_mpsc();
+
+	printf("%s\n", (nerr == 0)? "OK": "FAILED");
+	return (nerr == 0)? 0: 1;
+}
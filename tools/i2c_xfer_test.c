@@ -0,0 +1,791 @@
+/*
+ *----------------------------------------------------------------------
+ *    micro T-Kernel 3.0 BSP 2.0
+ *
+ *    Copyright (C) 2023-2024 by Ken Sakamura.
+ *    This software is distributed under the T-License 2.1.
+ *----------------------------------------------------------------------
+ *
+ *    Released by TRON Forum(http://www.tron.org) at 2024/08.
+ *
+ *----------------------------------------------------------------------
+ */
+
+/*
+ *	i2c_xfer_test.c
+ *	Test of the I2C transaction queue on a simulated bus (Host tool)
+ *
+ *	usage: cc -O2 -pthread -o i2c_xfer_test tools/i2c_xfer_test.c
+ *	       ./i2c_xfer_test
+ *
+ *	The transaction queue of the STM32Cube I2C driver
+ *	(sysdepend/stm32_cube/device/hal_i2c/hal_i2c.c) is run with the HAL
+ *	functions of a simulated bus. The bus executes one transfer at a time,
+ *	and the test completes it by calling the HAL callback (Interrupt).
+ *		order	: Transactions of several submitters are executed in
+ *			  order of submission, back-to-back.
+ *		fair	: A polling submitter is not starved by a bulk submitter.
+ *			  (The wait is bounded by the queue length at submission)
+ *		error	: Start failure, bus error, cancel and abort.
+ *		sync	: Synchronous transactions of concurrent tasks (Threads)
+ *			  are queued together.
+ *	The exit status is 0 if all tests pass.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+/* Definitions of micro T-Kernel used by hal_i2c.c */
+typedef int32_t		W;
+typedef uint32_t	UW;
+typedef uint8_t		UB;
+typedef int		INT;
+typedef unsigned int	UINT;
+typedef INT		BOOL;
+typedef W		ER;
+typedef W		ID;
+typedef W		SZ;
+typedef UW		ATR;
+typedef W		TMO;
+
+#define LOCAL		static
+#define EXPORT
+#define IMPORT		extern
+#define CONST		const
+#define TRUE		1
+#define FALSE		0
+#define E_OK		(0)
+#define E_SYS		(-5)
+#define E_NOSPT		(-9)
+#define E_PAR		(-17)
+#define E_ID		(-18)
+#define E_NOMEM		(-33)
+#define E_OBJ		(-41)
+#define E_TMOUT		(-50)
+#define E_ABORT		(-52)
+#define E_IO		(-57)
+#define E_BUSY		(-65)
+#define TMO_FEVR	(-1)
+#define TA_TFIFO	0x00000000
+#define TA_FIRST	0x00000000
+#define TA_WMUL		0x00000008
+#define TWF_ANDW	0x00000000
+#define TWF_BITCLR	0x00000020
+#define TDK_UNDEF	0x0000
+
+#define MTKBSP_STM32CUBE
+#define DEVCNF_USE_HAL_IIC	(1)
+#define TK_SUPPORT_MEMLIB	(1)
+
+#define DEVNAME_HAL_I2C		"hiic"
+#define DEV_HAL_I2C_TMOUT	(50)
+#define DEV_HAL_I2C_UNITNM	(2)
+#define DEV_HAL_I2C_DMA_UNIT	(0x00)
+#define DEV_HAL_I2C_DMA_SIZE	(32)
+
+#define Kmalloc		malloc
+#define Kfree		free
+#define knl_strcpy	strcpy
+#define knl_strlen	strlen
+#define knl_memset	memset
+#define CNF_MAX_OPNDEV	(16)
+
+#define DCacheClean(a, s)	((void)(a), (void)(s))
+#define DCacheFlush(a, s)	((void)(a), (void)(s))
+#define DCacheInvalidate(a, s)	((void)(a), (void)(s))
+
+/* Interrupt disable: The callbacks of the simulated bus are serialized */
+LOCAL pthread_mutex_t	intr_lock;
+#define DI(imask)	(pthread_mutex_lock(&intr_lock), (imask) = 0)
+#define EI(imask)	((void)(imask), pthread_mutex_unlock(&intr_lock))
+#define ENTER_TASK_INDEPENDENT
+#define LEAVE_TASK_INDEPENDENT
+
+/* Event flag and semaphore */
+typedef struct { ATR flgatr; UINT iflgptn; } T_CFLG;
+typedef struct { ATR sematr; INT isemcnt; INT maxsem; } T_CSEM;
+
+LOCAL pthread_mutex_t	obj_lock = PTHREAD_MUTEX_INITIALIZER;
+LOCAL pthread_cond_t	obj_cond = PTHREAD_COND_INITIALIZER;
+LOCAL UINT		flg_ptn;
+LOCAL INT		sem_cnt;
+
+LOCAL ID tk_cre_flg( T_CFLG *pk_cflg ) { flg_ptn = pk_cflg->iflgptn; return 1; }
+LOCAL ER tk_del_flg( ID flgid ) { (void)flgid; return E_OK; }
+LOCAL ID tk_cre_sem( T_CSEM *pk_csem ) { sem_cnt = pk_csem->isemcnt; return 1; }
+LOCAL ER tk_del_sem( ID semid ) { (void)semid; return E_OK; }
+
+LOCAL ER tk_set_flg( ID flgid, UINT setptn )
+{
+	(void)flgid;
+	pthread_mutex_lock(&obj_lock);
+	flg_ptn |= setptn;
+	pthread_cond_broadcast(&obj_cond);
+	pthread_mutex_unlock(&obj_lock);
+	return E_OK;
+}
+
+LOCAL ER tk_clr_flg( ID flgid, UINT clrptn )
+{
+	(void)flgid;
+	pthread_mutex_lock(&obj_lock);
+	flg_ptn &= clrptn;
+	pthread_mutex_unlock(&obj_lock);
+	return E_OK;
+}
+
+LOCAL ER obj_wait( TMO tmout, struct timespec *ts )
+{
+	if(tmout == TMO_FEVR) {
+		pthread_cond_wait(&obj_cond, &obj_lock);
+		return E_OK;
+	}
+	return (pthread_cond_timedwait(&obj_cond, &obj_lock, ts) == ETIMEDOUT)? E_TMOUT: E_OK;
+}
+
+LOCAL void obj_timeout( TMO tmout, struct timespec *ts )
+{
+	clock_gettime(CLOCK_REALTIME, ts);
+	if(tmout == TMO_FEVR) return;
+	ts->tv_nsec += (long)tmout * 1000000;
+	ts->tv_sec += ts->tv_nsec / 1000000000;
+	ts->tv_nsec %= 1000000000;
+}
+
+LOCAL ER tk_wai_flg( ID flgid, UINT waiptn, UINT wfmode, UINT *p_flgptn, TMO tmout )
+{
+	struct timespec	ts;
+	ER		err = E_OK;
+
+	(void)flgid;
+	obj_timeout(tmout, &ts);
+	pthread_mutex_lock(&obj_lock);
+	while((flg_ptn & waiptn) != waiptn && err == E_OK) err = obj_wait(tmout, &ts);
+	if((flg_ptn & waiptn) == waiptn) {
+		*p_flgptn = flg_ptn;
+		if(wfmode & TWF_BITCLR) flg_ptn &= ~waiptn;
+		err = E_OK;
+	}
+	pthread_mutex_unlock(&obj_lock);
+	return err;
+}
+
+LOCAL ER tk_wai_sem( ID semid, INT cnt, TMO tmout )
+{
+	struct timespec	ts;
+	ER		err = E_OK;
+
+	(void)semid;
+	obj_timeout(tmout, &ts);
+	pthread_mutex_lock(&obj_lock);
+	while(sem_cnt < cnt && err == E_OK) err = obj_wait(tmout, &ts);
+	if(sem_cnt >= cnt) {
+		sem_cnt -= cnt;
+		err = E_OK;
+	}
+	pthread_mutex_unlock(&obj_lock);
+	return err;
+}
+
+LOCAL ER tk_sig_sem( ID semid, INT cnt )
+{
+	(void)semid;
+	pthread_mutex_lock(&obj_lock);
+	sem_cnt += cnt;
+	pthread_cond_broadcast(&obj_cond);
+	pthread_mutex_unlock(&obj_lock);
+	return E_OK;
+}
+
+/* Device management */
+typedef struct { W start; void *buf; SZ size; SZ asize; } T_DEVREQ;
+typedef struct { ID evtmbfid; } T_IDEV;
+struct t_msdi;
+typedef struct {
+	void	*exinf;
+	ATR	drvatr;
+	ATR	devatr;
+	INT	nsub;
+	SZ	blksz;
+	ER	(*openfn)( ID devid, UINT omode, struct t_msdi *msdi );
+	ER	(*closefn)( ID devid, UINT option, struct t_msdi *msdi );
+	ER	(*readfn)( T_DEVREQ *req, struct t_msdi *msdi );
+	ER	(*writefn)( T_DEVREQ *req, struct t_msdi *msdi );
+	ER	(*eventfn)( INT evttyp, void *evtinf, struct t_msdi *msdi );
+	UB	devnm[8+1];
+} T_DMSDI;
+typedef struct t_msdi { T_DMSDI dmsdi; ID devid; } T_MSDI;
+
+LOCAL T_MSDI	msdi[DEV_HAL_I2C_UNITNM];
+LOCAL INT	msdi_cnt;
+
+LOCAL ER msdi_def_dev( T_DMSDI *dmsdi, T_IDEV *idev, T_MSDI **p_msdi )
+{
+	*p_msdi = &msdi[msdi_cnt];
+	msdi[msdi_cnt].dmsdi = *dmsdi;
+	msdi[msdi_cnt].devid = msdi_cnt + 1;
+	msdi_cnt++;
+	idev->evtmbfid = 0;
+	return E_OK;
+}
+
+LOCAL INT	oref_cnt;			// Number of tk_oref_dev() calls
+LOCAL ID tk_oref_dev( ID dd, UB *devnm ) { (void)devnm; oref_cnt++; return dd; }
+
+#define TDN_HAL_I2C_EXEC	(-99)
+typedef struct {
+	UW	sadr;
+	SZ	snd_size;
+	UB	*snd_data;
+	SZ	rcv_size;
+	UB	*rcv_data;
+} T_HAL_I2C_EXEC;
+
+/*----------------------------------------------------------------------
+ * Simulated bus (STM32Cube HAL)
+ */
+typedef enum { HAL_OK = 0, HAL_ERROR, HAL_BUSY, HAL_TIMEOUT } HAL_StatusTypeDef;
+typedef struct { INT dummy; } DMA_HandleTypeDef;
+typedef struct { UW CR1; } I2C_TypeDef;
+typedef struct {
+	I2C_TypeDef		*Instance;
+	DMA_HandleTypeDef	*hdmatx;
+	DMA_HandleTypeDef	*hdmarx;
+} I2C_HandleTypeDef;
+
+#define I2C1_BASE	(0x40005400UL)	// Registers are not accessed
+#define I2C3_BASE	(0x40005C00UL)
+
+#define I2C_MEMADD_SIZE_8BIT	(1)
+#define I2C_MEMADD_SIZE_16BIT	(2)
+#define I2C_FIRST_FRAME		(1)
+#define I2C_LAST_FRAME		(2)
+
+enum { OP_NONE, OP_TX, OP_RX, OP_SEQ_TX, OP_SEQ_RX, OP_MEM_TX, OP_MEM_RX, OP_ABORT, OP_SLAVE };
+
+#define LOG_MAX		(64)
+
+LOCAL struct {
+	I2C_HandleTypeDef	*hi2c;
+	INT			op;		// Executing transfer
+	UW			sadr;
+	UW			radr;
+	UB			*buf;
+	uint16_t		size;
+	INT			fail;		// Number of the start failures to inject
+	UW			nstart;		// Number of the started transfers
+	UW			nidle;		// Idle while transactions are queued
+	INT			log[LOG_MAX][2];// Started transfers (op, sadr)
+	INT			nlog;
+} bus;
+
+LOCAL HAL_StatusTypeDef bus_start( I2C_HandleTypeDef *hi2c, INT op, uint16_t sadr, UW radr,
+						UB *buf, uint16_t size )
+{
+	if(bus.op != OP_NONE) return HAL_BUSY;
+	if(bus.fail > 0) {
+		bus.fail--;
+		return HAL_ERROR;
+	}
+	bus.hi2c = hi2c;
+	bus.op	 = op;
+	bus.sadr = sadr >> 1;
+	bus.radr = radr;
+	bus.buf	 = buf;
+	bus.size = size;
+	bus.nstart++;
+	if(bus.nlog < LOG_MAX) {
+		bus.log[bus.nlog][0] = op;
+		bus.log[bus.nlog][1] = (INT)bus.sadr;
+		bus.nlog++;
+	}
+	return HAL_OK;
+}
+
+#define HAL_I2C_Master_Transmit_IT(h, a, b, n)		bus_start(h, OP_TX, a, 0, b, n)
+#define HAL_I2C_Master_Receive_IT(h, a, b, n)		bus_start(h, OP_RX, a, 0, b, n)
+#define HAL_I2C_Master_Seq_Transmit_IT(h, a, b, n, o)	bus_start(h, OP_SEQ_TX, a, 0, b, n)
+#define HAL_I2C_Master_Seq_Receive_IT(h, a, b, n, o)	bus_start(h, OP_SEQ_RX, a, 0, b, n)
+#define HAL_I2C_Mem_Write_IT(h, a, r, m, b, n)		((void)(m), bus_start(h, OP_MEM_TX, a, r, b, n))
+#define HAL_I2C_Mem_Read_IT(h, a, r, m, b, n)		((void)(m), bus_start(h, OP_MEM_RX, a, r, b, n))
+#define HAL_I2C_Master_Transmit_DMA			HAL_I2C_Master_Transmit_IT
+#define HAL_I2C_Master_Receive_DMA			HAL_I2C_Master_Receive_IT
+#define HAL_I2C_Master_Seq_Transmit_DMA			HAL_I2C_Master_Seq_Transmit_IT
+#define HAL_I2C_Master_Seq_Receive_DMA			HAL_I2C_Master_Seq_Receive_IT
+#define HAL_I2C_Mem_Write_DMA				HAL_I2C_Mem_Write_IT
+#define HAL_I2C_Mem_Read_DMA				HAL_I2C_Mem_Read_IT
+#define HAL_I2C_Slave_Transmit_IT(h, b, n)		bus_start(h, OP_SLAVE, 0, 0, b, n)
+#define HAL_I2C_Slave_Receive_IT(h, b, n)		bus_start(h, OP_SLAVE, 0, 0, b, n)
+
+LOCAL HAL_StatusTypeDef HAL_I2C_Master_Abort_IT( I2C_HandleTypeDef *hi2c, uint16_t sadr )
+{
+	(void)sadr;
+	if(bus.op == OP_NONE) return HAL_ERROR;
+	bus.hi2c = hi2c;
+	bus.op = OP_ABORT;
+	return HAL_OK;
+}
+
+#include "../sysdepend/stm32_cube/device/hal_i2c/hal_i2c.h"
+
+#define I2C_HOSTTEST
+#include "../sysdepend/stm32_cube/device/hal_i2c/hal_i2c.c"
+
+/* Received data of the simulated target */
+#define RXDATA(sadr, radr, i)	((UB)((sadr) * 16 + (radr) + (i)))
+
+/*
+ * Complete the executing transfer (Interrupt)
+ *	Returns FALSE if the bus is idle.
+ */
+LOCAL BOOL bus_complete( BOOL error )
+{
+	I2C_HandleTypeDef	*hi2c = bus.hi2c;
+	INT			op;
+	UINT			i, imask;
+
+	DI(imask);
+	op = bus.op;
+	if(op == OP_NONE) {
+		EI(imask);
+		return FALSE;
+	}
+	if(!error && (op == OP_RX || op == OP_SEQ_RX || op == OP_MEM_RX)) {
+		for(i = 0; i < bus.size; i++) bus.buf[i] = RXDATA(bus.sadr, bus.radr, i);
+	}
+	bus.op = OP_NONE;
+
+	if(op == OP_ABORT) {
+		HAL_I2C_AbortCpltCallback(hi2c);
+	} else if(error) {
+		HAL_I2C_ErrorCallback(hi2c);
+	} else if(op == OP_TX || op == OP_SEQ_TX) {
+		HAL_I2C_MasterTxCpltCallback(hi2c);
+	} else if(op == OP_RX || op == OP_SEQ_RX) {
+		HAL_I2C_MasterRxCpltCallback(hi2c);
+	} else if(op == OP_MEM_TX) {
+		HAL_I2C_MemTxCpltCallback(hi2c);
+	} else {
+		HAL_I2C_MemRxCpltCallback(hi2c);
+	}
+
+	/* Back-to-back: The next transaction is started in the interrupt */
+	if(bus.op == OP_NONE && get_hdl_dcb(hi2c)->xfer_top != NULL) bus.nidle++;
+	EI(imask);
+	return TRUE;
+}
+
+LOCAL void bus_reset( void )
+{
+	bus.op = OP_NONE;
+	bus.fail = 0;
+	bus.nstart = 0;
+	bus.nidle = 0;
+	bus.nlog = 0;
+}
+
+/*----------------------------------------------------------------------
+ * Test
+ */
+LOCAL INT	nerr;
+
+#define CHECK(cond, ...)						\
+	do {								\
+		if(!(cond)) {						\
+			printf("  NG: " __VA_ARGS__);			\
+			printf("\n");					\
+			nerr++;						\
+		}							\
+	} while(0)
+
+LOCAL I2C_HandleTypeDef	hi2c[DEV_HAL_I2C_UNITNM];
+LOCAL ID		dd[DEV_HAL_I2C_UNITNM];
+
+/* Completion record */
+#define NXFER		(16)
+
+LOCAL T_HAL_I2C_XFER	xfer[NXFER];
+LOCAL UB		rbuf[NXFER][8];
+LOCAL UB		sbuf[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+LOCAL INT		done[NXFER];
+LOCAL INT		ndone;
+
+LOCAL void xfer_cbf( T_HAL_I2C_XFER *p_xfer )
+{
+	if(ndone < NXFER) done[ndone++] = (INT)(p_xfer - xfer);
+}
+
+/* Set the transaction (Target address = Index) */
+LOCAL T_HAL_I2C_XFER *set_xfer( INT n, INT type )
+{
+	T_HAL_I2C_XFER	*p = &xfer[n];
+
+	memset(p, 0, sizeof(*p));
+	memset(rbuf[n], 0, sizeof(rbuf[n]));
+	p->sadr = (UW)n;
+	p->cbf = xfer_cbf;
+	switch(type) {
+	case OP_TX:				// Write
+		p->sbuf = sbuf; p->ssize = 4;
+		break;
+	case OP_RX:				// Read
+		p->rbuf = rbuf[n]; p->rsize = 4;
+		break;
+	case OP_SEQ_TX:				// Write-then-read
+		p->sbuf = sbuf; p->ssize = 1;
+		p->rbuf = rbuf[n]; p->rsize = 6;
+		break;
+	case OP_MEM_RX:				// Register read (16-bit address)
+		p->radr = 0x10; p->rasz = 2;
+		p->rbuf = rbuf[n]; p->rsize = 2;
+		break;
+	}
+	return p;
+}
+
+LOCAL BOOL check_rx( INT n, UW radr )
+{
+	SZ	i;
+
+	for(i = 0; i < xfer[n].rsize; i++) {
+		if(rbuf[n][i] != RXDATA((UW)n, radr, i)) return FALSE;
+	}
+	return TRUE;
+}
+
+/*----------------------------------------------------------------------
+ * Order of execution
+ *	Three submitters queue the transactions of each type alternately.
+ */
+LOCAL void test_order( void )
+{
+	static const INT type[NXFER] = {
+		OP_TX, OP_RX, OP_SEQ_TX, OP_MEM_RX, OP_RX, OP_TX, OP_SEQ_TX, OP_RX,
+		OP_MEM_RX, OP_TX, OP_TX, OP_SEQ_TX, OP_RX, OP_MEM_RX, OP_TX, OP_SEQ_TX,
+	};
+	INT	expect[LOG_MAX][2];
+	INT	i, n, nexp;
+	ER	er;
+
+	printf("order\n");
+	bus_reset();
+	ndone = 0;
+	for(i = 0; i < NXFER; i++) {
+		/* Submitter A: 0,3,6,..  B: 1,4,7,..  C: 2,5,8,.. */
+		er = i2c_submit_xfer(dd[0], set_xfer(i, type[i]));
+		CHECK(er == E_OK, "submit %d: %d", i, er);
+		if(i == 5) {			// Some are completed while queueing
+			bus_complete(FALSE);
+			bus_complete(FALSE);
+		}
+	}
+	while(bus_complete(FALSE));
+
+	for(i = 0, nexp = 0; i < NXFER; i++) {
+		expect[nexp][0] = (type[i] == OP_MEM_RX)? OP_MEM_RX: type[i];
+		expect[nexp++][1] = i;
+		if(type[i] == OP_SEQ_TX) {	// Repeated start
+			expect[nexp][0] = OP_SEQ_RX;
+			expect[nexp++][1] = i;
+		}
+	}
+	CHECK(bus.nlog == nexp, "%d transfers, expected %d", bus.nlog, nexp);
+	for(n = 0; n < nexp && n < bus.nlog; n++) {
+		CHECK(bus.log[n][0] == expect[n][0] && bus.log[n][1] == expect[n][1],
+			"transfer %d: op %d sadr %d, expected op %d sadr %d",
+			n, bus.log[n][0], bus.log[n][1], expect[n][0], expect[n][1]);
+	}
+	CHECK(ndone == NXFER, "%d completed", ndone);
+	for(i = 0; i < ndone; i++) {
+		n = done[i];
+		CHECK(n == i, "completion %d: transaction %d", i, n);
+		CHECK(xfer[n].err == E_OK, "transaction %d: err %d", n, xfer[n].err);
+		CHECK(check_rx(n, xfer[n].rasz? xfer[n].radr: 0), "transaction %d: receive data", n);
+	}
+	CHECK(bus.nidle == 0, "bus idle %u times with queued transactions", bus.nidle);
+}
+
+/*----------------------------------------------------------------------
+ * Fairness
+ *	The polling submitter keeps one transaction queued, and the bulk
+ *	submitter queues a burst of BURST transactions whenever its previous
+ *	burst has been completed.
+ */
+#define BURST		(8)
+#define NFAIR		(2000)
+
+LOCAL T_HAL_I2C_XFER	poll_xfer, bulk_xfer[BURST];
+LOCAL UB		poll_buf[2];
+LOCAL UW		poll_submit, poll_wait_max, poll_cnt, bulk_cnt, bulk_left;
+
+LOCAL void bulk_burst( void );
+
+LOCAL void poll_cbf( T_HAL_I2C_XFER *p_xfer )
+{
+	(void)p_xfer;
+	poll_cnt++;
+	poll_xfer.rbuf = poll_buf;
+	poll_xfer.rsize = 2;
+	poll_submit = bus.nstart;
+	i2c_submit_xfer(dd[0], &poll_xfer);	// Pipelined from the callback
+}
+
+LOCAL void bulk_cbf( T_HAL_I2C_XFER *p_xfer )
+{
+	(void)p_xfer;
+	bulk_cnt++;
+	if(--bulk_left == 0) bulk_burst();
+}
+
+LOCAL void bulk_burst( void )
+{
+	INT	i;
+
+	for(i = 0; i < BURST; i++) {
+		memset(&bulk_xfer[i], 0, sizeof(T_HAL_I2C_XFER));
+		bulk_xfer[i].sadr = 0x50;
+		bulk_xfer[i].sbuf = sbuf;
+		bulk_xfer[i].ssize = 8;
+		bulk_xfer[i].cbf = bulk_cbf;
+		i2c_submit_xfer(dd[0], &bulk_xfer[i]);
+	}
+	bulk_left = BURST;
+}
+
+LOCAL void test_fair( void )
+{
+	UW	wait;
+	INT	i;
+
+	printf("fair (burst %d)\n", BURST);
+	bus_reset();
+	poll_cnt = bulk_cnt = 0;
+	poll_wait_max = 0;
+
+	memset(&poll_xfer, 0, sizeof(poll_xfer));
+	poll_xfer.sadr = 0x20;
+	poll_xfer.rbuf = poll_buf;
+	poll_xfer.rsize = 2;
+	poll_xfer.cbf = poll_cbf;
+	bulk_burst();
+	poll_submit = bus.nstart;
+	i2c_submit_xfer(dd[0], &poll_xfer);
+
+	for(i = 0; i < NFAIR; i++) {
+		if(bus.op == OP_RX && bus.sadr == 0x20) {
+			/* Transfers started between the submission and the start */
+			wait = bus.nstart - 1 - poll_submit;
+			if(wait > poll_wait_max) poll_wait_max = wait;
+		}
+		bus_complete(FALSE);
+	}
+	printf("  polling %u  bulk %u  max wait %u transfers\n", poll_cnt, bulk_cnt, poll_wait_max);
+	CHECK(poll_wait_max <= BURST, "polling transaction waited %u transfers", poll_wait_max);
+	CHECK(poll_cnt >= NFAIR / (BURST + 1), "polling transactions %u", poll_cnt);
+	CHECK(bulk_cnt >= NFAIR / 2, "bulk transactions %u", bulk_cnt);
+	CHECK(bus.nidle == 0, "bus idle %u times with queued transactions", bus.nidle);
+
+	/* Drain the queue */
+	poll_xfer.cbf = NULL;
+	for(i = 0; i < BURST; i++) bulk_xfer[i].cbf = NULL;
+	while(bus_complete(FALSE));
+}
+
+/*----------------------------------------------------------------------
+ * Errors, cancel and abort
+ */
+LOCAL void test_error( void )
+{
+	T_HAL_I2C_XFER	*p;
+	UB		data[2];
+	ER		er;
+
+	printf("error\n");
+
+	/* Start failure: Completed with E_IO, and the next one is started */
+	bus_reset();
+	ndone = 0;
+	i2c_submit_xfer(dd[0], set_xfer(0, OP_TX));
+	bus.fail = 1;
+	i2c_submit_xfer(dd[0], set_xfer(1, OP_RX));
+	i2c_submit_xfer(dd[0], set_xfer(2, OP_RX));
+	while(bus_complete(FALSE));
+	CHECK(ndone == 3 && xfer[1].err == E_IO && xfer[2].err == E_OK, "start failure: err %d, %d",
+			xfer[1].err, xfer[2].err);
+
+	/* Bus error on the send of write-then-read: The receive is not started */
+	bus_reset();
+	i2c_submit_xfer(dd[0], set_xfer(3, OP_SEQ_TX));
+	i2c_submit_xfer(dd[0], set_xfer(4, OP_TX));
+	bus_complete(TRUE);
+	CHECK(xfer[3].err == E_IO, "bus error: err %d", xfer[3].err);
+	CHECK(bus.op == OP_TX && bus.sadr == 4, "bus error: next transaction is not started");
+	while(bus_complete(FALSE));
+	CHECK(bus.nlog == 2, "bus error: %d transfers", bus.nlog);
+
+	/* Cancel: Only the waiting transaction is removed */
+	bus_reset();
+	ndone = 0;
+	i2c_submit_xfer(dd[0], set_xfer(5, OP_TX));
+	i2c_submit_xfer(dd[0], p = set_xfer(6, OP_TX));
+	i2c_submit_xfer(dd[0], set_xfer(7, OP_TX));
+	CHECK(i2c_cancel_xfer(dd[0], &xfer[5]) == E_OBJ, "cancel of executing transaction");
+	CHECK(i2c_cancel_xfer(dd[0], p) == E_OK && p->err == E_ABORT, "cancel: err %d", p->err);
+	CHECK(i2c_cancel_xfer(dd[0], p) == E_OBJ, "cancel of removed transaction");
+	while(bus_complete(FALSE));
+	CHECK(ndone == 2 && done[0] == 5 && done[1] == 7, "cancel: %d completed", ndone);
+
+	/* Timeout: The transfer is aborted, and the queue is restarted on the
+	   abort completion */
+	bus_reset();
+	ndone = 0;
+	er = i2c_read_regs(dd[0], 0x30, 0, data, 2);	// The bus does not respond
+	CHECK(er == E_TMOUT, "timeout: %d", er);
+	CHECK(bus.op == OP_ABORT, "timeout: transfer is not aborted");
+	i2c_submit_xfer(dd[0], set_xfer(8, OP_RX));
+	CHECK(bus.op == OP_ABORT, "timeout: started before the abort completion");
+	bus_complete(FALSE);
+	CHECK(bus.op == OP_RX && bus.sadr == 8, "timeout: queue is not restarted");
+	while(bus_complete(FALSE));
+	CHECK(ndone == 1 && xfer[8].err == E_OK && check_rx(8, 0), "timeout: err %d", xfer[8].err);
+
+	/* Invalid transactions */
+	p = set_xfer(9, OP_TX);
+	p->ssize = 0;
+	CHECK(i2c_submit_xfer(dd[0], p) == E_PAR, "empty transaction");
+	p = set_xfer(9, OP_SEQ_TX);
+	p->rasz = 1;
+	CHECK(i2c_submit_xfer(dd[0], p) == E_PAR, "register access with write-then-read");
+	CHECK(bus.op == OP_NONE, "bus is not idle");
+
+	/* The DCB of the dd is cached: The device is looked up only once */
+	oref_cnt = 0;
+	i2c_submit_xfer(dd[0], set_xfer(10, OP_TX));
+	i2c_submit_xfer(dd[0], set_xfer(11, OP_TX));
+	while(bus_complete(FALSE));
+	CHECK(oref_cnt == 0, "dd cache: %d lookups", oref_cnt);
+	dev_i2c_openfn(dd[0], 0, &msdi[0]);		// The cache is cleared by open
+	i2c_submit_xfer(dd[0], set_xfer(12, OP_TX));
+	i2c_submit_xfer(dd[0], set_xfer(13, OP_TX));
+	while(bus_complete(FALSE));
+	CHECK(oref_cnt == 1, "dd cache after open: %d lookups", oref_cnt);
+	CHECK(i2c_submit_xfer(CNF_MAX_OPNDEV + 1, set_xfer(14, OP_TX)) == E_ID, "invalid dd");
+}
+
+/*----------------------------------------------------------------------
+ * Synchronous transactions of concurrent tasks
+ *	The tasks read the registers with i2c_read_regs(), and the bus
+ *	thread completes the transfers.
+ */
+#define NTASK		(4)
+#define NSYNC		(300)
+
+LOCAL volatile INT	bus_run;
+LOCAL UW		sync_depth;		// Maximum number of queued transactions
+LOCAL INT		sync_err[NTASK];
+
+LOCAL void *bus_thread( void *arg )
+{
+	T_HAL_I2C_DCB	*p_dcb = get_dcb_ptr(1);
+	T_HAL_I2C_XFER	*p;
+	UW		n;
+	UINT		imask;
+
+	(void)arg;
+	while(__atomic_load_n(&bus_run, __ATOMIC_ACQUIRE)) {
+		usleep(20);			// Transfer time
+		DI(imask);
+		for(n = 0, p = p_dcb->xfer_top; p != NULL; p = p->next) n++;
+		if(n > sync_depth) sync_depth = n;
+		EI(imask);
+		bus_complete(FALSE);
+	}
+	return NULL;
+}
+
+LOCAL void *sync_task( void *arg )
+{
+	INT	t = (INT)(uintptr_t)arg;
+	UB	buf[4];
+	UW	radr;
+	INT	i, j;
+	ER	er;
+
+	for(i = 0; i < NSYNC; i++) {
+		radr = (UW)(i & 0x7);
+		memset(buf, 0, sizeof(buf));
+		er = i2c_read_regs(dd[1], (UW)(0x40 + t), radr, buf, sizeof(buf));
+		if(er != E_OK) {
+			sync_err[t]++;
+			continue;
+		}
+		for(j = 0; j < (INT)sizeof(buf); j++) {
+			if(buf[j] != RXDATA((UW)(0x40 + t), radr, j)) {
+				sync_err[t]++;
+				break;
+			}
+		}
+	}
+	return NULL;
+}
+
+LOCAL void test_sync( void )
+{
+	pthread_t	bth, tth[NTASK];
+	INT		t;
+
+	printf("sync (%d tasks)\n", NTASK);
+	bus_reset();
+	sync_depth = 0;
+	bus_run = 1;
+	pthread_create(&bth, NULL, bus_thread, NULL);
+	for(t = 0; t < NTASK; t++) {
+		pthread_create(&tth[t], NULL, sync_task, (void*)(uintptr_t)t);
+	}
+	for(t = 0; t < NTASK; t++) {
+		pthread_join(tth[t], NULL);
+		CHECK(sync_err[t] == 0, "task %d: %d errors", t, sync_err[t]);
+	}
+	__atomic_store_n(&bus_run, 0, __ATOMIC_RELEASE);
+	pthread_join(bth, NULL);
+
+	printf("  %u transfers  max queued %u\n", bus.nstart, sync_depth);
+	CHECK(bus.nstart == NTASK * NSYNC, "%u transfers", bus.nstart);
+	CHECK(sync_depth > 1, "synchronous transactions are not queued together");
+	CHECK(get_dcb_ptr(1)->syncptn == 0, "flag bits are not released");
+	CHECK(sem_cnt == SYNC_MAX, "semaphore count %d", sem_cnt);
+}
+
+int main( void )
+{
+	pthread_mutexattr_t	attr;
+	INT			i;
+
+	pthread_mutexattr_init(&attr);
+	pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+	pthread_mutex_init(&intr_lock, &attr);
+
+	hi2c[0].Instance = (I2C_TypeDef*)I2C3_BASE;	// Unit 0: I2C3
+	hi2c[1].Instance = (I2C_TypeDef*)I2C1_BASE;	// Unit 1: I2C1
+	for(i = 0; i < DEV_HAL_I2C_UNITNM; i++) {
+		if(dev_init_hal_i2c((UW)i, &hi2c[i]) != E_OK) {
+			printf("dev_init_hal_i2c() failed\n");
+			return 1;
+		}
+		dd[i] = get_dcb_ptr(i)->devid;
+	}
+
+	test_order();
+	test_fair();
+	test_error();
+	test_sync();
+
+	printf("%s\n", (nerr == 0)? "OK": "FAILED");
+	return (nerr == 0)? 0: 1;
+}
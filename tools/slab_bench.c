@@ -0,0 +1,256 @@
+/*
+ *----------------------------------------------------------------------
+ *    micro T-Kernel 3.0 BSP 2.0
+ *
+ *    Copyright (C) 2023-2024 by Ken Sakamura.
+ *    This software is distributed under the T-License 2.1.
+ *----------------------------------------------------------------------
+ *
+ *    Released by TRON Forum(http://www.tron.org) at 2024/08.
+ *
+ *----------------------------------------------------------------------
+ */
+
+/*
+ *	slab_bench.c
+ *	Fragmentation benchmark of the slab allocator (Host tool)
+ *
+ *	usage: cc -O2 -o slab_bench tools/slab_bench.c
+ *	       ./slab_bench [<Number of operations> [<Random seed>]]
+ *
+ *	The random allocation and release of the small blocks (Driver control
+ *	blocks, lwIP mem_malloc) are run on the slab allocator (lib/libtk/slab.c)
+ *	and on a first-fit heap of the same size. The number of failures, the
+ *	first failure and the largest free block of the first-fit heap are
+ *	printed.
+ *	The first-fit heap wastes no memory by the size rounding and shares
+ *	all the free area between the sizes, so it fails fewer allocations at
+ *	these loads. Use the benchmark to size SLAB_MEMSZ for the workload.
+ *	Result (16 KB, 1M operations, seeds 1-10):
+ *		phase	: first-fit 0, slab 18 - 70 failures
+ *		residue	: first-fit 0, slab 797 - 439371 failures
+ *			  (Once the area is saturated, most of the later
+ *			   allocations fail.)
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+/* Definitions of micro T-Kernel used by slab.c */
+typedef int32_t		W;
+typedef uint32_t	UW;
+typedef uint16_t	UH;
+typedef uint8_t		UB;
+typedef int		INT;
+typedef unsigned int	UINT;
+typedef W		ER;
+typedef INT		BOOL;
+
+#define LOCAL		static
+#define EXPORT
+#define IMPORT		extern
+#define TRUE		1
+#define FALSE		0
+#define E_OK		(0)
+#define E_PAR		(-17)
+
+#define DI(imask)	((imask) = 0)	/* Single thread */
+#define EI(imask)	((void)(imask))
+#define knl_memset	memset
+#define knl_memcpy	memcpy
+
+#define USE_TMONITOR	(0)
+#define USE_SLAB	(1)
+#define SLAB_MEMSZ	(16*1024)
+#define SLAB_PAGESZ	(512)
+#define SLAB_CACHE	(8)
+#define SLAB_KMALLOC	(0)
+#define SLAB_NCLS	14
+
+typedef struct {			/* Same as <tk/syslib.h> */
+	UW	size;
+	UW	pages;
+	UW	inuse;
+	UW	peak;
+	UW	nalloc;
+	UW	nfail;
+} T_RSLAB;
+
+/* No memory out of the slab area (Counted as the failure) */
+LOCAL void *Kmalloc( size_t size ) { (void)size; return NULL; }
+LOCAL void *Krealloc( void *ptr, size_t size ) { (void)ptr; (void)size; return NULL; }
+LOCAL void Kfree( void *ptr ) { (void)ptr; }
+
+#define SLAB_HOSTBENCH
+#include "../lib/libtk/slab.c"
+
+/*----------------------------------------------------------------------
+ * First-fit heap (Reference)
+ *	Block header: Size (bytes, including the header) | Used bit
+ *	The adjacent free blocks are merged on release.
+ */
+#define FF_USED		1U
+
+LOCAL UW	ff_area[SLAB_MEMSZ / sizeof(UW)];
+
+LOCAL void ff_init( void )
+{
+	ff_area[0] = SLAB_MEMSZ;
+}
+
+LOCAL void *ff_alloc( size_t size )
+{
+	UW	i, sz, need;
+
+	need = (UW)((size + sizeof(UW) + 7) & ~7U);
+	for(i = 0; i < SLAB_MEMSZ / sizeof(UW); i += sz / sizeof(UW)) {
+		sz = ff_area[i] & ~FF_USED;
+		if((ff_area[i] & FF_USED) || sz < need) continue;
+		if(sz - need >= 16) {				// Split
+			ff_area[i + need / sizeof(UW)] = sz - need;
+			sz = need;
+		}
+		ff_area[i] = sz | FF_USED;
+		return &ff_area[i + 1];
+	}
+	return NULL;
+}
+
+LOCAL void ff_free( void *ptr )
+{
+	UW	*h, *prev, *p, sz;
+
+	h = (UW*)ptr - 1;
+	*h &= ~FF_USED;
+
+	prev = NULL;						// Merge with the neighbors
+	for(p = ff_area; p < &ff_area[SLAB_MEMSZ / sizeof(UW)]; p += sz / sizeof(UW)) {
+		sz = *p & ~FF_USED;
+		if(p == h) break;
+		prev = (*p & FF_USED)? NULL: p;
+	}
+	p = h + (*h / sizeof(UW));
+	if(p < &ff_area[SLAB_MEMSZ / sizeof(UW)] && !(*p & FF_USED)) *h += *p;
+	if(prev != NULL) *prev += *h;
+}
+
+LOCAL UW ff_maxfree( void )
+{
+	UW	i, sz, max = 0;
+
+	for(i = 0; i < SLAB_MEMSZ / sizeof(UW); i += sz / sizeof(UW)) {
+		sz = ff_area[i] & ~FF_USED;
+		if(!(ff_area[i] & FF_USED) && sz > max) max = sz;
+	}
+	return max;
+}
+
+/*----------------------------------------------------------------------
+ * Workload
+ *	Phase	: The size distribution is changed every PHASE operations.
+ *		  The live data is kept around 50% of the area.
+ *	Residue	: The size distribution is fixed, and some blocks live long
+ *		  (Released with the low probability). The live data is kept
+ *		  around 70% of the area.
+ */
+#define NLIVE		1024
+#define PHASE		20000
+
+LOCAL const UH	wl_size[][4] = {			// Sizes of the phase
+	{ 12,  24,  40,  200 },				// Multicast items, NetAddr
+	{ 20,  60, 100,  300 },				// Driver control blocks
+	{ 16,  36, 160,  480 },
+};
+#define NPHASE		(sizeof(wl_size) / sizeof(wl_size[0]))
+
+typedef struct {
+	void	*(*alloc)( size_t size );
+	void	(*free)( void *ptr );
+	const char *name;
+} T_BENCH;
+
+LOCAL void *slab_alloc( size_t size )
+{
+	return SlabAlloc(size);
+}
+
+LOCAL void slab_free( void *ptr )
+{
+	SlabFree(ptr);
+}
+
+LOCAL void print_result( const T_BENCH *b, const char *wl, long fail, long first )
+{
+	printf("%-8s %-10s failures %8ld  first failure %8ld", wl, b->name, fail, first);
+	if(b->free == ff_free) printf("  max free block %5u", ff_maxfree());
+	printf("\n");
+}
+
+LOCAL void run( const T_BENCH *b, BOOL residue, long nop, unsigned int seed )
+{
+	void	*ptr[NLIVE];
+	UH	sz[NLIVE];
+	UB	lng[NLIVE];
+	long	op, fail = 0, first = -1;
+	UW	live = 0, limit;
+	INT	n = 0, i;
+
+	limit = residue? SLAB_MEMSZ * 7 / 10: SLAB_MEMSZ / 2;
+	srand(seed);
+	for(op = 0; op < nop; op++) {
+		if(n > 0 && (live > limit || n >= NLIVE || rand() % 2)) {
+			i = rand() % n;				// Release
+			if(lng[i] && rand() % 64 != 0) continue;
+			b->free(ptr[i]);
+			live -= sz[i];
+			n--;
+			ptr[i] = ptr[n];
+			sz[i] = sz[n];
+			lng[i] = lng[n];
+		} else {
+			sz[n] = wl_size[residue? 0: (op / PHASE) % NPHASE][rand() % 4];
+			lng[n] = residue && (rand() % 8 == 0);
+			ptr[n] = b->alloc(sz[n]);
+			if(ptr[n] == NULL) {
+				if(first < 0) first = op;
+				fail++;
+				continue;
+			}
+			memset(ptr[n], 0xA5, sz[n]);
+			live += sz[n];
+			n++;
+		}
+	}
+	print_result(b, residue? "residue": "phase", fail, first);
+
+	while(n > 0) b->free(ptr[--n]);
+}
+
+int main( int argc, char *argv[] )
+{
+	static const T_BENCH	slab = { slab_alloc, slab_free, "slab" };
+	static const T_BENCH	ff = { ff_alloc, ff_free, "first-fit" };
+	T_RSLAB		stat;
+	long		nop;
+	unsigned int	seed;
+	INT		cls;
+
+	nop	= (argc > 1)? atol(argv[1]): 1000000;
+	seed	= (argc > 2)? (unsigned int)atoi(argv[2]): 1;
+
+	printf("Area %d bytes, %ld operations, seed %u\n", SLAB_MEMSZ, nop, seed);
+	ff_init();
+	run(&ff, FALSE, nop, seed);
+	run(&slab, FALSE, nop, seed);
+	run(&ff, TRUE, nop, seed);
+	run(&slab, TRUE, nop, seed);
+
+	printf("SIZE PAGES  INUSE   PEAK     NALLOC  NFAIL\n");
+	for(cls = 0; cls < SLAB_NCLS; cls++) {
+		SlabGetStat(cls, &stat);
+		printf("%4u %5u %6u %6u %10u %6u\n",
+			stat.size, stat.pages, stat.inuse, stat.peak, stat.nalloc, stat.nfail);
+	}
+	return 0;
+}